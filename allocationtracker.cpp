@@ -0,0 +1,246 @@
+#include "allocationtracker.h"
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <new>
+
+// Whether malloc() itself is counted, not just operator new
+#if defined(TRACK_ALLOCATIONS) && defined(Q_OS_LINUX) && defined(__GLIBC__)
+#define COUNTS_MALLOC
+#endif
+
+namespace {
+std::atomic<quint64> allocationCount(0);
+std::atomic<quint64> allocatedBytes(0);
+std::atomic<quint64> tagCounts[AllocationTracker::TAG_COUNT];
+
+thread_local AllocationTracker::Tag currentTag = AllocationTracker::UNTAGGED;
+
+// Only touched by the thread calling beginFrame()
+AllocationTracker::Counts frameStart;
+AllocationTracker::Counts previousFrame;
+quint64 frames = 0;
+quint64 allocatingFrames = 0;
+
+#ifdef TRACK_ALLOCATIONS
+void count(std::size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    tagCounts[currentTag].fetch_add(1, std::memory_order_relaxed);
+}
+
+void *allocate(std::size_t size)
+{
+#ifndef COUNTS_MALLOC
+    count(size);
+#endif
+    return std::malloc(size > 0 ? size : 1);
+}
+#endif
+}
+
+#ifdef COUNTS_MALLOC
+// glibc exports its allocator under these names too, so malloc() can be
+// replaced by one that counts and then forwards. This is what sees the
+// storage of QString, QByteArray, QVector and QHash, which Qt 5 takes
+// from malloc() rather than operator new.
+extern "C" {
+void *__libc_malloc(std::size_t size);
+void *__libc_calloc(std::size_t count, std::size_t size);
+void *__libc_realloc(void *memory, std::size_t size);
+void *__libc_memalign(std::size_t alignment, std::size_t size);
+void *__libc_valloc(std::size_t size);
+void *__libc_pvalloc(std::size_t size);
+void __libc_free(void *memory);
+
+void *malloc(std::size_t size)
+{
+    count(size);
+    return __libc_malloc(size);
+}
+
+void *calloc(std::size_t elements, std::size_t size)
+{
+    count(elements * size);
+    return __libc_calloc(elements, size);
+}
+
+// A realloc() that grows a buffer counts as an allocation, like the copy it may be
+void *realloc(void *memory, std::size_t size)
+{
+    if (size > 0) {
+        count(size);
+    }
+    return __libc_realloc(memory, size);
+}
+
+// The aligned variants; glibc frees all of them through free()
+void *memalign(std::size_t alignment, std::size_t size)
+{
+    count(size);
+    return __libc_memalign(alignment, size);
+}
+
+void *aligned_alloc(std::size_t alignment, std::size_t size)
+{
+    count(size);
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void **memory, std::size_t alignment, std::size_t size)
+{
+    // Same checks as glibc: a power of two that is a multiple of sizeof(void *)
+    if (alignment % sizeof(void *) != 0 || (alignment & (alignment - 1)) != 0 || alignment == 0) {
+        return EINVAL;
+    }
+    count(size);
+    void *result = __libc_memalign(alignment, size);
+    if (!result) {
+        return ENOMEM;
+    }
+    *memory = result;
+    return 0;
+}
+
+void *valloc(std::size_t size)
+{
+    count(size);
+    return __libc_valloc(size);
+}
+
+void *pvalloc(std::size_t size)
+{
+    count(size);
+    return __libc_pvalloc(size);
+}
+
+void free(void *memory)
+{
+    __libc_free(memory);
+}
+}
+#endif
+
+#ifdef TRACK_ALLOCATIONS
+void *operator new(std::size_t size)
+{
+    void *memory = allocate(size);
+    if (!memory) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    return allocate(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    return allocate(size);
+}
+
+void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, const std::nothrow_t &) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void *memory, const std::nothrow_t &) noexcept
+{
+    std::free(memory);
+}
+#endif
+
+namespace AllocationTracker
+{
+
+Counts total()
+{
+    Counts counts;
+    counts.allocations = allocationCount.load(std::memory_order_relaxed);
+    counts.bytes = allocatedBytes.load(std::memory_order_relaxed);
+    for (int tag = 0; tag < TAG_COUNT; ++tag) {
+        counts.perTag[tag] = tagCounts[tag].load(std::memory_order_relaxed);
+    }
+    return counts;
+}
+
+void beginFrame()
+{
+    const Counts now = total();
+    previousFrame.allocations = now.allocations - frameStart.allocations;
+    previousFrame.bytes = now.bytes - frameStart.bytes;
+    for (int tag = 0; tag < TAG_COUNT; ++tag) {
+        previousFrame.perTag[tag] = now.perTag[tag] - frameStart.perTag[tag];
+    }
+    frameStart = now;
+
+    frames++;
+    if (previousFrame.allocations > 0) {
+        allocatingFrames++;
+    }
+}
+
+const Counts &lastFrame()
+{
+    return previousFrame;
+}
+
+quint64 allocatingFrameCount()
+{
+    return allocatingFrames;
+}
+
+quint64 frameCount()
+{
+    return frames;
+}
+
+const char *tagName(Tag tag)
+{
+    switch (tag) {
+    case UNTAGGED:
+        return "untagged";
+    case WALK:
+        return "walk";
+    case BATTLE_MENU:
+        return "battle menu";
+    case SCRIPTS:
+        return "scripts";
+    case DEBUG_HUD:
+        return "debug hud";
+    case TAG_COUNT:
+        break;
+    }
+    return "?";
+}
+
+Scope::Scope(Tag tag)
+    : previous(currentTag)
+{
+    currentTag = tag;
+}
+
+Scope::~Scope()
+{
+    currentTag = previous;
+}
+
+}
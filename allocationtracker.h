@@ -0,0 +1,76 @@
+#ifndef ALLOCATIONTRACKER_H
+#define ALLOCATIONTRACKER_H
+
+#include <QtGlobal>
+
+// Counts heap allocations.
+//
+// Counting is only built in with CONFIG += track_allocations, which debug
+// builds turn on by default; benchmark builds pass it to qmake. Then
+// allocationtracker.cpp replaces the global operator new/delete for the
+// whole program, and on Linux with glibc also malloc(), calloc(),
+// realloc() and the aligned allocators, which is where Qt 5 gets the
+// storage of its strings and containers. Elsewhere only operator new is
+// seen, so a quiet counter there does not mean Qt allocated nothing.
+// Without the option the allocator is left alone and every counter stays 0.
+//
+// A frame is the time between two beginFrame() calls (one updateScene()).
+// Code that should not allocate in the steady state opens a Scope with its
+// tag, so a frame's allocations can be broken down by call site:
+//
+//   AllocationTracker::Scope scope(AllocationTracker::WALK);
+namespace AllocationTracker
+{
+    // Whether this build counts at all
+    constexpr bool isEnabled()
+    {
+#ifdef TRACK_ALLOCATIONS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    enum Tag {
+        UNTAGGED,
+        WALK,         // Applying a movement snapshot: sprite, camera, triggers
+        BATTLE_MENU,  // Moving the battle menu cursor
+        SCRIPTS,      // Event scripts ticking
+        DEBUG_HUD,    // The debug overlay's own counter text
+        TAG_COUNT
+    };
+
+    struct Counts {
+        quint64 allocations{0};
+        quint64 bytes{0};
+        quint64 perTag[TAG_COUNT] = {};
+    };
+
+    // Since start-up, on every thread
+    Counts total();
+
+    // Ends the current frame and starts the next one
+    void beginFrame();
+    // What the frame before the current one allocated
+    const Counts &lastFrame();
+    // Frames with at least one allocation since start-up, and all frames
+    quint64 allocatingFrameCount();
+    quint64 frameCount();
+
+    const char *tagName(Tag tag);
+
+    // Attributes the allocations made on this thread to a tag until it goes
+    // out of scope; scopes nest
+    class Scope
+    {
+    public:
+        explicit Scope(Tag tag);
+        ~Scope();
+
+    private:
+        Tag previous;
+        Q_DISABLE_COPY(Scope)
+    };
+}
+
+#endif // ALLOCATIONTRACKER_H
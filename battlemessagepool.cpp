@@ -0,0 +1,94 @@
+#include "battlemessagepool.h"
+#include <QDebug>
+
+BattleMessagePool::BattleMessagePool(QGraphicsScene *scene, int lineCount)
+    : scene(scene),
+      capacity(qMax(1, lineCount))
+{
+}
+
+BattleMessagePool::~BattleMessagePool()
+{
+    clear();
+}
+
+const QFont &BattleMessagePool::font()
+{
+    static const QFont battleFont("Arial", 12, QFont::Bold);
+    return battleFont;
+}
+
+void BattleMessagePool::createLines()
+{
+    lines.reserve(capacity);
+    for (int i = 0; i < capacity; ++i) {
+        Line line;
+        line.item = BitmapTextItem::create(scene, QString(), font());
+        line.item->setDefaultTextColor(Qt::black);
+        line.item->setZValue(205);  // Above the battle menu
+        line.item->setVisible(false);
+        lines.append(line);
+    }
+    oldest = 0;
+    qDebug() << "Battle message pool created" << capacity << "lines";
+}
+
+quint32 BattleMessagePool::show(const QString &text, const QPointF &pos)
+{
+    if (lines.isEmpty()) {
+        createLines();
+    }
+
+    // Prefer a hidden line; otherwise replace the oldest message
+    int index = -1;
+    for (int i = 0; i < lines.size(); ++i) {
+        if (lines[i].ticket == 0) {
+            index = i;
+            break;
+        }
+    }
+    if (index < 0) {
+        index = oldest;
+        oldest = (oldest + 1) % lines.size();
+    }
+
+    Line &line = lines[index];
+    line.ticket = nextTicket++;
+    if (nextTicket == 0) {
+        nextTicket = 1;
+    }
+    line.item->setPlainText(text);
+    line.item->setPos(pos);
+    line.item->setVisible(true);
+    return line.ticket;
+}
+
+void BattleMessagePool::hide(quint32 ticket)
+{
+    for (Line &line : lines) {
+        if (ticket != 0 && line.ticket == ticket) {
+            line.ticket = 0;
+            line.item->setVisible(false);
+            return;
+        }
+    }
+}
+
+void BattleMessagePool::hideAll()
+{
+    for (Line &line : lines) {
+        line.ticket = 0;
+        line.item->setVisible(false);
+    }
+}
+
+void BattleMessagePool::clear()
+{
+    for (Line &line : lines) {
+        if (line.item->scene()) {
+            line.item->scene()->removeItem(line.item);
+        }
+        delete line.item;
+    }
+    lines.clear();
+}
@@ -0,0 +1,53 @@
+#ifndef BATTLEMESSAGEPOOL_H
+#define BATTLEMESSAGEPOOL_H
+
+#include "bitmaptextitem.h"
+#include <QFont>
+#include <QGraphicsScene>
+#include <QPointF>
+#include <QString>
+#include <QVector>
+
+// Fixed set of text lines for battle messages ("Wild Squirtle used
+// Tackle!", "Pokemon is captured!", ...).
+//
+// The lines are created once, already styled, and reused with
+// setPlainText(), so a long battle allocates no items per turn and the
+// scene's item count stays flat. When every line is showing, the oldest
+// message is replaced.
+class BattleMessagePool
+{
+public:
+    explicit BattleMessagePool(QGraphicsScene *scene, int lineCount = 4);
+    ~BattleMessagePool();
+
+    // Shows text with its top-left corner at pos. The returned ticket hides
+    // exactly this message later, even if its line has been reused since.
+    quint32 show(const QString &text, const QPointF &pos);
+    void hide(quint32 ticket);
+    void hideAll();
+
+    // Removes and deletes every line - call before the scene is cleared
+    void clear();
+
+    // Arial 12 bold, shared by all battle text
+    static const QFont &font();
+
+    int lineCount() const { return lines.size(); }
+
+private:
+    struct Line {
+        BitmapTextItem *item{nullptr};
+        quint32 ticket{0};  // 0 while hidden
+    };
+
+    QGraphicsScene *scene;
+    int capacity;
+    QVector<Line> lines;
+    int oldest{0};
+    quint32 nextTicket{1};
+
+    void createLines();
+};
+
+#endif // BATTLEMESSAGEPOOL_H
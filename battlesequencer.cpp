@@ -0,0 +1,82 @@
+#include "battlesequencer.h"
+
+void BattleSequencer::after(int delayMs, const std::function<void()> &action)
+{
+    Step step;
+    step.remainingMs = qMax(0, delayMs);
+    step.action = action;
+    steps.append(step);
+}
+
+void BattleSequencer::waitForAction(const std::function<bool(int action)> &onAction)
+{
+    Step step;
+    step.onAction = onAction;
+    steps.append(step);
+}
+
+bool BattleSequencer::actionPressed(int action)
+{
+    if (!isWaitingForAction()) {
+        return false;
+    }
+
+    // Copy the handler out first: it may queue or cancel steps
+    std::function<bool(int)> onAction = steps[head].onAction;
+    const quint32 before = generation;
+    if (onAction(action) && generation == before) {
+        head++;
+        if (head >= steps.size()) {
+            steps.resize(0);
+            head = 0;
+        }
+    }
+    return true;
+}
+
+void BattleSequencer::advance(qint64 now)
+{
+    // The first tick only sets the time base, and a restarted clock never runs time backwards
+    qreal elapsed = lastNow < 0 ? 0 : static_cast<qreal>(qMax<qint64>(0, now - lastNow));
+    lastNow = now;
+    if (paused || head >= steps.size()) {
+        return;
+    }
+
+    const bool instant = timeScale <= 0;
+    elapsed *= timeScale;
+
+    // Run every step that came due, carrying leftover time into the next one
+    while (head < steps.size()) {
+        Step &step = steps[head];
+        if (step.onAction) {
+            break;  // Time stands still for the steps behind an input wait
+        }
+        if (!instant && step.remainingMs > elapsed) {
+            step.remainingMs -= elapsed;
+            break;
+        }
+        elapsed -= step.remainingMs;
+
+        // Take the action out first: it may queue or cancel steps
+        std::function<void()> action = step.action;
+        head++;
+        action();
+
+        if (paused) {
+            break;
+        }
+    }
+
+    if (head >= steps.size()) {
+        steps.resize(0);  // Keeps the storage for the next steps
+        head = 0;
+    }
+}
+
+void BattleSequencer::cancel()
+{
+    steps.resize(0);
+    head = 0;
+    generation++;
+}
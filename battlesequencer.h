@@ -0,0 +1,69 @@
+#ifndef BATTLESEQUENCER_H
+#define BATTLESEQUENCER_H
+
+#include <QVector>
+#include <functional>
+
+// Runs the timed steps of a battle (show a message, redraw the HP bars,
+// start the wild Pokémon's turn, ...) one after another.
+//
+// Each step waits for its delay after the previous step has run, so a
+// battle is written as a flat queue instead of nested QTimer::singleShot
+// lambdas. Time comes from the scene's clock through advance(), which
+// makes the whole queue cancellable, pausable and scalable: a time scale
+// of 10 plays a battle ten times faster, and a scale of 0 runs every
+// queued step on the next advance().
+//
+// A step can also wait for input (waitForAction), so a flow such as "pick a
+// Pokémon, let the dialogue clear, open the battle" is queued in one place
+// instead of being split across state flags and key handlers. Finished
+// steps are dropped without giving back the queue's storage, so a battle
+// reuses the same step slots from turn to turn.
+class BattleSequencer
+{
+public:
+    BattleSequencer() = default;
+
+    // Queues action to run delayMs after the previous step. Steps may queue
+    // further steps while they run.
+    void after(int delayMs, const std::function<void()> &action);
+
+    // Queues a step that holds the queue until onAction accepts one of the
+    // input actions passed to actionPressed(). The steps after it are timed
+    // from that press.
+    void waitForAction(const std::function<bool(int action)> &onAction);
+
+    // Offers an action to a waiting step; returns false when none is waiting
+    bool actionPressed(int action);
+    bool isWaitingForAction() const { return head < steps.size() && steps[head].onAction; }
+
+    // now: milliseconds on the driving clock (e.g. QElapsedTimer::elapsed())
+    void advance(qint64 now);
+
+    // Drops every queued step; a step that is running finishes normally
+    void cancel();
+
+    void setPaused(bool paused) { this->paused = paused; }
+    bool isPaused() const { return paused; }
+    void setTimeScale(qreal scale) { timeScale = qMax(0.0, scale); }
+    qreal getTimeScale() const { return timeScale; }
+
+    bool isIdle() const { return head >= steps.size(); }
+    int pendingCount() const { return steps.size() - head; }
+
+private:
+    struct Step {
+        qreal remainingMs{0};  // Scene time left before the step runs
+        std::function<void()> action;
+        std::function<bool(int)> onAction;  // Set for steps that wait for input
+    };
+
+    QVector<Step> steps;
+    int head{0};  // Next step; the queue is compacted once it runs dry
+    quint32 generation{0};  // Bumped by cancel(), so an input step can tell it was dropped
+    qint64 lastNow{-1};
+    bool paused{false};
+    qreal timeScale{1.0};
+};
+
+#endif // BATTLESEQUENCER_H
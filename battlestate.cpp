@@ -0,0 +1,359 @@
+#include "battlestate.h"
+#include "inputsystem.h"
+#include "stringtable.h"
+#include <QDebug>
+#include <QRandomGenerator>
+
+BattleState::BattleState(QRandomGenerator *random)
+    : random(random)
+{
+}
+
+void BattleState::start(const Setup &setup, qint64 nowMs)
+{
+    // Sets the sequencer's time base, so the time since the last battle is not counted
+    sequencer.advance(nowMs);
+    sequencer.cancel();
+
+    active = true;
+    wildSpecies = setup.wildSpecies;
+    wildHp = WILD_MAX_HP;
+    party = setup.party;
+    items = setup.items;
+    qDebug() << "Battle with wild" << wildSpecies << "- waiting for the party selection";
+
+    // Pick a Pokémon, let the dialogue clear, then open the battle
+    sequencer.waitForAction([this](int action) { return choosePokemon(action); });
+}
+
+void BattleState::choose(int action, qint64 nowMs)
+{
+    sequencer.advance(nowMs);
+    sequencer.actionPressed(action);
+}
+
+void BattleState::command(Command command, int index, qint64 nowMs)
+{
+    sequencer.advance(nowMs);
+    if (!active || party.isEmpty()) {
+        return;
+    }
+
+    // Running away is always possible; anything else waits for the last turn
+    if (command == RUN) {
+        end();
+        return;
+    }
+    if (isBusy()) {
+        return;
+    }
+
+    switch (command) {
+        case FIGHT:
+            useMove(index);
+            break;
+        case USE_ITEM:
+            useItem(index);
+            break;
+        case RUN:
+            break;
+    }
+}
+
+void BattleState::advance(qint64 nowMs)
+{
+    sequencer.advance(nowMs);
+}
+
+void BattleState::cancel()
+{
+    sequencer.cancel();
+    active = false;
+    events.resize(0);
+}
+
+void BattleState::takeEvents(QVector<Event> &out)
+{
+    out += events;
+    events.resize(0);
+}
+
+bool BattleState::choosePokemon(int action)
+{
+    if (action == InputSystem::CANCEL) {
+        qDebug() << "Escaping from battle";
+        end();
+        return true;
+    }
+
+    int index = InputSystem::selection(action) - 1;
+    if (index < 0 || index >= party.size()) {
+        return false;
+    }
+
+    qDebug() << "Selected Pokemon at index" << index << "- moving to front and starting battle";
+    party.move(index, 0);
+    raise(Event::PARTY_CHOSEN, index);
+    sequencer.after(100, [this]() {
+        raise(Event::OPENED);
+    });
+    return true;
+}
+
+void BattleState::useMove(int moveIndex)
+{
+    Pokemon &activePokemon = party.first();
+
+    // Handle "Do Nothing" option
+    if (moveIndex == -1) {
+        // Opponent's turn without showing any text
+        sequencer.after(1000, [this]() {
+            wildPokemonTurn();
+        });
+        return;
+    }
+
+    // Check if move index is valid and has PP
+    const QVector<Pokemon::Move> &moves = activePokemon.getMoves();
+    if (moveIndex < 0 || moveIndex >= moves.size() || moves[moveIndex].pp <= 0) {
+        return;
+    }
+    const Pokemon::Move selectedMove = moves[moveIndex];
+
+    // Calculate damage using the formula: Damage = (Power + User's Attack - Opponent's Defense) × Level
+    int power = selectedMove.power;
+    int userAttack = activePokemon.getAttack();
+    int opponentDefense = 5; // Base defense for wild Pokémon
+    int damage = (power + userAttack - opponentDefense) * activePokemon.getLevel();
+    if (damage < 1) damage = 1; // Minimum damage is 1
+
+    activePokemon.setMovePp(moveIndex, selectedMove.pp - 1);
+    pokemonChanged();
+
+    // Apply damage to wild Pokemon
+    wildHp = qMax(0, wildHp - damage);
+    raise(Event::WILD_HP, wildHp);
+
+    // Show the move and damage, then the new HP
+    QString text;
+    StringTable::format(text, STR_PLAYER_MOVE,
+                        {StringTable::name(activePokemon.getName()), StringTable::name(selectedMove.name), damage});
+    showMessage(PROMPT, text);
+    raise(Event::REFRESH);
+
+    // Check if battle should end
+    if (wildHp <= 0) {
+        // Level up the player's Pokémon
+        activePokemon.setLevel(activePokemon.getLevel() + 1);
+        pokemonChanged();
+
+        StringTable::format(text, STR_VICTORY, {StringTable::name(activePokemon.getName()), activePokemon.getLevel()});
+        showMessage(PROMPT, text);
+
+        // Exit battle scene after a delay
+        sequencer.after(2000, [this]() {
+            end();
+        });
+        return;
+    }
+
+    // Opponent's turn
+    sequencer.after(2000, [this]() {
+        wildPokemonTurn();
+    });
+}
+
+void BattleState::useItem(int itemIndex)
+{
+    Pokemon &activePokemon = party.first();
+    QString text;
+
+    switch (itemIndex) {
+        case 1: // Poké Ball
+            if (items.value("Poké Ball", 0) <= 0) {
+                break;
+            }
+
+            // 50% chance to catch
+            if (random->bounded(100) < 50) {
+                for (const Pokemon &pokemon : party) {
+                    if (pokemon.getName() == wildSpecies) {
+                        // The ball is not used up on a species the player already has
+                        showMessage(PLAYER_SIDE, StringTable::get(STR_ALREADY_HAVE));
+                        sequencer.after(2000, [this]() {
+                            raise(Event::REFRESH);
+                        });
+                        return;
+                    }
+                }
+
+                takeItem("Poké Ball");
+                Event caught;
+                caught.type = Event::CAUGHT;
+                caught.text = wildSpecies;
+                caught.value = wildHp;  // Keeps the HP it had left
+                events.append(caught);
+                showMessage(PLAYER_SIDE, StringTable::get(STR_CAPTURED));
+
+                // Exit battle scene after 2 seconds
+                sequencer.after(2000, [this]() {
+                    end();
+                });
+            } else {
+                takeItem("Poké Ball");
+
+                // Show the failure above the wild Pokémon for 2 seconds, then
+                // wait 2 more seconds before it attacks
+                const int messageId = showMessage(WILD_SIDE, StringTable::get(STR_CAPTURE_FAILED));
+                sequencer.after(2000, [this, messageId]() {
+                    raise(Event::HIDE_MESSAGE, messageId);
+                });
+                sequencer.after(2000, [this]() {
+                    wildPokemonTurn();
+                });
+            }
+            return;
+
+        case 2: // Potion
+            if (items.value("Potion", 0) <= 0) {
+                break;
+            }
+
+            // Only heal if not at max HP
+            if (activePokemon.getCurrentHp() >= activePokemon.getMaxHp()) {
+                showMessage(PLAYER_SIDE, StringTable::get(STR_HP_FULL));
+                sequencer.after(1000, [this]() {
+                    raise(Event::REFRESH);
+                });
+                return;
+            }
+
+            activePokemon.setCurrentHp(qMin(activePokemon.getCurrentHp() + 10, activePokemon.getMaxHp()));
+            pokemonChanged();
+            takeItem("Potion");
+            StringTable::format(text, STR_RECOVERED_HP, {StringTable::name(activePokemon.getName())});
+            showMessage(PLAYER_SIDE, text);
+
+            // Show the new HP after 2 seconds, then the wild Pokémon's turn
+            sequencer.after(2000, [this]() {
+                raise(Event::REFRESH);
+            });
+            sequencer.after(2000, [this]() {
+                wildPokemonTurn();
+            });
+            return;
+
+        case 3: // Ether
+            if (items.value("Ether", 0) <= 0) {
+                break;
+            }
+
+            // Restore PP of all moves
+            for (int i = 0; i < activePokemon.getMoves().size(); ++i) {
+                activePokemon.setMovePp(i, 20);
+            }
+            pokemonChanged();
+            takeItem("Ether");
+            showMessage(PLAYER_SIDE, StringTable::get(STR_PP_RESTORED));
+
+            // Wait 3 seconds before wild Pokémon's turn
+            sequencer.after(3000, [this]() {
+                wildPokemonTurn();
+            });
+            return;
+    }
+
+    // Nothing of that kind in the bag: straight back to the menu
+    raise(Event::REFRESH);
+}
+
+void BattleState::wildPokemonTurn()
+{
+    Pokemon &activePokemon = party.first();
+
+    // Calculate damage using the same formula: Damage = (Power + User's Attack - Opponent's Defense) × Level
+    int power = 10; // Base power for wild Pokémon moves
+    int wildAttack = 5; // Same attack as player Pokémon
+    int playerDefense = 5; // Base defense for player's Pokémon
+    int wildLevel = 1; // Wild Pokémon are always level 1
+    int damage = (power + wildAttack - playerDefense) * wildLevel;
+    if (damage < 1) damage = 1; // Minimum damage is 1
+
+    QString text;
+    StringTable::format(text, STR_WILD_USED, {StringTable::name(wildSpecies), StringTable::name("Tackle")});
+    showMessage(WILD_MOVE, text);
+    showMessage(WILD_DAMAGE, StringTable::format(text, STR_DEALT_DAMAGE, {damage}));
+
+    activePokemon.setCurrentHp(qMax(0, activePokemon.getCurrentHp() - damage));
+    pokemonChanged();
+
+    // Update battle display after a short delay
+    sequencer.after(2000, [this]() {
+        raise(Event::REFRESH);
+
+        // Check if battle should end
+        const Pokemon &playerPokemon = party.first();
+        if (playerPokemon.getCurrentHp() <= 0) {
+            QString fainted;
+            showMessage(WILD_SIDE, StringTable::format(fainted, STR_FAINTED, {StringTable::name(playerPokemon.getName())}));
+
+            // Exit battle scene after a delay without showing additional text
+            sequencer.after(2000, [this]() {
+                end();
+            });
+            return;
+        }
+
+        // Return to battle menu
+        raise(Event::NEXT_TURN);
+    });
+}
+
+void BattleState::end()
+{
+    // Nothing queued for this battle may run once it is over
+    sequencer.cancel();
+    active = false;
+    raise(Event::ENDED);
+}
+
+void BattleState::takeItem(const QString &item)
+{
+    items[item]--;
+    Event used;
+    used.type = Event::ITEM_USED;
+    used.text = item;
+    events.append(used);
+}
+
+void BattleState::raise(Event::Type type, int value)
+{
+    Event event;
+    event.type = type;
+    event.value = value;
+    events.append(event);
+}
+
+int BattleState::showMessage(MessageSlot slot, const QString &text)
+{
+    Event event;
+    event.type = Event::MESSAGE;
+    event.id = nextMessageId++;
+    event.slot = slot;
+    event.text = text;
+    events.append(event);
+    return event.id;
+}
+
+void BattleState::pokemonChanged()
+{
+    const Pokemon &activePokemon = party.first();
+    Event event;
+    event.type = Event::POKEMON_CHANGED;
+    event.value = activePokemon.getCurrentHp();
+    event.level = activePokemon.getLevel();
+    for (const Pokemon::Move &move : activePokemon.getMoves()) {
+        event.pp.append(move.pp);
+    }
+    events.append(event);
+}
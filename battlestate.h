@@ -0,0 +1,120 @@
+#ifndef BATTLESTATE_H
+#define BATTLESTATE_H
+
+#include "battlesequencer.h"
+#include "pokemon.h"
+#include <QMap>
+#include <QString>
+#include <QVector>
+
+class QRandomGenerator;
+
+// Rules and pacing of a wild battle, run on the simulation thread.
+//
+// The grassland hands over a copy of the party and the bag when a battle
+// starts. From then on the party selection, the moves, items, catches, the
+// wild Pokémon's turns and the delays between them all play out here, on
+// the simulation's clock and random generator, so a slow repaint never
+// holds a battle up. Every visible result - a message, new HP, a used
+// item, the end of the battle - becomes an Event, which the simulation
+// publishes with its next snapshot; the scene only draws them and copies
+// the changes back into Game.
+class BattleState
+{
+public:
+    // Copied out of Game when the battle starts
+    struct Setup {
+        QString wildSpecies;
+        QVector<Pokemon> party;      // Game's order, front first
+        QMap<QString, int> items;    // Poké Ball, Potion and Ether counts
+    };
+
+    // The battle menu's choices, sent once the player has picked one
+    enum Command {
+        FIGHT,     // index: move, -1 to do nothing
+        USE_ITEM,  // index: 1 Poké Ball, 2 Potion, 3 Ether
+        RUN
+    };
+
+    // Where a message goes on the battle screen
+    enum MessageSlot {
+        PLAYER_SIDE,  // Above the player's Pokémon
+        WILD_SIDE,    // Above the wild Pokémon
+        WILD_MOVE,    // The wild Pokémon's move, and its damage one line below
+        WILD_DAMAGE,
+        PROMPT        // Over the menu at the bottom
+    };
+
+    struct Event {
+        enum Type {
+            PARTY_CHOSEN,     // value: party index moved to the front
+            OPENED,           // The battle screen comes up with the menu
+            MESSAGE,          // id, slot, text
+            HIDE_MESSAGE,     // id
+            REFRESH,          // Redraw the screen with the current HP
+            NEXT_TURN,        // Back to the menu, cursor on FIGHT
+            WILD_HP,          // value
+            POKEMON_CHANGED,  // The front Pokémon: value HP, level, pp per move
+            ITEM_USED,        // text: item, one less in the bag
+            CAUGHT,           // text: species, value: its HP
+            ENDED
+        };
+
+        Type type{ENDED};
+        int id{0};
+        int slot{PROMPT};
+        int value{0};
+        int level{0};
+        QString text;
+        QVector<int> pp;
+    };
+
+    static const int WILD_MAX_HP = 30;
+
+    explicit BattleState(QRandomGenerator *random);
+
+    // Shows nothing itself: the scene puts up the party selection, and
+    // choose() answers it. nowMs comes from the clock advance() runs on.
+    void start(const Setup &setup, qint64 nowMs);
+    // Input while the party selection is up: a number picks, cancel runs
+    void choose(int action, qint64 nowMs);
+    // Ignored while the previous choice is still playing out, except RUN
+    void command(Command command, int index, qint64 nowMs);
+    void advance(qint64 nowMs);
+    // Ends the battle without an ENDED event, e.g. when the world unloads
+    void cancel();
+
+    bool isActive() const { return active; }
+    // Steps are queued and no new command is taken
+    bool isBusy() const { return !sequencer.isIdle(); }
+    // Steps are waiting on the clock, not on the player
+    bool isRunning() const { return !sequencer.isIdle() && !sequencer.isWaitingForAction(); }
+    void setTimeScale(qreal scale) { sequencer.setTimeScale(scale); }
+
+    // Hands over the events raised since the last call, oldest first
+    void takeEvents(QVector<Event> &out);
+
+private:
+    QRandomGenerator *random;
+    BattleSequencer sequencer;
+    bool active{false};
+    QString wildSpecies;
+    int wildHp{WILD_MAX_HP};
+    QVector<Pokemon> party;
+    QMap<QString, int> items;
+    QVector<Event> events;
+    int nextMessageId{1};
+
+    bool choosePokemon(int action);
+    void useMove(int moveIndex);
+    void useItem(int itemIndex);
+    void wildPokemonTurn();
+    void end();
+    void takeItem(const QString &item);
+
+    void raise(Event::Type type, int value = 0);
+    int showMessage(MessageSlot slot, const QString &text);
+    void pokemonChanged();
+};
+
+#endif // BATTLESTATE_H
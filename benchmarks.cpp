@@ -0,0 +1,454 @@
+#include "benchmarks.h"
+#include "allocationtracker.h"
+#include "battlesequencer.h"
+#include "collisionworld.h"
+#include "game.h"
+#include "grasslandscene.h"
+#include "kinematicmover.h"
+#include "maplayout.h"
+#include "pathfinder.h"
+#include "pokemon.h"
+#include "savegame.h"
+#include "simulation.h"
+#include "stringtable.h"
+#include "triggersystem.h"
+#include <QApplication>
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QGraphicsScene>
+#include <QGraphicsView>
+#include <QKeyEvent>
+#include <QRandomGenerator>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QTimer>
+#include <QVector>
+
+namespace Benchmarks
+{
+
+int runFromArguments(int argc, char *argv[])
+{
+    QByteArray benchmark;
+    for (int i = 1; i < argc; ++i) {
+        if (QByteArray(argv[i]).startsWith("--bench-")) {
+            benchmark = argv[i];
+        }
+    }
+
+    if (benchmark.isEmpty()) {
+        return -1;
+    }
+
+    // The allocation run plays real scenes, which need a widget application;
+    // it draws offscreen unless a platform was chosen
+    if (benchmark == "--bench-alloc") {
+        if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+            qputenv("QT_QPA_PLATFORM", "offscreen");
+        }
+        QApplication app(argc, argv);
+        return runAllocations();
+    }
+
+    // Timers and Qt containers only need a core application, no window
+    QCoreApplication app(argc, argv);
+    if (benchmark == "--bench-pathfinding") {
+        return runPathfinding();
+    }
+    if (benchmark == "--bench-save") {
+        return runSaveLoad();
+    }
+
+    QTextStream(stderr) << "Unknown benchmark " << benchmark << "\n";
+    return 1;
+}
+
+namespace {
+// Runs body once to warm up its buffers, then ITERATIONS times, and returns
+// how many allocations the measured runs made
+template<typename Body>
+quint64 countAllocations(Body body)
+{
+    const int ITERATIONS = 1000;
+    body(0);
+    const quint64 before = AllocationTracker::total().allocations;
+    for (int i = 1; i <= ITERATIONS; ++i) {
+        body(i);
+    }
+    return AllocationTracker::total().allocations - before;
+}
+
+quint64 taggedAllocations(AllocationTracker::Tag tag)
+{
+    return AllocationTracker::total().perTag[tag];
+}
+
+// Lets frames, timers and the simulation thread run for a while
+void runEventLoop(int ms)
+{
+    QEventLoop loop;
+    QTimer::singleShot(ms, &loop, &QEventLoop::quit);
+    loop.exec();
+}
+
+void sendKey(Game &game, QEvent::Type type, int key)
+{
+    QKeyEvent event(type, key, Qt::NoModifier);
+    if (type == QEvent::KeyPress) {
+        game.handleKeyPress(&event);
+    } else {
+        game.handleKeyRelease(&event);
+    }
+}
+
+// A square walk around the middle of the town, through the same path as
+// playing: key press, simulation step, snapshot, sprite, camera, streamed
+// background. The first lap fills the sprite cache and creates the
+// background chunks it passes; the second is counted.
+quint64 walkTown(Game &game)
+{
+    static const int keys[4] = {Qt::Key_Right, Qt::Key_Down, Qt::Key_Left, Qt::Key_Up};
+    const int LEG_MS = 500;
+
+    game.changeScene(GameState::TOWN);
+    runEventLoop(300);
+
+    quint64 before = 0;
+    for (int lap = 0; lap < 2; ++lap) {
+        if (lap == 1) {
+            before = taggedAllocations(AllocationTracker::WALK);
+        }
+        for (int key : keys) {
+            sendKey(game, QEvent::KeyPress, key);
+            runEventLoop(LEG_MS);
+            sendKey(game, QEvent::KeyRelease, key);
+        }
+    }
+    return taggedAllocations(AllocationTracker::WALK) - before;
+}
+
+// Opens a battle in the grassland and moves the menu cursor around the four
+// options, a frame between each move
+quint64 battleMenuCursor(Game &game, int rounds)
+{
+    static const int keys[4] = {Qt::Key_Right, Qt::Key_Down, Qt::Key_Left, Qt::Key_Up};
+
+    game.addPokemon(new Pokemon(Pokemon::CHARMANDER));
+    game.changeScene(GameState::GRASSLAND);
+    GrasslandScene *grassland = dynamic_cast<GrasslandScene *>(game.getCurrentScene());
+    if (!grassland) {
+        return 0;
+    }
+    game.getSimulation()->setBattleTimeScale(0);
+    static_cast<ScriptHost *>(grassland)->scriptStartBattle("Bulbasaur");
+    sendKey(game, QEvent::KeyPress, Qt::Key_1);
+    sendKey(game, QEvent::KeyRelease, Qt::Key_1);
+    runEventLoop(300);
+
+    quint64 before = 0;
+    for (int round = 0; round <= rounds; ++round) {
+        if (round == 1) {
+            before = taggedAllocations(AllocationTracker::BATTLE_MENU);  // Round 0 warms up
+        }
+        for (int key : keys) {
+            sendKey(game, QEvent::KeyPress, key);
+            sendKey(game, QEvent::KeyRelease, key);
+            QCoreApplication::processEvents();
+        }
+    }
+    return taggedAllocations(AllocationTracker::BATTLE_MENU) - before;
+}
+}
+
+int runPathfinding()
+{
+    QTextStream out(stdout);
+
+    // The grassland is the largest map and the only one with ledges
+    CollisionWorld world;
+    for (const QRectF &rect : MapLayout::grasslandBarriers()) {
+        world.addSolid(rect);
+    }
+    for (const QRectF &rect : MapLayout::grasslandLedges()) {
+        world.addLedge(rect);
+    }
+
+    const QRectF bounds(0, 0, MapLayout::GRASSLAND_WIDTH - 25, MapLayout::GRASSLAND_HEIGHT - 48);
+
+    Pathfinder pathfinder;
+    QElapsedTimer timer;
+    timer.start();
+    pathfinder.build(world, bounds);
+    qint64 buildNs = timer.nsecsElapsed();
+
+    out << "Grid: " << pathfinder.columns() << " x " << pathfinder.rowCount() << " nodes, "
+        << pathfinder.walkableCount() << " walkable, built in " << buildNs / 1000 << " us\n";
+
+    // Fixed seed so runs can be compared with each other
+    QRandomGenerator random(31);
+    const int QUERY_COUNT = 2000;
+    QVector<QPointF> starts;
+    QVector<QPointF> goals;
+    while (starts.size() < QUERY_COUNT) {
+        QPointF start(random.bounded(static_cast<int>(bounds.width())), random.bounded(static_cast<int>(bounds.height())));
+        QPointF goal(random.bounded(static_cast<int>(bounds.width())), random.bounded(static_cast<int>(bounds.height())));
+        if (pathfinder.isWalkable(start) && pathfinder.isWalkable(goal)) {
+            starts.append(start);
+            goals.append(goal);
+        }
+    }
+
+    QVector<QPointF> path;
+
+    // Every query runs a full A* search
+    pathfinder.setCacheEnabled(false);
+    int found = 0;
+    qint64 expanded = 0;
+    timer.restart();
+    for (int i = 0; i < QUERY_COUNT; ++i) {
+        if (pathfinder.findPath(starts[i], goals[i], path)) {
+            found++;
+        }
+        expanded += pathfinder.lastExpandedCount();
+    }
+    qint64 uncachedNs = qMax<qint64>(1, timer.nsecsElapsed());
+
+    out << "Uncached: " << QUERY_COUNT << " queries, " << found << " reachable, "
+        << expanded / QUERY_COUNT << " nodes expanded on average\n";
+    out << "  " << uncachedNs / 1000.0 / QUERY_COUNT << " us/query, "
+        << static_cast<qint64>(QUERY_COUNT * 1e9 / uncachedNs) << " queries/s\n";
+
+    // Repeated queries over a working set that fits in the cache, like NPC patrols
+    const int WORKING_SET = 256;
+    const int REPEATS = 20;
+    pathfinder.setCacheEnabled(true);
+    for (int i = 0; i < WORKING_SET; ++i) {
+        pathfinder.findPath(starts[i], goals[i], path);
+    }
+    timer.restart();
+    for (int repeat = 0; repeat < REPEATS; ++repeat) {
+        for (int i = 0; i < WORKING_SET; ++i) {
+            pathfinder.findPath(starts[i], goals[i], path);
+        }
+    }
+    qint64 cachedNs = qMax<qint64>(1, timer.nsecsElapsed());
+    const int cachedQueries = WORKING_SET * REPEATS;
+
+    out << "Cached: " << cachedQueries << " queries, " << pathfinder.cacheHits() << " hits, "
+        << pathfinder.cacheMisses() - QUERY_COUNT << " misses\n";
+    out << "  " << cachedNs / 1000.0 / cachedQueries << " us/query, "
+        << static_cast<qint64>(cachedQueries * 1e9 / cachedNs) << " queries/s\n";
+
+    return 0;
+}
+
+int runSaveLoad()
+{
+    QTextStream out(stdout);
+
+    QTemporaryDir directory;
+    if (!directory.isValid()) {
+        out << "Could not create a temporary directory\n";
+        return 1;
+    }
+    const QString path = directory.filePath("save.dat");
+
+    // From a normal game up to far more than anyone will ever collect
+    const int SCALES[] = {6, 1000, 100000};
+    QRandomGenerator random(33);
+
+    for (int scale : SCALES) {
+        SaveData data;
+        data.scene = 3;
+        data.townBoxesInitialized = true;
+        for (int i = 0; i < scale; ++i) {
+            SaveData::PokemonRecord pokemon;
+            pokemon.type = random.bounded(3);
+            pokemon.level = random.bounded(1, 100);
+            pokemon.currentHp = random.bounded(31);
+            pokemon.movePp = {random.bounded(21), random.bounded(21)};
+            data.party.append(pokemon);
+            data.inventory.insert(QString("Item %1").arg(i), random.bounded(1, 100));
+        }
+        for (int i = 0; i < 15; ++i) {
+            data.townBoxPositions.append(QPointF(random.bounded(1000), random.bounded(1000)));
+            data.townBoxOpenedStates.insert(i, random.bounded(2) == 1);
+            data.townBoxContents.insert(i, "Potion");
+        }
+
+        // Enough rounds for stable numbers without taking minutes
+        const int rounds = qMax(3, 20000 / scale);
+        QElapsedTimer timer;
+        qint64 snapshotNs = 0;
+        qint64 serializeNs = 0;
+        qint64 deserializeNs = 0;
+        qint64 writeNs = 0;
+        qint64 readNs = 0;
+        int bytes = 0;
+
+        for (int round = 0; round < rounds; ++round) {
+            timer.start();
+            SaveData snapshot = data;
+            snapshotNs += timer.nsecsElapsed();
+
+            timer.restart();
+            QByteArray serialized = SaveGame::serialize(snapshot);
+            serializeNs += timer.nsecsElapsed();
+            bytes = serialized.size();
+
+            SaveData loaded;
+            timer.restart();
+            if (!SaveGame::deserialize(serialized, loaded)) {
+                out << "Round trip failed\n";
+                return 1;
+            }
+            deserializeNs += timer.nsecsElapsed();
+
+            timer.restart();
+            SaveGame::writeFile(path, snapshot);
+            writeNs += timer.nsecsElapsed();
+
+            timer.restart();
+            if (!SaveGame::readFile(path, loaded) || loaded.party.size() != scale) {
+                out << "Reading the save back failed\n";
+                return 1;
+            }
+            readNs += timer.nsecsElapsed();
+        }
+
+        out << scale << " Pokemon / " << scale << " item kinds: " << bytes << " bytes\n";
+        out << "  snapshot " << snapshotNs / 1000.0 / rounds << " us, serialize "
+            << serializeNs / 1000.0 / rounds << " us, deserialize " << deserializeNs / 1000.0 / rounds << " us\n";
+        out << "  write file " << writeNs / 1000.0 / rounds << " us, read file "
+            << readNs / 1000.0 / rounds << " us\n";
+    }
+
+    return 0;
+}
+
+int runAllocations()
+{
+    QTextStream out(stdout);
+    if (!AllocationTracker::isEnabled()) {
+        // Every counter would read 0 and the run would pass without measuring anything
+        out << "Allocation counting is not built in - rebuild with qmake CONFIG+=track_allocations\n";
+        return 1;
+    }
+
+    int failures = 0;
+    auto report = [&](const char *name, quint64 allocations) {
+        out << name << ": " << allocations << " allocations in 1000 runs\n";
+        if (allocations > 0) {
+            failures++;
+        }
+    };
+
+    // Battle and dialogue text, written into a buffer the caller keeps
+    QString buffer;
+    const QString species("Charmander");
+    const QString move("Scratch");
+    report("StringTable::format", countAllocations([&](int i) {
+        StringTable::format(buffer, STR_PLAYER_MOVE, {species, move, i % 20});
+    }));
+
+    // Walking around the grassland: sweeps against the real map
+    CollisionWorld world;
+    for (const QRectF &rect : MapLayout::grasslandBarriers()) {
+        world.addSolid(rect);
+    }
+    for (const QRectF &rect : MapLayout::grasslandLedges()) {
+        world.addLedge(rect);
+    }
+    KinematicMover mover;
+    QPointF position(MapLayout::GRASSLAND_WIDTH / 2, MapLayout::GRASSLAND_HEIGHT / 2);
+    report("KinematicMover::move", countAllocations([&](int i) {
+        const QPointF delta = (i / 100) % 2 == 0 ? QPointF(4, 4) : QPointF(-4, -4);
+        position = mover.move(world, position, delta).position;
+    }));
+
+    // Portal and grass triggers raised along the way
+    TriggerSystem triggers;
+    int index = 0;
+    for (const QRectF &rect : MapLayout::grasslandTallGrass()) {
+        triggers.addRect(TriggerSystem::Kind::Grass, index++, rect);
+    }
+    triggers.addRect(TriggerSystem::Kind::Portal, 0, MapLayout::grasslandTownPath());
+    triggers.addRect(TriggerSystem::Kind::Bulletin, 0, MapLayout::grasslandBulletinBoard());
+    report("TriggerSystem::updatePlayer", countAllocations([&](int i) {
+        triggers.updatePlayer(QPointF((i * 7) % MapLayout::GRASSLAND_WIDTH, (i * 3) % MapLayout::GRASSLAND_HEIGHT));
+    }));
+
+    // NPC patrols repeat the same few paths, which come from the cache
+    Pathfinder pathfinder;
+    pathfinder.build(world, QRectF(0, 0, MapLayout::GRASSLAND_WIDTH - 25, MapLayout::GRASSLAND_HEIGHT - 48));
+    QVector<QPointF> starts;
+    QVector<QPointF> goals;
+    QRandomGenerator random(35);
+    while (starts.size() < 16) {
+        QPointF start(random.bounded(MapLayout::GRASSLAND_WIDTH - 25), random.bounded(MapLayout::GRASSLAND_HEIGHT - 48));
+        QPointF goal(random.bounded(MapLayout::GRASSLAND_WIDTH - 25), random.bounded(MapLayout::GRASSLAND_HEIGHT - 48));
+        if (pathfinder.isWalkable(start) && pathfinder.isWalkable(goal)) {
+            starts.append(start);
+            goals.append(goal);
+        }
+    }
+    QVector<QPointF> path;
+    for (int i = 0; i < starts.size(); ++i) {
+        pathfinder.findPath(starts[i], goals[i], path);
+    }
+    report("Pathfinder::findPath (cached)", countAllocations([&](int i) {
+        pathfinder.findPath(starts[i % starts.size()], goals[i % goals.size()], path);
+    }));
+
+    // The battle menu waiting for the player: nothing queued, input ignored
+    BattleSequencer sequencer;
+    report("BattleSequencer idle", countAllocations([&](int i) {
+        sequencer.advance(i * 16);
+        sequencer.actionPressed(InputSystem::MOVE_DOWN);
+    }));
+
+    // The real scenes, on a scratch save so the player's own is left alone
+    QTemporaryDir directory;
+    if (!directory.isValid()) {
+        out << "Could not create a temporary directory\n";
+        return 1;
+    }
+    QGraphicsScene graphicsScene;
+    graphicsScene.setSceneRect(0, 0, 750, 750);
+    QGraphicsView view(&graphicsScene);
+    view.setFixedSize(525, 450);
+    view.show();
+    {
+        Game game(&graphicsScene, nullptr, directory.filePath("bench.sav"));
+        game.start();
+
+        const quint64 walk = walkTown(game);
+        out << "Town walk (" << AllocationTracker::tagName(AllocationTracker::WALK) << "): "
+            << walk << " allocations in one lap\n";
+        if (walk > 0) {
+            failures++;
+        }
+
+        const int ROUNDS = 250;
+        const quint64 menu = battleMenuCursor(game, ROUNDS);
+        out << "Battle menu cursor (" << AllocationTracker::tagName(AllocationTracker::BATTLE_MENU) << "): "
+            << menu << " allocations in " << ROUNDS * 4 << " moves\n";
+        if (menu > 0) {
+            failures++;
+        }
+    }
+
+#ifndef Q_OS_LINUX
+    out << "Only operator new is counted on this platform; Qt's malloc() use is not seen\n";
+#endif
+    if (failures > 0) {
+        out << failures << " measured path(s) allocated\n";
+        return 1;
+    }
+    out << "Nothing counted allocated in the measured paths\n";
+    return 0;
+}
+
+}
@@ -0,0 +1,28 @@
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+// Headless benchmarks, run from the command line instead of the game:
+//
+//   term_project --bench-pathfinding
+//   term_project --bench-save
+//   term_project --bench-alloc
+//
+// --bench-alloc needs a build with allocation counting (debug builds, or
+// qmake CONFIG+=track_allocations).
+// They use the real map geometry so numbers track what the game does.
+namespace Benchmarks
+{
+    // Runs the benchmark named in argv. Returns the process exit code, or -1
+    // when no benchmark was requested and the game should start normally.
+    int runFromArguments(int argc, char *argv[]);
+
+    int runPathfinding();
+    int runSaveLoad();
+    // Counts allocations in the per-frame hot paths, first in isolation, then
+    // in a real town walk and battle menu played offscreen. Exits with 1 if
+    // a measured path allocated; what Qt allocates inside those paths for
+    // the graphics scene counts too.
+    int runAllocations();
+}
+
+#endif // BENCHMARKS_H
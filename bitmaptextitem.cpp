@@ -0,0 +1,124 @@
+#include "bitmaptextitem.h"
+#include "glyphatlas.h"
+#include <QGraphicsScene>
+
+BitmapTextItem::BitmapTextItem(const QString &text, const QFont &font, QGraphicsItem *parent)
+    : QGraphicsItem(parent),
+      text(text),
+      font(font)
+{
+    relayout();
+}
+
+BitmapTextItem *BitmapTextItem::create(QGraphicsScene *scene, const QString &text, const QFont &font)
+{
+    BitmapTextItem *item = new BitmapTextItem(text, font);
+    scene->addItem(item);
+    return item;
+}
+
+void BitmapTextItem::setPlainText(const QString &text)
+{
+    if (text == this->text) {
+        return;
+    }
+    this->text = text;
+    relayout();
+}
+
+void BitmapTextItem::setDefaultTextColor(const QColor &color)
+{
+    if (color == this->color) {
+        return;
+    }
+    this->color = color;
+    relayout();  // Each color has its own atlas
+}
+
+void BitmapTextItem::setTextWidth(qreal width)
+{
+    if (width == textWidth) {
+        return;
+    }
+    textWidth = width;
+    relayout();
+}
+
+void BitmapTextItem::relayout()
+{
+    prepareGeometryChange();
+    atlas = GlyphAtlas::get(font, color);
+    fragments.clear();
+
+    const qreal maxWidth = textWidth > 0 ? textWidth - 2 * MARGIN : -1;
+    const qreal lineHeight = atlas->lineHeight();
+    qreal widest = 0;
+    int lineCount = 0;
+
+    // Places text[start, end) on the next line
+    auto placeLine = [&](const QString &line, int start, int end) {
+        qreal x = MARGIN;
+        const qreal y = MARGIN + lineCount * lineHeight;
+        for (int i = start; i < end; ++i) {
+            const GlyphAtlas::Glyph &glyph = atlas->glyph(line[i]);
+            if (!line[i].isSpace()) {
+                // Fragments are positioned by their center
+                const QPointF center(x - GlyphAtlas::PADDING + glyph.source.width() / 2,
+                                     y - GlyphAtlas::PADDING + glyph.source.height() / 2);
+                fragments.append(QPainter::PixmapFragment::create(center, glyph.source));
+            }
+            x += glyph.advance;
+        }
+        widest = qMax(widest, x - MARGIN);
+        lineCount++;
+    };
+
+    for (const QString &paragraph : text.split(QLatin1Char('\n'))) {
+        int lineStart = 0;
+        int lastSpace = -1;
+        qreal x = 0;
+
+        for (int i = 0; i < paragraph.size(); ++i) {
+            const qreal advance = atlas->glyph(paragraph[i]).advance;
+            if (paragraph[i] == QLatin1Char(' ')) {
+                lastSpace = i;
+            }
+
+            if (maxWidth > 0 && x + advance > maxWidth && i > lineStart) {
+                // Break after the last space, or inside a word too long for a line
+                const int end = lastSpace > lineStart ? lastSpace : i;
+                const int next = lastSpace > lineStart ? lastSpace + 1 : i;
+                placeLine(paragraph, lineStart, end);
+                lineStart = next;
+                lastSpace = -1;
+                x = 0;
+                for (int j = lineStart; j < i; ++j) {
+                    x += atlas->glyph(paragraph[j]).advance;
+                }
+            }
+            if (i >= lineStart) {
+                x += advance;  // A space that ended the line is dropped
+            }
+        }
+        placeLine(paragraph, lineStart, paragraph.size());
+    }
+
+    const qreal width = textWidth > 0 ? textWidth : widest + 2 * MARGIN;
+    bounds = QRectF(0, 0, width, lineCount * lineHeight + 2 * MARGIN);
+    update();
+}
+
+QRectF BitmapTextItem::boundingRect() const
+{
+    return bounds;
+}
+
+void BitmapTextItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+    Q_UNUSED(option);
+    Q_UNUSED(widget);
+
+    if (!fragments.isEmpty()) {
+        painter->drawPixmapFragments(fragments.constData(), fragments.size(), atlas->pixmap());
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef BITMAPTEXTITEM_H
+#define BITMAPTEXTITEM_H
+
+#include <QColor>
+#include <QFont>
+#include <QGraphicsItem>
+#include <QPainter>
+#include <QString>
+#include <QVector>
+
+class GlyphAtlas;
+class QGraphicsScene;
+
+// Plain text drawn from a GlyphAtlas instead of a QTextDocument.
+//
+// The layout (one atlas fragment per glyph, with word wrap) is built when
+// the text, width or color changes and then reused for every paint, which
+// is a single drawPixmapFragments() call. The item keeps the 4px margin of
+// QGraphicsTextItem's document, so it can replace one at the same position.
+class BitmapTextItem : public QGraphicsItem
+{
+public:
+    explicit BitmapTextItem(const QString &text, const QFont &font, QGraphicsItem *parent = nullptr);
+
+    // Adds a new item to scene, like QGraphicsScene::addText()
+    static BitmapTextItem *create(QGraphicsScene *scene, const QString &text, const QFont &font);
+
+    void setPlainText(const QString &text);
+    QString toPlainText() const { return text; }
+    void setDefaultTextColor(const QColor &color);
+    // Wraps at word boundaries within width (margins included); -1 turns wrapping off
+    void setTextWidth(qreal width);
+
+    QRectF boundingRect() const override;
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget = nullptr) override;
+
+private:
+    static const int MARGIN = 4;  // QTextDocument's default documentMargin
+
+    QString text;
+    QFont font;
+    QColor color{Qt::black};
+    qreal textWidth{-1};
+
+    GlyphAtlas *atlas{nullptr};
+    QVector<QPainter::PixmapFragment> fragments;
+    QRectF bounds;
+
+    void relayout();
+};
+
+#endif // BITMAPTEXTITEM_H
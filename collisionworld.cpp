@@ -0,0 +1,98 @@
+#include "collisionworld.h"
+#include <cmath>
+
+CollisionWorld::CollisionWorld(qreal cellSize)
+    : cellSize(cellSize > 0 ? cellSize : 64.0)
+{
+}
+
+void CollisionWorld::clear()
+{
+    solidRects.clear();
+    ledgeRects.clear();
+    solidCells.clear();
+    ledgeCells.clear();
+    solidStamps.clear();
+    ledgeStamps.clear();
+}
+
+void CollisionWorld::addSolid(const QRectF &rect)
+{
+    insert(solidCells, rect, solidRects.size());
+    solidRects.append(rect);
+    solidStamps.append(0);
+}
+
+void CollisionWorld::addLedge(const QRectF &rect)
+{
+    insert(ledgeCells, rect, ledgeRects.size());
+    ledgeRects.append(rect);
+    ledgeStamps.append(0);
+}
+
+void CollisionWorld::insert(QHash<qint64, QVector<int>> &cells, const QRectF &rect, int index)
+{
+    int firstX = static_cast<int>(std::floor(rect.left() / cellSize));
+    int lastX = static_cast<int>(std::floor(rect.right() / cellSize));
+    int firstY = static_cast<int>(std::floor(rect.top() / cellSize));
+    int lastY = static_cast<int>(std::floor(rect.bottom() / cellSize));
+
+    for (int y = firstY; y <= lastY; ++y) {
+        for (int x = firstX; x <= lastX; ++x) {
+            cells[cellKey(x, y)].append(index);
+        }
+    }
+}
+
+void CollisionWorld::query(const QHash<qint64, QVector<int>> &cells, QVector<quint32> &stamps,
+                           const QRectF &area, QVector<int> &result) const
+{
+    // A new stamp value marks "not reported yet" for every rect at once
+    if (++queryStamp == 0) {
+        solidStamps.fill(0);
+        ledgeStamps.fill(0);
+        queryStamp = 1;
+    }
+
+    int firstX = static_cast<int>(std::floor(area.left() / cellSize));
+    int lastX = static_cast<int>(std::floor(area.right() / cellSize));
+    int firstY = static_cast<int>(std::floor(area.top() / cellSize));
+    int lastY = static_cast<int>(std::floor(area.bottom() / cellSize));
+
+    for (int y = firstY; y <= lastY; ++y) {
+        for (int x = firstX; x <= lastX; ++x) {
+            auto it = cells.constFind(cellKey(x, y));
+            if (it == cells.constEnd()) {
+                continue;
+            }
+            for (int index : it.value()) {
+                if (stamps[index] != queryStamp) {
+                    stamps[index] = queryStamp;
+                    result.append(index);
+                }
+            }
+        }
+    }
+}
+
+void CollisionWorld::querySolids(const QRectF &area, QVector<int> &result) const
+{
+    query(solidCells, solidStamps, area, result);
+}
+
+void CollisionWorld::queryLedges(const QRectF &area, QVector<int> &result) const
+{
+    query(ledgeCells, ledgeStamps, area, result);
+}
+
+bool CollisionWorld::overlapsSolid(const QRectF &rect) const
+{
+    QVector<int> candidates;
+    querySolids(rect, candidates);
+    for (int index : candidates) {
+        if (rect.intersects(solidRects[index])) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,51 @@
+#ifndef COLLISIONWORLD_H
+#define COLLISIONWORLD_H
+
+#include <QHash>
+#include <QRectF>
+#include <QVector>
+
+// Static collision geometry of a map: solid barriers plus one-way ledges.
+//
+// Rects are bucketed into a uniform grid so movement only looks at the
+// handful of rects near the player instead of every barrier on the map.
+class CollisionWorld
+{
+public:
+    explicit CollisionWorld(qreal cellSize = 64.0);
+
+    void clear();
+    void addSolid(const QRectF &rect);
+    // Ledges can be jumped down (moving +y) but not climbed up
+    void addLedge(const QRectF &rect);
+
+    const QVector<QRectF> &solids() const { return solidRects; }
+    const QVector<QRectF> &ledges() const { return ledgeRects; }
+
+    // Appends the indices of solids / ledges whose grid cells touch area.
+    // Each index is reported once; callers still test the exact rect.
+    void querySolids(const QRectF &area, QVector<int> &result) const;
+    void queryLedges(const QRectF &area, QVector<int> &result) const;
+
+    bool overlapsSolid(const QRectF &rect) const;
+
+private:
+    qreal cellSize;
+
+    QVector<QRectF> solidRects;
+    QVector<QRectF> ledgeRects;
+    QHash<qint64, QVector<int>> solidCells;  // Packed cell coordinate -> solid indices
+    QHash<qint64, QVector<int>> ledgeCells;
+
+    // Per-query stamps so a rect spanning several cells is reported once
+    mutable QVector<quint32> solidStamps;
+    mutable QVector<quint32> ledgeStamps;
+    mutable quint32 queryStamp{0};
+
+    static qint64 cellKey(int x, int y) { return (static_cast<qint64>(y) << 32) | static_cast<quint32>(x); }
+    void insert(QHash<qint64, QVector<int>> &cells, const QRectF &rect, int index);
+    void query(const QHash<qint64, QVector<int>> &cells, QVector<quint32> &stamps,
+               const QRectF &area, QVector<int> &result) const;
+};
+
+#endif // COLLISIONWORLD_H
@@ -0,0 +1,106 @@
+#include "debugoverlayitem.h"
+#include "allocationtracker.h"
+#include <QGraphicsScene>
+#include <QGraphicsSimpleTextItem>
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+
+DebugOverlayItem *DebugOverlayItem::create(QGraphicsScene *scene, qreal z)
+{
+#ifdef QT_DEBUG
+    DebugOverlayItem *overlay = new DebugOverlayItem;
+    overlay->setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);  // Fills in exposedRect
+    overlay->setZValue(z);
+    scene->addItem(overlay);
+    return overlay;
+#else
+    Q_UNUSED(scene);
+    Q_UNUSED(z);
+    return nullptr;
+#endif
+}
+
+void DebugOverlayItem::addRect(const QRectF &rect, const QPen &pen, const QBrush &brush)
+{
+    // Leave room for half the pen on every side
+    qreal grow = pen.widthF() / 2 + 1;
+    prepareGeometryChange();
+    shapes.append({rect, pen, brush});
+    bounds |= rect.adjusted(-grow, -grow, grow, grow);
+}
+
+void DebugOverlayItem::addRects(const QVector<QRectF> &rects, const QPen &pen, const QBrush &brush)
+{
+    for (const QRectF &rect : rects) {
+        addRect(rect, pen, brush);
+    }
+}
+
+void DebugOverlayItem::showAllocationStats(const QPointF &viewTopLeft)
+{
+    if (!statsItem) {
+        statsItem = new QGraphicsSimpleTextItem;
+        statsItem->setBrush(Qt::yellow);
+        statsItem->setZValue(1000);
+        scene()->addItem(statsItem);
+    }
+    statsItem->setPos(viewTopLeft + QPointF(4, 4));
+    statsItem->setVisible(true);
+
+    if (!AllocationTracker::isEnabled()) {
+        if (statsItem->text().isEmpty()) {
+            statsItem->setText("alloc/frame: not counted in this build");
+        }
+        return;
+    }
+
+    // Rebuilding the text allocates, so only do it every 60 frames and count
+    // it under its own tag
+    const quint64 frame = AllocationTracker::frameCount();
+    if (frame - statsFrame < 60 && !statsItem->text().isEmpty()) {
+        return;
+    }
+    statsFrame = frame;
+
+    AllocationTracker::Scope allocationScope(AllocationTracker::DEBUG_HUD);
+    const AllocationTracker::Counts &last = AllocationTracker::lastFrame();
+    QString text = QString("alloc/frame: %1 (%2 B)  frames allocating: %3/%4\n")
+                       .arg(last.allocations)
+                       .arg(last.bytes)
+                       .arg(AllocationTracker::allocatingFrameCount())
+                       .arg(frame);
+    for (int tag = 0; tag < AllocationTracker::TAG_COUNT; ++tag) {
+        text += QString("%1: %2  ").arg(AllocationTracker::tagName(static_cast<AllocationTracker::Tag>(tag)))
+                                   .arg(last.perTag[tag]);
+    }
+    statsItem->setText(text);
+}
+
+void DebugOverlayItem::hideAllocationStats()
+{
+    if (statsItem) {
+        statsItem->setVisible(false);
+    }
+}
+
+QRectF DebugOverlayItem::boundingRect() const
+{
+    return bounds;
+}
+
+void DebugOverlayItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+    Q_UNUSED(widget);
+
+    // Only the shapes touching the exposed area need drawing
+    const QRectF exposed = option->exposedRect;
+    for (const Shape &shape : shapes) {
+        qreal grow = shape.pen.widthF() / 2 + 1;
+        if (!exposed.isEmpty() && !exposed.intersects(shape.rect.adjusted(-grow, -grow, grow, grow))) {
+            continue;
+        }
+        painter->setPen(shape.pen);
+        painter->setBrush(shape.brush);
+        painter->drawRect(shape.rect);
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef DEBUGOVERLAYITEM_H
+#define DEBUGOVERLAYITEM_H
+
+#include <QBrush>
+#include <QGraphicsItem>
+#include <QPen>
+#include <QRectF>
+#include <QVector>
+
+class QGraphicsScene;
+class QGraphicsSimpleTextItem;
+
+// Draws a scene's debug geometry (barriers, ledges, grass areas, portals,
+// bulletin boards) as outlines from one item.
+//
+// Collision and trigger data live in plain rects; this overlay only shows
+// them. It exists in debug builds only: create() returns nullptr in release,
+// so production scenes hold just the items the player actually sees.
+//
+// It also shows the allocation counters of AllocationTracker, so a frame
+// that starts allocating while walking around is visible straight away.
+class DebugOverlayItem : public QGraphicsItem
+{
+public:
+    // Adds a new overlay to scene, or returns nullptr in release builds
+    static DebugOverlayItem *create(QGraphicsScene *scene, qreal z = 5);
+
+    void addRect(const QRectF &rect, const QPen &pen, const QBrush &brush = Qt::NoBrush);
+    void addRects(const QVector<QRectF> &rects, const QPen &pen, const QBrush &brush = Qt::NoBrush);
+
+    // Call once per frame after AllocationTracker::beginFrame(); viewTopLeft
+    // is the camera position. The text is rebuilt about once a second.
+    void showAllocationStats(const QPointF &viewTopLeft);
+    // While another scene's camera is in charge
+    void hideAllocationStats();
+
+    QRectF boundingRect() const override;
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget = nullptr) override;
+
+private:
+    DebugOverlayItem() = default;
+
+    struct Shape {
+        QRectF rect;
+        QPen pen;
+        QBrush brush;
+    };
+
+    QVector<Shape> shapes;
+    QRectF bounds;
+
+    // A separate top-level item so it stays above the sprites; the scene owns it
+    QGraphicsSimpleTextItem *statsItem{nullptr};
+    quint64 statsFrame{0};
+};
+
+#endif // DEBUGOVERLAYITEM_H
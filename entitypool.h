@@ -0,0 +1,128 @@
+#ifndef ENTITYPOOL_H
+#define ENTITYPOOL_H
+
+#include <QVector>
+#include <QtGlobal>
+
+// Fixed-capacity storage for short-lived game entities (wild Pokémon, ...).
+//
+// All slots are allocated up front and recycled through a free list, so a
+// long session never grows the pool. Handles carry the slot's generation;
+// once an entity is released its old handles stop resolving, which catches
+// stale references instead of silently pointing at whatever reused the slot.
+// Live entities are also kept in a dense list so per-tick loops only visit
+// what is actually alive.
+template <typename T>
+class EntityPool
+{
+public:
+    struct Handle {
+        int index{-1};
+        quint32 generation{0};
+
+        bool isNull() const { return index < 0; }
+    };
+
+    explicit EntityPool(int capacity)
+    {
+        entries.resize(capacity);
+        freeList.reserve(capacity);
+        live.reserve(capacity);
+        clear();
+    }
+
+    int capacity() const { return entries.size(); }
+    int size() const { return live.size(); }
+    bool isFull() const { return freeList.isEmpty(); }
+
+    // Returns a null handle when every slot is in use
+    Handle acquire()
+    {
+        Handle handle;
+        if (freeList.isEmpty()) {
+            return handle;
+        }
+
+        int index = freeList.last();
+        freeList.removeLast();
+
+        Slot &slot = entries[index];
+        slot.value = T();
+        slot.livePos = live.size();
+        live.append(index);
+
+        handle.index = index;
+        handle.generation = slot.generation;
+        return handle;
+    }
+
+    bool release(Handle handle)
+    {
+        if (!isValid(handle)) {
+            return false;
+        }
+
+        Slot &slot = entries[handle.index];
+
+        // Swap-remove from the live list
+        int moved = live.last();
+        live[slot.livePos] = moved;
+        entries[moved].livePos = slot.livePos;
+        live.removeLast();
+
+        slot.livePos = -1;
+        slot.generation++;  // Invalidate outstanding handles
+        freeList.append(handle.index);
+        return true;
+    }
+
+    bool isValid(Handle handle) const
+    {
+        return handle.index >= 0 && handle.index < entries.size()
+               && entries[handle.index].livePos >= 0
+               && entries[handle.index].generation == handle.generation;
+    }
+
+    T *get(Handle handle) { return isValid(handle) ? &entries[handle.index].value : nullptr; }
+    const T *get(Handle handle) const { return isValid(handle) ? &entries[handle.index].value : nullptr; }
+
+    // Dense access to live entities, 0 <= i < size(). Releasing entity i
+    // moves the last live entity into position i.
+    T &liveAt(int i) { return entries[live[i]].value; }
+    const T &liveAt(int i) const { return entries[live[i]].value; }
+    Handle liveHandle(int i) const
+    {
+        Handle handle;
+        handle.index = live[i];
+        handle.generation = entries[live[i]].generation;
+        return handle;
+    }
+
+    // Releases everything; old handles become invalid
+    void clear()
+    {
+        freeList.clear();
+        live.clear();
+        for (int i = entries.size() - 1; i >= 0; --i) {
+            if (entries[i].livePos >= 0) {
+                entries[i].generation++;
+            }
+            entries[i].value = T();
+            entries[i].livePos = -1;
+            freeList.append(i);  // Lowest index is handed out first
+        }
+    }
+
+private:
+    struct Slot {
+        T value{};
+        quint32 generation{0};
+        int livePos{-1};  // Position in live, -1 when free
+    };
+
+    QVector<Slot> entries;
+    QVector<int> freeList;
+    QVector<int> live;
+};
+
+#endif // ENTITYPOOL_H
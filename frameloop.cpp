@@ -0,0 +1,99 @@
+#include "frameloop.h"
+#include "stresstest.h"
+#include <QDebug>
+#include <QTimer>
+
+// How often the frame rate and CPU use are logged
+static const int REPORT_INTERVAL_MS = 10000;
+
+FrameLoop::FrameLoop(int intervalMs, QObject *parent)
+    : QObject(parent),
+      intervalMs(intervalMs),
+      frameTimer(new QTimer(this)),
+      wakeTimer(new QTimer(this)),
+      reportTimer(new QTimer(this))
+{
+    connect(frameTimer, &QTimer::timeout, this, &FrameLoop::frame);
+
+    wakeTimer->setSingleShot(true);
+    connect(wakeTimer, &QTimer::timeout, this, &FrameLoop::wake);
+
+    connect(reportTimer, &QTimer::timeout, this, &FrameLoop::report);
+}
+
+void FrameLoop::start()
+{
+    running = true;
+    asleep = false;
+    frameTimer->start(intervalMs);
+
+    frames = 0;
+    sleptNs = 0;
+    reportClock.start();
+    cpuAtReportNs = StressTest::processCpuNanoseconds();
+    reportTimer->start(REPORT_INTERVAL_MS);
+}
+
+void FrameLoop::stop()
+{
+    running = false;
+    asleep = false;
+    frameTimer->stop();
+    wakeTimer->stop();
+    reportTimer->stop();
+}
+
+void FrameLoop::wake()
+{
+    if (!running || !asleep) {
+        return;
+    }
+
+    asleep = false;
+    sleptNs += sleepClock.nsecsElapsed();
+    wakeTimer->stop();
+    frameTimer->start(intervalMs);
+}
+
+void FrameLoop::frameDone(bool busy, qint64 dueInMs)
+{
+    if (!running) {
+        return;
+    }
+    frames++;
+
+    if (busy || asleep) {
+        return;
+    }
+
+    // Nothing left to animate: sleep until something happens
+    asleep = true;
+    sleepClock.start();
+    frameTimer->stop();
+    if (dueInMs >= 0) {
+        wakeTimer->start(static_cast<int>(qMin<qint64>(dueInMs, 24 * 3600 * 1000)));
+    }
+}
+
+void FrameLoop::report()
+{
+    const qint64 elapsedNs = reportClock.nsecsElapsed();
+    qint64 slept = sleptNs;
+    if (asleep) {
+        slept += sleepClock.nsecsElapsed();
+        sleepClock.start();
+    }
+    const qint64 cpuNs = StressTest::processCpuNanoseconds();
+
+    QString cpu("n/a");
+    if (cpuNs >= 0 && cpuAtReportNs >= 0 && elapsedNs > 0) {
+        cpu = QString::number(100.0 * (cpuNs - cpuAtReportNs) / elapsedNs, 'f', 1) + "%";
+    }
+    qDebug() << "Frame loop:" << QString::number(frames * 1e9 / qMax<qint64>(1, elapsedNs), 'f', 1) << "frames/s, asleep"
+             << QString::number(100.0 * slept / qMax<qint64>(1, elapsedNs), 'f', 0) + "%" << "of the time, process CPU" << cpu;
+
+    frames = 0;
+    sleptNs = 0;
+    reportClock.start();
+    cpuAtReportNs = cpuNs;
+}
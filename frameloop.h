@@ -0,0 +1,62 @@
+#ifndef FRAMELOOP_H
+#define FRAMELOOP_H
+
+#include <QElapsedTimer>
+#include <QObject>
+
+class QTimer;
+
+// Runs a scene's frames while something is going on and sleeps while
+// nothing is.
+//
+// At the end of each frame the scene reports whether it is still busy
+// (scripts or battle steps running, a check waiting for the next frame)
+// and when its next timed event is due. An idle loop stops its frame timer
+// until wake() - a key press, a new simulation snapshot - or until that
+// event, so a player standing still costs no CPU. A wake starts the frames
+// again at once, so the player sees the change within a frame.
+//
+// Every ten seconds the loop logs its frame rate, how much of the time it
+// slept and the process' CPU use.
+class FrameLoop : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FrameLoop(int intervalMs = 16, QObject *parent = nullptr);
+
+    // The scene became current / was left
+    void start();
+    void stop();
+    bool isRunning() const { return running; }
+    bool isAsleep() const { return running && asleep; }
+
+    // End of a frame. dueInMs: time until the next timed event, -1 if none
+    void frameDone(bool busy, qint64 dueInMs = -1);
+
+public slots:
+    // Something changed; does nothing while the loop is stopped
+    void wake();
+
+signals:
+    void frame();
+
+private:
+    int intervalMs;
+    QTimer *frameTimer;
+    QTimer *wakeTimer;   // Single shot for the next timed event
+    QTimer *reportTimer;
+    bool running{false};
+    bool asleep{false};
+
+    // Since the last report
+    QElapsedTimer reportClock;
+    QElapsedTimer sleepClock;
+    qint64 sleptNs{0};
+    int frames{0};
+    qint64 cpuAtReportNs{-1};
+
+    void report();
+};
+
+#endif // FRAMELOOP_H
@@ -4,10 +4,22 @@
 #include "laboratoryscene.h"
 #include "townscene.h"
 #include "grasslandscene.h"
+#include "maplayout.h"
+#include "placementengine.h"
+#include "savegame.h"
+#include "savejournal.h"
+#include "simulation.h"
+#include "worldstreamer.h"
+#include "startupprofile.h"
+#include "stresstest.h"
+#include "warmup.h"
 #include <QDebug>
+#include <QFile>
 #include <QRandomGenerator>
+#include <QThread>
+#include <QTimer>
 
-Game::Game(QGraphicsScene* scene, QObject *parent)
+Game::Game(QGraphicsScene* scene, QObject *parent, const QString& customSavePath)
     : QObject(parent),
       scene(scene),
       currentScene(nullptr),
@@ -17,23 +29,94 @@ Game::Game(QGraphicsScene* scene, QObject *parent)
       townScene(nullptr),
       grasslandScene(nullptr),
       battleScene(nullptr),
+      simulationThread(nullptr),
+      simulation(nullptr),
+      worldStreamer(nullptr),
+      warmUp(nullptr),
       player(nullptr),
       laboratoryCompleted(false),
+      savePath(!customSavePath.isEmpty() ? customSavePath
+               : StressTest::isEnabled() ? StressTest::savePath() : SaveGame::defaultPath()),
+      journal(nullptr),
+      autosaveTimer(nullptr),
       townBoxesInitialized(false)
 {
     // No need to create view or scene, they are passed in from MainWindow
+
+    // The simulation lives on its own thread and is deleted there when it stops
+    simulationThread = new QThread(this);
+    simulationThread->setObjectName("Simulation");
+    simulation = new Simulation(&input);
+    simulation->moveToThread(simulationThread);
+    connect(simulationThread, &QThread::finished, simulation, &QObject::deleteLater);
+    simulationThread->start();
+
+    // Decode the first areas while the title screen is up
+    worldStreamer = new WorldStreamer(this);
+    worldStreamer->prefetch(MapLayout::AREA_LAB);
+    worldStreamer->prefetch(MapLayout::AREA_TOWN);
+    worldStreamer->prefetch(MapLayout::AREA_GRASSLAND);
+
+    // Started by the title scene; the scenes take whatever is ready when they load
+    warmUp = new WarmUp(this);
+    warmUp->setWorldBuilder(MapLayout::AREA_LAB, &LaboratoryScene::buildWorld);
+    warmUp->setWorldBuilder(MapLayout::AREA_TOWN, &TownScene::buildWorld);
+    warmUp->setWorldBuilder(MapLayout::AREA_GRASSLAND, &GrasslandScene::buildWorld);
+    connect(warmUp, &WarmUp::finished, this, []() {
+        StartupProfile::mark(StartupProfile::WARM_UP_DONE);
+    });
+
+    // Compiled from Script/events.evs during the build, so it can't have script errors
+    if (!scripts.loadBytecode(ScriptEngine::builtInBytecode())) {
+        qDebug() << "Built-in script bytecode failed to load; scripted dialogue is disabled";
+    }
+
+    // Gameplay events are appended to the journal as they happen; once a
+    // minute a long journal is folded into a fresh snapshot
+    journal = new SaveJournal(savePath);
+    autosaveTimer = new QTimer(this);
+    connect(autosaveTimer, &QTimer::timeout, this, [this]() {
+        if (journal->eventCount() >= JOURNAL_COMPACT_EVENTS) {
+            autosave();
+        }
+    });
+    autosaveTimer->setInterval(60000);
     
+    StartupProfile::mark(StartupProfile::GAME_CREATED);
     qDebug() << "Game initialized";
 }
 
 Game::~Game()
 {
     // Don't delete scene or view, they are owned by MainWindow
+    autosave();
+    SaveGame::waitForPendingWrites();
+    delete journal;
+    journal = nullptr;
     cleanup();
+
+    simulationThread->quit();
+    simulationThread->wait();
+    simulation = nullptr;
 }
 
 void Game::start()
 {
+    // The view exists by now; its paints close the input latency measurements
+    // and mark the first frames of the start-up profile
+    input.watchViews(scene);
+    StartupProfile::watchViews(scene);
+
+    // A stress run skips the title and plays on a scratch save from scratch
+    if (StressTest::isEnabled()) {
+        StressMonitor* monitor = new StressMonitor(this, scene, this);
+        monitor->start();
+        return;
+    }
+
+    // Pick up the last session if there is one
+    loadGame();
+
     // Start with title scene
     changeScene(GameState::TITLE);
     
@@ -58,11 +141,23 @@ void Game::exit()
 void Game::changeScene(GameState state)
 {
     qDebug() << "Changing scene from" << static_cast<int>(currentState) << "to" << static_cast<int>(state);
+
+    // Within the world nothing is torn down: the player is handed to the
+    // scene of the area they walked or were sent into
+    if (currentScene && isWorldState(currentState) && isWorldState(state)) {
+        enterArea(state);
+        journal->recordScene(static_cast<int>(state));
+        return;
+    }
     
     // Clean up old scene if it exists
     if (currentScene) {
         qDebug() << "Cleaning up old scene before changing to new scene";
-        currentScene->cleanup();
+        if (isWorldState(currentState)) {
+            leaveWorld();
+        } else {
+            currentScene->cleanup();
+        }
         currentScene = nullptr; // Set to null first to avoid double pointer issues
         
         // Clear the graphics scene to remove all items
@@ -84,152 +179,212 @@ void Game::changeScene(GameState state)
     currentState = state;
     qDebug() << "Scene state changed to:" << static_cast<int>(state);
 
-    // If this is the first time entering town, generate the boxes
-    if (state == GameState::TOWN && !townBoxesInitialized) {
-        generateTownBoxes();
-    }
-
     // Create or reuse existing scene
-    switch (state) {
-        case GameState::TITLE:
-            qDebug() << "Setting current scene to Title scene";
-            if (!titleScene) {
-                titleScene = new TitleScene(this, scene);
-                // Simple one-time connection since we won't return to title scene
-                connect(titleScene, &TitleScene::startGame, this, [this]() {
-                    changeScene(GameState::LABORATORY);
-                });
-            }
-            currentScene = titleScene;
-            break;
-        case GameState::LABORATORY:
-            qDebug() << "Setting current scene to Laboratory scene";
-            if (!laboratoryScene) {
-                laboratoryScene = new LaboratoryScene(this, scene);
-            }
-            currentScene = laboratoryScene;
-            generateRandomPokeballs(); // Generate random pokemon for pokeballs
-            break;
-        case GameState::TOWN:
-            qDebug() << "Setting current scene to Town scene";
-            if (!townScene) {
-                townScene = new TownScene(this, scene);
-            }
-            currentScene = townScene;
-            break;
-        case GameState::GRASSLAND:
-            qDebug() << "Setting current scene to Grassland scene";
-            if (!grasslandScene) {
-                grasslandScene = new GrasslandScene(this, scene);
-            }
-            currentScene = grasslandScene;
-            break;
-        case GameState::BATTLE:
-            // Will be implemented later
-            qDebug() << "Battle scene not yet implemented";
-            break;
-        default:
-            qDebug() << "Unknown scene state";
-            return;
-    }
-
-    // Initialize the new current scene
-    if (currentScene) {
-        qDebug() << "Initializing new scene";
-        try {
-            currentScene->initialize();
-            qDebug() << "Scene initialization complete";
-        } catch (const std::exception& e) {
-            qDebug() << "Error initializing scene:" << e.what();
-        } catch (...) {
-            qDebug() << "Unknown error initializing scene";
+    bool boxesGenerated = false;
+    try {
+        switch (state) {
+            case GameState::TITLE:
+                qDebug() << "Setting current scene to Title scene";
+                if (!titleScene) {
+                    titleScene = new TitleScene(this, scene);
+                    // Simple one-time connection since we won't return to title scene
+                    connect(titleScene, &TitleScene::startGame, this, [this]() {
+                        changeScene(loadedFromSave ? savedState : GameState::LABORATORY);
+                    });
+                }
+                currentScene = titleScene;
+                currentScene->initialize();
+                break;
+            case GameState::LABORATORY:
+            case GameState::TOWN:
+            case GameState::GRASSLAND:
+                boxesGenerated = enterWorld(state);
+                break;
+            case GameState::BATTLE:
+                // Will be implemented later
+                qDebug() << "Battle scene not yet implemented";
+                break;
+            default:
+                qDebug() << "Unknown scene state";
+                return;
         }
-    } else {
-        qDebug() << "Failed to set current scene!";
+        qDebug() << "Scene initialization complete";
+    } catch (const std::exception& e) {
+        qDebug() << "Error initializing scene:" << e.what();
+    } catch (...) {
+        qDebug() << "Unknown error initializing scene";
     }
-}
 
-Scene* Game::getCurrentScene() const
-{
-    return currentScene;
-}
+    if (!currentScene) {
+        qDebug() << "Failed to set current scene!";
+        return;
+    }
 
-void Game::handleKeyPress(QKeyEvent *event)
-{
-    qDebug() << "Game received key press event - key:" << event->key() << "text:" << event->text();
-    
-    // Pass key events to the current scene
-    if (currentScene) {
-        currentScene->handleKeyPress(event->key());
+    // The first scene and a new box layout need a full snapshot;
+    // any other scene change is one small journal record
+    if (state != GameState::TITLE) {
+        if (!journal->isOpen() || boxesGenerated) {
+            autosave();
+        } else {
+            journal->recordScene(static_cast<int>(state));
+        }
+        autosaveTimer->start();
     }
 }
 
-void Game::handleKeyRelease(QKeyEvent *event)
+GameState Game::areaState(MapLayout::Area area)
 {
-    if (currentScene) {
-        // Handle key releases for laboratory and town scenes
-        if (LaboratoryScene* labScene = dynamic_cast<LaboratoryScene*>(currentScene)) {
-            labScene->handleKeyRelease(event->key());
-        }
-        else if (TownScene* tScene = dynamic_cast<TownScene*>(currentScene)) {
-            tScene->handleKeyRelease(event->key());
-        }
-        else if (GrasslandScene* gScene = dynamic_cast<GrasslandScene*>(currentScene)) {
-            gScene->handleKeyRelease(event->key());
-        }
+    switch (area) {
+    case MapLayout::AREA_LAB:
+        return GameState::LABORATORY;
+    case MapLayout::AREA_GRASSLAND:
+        return GameState::GRASSLAND;
+    case MapLayout::AREA_TOWN:
+    default:
+        return GameState::TOWN;
     }
 }
 
-Player* Game::getPlayer() const
+bool Game::isWorldState(GameState state)
 {
-    return player;
+    return state == GameState::LABORATORY || state == GameState::TOWN || state == GameState::GRASSLAND;
 }
 
-void Game::addPokemon(Pokemon* pokemon)
+MapLayout::Area Game::stateArea(GameState state)
 {
-    if (pokemon) {
-        playerPokemon.append(pokemon);
-        qDebug() << "Added" << pokemon->getName() << "to player's collection";
+    switch (state) {
+    case GameState::LABORATORY:
+        return MapLayout::AREA_LAB;
+    case GameState::GRASSLAND:
+        return MapLayout::AREA_GRASSLAND;
+    default:
+        return MapLayout::AREA_TOWN;
     }
 }
 
-void Game::addItem(const QString& itemName, int quantity)
+Scene* Game::worldScene(GameState state) const
 {
-    inventory[itemName] += quantity;
-    qDebug() << "Added" << quantity << "of" << itemName;
+    switch (state) {
+    case GameState::LABORATORY:
+        return laboratoryScene;
+    case GameState::TOWN:
+        return townScene;
+    case GameState::GRASSLAND:
+        return grasslandScene;
+    default:
+        return nullptr;
+    }
 }
 
-QMap<QString, int> Game::getItems() const
+bool Game::enterWorld(GameState state)
 {
-    return inventory;
-}
+    qDebug() << "Entering the world";
 
-void Game::startBattle(Pokemon* wildPokemon)
-{
-    // Store the wild Pokemon for battle
-    qDebug() << "Battle started with" << (wildPokemon ? wildPokemon->getName() : "unknown Pokemon");
-}
+    // The town adds its boxes to the world, so they are placed first
+    bool boxesGenerated = false;
+    if (!townBoxesInitialized) {
+        boxesGenerated = generateTownBoxes();
+    }
+    if (state == GameState::LABORATORY) {
+        generateRandomPokeballs(); // Generate random pokemon for pokeballs
+    }
 
-void Game::endBattle(bool playerWon)
-{
-    qDebug() << "Battle ended, player" << (playerWon ? "won" : "lost");
+    if (!laboratoryScene) {
+        laboratoryScene = new LaboratoryScene(this, scene);
+    }
+    if (!townScene) {
+        townScene = new TownScene(this, scene);
+    }
+    if (!grasslandScene) {
+        grasslandScene = new GrasslandScene(this, scene);
+    }
+
+    // Background tiles and the sprites standing on them are streamed around the camera
+    worldStreamer->attach(scene);
+
+    // Doors lead between areas no path joins; the scenes add the rest
+    WorldContent content;
+    const QVector<MapLayout::PortalLink> portals = MapLayout::portalLinks();
+    for (int i = 0; i < portals.size(); ++i) {
+        content.addRect(TriggerSystem::Kind::Portal, i, portals[i].rect);
+    }
+    Scene* areas[] = {laboratoryScene, townScene, grasslandScene};
+    for (Scene* area : areas) {
+        area->initialize();
+        area->addToWorld(content);
+    }
+    content.buildChunks();
+
+    // Player movement, the colliders, volumes and wild Pokémon run on the simulation thread from here on
+    const MapLayout::Area area = stateArea(state);
+    playerArea = area;
+    playerPos = MapLayout::toWorld(area, MapLayout::areaInfo(area).entry);
+    worldGeneration = simulation->loadWorld(content, playerPos);
+
+    currentScene = worldScene(state);
+    currentScene->enterArea(playerPos);
+    return boxesGenerated;
 }
 
-bool Game::hasCompletedLaboratory() const
+void Game::enterArea(GameState state)
 {
-    return laboratoryCompleted;
+    const MapLayout::Area area = stateArea(state);
+    qDebug() << "Player moves from area" << playerArea << "to area" << area;
+    currentScene->leaveArea();
+
+    // Walking across, the player is there already. A door puts them on the
+    // far side of it, anything else (a script) at the area's entry point.
+    if (playerArea != area) {
+        playerPos = MapLayout::toWorld(area, MapLayout::areaInfo(area).entry);
+        for (const MapLayout::PortalLink &link : MapLayout::portalLinks()) {
+            if (link.from == playerArea && link.to == area) {
+                playerPos = link.arrival;
+                break;
+            }
+        }
+        playerArea = area;
+        worldGeneration = simulation->moveTo(playerPos);
+    }
+    if (state == GameState::LABORATORY) {
+        generateRandomPokeballs(); // Generate random pokemon for pokeballs
+    }
+
+    currentState = state;
+    currentScene = worldScene(state);
+    currentScene->enterArea(playerPos);
 }
 
-void Game::setLaboratoryCompleted(bool completed)
+void Game::leaveWorld()
 {
-    laboratoryCompleted = completed;
+    qDebug() << "Leaving the world";
+    simulation->unloadWorld();
+    Scene* areas[] = {laboratoryScene, townScene, grasslandScene};
+    for (Scene* area : areas) {
+        if (area) {
+            area->cleanup();
+        }
+    }
+    // Its items go with the scene
+    worldStreamer->detach();
 }
 
-void Game::initScenes()
+bool Game::takeWorldSnapshot(WorldSnapshot &snapshot)
 {
-    // Initialize scenes that weren't created in the constructor
-    // We've already created the initial scenes in the constructor
-    qDebug() << "Additional scenes initialized";
+    if (!simulation->takeSnapshot(worldGeneration, snapshot)) {
+        return false;
+    }
+    playerPos = snapshot.playerPos;
+    playerArea = snapshot.area;
+
+    // The other areas keep what the camera may see of them in step, like
+    // the grassland's wild Pokémon from the top of the town
+    Scene* areas[] = {laboratoryScene, townScene, grasslandScene};
+    for (Scene* area : areas) {
+        if (area && area != currentScene) {
+            area->snapshotTaken(snapshot);
+        }
+    }
+    return true;
 }
 
 void Game::cleanup()
@@ -332,6 +487,7 @@ const QMap<int, QString>& Game::getTownBoxContents() const {
 void Game::setTownBoxOpenedState(int boxIndex, bool isOpened) {
     if (boxIndex >= 0 && boxIndex < townBoxPositions.size()) {
         townBoxOpenedStates[boxIndex] = isOpened;
+        journal->recordBoxOpened(boxIndex, isOpened);
         qDebug() << "Box" << boxIndex << "set to" << (isOpened ? "opened" : "unopened");
     }
 }
@@ -340,126 +496,51 @@ bool Game::areTownBoxesInitialized() const {
     return townBoxesInitialized;
 }
 
-void Game::generateTownBoxes() {
+bool Game::generateTownBoxes() {
     qDebug() << "Generating town boxes positions";
     
-    do {
-        // Clear existing box data
-        townBoxPositions.clear();
-        townBoxOpenedStates.clear();
-        townBoxContents.clear();
-        
-        // Define the town dimensions - must match TownScene
-        const int TOWN_WIDTH = 1000;
-        const int TOWN_HEIGHT = 1000;
-        
-        // Get list of barrier positions (approximate from TownScene's createBarriers method)
-        QVector<QRect> barrierRects = {
-            // Tree barriers around the perimeter
-            QRect(0, 0, 492,100),  // Top left trees
-            QRect(585, 0, 470,100),  // Top right trees
-            QRect(0, 0, 80, TOWN_HEIGHT),  // Left trees
-            QRect(TOWN_WIDTH - 87, 0, 100, TOWN_HEIGHT),  // Right trees
-           
-            // Upper buildings (houses)
-            QRect(205, 175, 210, 219),  // Left house
-            QRect(586, 175, 210, 219),  // Right house
-            QRect(173, 326, 31, 68),  // Mailbox beside Left house
-            QRect(550, 326, 31, 68),  // Mailbox beside Right house
-
-            // Center-left fence 
-            QRect(208, 549, 214, 46),  
-            // Bottom fence
-            QRect(546, 801, 249, 41),
-            
-            QRect(550, 470, 281, 225),  // Center main building
-            
-            QRect(297, 849, 152, 145),  // Lake at bottom
-        };
-        
-        // Define bulletin board positions separately for special handling
-        QVector<QRect> bulletinBoardRects = {
-            QRect(209, 698, 42, 46),  // Bottom-left bulletin board
-            QRect(377, 548, 45, 45),  // Center-left fence bulletin board
-            QRect(669, 801, 45, 45),  // Bottom fence bulletin board
-        };
-        
-        // Also add portals to avoid
-        QVector<QRect> portalRects = {
-            QRect(669, 700, 45, 45),    // Lab portal
-            QRect(490, 0, 90, 90),      // Grassland portal
-        };
-        
-        // Create 15 box positions using similar logic to TownScene::createBoxes
-        const int BOX_SIZE = 30;
-        
-        // Helper to check if a position overlaps with barriers
-        auto overlapsBarrier = [&barrierRects](const QRectF &rect) -> bool {
-            for (const QRect &barrier : barrierRects) {
-                if (rect.intersects(barrier)) {
-                    return true;
-                }
-            }
-            return false;
-        };
-        
-        // Helper to check if a position is too close to a bulletin board or portal
-        auto isTooCloseToInteractive = [&bulletinBoardRects, &portalRects](const QRectF &rect) -> bool {
-            // Check if too close to bulletin boards (use expanded area to ensure distance)
-            for (const QRect &board : bulletinBoardRects) {
-                QRectF expandedBoard = board.adjusted(-60, -60, 60, 60); // 60 pixel safety margin
-                if (rect.intersects(expandedBoard)) {
-                    return true;
-                }
-            }
-            
-            // Check if too close to portals
-            for (const QRect &portal : portalRects) {
-                QRectF expandedPortal = portal.adjusted(-40, -40, 40, 40); // 40 pixel safety margin
-                if (rect.intersects(expandedPortal)) {
-                    return true;
-                }
-            }
-            
-            return false;
-        };
-        
-        // Helper to check if a position overlaps with other boxes
-        auto overlapsExistingBox = [&](const QPointF &pos) -> bool {
-            QRectF newRect(pos.x(), pos.y(), BOX_SIZE, BOX_SIZE);
-            for (const QPointF &existingPos : townBoxPositions) {
-                QRectF existingRect(existingPos.x(), existingPos.y(), BOX_SIZE, BOX_SIZE);
-                if (newRect.intersects(existingRect.adjusted(-40, -40, 40, 40))) { // Add some spacing
-                    return true;
-                }
-            }
-            return false;
-        };
-        
-        // Try to place boxes in valid positions
-        int attempts = 0;
-        
-        while (townBoxPositions.size() < 15 && attempts < 2000) {
-            // Generate position with random generator
-            int x = QRandomGenerator::global()->bounded(100, TOWN_WIDTH - 100);
-            int y = QRandomGenerator::global()->bounded(100, TOWN_HEIGHT - 100);
-            QPointF pos(x, y);
-            
-            // Check if position is valid
-            QRectF boxRect(x, y, BOX_SIZE, BOX_SIZE);
-            if (!overlapsBarrier(boxRect) && 
-                !isTooCloseToInteractive(boxRect) && 
-                !overlapsExistingBox(pos)) {
-                townBoxPositions.append(pos);
-                townBoxOpenedStates[townBoxPositions.size() - 1] = false;
-            }
-            
-            attempts++;
-        }
-        
-        qDebug() << "Generated" << townBoxPositions.size() << "town box positions after" << attempts << "attempts";
-        
-    } while (townBoxPositions.size() != 15); // Keep trying until we get exactly 15 boxes
+    // Clear existing box data
+    townBoxPositions.clear();
+    townBoxOpenedStates.clear();
+    townBoxContents.clear();
+    
+    // The same size TownScene draws the boxes at
+    const int BOX_SIZE = MapLayout::TOWN_BOX_SIZE;
+    
+    // Boxes stay 100 pixels away from the town edges
+    PlacementEngine placement(QRectF(100, 100, MapLayout::TOWN_WIDTH - BOX_SIZE - 200, MapLayout::TOWN_HEIGHT - BOX_SIZE - 200),
+                              QSizeF(BOX_SIZE, BOX_SIZE));
+    
+    // Solid scenery the boxes can't overlap
+    for (const QRectF &barrier : MapLayout::townBarriers()) {
+        placement.addObstacle(barrier);
+    }
+    
+    // Keep a safety margin around bulletin boards and portals so they stay reachable
+    for (const QRectF &board : MapLayout::townBulletinBoards()) {
+        placement.addObstacle(board, MapLayout::TOWN_BULLETIN_KEEP_OUT);
+    }
+    placement.addObstacle(MapLayout::townLabPortal(), MapLayout::TOWN_PORTAL_KEEP_OUT);
+    placement.addObstacle(MapLayout::townGrasslandPath(), MapLayout::TOWN_PORTAL_KEEP_OUT);
+    
+    // Boxes keep a 40 pixel gap between each other on at least one axis, like
+    // the old expanded-rect overlap test; stress runs pack them tight
+    placement.setSpacingMetric(PlacementEngine::AXIS_ALIGNED);
+    const int boxCount = StressTest::isEnabled() ? StressTest::config().townBoxes : TOWN_BOX_COUNT;
+    const int boxSpacing = StressTest::isEnabled() ? BOX_SIZE + 2 : BOX_SIZE + 40;
+    bool placed = StressTest::isEnabled()
+        ? StressTest::placeAsManyAsFit(placement, boxCount, boxSpacing, townBoxPositions)
+        : placement.place(boxCount, boxSpacing, townBoxPositions);
+    if (!placed) {
+        qDebug() << "Could not place" << boxCount << "town boxes - town layout has no room for them";
+        return false;
+    }
+    
+    for (int i = 0; i < townBoxPositions.size(); i++) {
+        townBoxOpenedStates[i] = false;
+    }
+    
+    qDebug() << "Generated" << townBoxPositions.size() << "town box positions";
     
     // Create a vector with exactly 3 Poké Balls, 9 Potions, and 3 Ethers
     QVector<QString> items;
@@ -486,7 +567,7 @@ void Game::generateTownBoxes() {
     
     // Assign the shuffled items to boxes
     for (int i = 0; i < townBoxPositions.size(); i++) {
-        townBoxContents[i] = items[i];
+        townBoxContents[i] = items[i % items.size()];
     }
     
     qDebug() << "Assigned items to boxes:";
@@ -496,10 +577,23 @@ void Game::generateTownBoxes() {
     
     // Mark as initialized
     townBoxesInitialized = true;
+    return true;
 }
 
 void Game::setItems(const QMap<QString, int>& items)
 {
+    // Journal only the counts that actually changed
+    for (auto it = items.constBegin(); it != items.constEnd(); ++it) {
+        if (inventory.value(it.key(), 0) != it.value()) {
+            journal->recordItemCount(it.key(), it.value());
+        }
+    }
+    for (auto it = inventory.constBegin(); it != inventory.constEnd(); ++it) {
+        if (!items.contains(it.key())) {
+            journal->recordItemCount(it.key(), 0);
+        }
+    }
+
     inventory = items;
 }
 
@@ -514,7 +608,118 @@ void Game::movePokemonToFront(int index)
         
         // Insert it at the front (index 0)
         playerPokemon.insert(0, selectedPokemon);
+        journal->recordPokemonMovedToFront(index);
         
         qDebug() << "Moved" << selectedPokemon->getName() << "to front of party";
     }
 }
+
+SaveData Game::createSaveData() const
+{
+    // Qt containers are implicitly shared, so copying them here is cheap and
+    // the save thread gets a snapshot that later changes can't touch
+    SaveData data;
+    data.scene = static_cast<int>(currentState);
+    data.laboratoryCompleted = laboratoryCompleted;
+    data.inventory = inventory;
+    data.townBoxesInitialized = townBoxesInitialized;
+    data.townBoxPositions = townBoxPositions;
+    data.townBoxOpenedStates = townBoxOpenedStates;
+    data.townBoxContents = townBoxContents;
+
+    data.party.reserve(playerPokemon.size());
+    for (const Pokemon* pokemon : playerPokemon) {
+        data.party.append(pokemonRecord(pokemon));
+    }
+    return data;
+}
+
+SaveData::PokemonRecord Game::pokemonRecord(const Pokemon* pokemon)
+{
+    SaveData::PokemonRecord record;
+    record.type = pokemon->getType();
+    record.level = pokemon->getLevel();
+    record.currentHp = pokemon->getCurrentHp();
+    for (const Pokemon::Move& move : pokemon->getMoves()) {
+        record.movePp.append(move.pp);
+    }
+    return record;
+}
+
+void Game::notifyPokemonChanged(Pokemon* pokemon)
+{
+    int index = playerPokemon.indexOf(pokemon);
+    if (index >= 0) {
+        journal->recordPokemonUpdated(index, pokemonRecord(pokemon));
+    }
+}
+
+void Game::applySaveData(const SaveData& data)
+{
+    qDeleteAll(playerPokemon);
+    playerPokemon.clear();
+    for (const SaveData::PokemonRecord& record : data.party) {
+        if (record.type < Pokemon::CHARMANDER || record.type > Pokemon::BULBASAUR) {
+            qDebug() << "Skipping saved Pokemon with unknown type" << record.type;
+            continue;
+        }
+        Pokemon* pokemon = new Pokemon(static_cast<Pokemon::Type>(record.type));
+        pokemon->setLevel(record.level);
+        pokemon->setCurrentHp(qBound(0, record.currentHp, pokemon->getMaxHp()));
+        for (int i = 0; i < record.movePp.size(); ++i) {
+            pokemon->setMovePp(i, record.movePp[i]);
+        }
+        playerPokemon.append(pokemon);
+    }
+
+    inventory = data.inventory;
+    laboratoryCompleted = data.laboratoryCompleted;
+
+    // Script flags aren't saved; the starter is the only one that matters
+    // across sessions, and owning a Pokémon means it was taken
+    scripts.setFlag("starter_chosen", laboratoryCompleted || !playerPokemon.isEmpty());
+
+    townBoxPositions = data.townBoxPositions;
+    townBoxOpenedStates = data.townBoxOpenedStates;
+    townBoxContents = data.townBoxContents;
+    townBoxesInitialized = data.townBoxesInitialized && !townBoxPositions.isEmpty();
+
+    // Without a Pokemon the only place to go is the lab
+    GameState state = static_cast<GameState>(data.scene);
+    if (playerPokemon.isEmpty() || (state != GameState::TOWN && state != GameState::GRASSLAND)) {
+        savedState = playerPokemon.isEmpty() ? GameState::LABORATORY : GameState::TOWN;
+    } else {
+        savedState = state;
+    }
+}
+
+bool Game::loadGame()
+{
+    if (!QFile::exists(savePath)) {
+        return false;
+    }
+
+    SaveData data;
+    QString error;
+    if (!journal->load(data, &error)) {
+        qDebug() << "Ignoring save file" << savePath << "-" << error;
+        return false;
+    }
+
+    applySaveData(data);
+    loadedFromSave = true;
+
+    // Fold the replayed events into a new snapshot and start a clean journal
+    journal->compact(data);
+    qDebug() << "Loaded save with" << playerPokemon.size() << "Pokemon and" << inventory.size() << "item kinds";
+    return true;
+}
+
+void Game::autosave()
+{
+    // Nothing worth saving until the player has left the title screen
+    if (currentState == GameState::TITLE) {
+        return;
+    }
+    journal->compact(createSaveData());
+}
@@ -9,6 +9,10 @@
 #include <QString>
 #include <memory>
 #include "pokemon.h"
+#include "savegame.h"
+#include "scriptengine.h"
+#include "inputsystem.h"
+#include "maplayout.h"
 #include <QVector>
 #include <QDebug>
 #include <QPointF>
@@ -23,6 +27,13 @@ class BattleScene;
 class Player;
 class Pokemon;
 class Item;
+class Simulation;
+class WorldStreamer;
+class WarmUp;
+class QThread;
+class QTimer;
+class SaveJournal;
+struct WorldSnapshot;
 
 // Game states
 enum class GameState {
@@ -38,7 +49,9 @@ class Game : public QObject
     Q_OBJECT
 
 public:
-    explicit Game(QGraphicsScene* scene, QObject *parent = nullptr);
+    // customSavePath: where this game journals and saves; empty for the usual file
+    // (or the scratch file of a stress run)
+    explicit Game(QGraphicsScene* scene, QObject *parent = nullptr, const QString& customSavePath = QString());
     ~Game();
 
     // Game lifecycle methods
@@ -47,15 +60,29 @@ public:
     void resume();
     void exit();
 
-    // Scene management
+    // Scene management. Between the lab, the town and the grassland this
+    // only hands the player over, see Scene::enterArea().
     void initialize();
     void changeScene(GameState newState);
+    static GameState areaState(MapLayout::Area area);
     void cleanup();
     Scene* getCurrentScene() const;
+    Simulation* getSimulation() const;
+    WorldStreamer* getWorldStreamer() const;
+    WarmUp* getWarmUp() const { return warmUp; }
+    ScriptEngine* getScripts() { return &scripts; }
+    InputSystem* getInput() { return &input; }
+    // Copies out the newest simulation snapshot if the current scene has
+    // not seen it yet, and shows it to the other world scenes as well
+    bool takeWorldSnapshot(WorldSnapshot &snapshot);
 
     // Event handling
     void handleKeyPress(QKeyEvent *event);
     void handleKeyRelease(QKeyEvent *event);
+    // Input tick for the current scene's menus and dialogues: hands it the
+    // actions pressed and released since the last tick. Runs on every key
+    // event and at the start of every scene frame.
+    void pollInput();
 
     // Player and Pokémon management
     Player* getPlayer() const;
@@ -88,7 +115,15 @@ public:
     const QMap<int, QString>& getTownBoxContents() const;
     void setTownBoxOpenedState(int boxIndex, bool isOpened);
     bool areTownBoxesInitialized() const;
-    void generateTownBoxes();
+    bool generateTownBoxes();
+
+    // Saving and loading
+    SaveData createSaveData() const;
+    void applySaveData(const SaveData& data);
+    bool loadGame();
+    void autosave();
+    // Battles change Pokemon in place; this journals the new state
+    void notifyPokemonChanged(Pokemon* pokemon);
 
 private:
     // Core components
@@ -103,6 +138,28 @@ private:
     GrasslandScene* grasslandScene;
     BattleScene* battleScene;
 
+    // Key state, sampled by the simulation every step and by pollInput()
+    InputSystem input;
+    InputSystem::Reader sceneInput;
+
+    // Player movement runs on its own thread
+    QThread* simulationThread;
+    Simulation* simulation;
+
+    // Area backgrounds are decoded and cached off the GUI thread
+    WorldStreamer* worldStreamer;
+
+    // The world the lab, town and grassland scenes share in the simulation
+    quint32 worldGeneration = 0;  // Of the snapshots they take
+    QPointF playerPos;            // As of the last snapshot taken
+    MapLayout::Area playerArea = MapLayout::AREA_TOWN;
+
+    // Collision worlds and sprites are prepared in the background during the title screen
+    WarmUp* warmUp;
+
+    // Dialogue and story events, compiled from Script/events.evs at build time
+    ScriptEngine scripts;
+
     // Game data
     Player* player;
     QMap<QString, int> inventory;
@@ -120,9 +177,29 @@ private:
     QMap<int, bool> townBoxOpenedStates;
     QMap<int, QString> townBoxContents;
     bool townBoxesInitialized = false;
+    static const int TOWN_BOX_COUNT = 15;
+
+    // Autosave: every change is journaled, full snapshots compact the journal
+    QString savePath;
+    SaveJournal* journal;
+    QTimer* autosaveTimer;
+    static const int JOURNAL_COMPACT_EVENTS = 256;
+    bool loadedFromSave = false;
+    GameState savedState = GameState::LABORATORY;  // Where a loaded save resumes
 
     // Initialize different game components
     void initScenes();
+
+    static bool isWorldState(GameState state);
+    static MapLayout::Area stateArea(GameState state);
+    Scene* worldScene(GameState state) const;
+    // Sets up all three world scenes and loads the world into the
+    // simulation; returns whether new town boxes were placed
+    bool enterWorld(GameState state);
+    void enterArea(GameState state);
+    void leaveWorld();
+
+    static SaveData::PokemonRecord pokemonRecord(const Pokemon* pokemon);
 };
 
 #endif // GAME_H
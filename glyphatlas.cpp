@@ -0,0 +1,101 @@
+#include "glyphatlas.h"
+#include <QDebug>
+#include <QFontMetricsF>
+#include <QPainter>
+#include <cmath>
+
+static const int ATLAS_WIDTH = 512;
+
+GlyphAtlas *GlyphAtlas::get(const QFont &font, const QColor &color)
+{
+    static QHash<QString, GlyphAtlas *> atlases;
+
+    const QString key = font.key() + QLatin1Char('/') + QString::number(color.rgba(), 16);
+    GlyphAtlas *&atlas = atlases[key];
+    if (!atlas) {
+        atlas = new GlyphAtlas(font, color);
+    }
+    return atlas;
+}
+
+GlyphAtlas::GlyphAtlas(const QFont &font, const QColor &color)
+    : font(font),
+      color(color)
+{
+    QFontMetricsF metrics(font);
+    lineSpacing = metrics.lineSpacing();
+    fontAscent = metrics.ascent();
+    cellHeight = static_cast<int>(std::ceil(metrics.height())) + 2 * PADDING;
+
+    image = QImage(ATLAS_WIDTH, cellHeight * 4, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+
+    // Everything the game's own strings use
+    for (ushort code = 32; code < 127; ++code) {
+        glyph(QChar(code));
+    }
+    qDebug() << "Glyph atlas ready for" << font.family() << font.pointSize() << "-" << glyphs.size() << "glyphs";
+}
+
+const GlyphAtlas::Glyph &GlyphAtlas::glyph(QChar character)
+{
+    auto it = glyphs.find(character);
+    if (it == glyphs.end()) {
+        it = glyphs.insert(character, rasterize(character));
+    }
+    return it.value();
+}
+
+const QPixmap &GlyphAtlas::pixmap()
+{
+    if (pixmapDirty) {
+        cachedPixmap = QPixmap::fromImage(image);
+        pixmapDirty = false;
+    }
+    return cachedPixmap;
+}
+
+GlyphAtlas::Glyph GlyphAtlas::rasterize(QChar character)
+{
+    QFontMetricsF metrics(font);
+    const QString text(character);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 11, 0)
+    const qreal advance = metrics.horizontalAdvance(text);
+#else
+    const qreal advance = metrics.width(text);
+#endif
+
+    // Italic and wide glyphs can reach past their advance
+    const QRectF ink = metrics.boundingRect(text);
+    const int width = static_cast<int>(std::ceil(qMax(advance, ink.right()))) + 2 * PADDING;
+
+    if (cursorX + width > image.width()) {
+        cursorX = 0;
+        cursorY += cellHeight;
+    }
+    if (cursorY + cellHeight > image.height()) {
+        // Grow downwards; cells already handed out keep their place
+        QImage grown(image.width(), image.height() * 2, QImage::Format_ARGB32_Premultiplied);
+        grown.fill(Qt::transparent);
+        QPainter copier(&grown);
+        copier.setCompositionMode(QPainter::CompositionMode_Source);
+        copier.drawImage(0, 0, image);
+        copier.end();
+        image = grown;
+    }
+
+    Glyph glyph;
+    glyph.source = QRectF(cursorX, cursorY, width, cellHeight);
+    glyph.advance = advance;
+
+    if (!character.isSpace()) {
+        QPainter painter(&image);
+        painter.setFont(font);
+        painter.setPen(color);
+        painter.drawText(QPointF(cursorX + PADDING, cursorY + PADDING + fontAscent), text);
+        pixmapDirty = true;
+    }
+
+    cursorX += width;
+    return glyph;
+}
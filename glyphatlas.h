@@ -0,0 +1,57 @@
+#ifndef GLYPHATLAS_H
+#define GLYPHATLAS_H
+
+#include <QColor>
+#include <QFont>
+#include <QHash>
+#include <QImage>
+#include <QPixmap>
+#include <QRectF>
+
+// One font in one color, rasterized glyph by glyph into a shared image.
+//
+// Printable ASCII is drawn up front; any other character is added the
+// first time it is asked for. Glyphs never move once drawn, so layouts
+// that point into the atlas stay valid while it grows.
+class GlyphAtlas
+{
+public:
+    struct Glyph {
+        QRectF source;   // Cell in the atlas, including the padding
+        qreal advance;   // Pen movement after the glyph
+    };
+
+    // Shared atlas for font and color; created on first use, kept for the
+    // lifetime of the program
+    static GlyphAtlas *get(const QFont &font, const QColor &color);
+
+    const Glyph &glyph(QChar character);
+    const QPixmap &pixmap();
+
+    qreal lineHeight() const { return lineSpacing; }
+    qreal ascent() const { return fontAscent; }
+
+    // Cell offset from the pen position, so the glyph ink lands where
+    // QPainter::drawText would put it
+    static const int PADDING = 2;
+
+private:
+    GlyphAtlas(const QFont &font, const QColor &color);
+
+    QFont font;
+    QColor color;
+    qreal lineSpacing{0};
+    qreal fontAscent{0};
+    int cellHeight{0};
+
+    QImage image;
+    QPixmap cachedPixmap;
+    bool pixmapDirty{true};
+    int cursorX{0};
+    int cursorY{0};
+    QHash<QChar, Glyph> glyphs;
+
+    Glyph rasterize(QChar character);
+};
+
+#endif // GLYPHATLAS_H
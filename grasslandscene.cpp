@@ -1,84 +1,147 @@
 #include "grasslandscene.h"
+#include "allocationtracker.h"
 #include "game.h"
+#include "maplayout.h"
+#include "simulation.h"
+#include "spritecache.h"
+#include "stringtable.h"
+#include "stresstest.h"
+#include "warmup.h"
+#include "worldstreamer.h"
 #include <QDebug>
-#include <QGraphicsTextItem>
 #include <QFont>
-#include <QTextDocument>
-#include <QRandomGenerator>
 #include <cmath>
 
-// Define constants for the scene size - must match those from Scene class
-const int SCENE_WIDTH = 1000;
-const int SCENE_HEIGHT = 1000;
+// Define constants for the view size
 const int VIEW_WIDTH = 525;   // View width (smaller than scene)
 const int VIEW_HEIGHT = 450;  // View height (smaller than scene)
 
 GrasslandScene::GrasslandScene(Game *game, QGraphicsScene *scene, QObject *parent)
-    : Scene(game, scene, parent), backgroundItem(nullptr), playerItem(nullptr),
-    townPortalItem(nullptr), bulletinBoardItem(nullptr), currentGrassArea(-1)
+    : Scene(game, scene, parent), playerItem(nullptr),
+    wildPokemons(StressTest::isEnabled() ? StressTest::config().wildPokemon : MAX_WILD_POKEMON),
+    wildSpritePool(scene), viewportCuller(scene), battleMessages(scene)
 {
-    // Create update timer
-    updateTimer = new QTimer(this);
-    connect(updateTimer, &QTimer::timeout, this, &GrasslandScene::updateScene);
-
-    // Create movement timer for continuous walking
-    movementTimer = new QTimer(this);
-    connect(movementTimer, &QTimer::timeout, this, &GrasslandScene::processMovement);
-    movementTimer->setInterval(60);  // smaller number = faster walking speed
+    // Frames run while something moves and stop once the scene is still;
+    // input and new simulation snapshots start them again. Respawns and
+    // battle delays run on the simulation's timers, whose snapshots wake the loop.
+    frameLoop = new FrameLoop(16, this);
+    connect(frameLoop, &FrameLoop::frame, this, [this]() {
+        updateScene();
+        frameLoop->frameDone(isFrameBusy());
+    });
+    connect(game->getSimulation(), &Simulation::snapshotPublished, frameLoop, &FrameLoop::wake, Qt::QueuedConnection);
+
+    // The town's camera can see the grassland too
+    connect(game->getWorldStreamer(), &WorldStreamer::viewChanged, this, [this](const QRectF &viewRect) {
+        viewportCuller.update(viewRect);
+    });
 }
 
 GrasslandScene::~GrasslandScene()
 {
     cleanup();
-    if (updateTimer) {
-        updateTimer->stop();
-        delete updateTimer;
-    }
-    if (movementTimer) {
-        movementTimer->stop();
-        delete movementTimer;
-    }
 }
 
 void GrasslandScene::initialize()
 {
     qDebug() << "Initializing Grassland Scene";
 
-    // Set player position to the lower portion of the grassland but above the portal
-    playerPos = QPointF(GRASSLAND_WIDTH / 2, GRASSLAND_HEIGHT - 350);
-    qDebug() << "Player position set to:" << playerPos.x() << "," << playerPos.y();
-
     // Create scene elements
+    collisionWorld.clear();
+    pendingArea = -1;
+    occupiedBulletin = -1;
     createBackground();
     createBarriers();
+    if (const WarmUp::AreaWorld *prebuilt = game->getWarmUp()->world(MapLayout::AREA_GRASSLAND)) {
+        collisionWorld = prebuilt->collision;
+        pathfinder = prebuilt->pathfinder;
+    } else {
+        buildWorld(collisionWorld, pathfinder);
+    }
     createTallGrassAreas(); // Add tall grass areas
     createPlayer();
 
-    // Reset grass area tracking and spawn Pokémon in all tall grass areas
-    grassAreaVisited.clear();
-    currentGrassArea = -1;
+    // Sprites follow the simulation's wild list, starting empty
     wildPokemons.clear();
-    
-    // Spawn one Pokémon in each tall grass area immediately
-    for (int i = 0; i < tallGrassItems.size(); i++) {
-        spawnWildPokemon(i);
-        grassAreaVisited[i] = true;
-    }
+    wildVersion = 0;
+}
+
+void GrasslandScene::addToWorld(WorldContent &content)
+{
+    content.addCollision(collisionWorld);
+
+    // The board can be read from up to 20 pixels away. Its volume is
+    // numbered after the town's boards; the town lies beyond the path, no
+    // volume needed, the player just walks on.
+    content.addRect(TriggerSystem::Kind::Bulletin, content.triggerCount(TriggerSystem::Kind::Bulletin),
+                    bulletinBoardRect.adjusted(-20, -20, 20, 20));
+    for (int i = 0; i < tallGrassRects.size(); ++i) {
+        content.addRect(TriggerSystem::Kind::Grass, i, tallGrassRects[i]);
+    }
+
+    // Barriers, ledges and the bulletin board are kept clear so a Pokémon
+    // never sits on top of them
+    content.spawnBounds = MapLayout::areaRect(MapLayout::AREA_GRASSLAND);
+    content.spawnBlockers = barrierRects;
+    content.spawnBlockers += ledgeRects;
+    content.spawnBlockers.append(bulletinBoardRect);
+    content.grassAreas = tallGrassRects;
+    content.respawnDelayMs = WILD_RESPAWN_DELAY_MS;
+    content.maxWildPokemon = wildPokemons.capacity();
+
+    // Stress runs fill the grass and walk straight through it
+    content.fillGrass = StressTest::isEnabled();
+    content.encounters = !StressTest::isEnabled();
+
+    // The player may walk anywhere in the grassland and the town below it
+    WorldContent::Walk &walk = content.walks[MapLayout::AREA_GRASSLAND];
+    walk.bounds = MapLayout::regionRect(MapLayout::AREA_GRASSLAND).adjusted(0, 0, -25, -48);
+    walk.baseSpeed = 8;
+    walk.fastSpeed = 10;  // 20% faster after a few steps
+}
 
-    // Set initial camera position to center on player
+void GrasslandScene::enterArea(const QPointF &position)
+{
+    qDebug() << "Player entered the grassland at" << position.x() << "," << position.y();
+    playerPos = position;
+    pendingArea = -1;
+    if (playerItem) {
+        playerItem->setPos(playerPos);
+        playerItem->setVisible(true);
+    }
+    updatePlayerFreeze();
     updateCamera();
 
-    // Reset movement state to prevent carrying over movement from town scene
-    currentPressedKey = 0;
-    pressedKeys.clear();
-    if (movementTimer && movementTimer->isActive()) {
-        movementTimer->stop();
+    // Start the frame loop
+    frameLoop->start();
+}
+
+void GrasslandScene::leaveArea()
+{
+    frameLoop->stop();
+
+    // An event still waiting for the player must not resume once they have left
+    game->getScripts()->stop();
+    if (isDialogueActive) {
+        closeDialogue();
+    }
+    if (isBagOpen) {
+        toggleBag();
+    }
+    if (playerItem) {
+        playerItem->setVisible(false);
     }
+    if (debugOverlay) {
+        debugOverlay->hideAllocationStats();
+    }
+}
 
-    // Start update timer
-    updateTimer->start(16); // 60 FPS
-    // Start movement timer for continuous movement
-    movementTimer->start(100);
+void GrasslandScene::snapshotTaken(const WorldSnapshot &snapshot)
+{
+    if (snapshot.wildVersion != wildVersion) {
+        wildVersion = snapshot.wildVersion;
+        syncWildPokemon(snapshot.wild);
+    }
 }
 
 void GrasslandScene::cleanup()
@@ -86,52 +149,64 @@ void GrasslandScene::cleanup()
     qDebug() << "Cleaning up grassland scene";
     
     // Stop timers first
-    if (updateTimer && updateTimer->isActive()) {
-        updateTimer->stop();
-    }
-    
-    if (movementTimer && movementTimer->isActive()) {
-        movementTimer->stop();
-    }
+    frameLoop->stop();
+
+    // An event still waiting for the player must not resume in an unloaded scene
+    game->getScripts()->stop();
     
     // Clear bag display items explicitly
     clearBagDisplayItems();
     
-    // Reset movement state
-    currentPressedKey = 0;
-    pressedKeys.clear();
-    
-    // Clean up wild Pokémon sprites
-    for (WildPokemon& pokemon : wildPokemons) {
-        if (pokemon.spriteItem) {
-            scene->removeItem(pokemon.spriteItem);
-            delete pokemon.spriteItem;
-            pokemon.spriteItem = nullptr;
-        }
-    }
+    // Culled items go back into the scene first, so the pool and the
+    // scene find every item they own
+    viewportCuller.clear();
+
+    // Clean up wild Pokémon sprites before the scene is cleared
     wildPokemons.clear();
-    
-    // Reset grass area tracking
-    grassAreaVisited.clear();
-    currentGrassArea = -1;
-    
-    // Clean up battle scene
-    if (battleSceneItem) {
-        scene->removeItem(battleSceneItem);
-        delete battleSceneItem;
+    wildSpritePool.clear();
+    wildVersion = 0;
+    battleMessages.clear();
+    battleMessageTickets.clear();
+    
+    pendingArea = -1;
+    occupiedBulletin = -1;
+    
+    // Clean up battle scene; deleting the root deletes every battle item
+    if (battleRoot) {
+        scene->removeItem(battleRoot);
+        delete battleRoot;
+        battleRoot = nullptr;
         battleSceneItem = nullptr;
+        battlePlayerSprite = nullptr;
+        battleWildSprite = nullptr;
+        battlePlayerHpBar = nullptr;
+        battlePlayerHpFill = nullptr;
+        battlePlayerStats = nullptr;
+        battleWildHpBar = nullptr;
+        battleWildHpFill = nullptr;
+        battleWildStats = nullptr;
+        battleMenuItem = nullptr;
+        battlePromptText = nullptr;
+        battleMarker = nullptr;
+        battleListText = nullptr;
+        for (int i = 0; i < 4; i++) {
+            battleOptionRects[i] = nullptr;
+        }
     }
     inBattleScene = false;
+    isBattleStarting = false;
+    battleBusy = false;
     
     // We shouldn't remove or delete scene items here since the scene is managed by Game
     // Just reset our pointers so we don't try to use them later
-    backgroundItem = nullptr;
     playerItem = nullptr;
-    barrierItems.clear();
-    ledgeItems.clear();
-    tallGrassItems.clear();
-    bulletinBoardItem = nullptr;
-    townPortalItem = nullptr;
+    debugOverlay = nullptr;
+    barrierRects.clear();
+    ledgeRects.clear();
+    pathfinder.clear();
+    tallGrassRects.clear();
+    bulletinBoardRect = QRectF();
+    townPathRect = QRectF();
     
     // Don't clear the scene, as it's managed by Game
     qDebug() << "Grassland scene cleanup complete";
@@ -139,37 +214,8 @@ void GrasslandScene::cleanup()
 
 void GrasslandScene::createBackground()
 {
-    // First create a large black background for the entire scene
-    QGraphicsRectItem* blackBackground = scene->addRect(0, 0, SCENE_WIDTH, SCENE_HEIGHT, 
-        QPen(Qt::transparent), QBrush(Qt::black));
-    blackBackground->setZValue(-1);
-    qDebug() << "Black background created with size:" << SCENE_WIDTH << "x" << SCENE_HEIGHT;
-
-    // Load grassland background
-    QPixmap background(":/Dataset/Image/scene/GrassLand.png");
-
-    if (background.isNull()) {
-        qDebug() << "Grassland background image not found. Check the path.";
-        background = QPixmap(GRASSLAND_WIDTH, GRASSLAND_HEIGHT);
-        background.fill(QColor(120, 200, 80)); // Green color as fallback
-    } else {
-        qDebug() << "Grassland background loaded successfully, size:" << background.width() << "x" << background.height();
-        
-        // Scale the image to fill the grassland area if needed
-        if (background.width() != GRASSLAND_WIDTH || background.height() != GRASSLAND_HEIGHT) {
-            background = background.scaled(GRASSLAND_WIDTH, GRASSLAND_HEIGHT, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
-            qDebug() << "Grassland background scaled to:" << background.width() << "x" << background.height();
-        }
-    }
-
-    // Position grassland background at (0,0) in scene
-    backgroundItem = scene->addPixmap(background);
-    backgroundItem->setPos(0, 0);
-    backgroundItem->setZValue(0);
-
-    qDebug() << "Grassland background positioned for scrolling view";
-    
-    // Make sure the scene background is also black
+    // Game's WorldStreamer streams the grassland background in chunks around
+    // the camera; where there is no map the scene shows black
     scene->setBackgroundBrush(Qt::black);
 }
 
@@ -187,114 +233,75 @@ void GrasslandScene::createPlayer()
     }
 
     playerItem = scene->addPixmap(playerSprite);
-    playerItem->setPos(playerPos); // Set initial position
     playerItem->setZValue(3); // Ensure player is on top of other elements
-    qDebug() << "Initial player position:" << playerPos.x() << playerPos.y();
+    playerItem->setVisible(false); // Until the player enters the grassland
+}
+
+void GrasslandScene::buildWorld(CollisionWorld &world, Pathfinder &pathfinder)
+{
+    for (const QRectF &rect : MapLayout::toWorld(MapLayout::AREA_GRASSLAND, MapLayout::grasslandBarriers())) {
+        world.addSolid(rect);
+    }
+    for (const QRectF &rect : MapLayout::toWorld(MapLayout::AREA_GRASSLAND, MapLayout::grasslandLedges())) {
+        world.addLedge(rect);
+    }
+    pathfinder.build(world, MapLayout::areaRect(MapLayout::AREA_GRASSLAND).adjusted(0, 0, -25, -48));
 }
 
 void GrasslandScene::createBarriers()
 {
-    // Define barriers for the grassland based on 1000x1667 dimensions
-    QVector<QRect> barrierRects = {
-        // Boundary barriers to prevent player from walking off the map
-        QRect(0, 0, 422, 75),  // Top left barrier
-        QRect(570, 0, 458, 75),  // Top right barrier
-        QRect(0, 0, 75, GRASSLAND_HEIGHT),  // Left barrier
-        QRect(GRASSLAND_WIDTH - 75, 0, 50, GRASSLAND_HEIGHT),  // Right barrier
-        QRect(0, GRASSLAND_HEIGHT - 100, 488, 100),  // Bottom left barrier
-        QRect(582, GRASSLAND_HEIGHT - 100, 500, 100),  // Bottom right barrier
-        
-        // Added barriers for the interior areas based on the red lines in the image
-        QRect(85,1010,410,105), //Bottom left tree
-        QRect(85,600,80,100), //Center left alone tree
-        QRect(422,600,240,100), //Beside center left alone tree (3 tree)
-        QRect(338,128,80,358),
-    };
-
-    // Add barriers (with visible red outlines for debugging)
-    for (const QRect &rect : barrierRects) {
-        QGraphicsRectItem *barrier = scene->addRect(rect, QPen(Qt::transparent), QBrush(Qt::transparent));
-        barrier->setZValue(5); // Higher zValue to be visible for debugging
-        barrier->setVisible(false);
-        barrierItems.append(barrier);
-    }
-    
-    // Define ledges (one-way barriers, can jump down, can't climb up)
-    // Looking at the brown ledges in the image
-    QVector<QRect> ledgeRects = {
-       
-        QRect(82, 231, 246, 20),   
-        QRect(420, 231, 244, 20),   
-        QRect(82, 440, 248, 20),   
-        
-        
-          
-        QRect(170, 646, 240, 20),   
-        QRect(85, 851, 77, 20), 
-        QRect(213, 851, 160, 20), 
-        QRect(469, 851, 650, 20), 
-
-        QRect(GRASSLAND_WIDTH - 253,1105,175,20),
-        QRect(82,1315,163,20),
-        QRect(417,1315,550,20),
-    };
-    
-    // Add ledges with purple outlines
-    for (const QRect &rect : ledgeRects) {
-        QGraphicsRectItem *ledge = scene->addRect(rect, QPen(Qt::darkMagenta, 2), QBrush(Qt::transparent));
-        ledge->setZValue(4); // Below barriers but still visible
-        ledgeItems.append(ledge);
-    }
-    
-    // Create town transition portal (blue box) at position 2 shown in the image
-    QRect townPortalRect(GRASSLAND_WIDTH/2 - 50 + 35, GRASSLAND_HEIGHT - 90, 100, 90);
-    QGraphicsRectItem *townPortal = scene->addRect(townPortalRect, QPen(Qt::blue, 2), QBrush(QColor(0, 0, 255, 40)));
-    townPortal->setZValue(2); // Below player but visible
-    townPortalItem = townPortal;
-    
-    // Create a bulletin board (green box) - fixed position to match the tent/sign
-    QRect bulletinBoardRect(373, 1295, 40, 40);
-    QGraphicsRectItem *bulletinBoard = scene->addRect(bulletinBoardRect, QPen(Qt::darkGreen, 2), QBrush(QColor(0, 128, 0, 40)));
-    bulletinBoard->setZValue(2); // Below player but visible
-    bulletinBoardItem = bulletinBoard;
+    // Barriers and ledges come from the shared map layout. They are plain
+    // rects; debug builds outline them in a single overlay item.
+    debugOverlay = DebugOverlayItem::create(scene);
+
+    // Barriers stay invisible even in the overlay, the background shows them
+    barrierRects = MapLayout::toWorld(MapLayout::AREA_GRASSLAND, MapLayout::grasslandBarriers());
+    
+    // Add ledges (one-way barriers, can jump down, can't climb up) with purple outlines
+    ledgeRects = MapLayout::toWorld(MapLayout::AREA_GRASSLAND, MapLayout::grasslandLedges());
+    
+    // The path down to the town (blue box) at position 2 shown in the image, and
+    // the bulletin board (green box) - fixed position to match the tent/sign
+    townPathRect = MapLayout::toWorld(MapLayout::AREA_GRASSLAND, MapLayout::grasslandTownPath());
+    bulletinBoardRect = MapLayout::toWorld(MapLayout::AREA_GRASSLAND, MapLayout::grasslandBulletinBoard());
+
+    if (debugOverlay) {
+        debugOverlay->addRects(ledgeRects, QPen(Qt::darkMagenta, 2));
+        debugOverlay->addRect(townPathRect, QPen(Qt::blue, 2), QBrush(QColor(0, 0, 255, 40)));
+        debugOverlay->addRect(bulletinBoardRect, QPen(Qt::darkGreen, 2), QBrush(QColor(0, 128, 0, 40)));
+    }
      
-    qDebug() << "Created" << barrierItems.size() << "barriers," << ledgeItems.size() << "ledges, 1 town portal, and 1 bulletin board for grassland";
+    qDebug() << "Created" << barrierRects.size() << "barriers," << ledgeRects.size() << "ledges, the path to town, and 1 bulletin board for grassland";
 }
 
 void GrasslandScene::createTallGrassAreas()
 {
     // Define tall grass areas for wild Pokémon encounters
-    QVector<QRect> grassRects = {
-        // Tall grass areas from user specifications
-        QRect(82, 1337, 374, 168),  // First tall grass area
-        QRect(632, 1337, 295, 168), // Second tall grass area
-        QRect(500, 1457, 90, 112), // Third tall grass area
-        QRect(500, 1006, 256, 210), // Fourth tall grass area
-        QRect(428, 251, 483, 207), // Fifth tall grass area
-        QRect(662, 533, 244, 210), // Sixth tall grass area
-    };
-
-    // Add tall grass areas with yellow outlines
-    for (const QRect &rect : grassRects) {
-        QGraphicsRectItem *grassArea = scene->addRect(rect, QPen(Qt::yellow, 2), QBrush(QColor(255, 255, 0, 40)));
-        grassArea->setZValue(1); // Just above the background
-        tallGrassItems.append(grassArea);
-    }
-    
-    qDebug() << "Created" << tallGrassItems.size() << "tall grass areas for wild Pokémon encounters";
+    tallGrassRects = MapLayout::toWorld(MapLayout::AREA_GRASSLAND, MapLayout::grasslandTallGrass());
+
+    // Tall grass areas with yellow outlines in the debug overlay
+    if (debugOverlay) {
+        debugOverlay->addRects(tallGrassRects, QPen(Qt::yellow, 2), QBrush(QColor(255, 255, 0, 40)));
+    }
+    
+    qDebug() << "Created" << tallGrassRects.size() << "tall grass areas for wild Pokémon encounters";
 }
 
-void GrasslandScene::handleKeyPress(int key)
+void GrasslandScene::handleAction(InputSystem::Action action)
 {
-    qDebug() << "Battle scene key press:" << key << "- inBattleScene:" << inBattleScene 
-             << "isDialogueActive:" << isDialogueActive 
-             << "isPokemonSelectionDialogue:" << isPokemonSelectionDialogue;
+    frameLoop->wake();
+
+    // The party selection is answered by the battle in the simulation
+    if (isBattleStarting) {
+        game->getSimulation()->battleAction(action);
+        return;
+    }
     
     // If in battle scene, handle battle menu navigation
     if (inBattleScene) {
         // If in move selection, handle move choice
         if (isMoveSelectionActive) {
-            if (key == Qt::Key_B || key == Qt::Key_Escape) {
+            if (action == InputSystem::MENU || action == InputSystem::CANCEL) {
                 // Return to battle menu
                 isMoveSelectionActive = false;
                 showBattleScene();
@@ -307,16 +314,19 @@ void GrasslandScene::handleKeyPress(int key)
                 Pokemon* activePokemon = playerPokemon.first();
                 const QVector<Pokemon::Move>& moves = activePokemon->getMoves();
 
-                // Handle move selection (keys 1-2 for moves, C for Do Nothing)
-                if (key >= Qt::Key_1 && key <= Qt::Key_2) {
-                    int moveIndex = key - Qt::Key_1;
-                    if (moveIndex < moves.size()) {
-                        handleMoveSelection(moveIndex);
-                        isMoveSelectionActive = false;
-                    }
-                } else if (key == Qt::Key_C) {
-                    handleMoveSelection(-1); // Do Nothing
+                // Handle move selection (1-2 for moves, pass (C) for Do Nothing).
+                // The simulation plays the turn out and reports back.
+                int selection = InputSystem::selection(action);
+                int moveIndex = -2;
+                if (selection >= 1 && selection <= 2 && selection - 1 < moves.size()) {
+                    moveIndex = selection - 1;
+                } else if (action == InputSystem::PASS) {
+                    moveIndex = -1; // Do Nothing
+                }
+                if (moveIndex >= -1) {
                     isMoveSelectionActive = false;
+                    showBattleScene();
+                    game->getSimulation()->battleCommand(BattleState::FIGHT, moveIndex);
                 }
             }
             return;
@@ -324,15 +334,22 @@ void GrasslandScene::handleKeyPress(int key)
 
         // If in bag view, handle item selection
         if (isBattleBagOpen) {
-            if (key == Qt::Key_B || key == Qt::Key_Escape) {
+            // The item in use plays out before another one can be picked
+            if (battleBusy) {
+                return;
+            }
+
+            if (action == InputSystem::MENU || action == InputSystem::CANCEL) {
                 isBattleBagOpen = false;
                 showBattleScene();
                 return;
             }
             
-            if (key >= Qt::Key_1 && key <= Qt::Key_3) {
-                int itemIndex = key - Qt::Key_1 + 1;
-                handleBagSelection(itemIndex);
+            int itemIndex = InputSystem::selection(action);
+            if (itemIndex >= 1 && itemIndex <= 3) {
+                // The list stays up until the item's result brings the menu back
+                battleBusy = true;
+                game->getSimulation()->battleCommand(BattleState::USE_ITEM, itemIndex);
                 return;
             }
             return;
@@ -341,8 +358,8 @@ void GrasslandScene::handleKeyPress(int key)
         // Battle menu navigation
         BattleOption prevSelection = selectedBattleOption;
         
-        switch (key) {
-            case Qt::Key_Left:
+        switch (action) {
+            case InputSystem::MOVE_LEFT:
                 if (selectedBattleOption == BAG) {
                     selectedBattleOption = FIGHT;
                 } else if (selectedBattleOption == RUN) {
@@ -350,7 +367,7 @@ void GrasslandScene::handleKeyPress(int key)
                 }
                 break;
                 
-            case Qt::Key_Right:
+            case InputSystem::MOVE_RIGHT:
                 if (selectedBattleOption == FIGHT) {
                     selectedBattleOption = BAG;
                 } else if (selectedBattleOption == POKEMON) {
@@ -358,7 +375,7 @@ void GrasslandScene::handleKeyPress(int key)
                 }
                 break;
                 
-            case Qt::Key_Up:
+            case InputSystem::MOVE_UP:
                 if (selectedBattleOption == POKEMON) {
                     selectedBattleOption = FIGHT;
                 } else if (selectedBattleOption == RUN) {
@@ -366,7 +383,7 @@ void GrasslandScene::handleKeyPress(int key)
                 }
                 break;
                 
-            case Qt::Key_Down:
+            case InputSystem::MOVE_DOWN:
                 if (selectedBattleOption == FIGHT) {
                     selectedBattleOption = POKEMON;
                 } else if (selectedBattleOption == BAG) {
@@ -374,9 +391,7 @@ void GrasslandScene::handleKeyPress(int key)
                 }
                 break;
                 
-            case Qt::Key_Return:
-            case Qt::Key_Enter:
-            case Qt::Key_A:
+            case InputSystem::CONFIRM:
                 switch (selectedBattleOption) {
                     case FIGHT:
                         showMoveSelection();
@@ -388,138 +403,53 @@ void GrasslandScene::handleKeyPress(int key)
                         showPokemonSelectionDialogue();
                         break;
                     case RUN:
-                        exitBattleScene();
+                        game->getSimulation()->battleCommand(BattleState::RUN);
                         break;
                 }
                 return;
+
+            default:
+                break;
         }
         
-        // If selection changed, update the battle menu display
+        // If selection changed, move the highlight; the rest of the menu stays as it is
         if (prevSelection != selectedBattleOption) {
-            qDebug() << "Battle menu selection changed from" << static_cast<int>(prevSelection) 
-                     << "to" << static_cast<int>(selectedBattleOption);
-            showBattleScene();
+            AllocationTracker::Scope allocationScope(AllocationTracker::BATTLE_MENU);
+            updateBattleMenuSelection();
         }
         return;
     }
 
-    // If dialogue is active, handle Pokémon selection or dialogue advancement
+    // If dialogue is active, confirm (A) advances it
     if (isDialogueActive) {
-        if (isPokemonSelectionDialogue) {
-            // Handle Pokémon selection during battle start
-            const QVector<Pokemon*>& playerPokemon = game->getPokemon();
-            if (key >= Qt::Key_1 && key <= Qt::Key_9) {
-                int index = key - Qt::Key_1;
-                if (index < playerPokemon.size()) {
-                    qDebug() << "Selected Pokemon at index" << index << "- moving to front and starting battle";
-                    // Move selected Pokémon to front
-                    game->movePokemonToFront(index);
-                    
-                    // Clear the dialogue
-                    closeDialogue();
-                    isPokemonSelectionDialogue = false;
-                    
-                    // Show battle scene after a short delay to allow dialogue to clear
-                    QTimer::singleShot(100, [this]() {
-                        inBattleScene = true;
-                        selectedBattleOption = FIGHT;
-                        showBattleScene();
-                    });
-                    return;
-                }
-            } else if (key == Qt::Key_Escape) {
-                qDebug() << "Escaping from battle";
-                // Run away
-                closeDialogue();
-                isPokemonSelectionDialogue = false;
-                // Resume movement timer
-                if (movementTimer && !movementTimer->isActive()) {
-                    movementTimer->start(60);
-                }
-                return;
-            }
-            return;
-        }
-        
-        if (key == Qt::Key_A) {
+        if (action == InputSystem::CONFIRM) {
             handleDialogue();
         }
         return;
     }
 
-    // If bag is open, only allow B key to close it
+    // If bag is open, only allow the menu key (B) to close it
     if (isBagOpen) {
-        if (key == Qt::Key_B) {
+        if (action == InputSystem::MENU) {
             toggleBag();
         }
         return; // Block all other key presses while bag is open
     }
 
-    // Add key to pressed keys set for movement
-    pressedKeys.insert(key);
-    qDebug() << "Key pressed: " << key;
-
-    // For arrow keys, set as current pressed key for continuous movement
-    // and also take a small step immediately for responsive feel
-    if (key == Qt::Key_Up || key == Qt::Key_Down || key == Qt::Key_Left || key == Qt::Key_Right) {
-        QPointF prevPos = playerPos;
-        bool moved = false;
-        
-        // Take immediate step (5 pixels)
-        if (key == Qt::Key_Up) {
-            playerDirection = "B";
-            playerPos.setY(playerPos.y() - 5);
-            moved = true;
-        } else if (key == Qt::Key_Down) {
-            playerDirection = "F";
-            playerPos.setY(playerPos.y() + 5);
-            moved = true;
-        } else if (key == Qt::Key_Left) {
-            playerDirection = "L";
-            playerPos.setX(playerPos.x() - 5);
-            moved = true;
-        } else if (key == Qt::Key_Right) {
-            playerDirection = "R";
-            playerPos.setX(playerPos.x() + 5);
-            moved = true;
-        }
-        
-        // Check for collisions with barriers and ledges
-        bool collision = checkCollision();
-        bool jumpingDownLedge = isPlayerJumpingDownLedge(playerPos);
-            
-        if (collision && !jumpingDownLedge) {
-            playerPos = prevPos;
-        } else {
-            // Update position and sprite
-            if (playerItem) {
-                playerItem->setPos(playerPos);
-                qDebug() << "Immediate step: player position updated to:" << playerPos;
-            }
-            walkFrame = (walkFrame + 1) % 3;
-            updatePlayerSprite();
-            updateCamera();
-        }
-        
-        // Set current key for continuous movement
-        currentPressedKey = key;
-        // Start the movement timer if it's not already running
-        if (!movementTimer->isActive()) {
-            movementTimer->start(100);
-        }
-    }
+    // Arrow keys already reached the simulation through Game's input state:
+    // one short step right away, then steps for as long as the key stays down
 
-    // Check for B key to open bag
-    if (key == Qt::Key_B) {
+    // Menu key (B) opens the bag
+    if (action == InputSystem::MENU) {
         toggleBag();
         return;
     }
 
-    // Check for A key to interact with objects
-    if (key == Qt::Key_A) {
+    // Confirm (A) interacts with objects
+    if (action == InputSystem::CONFIRM) {
         // Check if player is near the bulletin board
-        if (isPlayerNearBulletinBoard()) {
-            showDialogue("GRASSLAND BULLETIN: Wild Pokémon can be found in the tall grass. Be careful and always carry your Pokémon with you!");
+        if (occupiedBulletin >= 0) {
+            game->getScripts()->start("grassland_bulletin", this);
             return;
         }
         
@@ -527,190 +457,181 @@ void GrasslandScene::handleKeyPress(int key)
     }
 }
 
-void GrasslandScene::handleKeyRelease(int key)
+void GrasslandScene::handleActionRelease(InputSystem::Action action)
 {
-    // Remove key from pressed keys set
-    pressedKeys.remove(key);
-    
-    // If the released key was the current movement key, reset it
-    if (key == currentPressedKey) {
-        currentPressedKey = 0;
-        
-        // Stop the movement timer if no arrow keys are pressed
-        if (!pressedKeys.contains(Qt::Key_Up) && 
-            !pressedKeys.contains(Qt::Key_Down) && 
-            !pressedKeys.contains(Qt::Key_Left) && 
-            !pressedKeys.contains(Qt::Key_Right)) {
-            movementTimer->stop();
-        }
-    }
+    Q_UNUSED(action);
+
+    // The simulation already saw the release through the input state
+    frameLoop->wake();
 }
 
-void GrasslandScene::processMovement()
+void GrasslandScene::applySimulationSnapshot()
 {
-    // Do nothing if no key is pressed or dialogue/bag is open
-    if (currentPressedKey == 0 || isDialogueActive || isBagOpen) {
+    AllocationTracker::Scope allocationScope(AllocationTracker::WALK);
+    WorldSnapshot snapshot;
+    if (!game->takeWorldSnapshot(snapshot)) {
         return;
     }
-    
-    QPointF prevPos = playerPos;
-    bool moved = false;
-
-    // Speed increases after holding the key for some time
-    static int moveSteps = 0;
-    int moveSpeed = 8; // Base speed
-    
-    // Increase speed by 20% after a few steps
-    if (moveSteps > 3) {
-        moveSpeed = 10; // Increased by 20% from base
-    }
-    moveSteps++;
-
-    // Movement based on currently pressed key
-    if (currentPressedKey == Qt::Key_Up) {
-        playerPos.setY(playerPos.y() - moveSpeed);
-        playerDirection = "B";
-        moved = true;
-    } else if (currentPressedKey == Qt::Key_Down) {
-        playerPos.setY(playerPos.y() + moveSpeed);
-        playerDirection = "F";
-        moved = true;
-    } else if (currentPressedKey == Qt::Key_Left) {
-        playerPos.setX(playerPos.x() - moveSpeed);
-        playerDirection = "L";
-        moved = true;
-    } else if (currentPressedKey == Qt::Key_Right) {
-        playerPos.setX(playerPos.x() + moveSpeed);
-        playerDirection = "R";
-        moved = true;
-    }
-
-    if (moved) {
-        // Boundary checking - don't allow player to go outside grassland area
-        if (playerPos.x() < 0) {
-            playerPos.setX(0);
-        } else if (playerPos.x() > GRASSLAND_WIDTH - 25) {
-            playerPos.setX(GRASSLAND_WIDTH - 25);
-        }
+    // The items below show the step the press asked for from the next paint
+    game->getInput()->markApplied(snapshot.inputNs, InputSystem::WALK_LATENCY);
+
+    // Written in place: assigning a new QString would allocate on every turn
+    const QChar direction = QLatin1Char(snapshot.direction);
+    if (direction != playerDirection.at(0) || snapshot.walkFrame != walkFrame) {
+        playerDirection[0] = direction;
+        walkFrame = snapshot.walkFrame;
+        updatePlayerSprite();
+    }
 
-        if (playerPos.y() < 0) {
-            playerPos.setY(0);
-        } else if (playerPos.y() > GRASSLAND_HEIGHT - 48) {
-            playerPos.setY(GRASSLAND_HEIGHT - 48);
+    if (snapshot.playerPos != playerPos) {
+        playerPos = snapshot.playerPos;
+        if (playerItem) {
+            playerItem->setPos(playerPos);
         }
+        updateCamera();
+    }
 
-        // Check collision with barriers using a smaller hitbox at player's feet
-        QRectF playerRect(playerPos.x() + 5, playerPos.y() + 30, 25, 18);
-        bool collision = false;
-        
-        // Check regular barrier collisions
-        for (const QGraphicsRectItem* barrier : barrierItems) {
-            QRectF barrierRect = barrier->rect();
-            if (playerRect.intersects(barrierRect)) {
-                collision = true;
+    // Walked down into the town: its scene takes over in updateScene
+    if (snapshot.area != MapLayout::AREA_GRASSLAND) {
+        pendingArea = snapshot.area;
+    }
+
+    occupiedBulletin = snapshot.occupiedTrigger(TriggerSystem::Kind::Bulletin);
+    battleBusy = snapshot.battleBusy;
+    if (snapshot.wildVersion != wildVersion) {
+        wildVersion = snapshot.wildVersion;
+        syncWildPokemon(snapshot.wild);
+    }
+
+    // Act on what the simulation did since the last snapshot we took
+    for (int i = snapshot.firstNewEvent; i < snapshot.events.size(); ++i) {
+        const WorldEvent &event = snapshot.events[i];
+        switch (event.type) {
+            case WorldEvent::TRIGGER_ENTERED:
+                if (event.trigger == TriggerSystem::Kind::Grass) {
+                    qDebug() << "Player entered grass area" << event.index;
+                }
                 break;
-            }
-        }
-        
-        // Check ledge collisions - only if moving upward
-        if (!collision && currentPressedKey == Qt::Key_Up) {
-            for (const QGraphicsRectItem* ledge : ledgeItems) {
-                QRectF ledgeRect = ledge->rect();
-                
-                // Improve the calculation of player's feet position in relation to the ledge
-                QRectF oldPlayerRect(prevPos.x() + 5, prevPos.y() + 30, 25, 18); // Previous position
-                
-                // Check if:
-                // 1. Player's previous position was below the ledge
-                // 2. Player is trying to cross the ledge vertically
-                // 3. Player is horizontally aligned with the ledge
-                bool wasBelow = oldPlayerRect.top() > ledgeRect.top();
-                bool isCrossing = playerRect.top() <= ledgeRect.bottom() && playerRect.top() > ledgeRect.top();
-                bool isAligned = playerRect.right() >= ledgeRect.left() && playerRect.left() <= ledgeRect.right();
-                
-                if (wasBelow && isCrossing && isAligned) {
-                    qDebug() << "LEDGE BLOCKED: Player blocked from climbing ledge at" << ledgeRect;
-                    collision = true;
-                    break;
+            case WorldEvent::TRIGGER_EXITED:
+                if (event.trigger == TriggerSystem::Kind::Grass) {
+                    qDebug() << "Player exited grass area" << event.index;
                 }
-            }
+                break;
+            case WorldEvent::ENCOUNTER:
+                startBattle(event.species);
+                break;
+            case WorldEvent::BATTLE:
+                handleBattleEvent(event.battle);
+                break;
         }
-        
-        // Allow jumping down ledges
-        bool jumpingDownLedge = isPlayerJumpingDownLedge(playerPos);
+        if (game->getCurrentScene() != this) {
+            return;
+        }
+    }
+}
 
-        if (collision && !jumpingDownLedge) {
-            playerPos = prevPos;
-        } else {
-            // Update walk frame only if we actually moved
-            walkFrame = (walkFrame + 1) % 3;
-            
-            // Update player visual position
-            if (playerItem) {
-                playerItem->setPos(playerPos);
-                qDebug() << "Continuous movement: player position updated to:" << playerPos;
-            }
-            
-            // Update player sprite based on direction and walk frame
-            updatePlayerSprite();
-            
-            // Update camera to follow player
-            updateCamera();
+void GrasslandScene::syncWildPokemon(const QVector<WildSpawner::Spawn> &spawns)
+{
+    // Index the simulation's list; whatever is left over after the pass
+    // below has just spawned
+    wildSpawnIndex.clear();
+    for (int i = 0; i < spawns.size(); ++i) {
+        wildSpawnIndex.insert(spawns[i].token, i);
+    }
+
+    // Encountered Pokémon hand their sprite back to the pool for the next spawn
+    for (int i = wildPokemons.size() - 1; i >= 0; --i) {
+        WildPokemon &pokemon = wildPokemons.liveAt(i);
+        const int index = wildSpawnIndex.value(pokemon.spawnToken, -1);
+        if (index >= 0 && spawns[index].species == pokemon.type && spawns[index].position == pokemon.position) {
+            wildSpawnIndex.remove(pokemon.spawnToken);
+            continue;
+        }
+        wildSpritePool.release(pokemon.spriteItem);
+        wildPokemons.release(wildPokemons.liveHandle(i));
+    }
+
+    for (auto it = wildSpawnIndex.constBegin(); it != wildSpawnIndex.constEnd(); ++it) {
+        const WildSpawner::Spawn &spawn = spawns[it.value()];
+        if (wildPokemons.isFull()) {
+            break;
+        }
+
+        // Shared 40x40 overworld sprite for the species
+        QPixmap pokemonPixmap = SpriteCache::instance().sprite(spawn.species, SpriteCache::OVERWORLD);
+        if (pokemonPixmap.isNull()) {
+            qDebug() << "ERROR: Failed to load Pokémon sprite for" << spawn.species;
+            continue;
         }
+
+        WildPokemon pokemon;
+        pokemon.type = spawn.species;
+        pokemon.position = spawn.position;
+        pokemon.spawnToken = spawn.token;
+        QGraphicsPixmapItem* spriteItem = wildSpritePool.acquire(pokemonPixmap);
+        spriteItem->setPos(pokemon.position.x() - 20, pokemon.position.y() - 20); // Center sprite
+        spriteItem->setZValue(10); // Increased zValue to ensure visibility
+        pokemon.spriteItem = spriteItem;
+        viewportCuller.addItem(spriteItem);  // Pooled items move, so this refreshes their bounds
+
+        // Add to wild Pokémon pool
+        *wildPokemons.get(wildPokemons.acquire()) = pokemon;
     }
 }
 
+void GrasslandScene::updatePlayerFreeze()
+{
+    // The player stands still during battles, dialogues and while the bag is open
+    game->getSimulation()->setFrozen(inBattleScene || isBattleStarting || isDialogueActive || isBagOpen);
+}
+
 void GrasslandScene::updateScene()
 {
-    // Skip updates if in battle scene
-    if (inBattleScene) {
+    // Everything allocated from here on counts towards this frame
+    AllocationTracker::beginFrame();
+    if (debugOverlay) {
+        debugOverlay->showAllocationStats(cameraPos);
+    }
+
+    // Menu, dialogue and battle actions from this tick's input sample
+    game->pollInput();
+    if (game->getCurrentScene() != this) {
+        return;
+    }
+
+    // Events that used up their step budget carry on here
+    {
+        AllocationTracker::Scope allocationScope(AllocationTracker::SCRIPTS);
+        game->getScripts()->tick();
+    }
+
+    // Walking, spawns, encounters and battle turns all happened on the
+    // simulation thread; this only shows the results
+    applySimulationSnapshot();
+    if (game->getCurrentScene() != this) {
         return;
     }
     
-    // Call our frame update logic
-    update();
-    
-    // Check if player is on the town portal to return to town
-    if (isPlayerNearTownPortal()) {
-        qDebug() << "Player is on town portal, changing scene to town";
-        
-        // Clean up grassland scene
-        cleanup();
-        
-        // Change scene back to town
-        game->changeScene(GameState::TOWN);
+    // Hand the player over once they have walked down into the town
+    if (pendingArea >= 0) {
+        qDebug() << "Player left the grassland for area" << pendingArea;
+        const GameState next = Game::areaState(static_cast<MapLayout::Area>(pendingArea));
+        pendingArea = -1;
+        game->changeScene(next);
     }
 }
 
-void GrasslandScene::updatePlayerSprite()
+bool GrasslandScene::isFrameBusy() const
 {
-    QString basePath = ":/Dataset/Image/player/player_";
-    QString spritePath;
+    // Respawns and battle delays wake the loop with their snapshots
+    return game->getScripts()->needsTick() || pendingArea >= 0;
+}
 
-    // If not moving or first frame, use the base sprite for that direction
-    if (walkFrame == 0) {
-        spritePath = basePath + playerDirection + ".png";
-    } else {
-        // Use the walking animation frames (W1 or W2)
-        spritePath = basePath + playerDirection + "W" + QString::number(walkFrame) + ".png";
-    }
-    
-    QPixmap playerSprite(spritePath);
-    
-    if (playerSprite.isNull()) {
-        qDebug() << "Failed to load sprite:" << spritePath;
-        // Fallback to default sprite if animation frame not found
-        if (playerDirection == "F") {
-            playerSprite = QPixmap(":/Dataset/Image/player/player_F.png");
-        } else {
-            // If even the fallback fails, create a colored rectangle
-            playerSprite = QPixmap(35, 48);
-            playerSprite.fill(Qt::red);
-        }
-    }
-    
+void GrasslandScene::updatePlayerSprite()
+{
+    // Walk frames are decoded once and shared, so a step only swaps pixmaps
     if (playerItem) {
-        playerItem->setPixmap(playerSprite);
+        playerItem->setPixmap(SpriteCache::instance().playerFrame(playerDirection.at(0), walkFrame));
     }
 }
 
@@ -727,13 +648,14 @@ void GrasslandScene::updateCamera()
     targetCameraPos.setX(playerCenter.x() - VIEW_WIDTH / 2);
     targetCameraPos.setY(playerCenter.y() - VIEW_HEIGHT / 2);
     
-    // Calculate boundary constraints
-    float minCameraX = 0; // Left boundary
-    float maxCameraX = GRASSLAND_WIDTH - VIEW_WIDTH; // Right boundary
-    float minCameraY = 0; // Top boundary
-    float maxCameraY = GRASSLAND_HEIGHT - VIEW_HEIGHT; // Bottom boundary
+    // Calculate boundary constraints; the town below is in view too
+    const QRectF region = MapLayout::regionRect(MapLayout::AREA_GRASSLAND);
+    float minCameraX = region.left(); // Left boundary
+    float maxCameraX = region.right() - VIEW_WIDTH; // Right boundary
+    float minCameraY = region.top(); // Top boundary
+    float maxCameraY = region.bottom() - VIEW_HEIGHT; // Bottom boundary
     
-    // Apply constraints - prevent camera from going outside grassland boundaries
+    // Apply constraints - prevent camera from going outside the map
     if (targetCameraPos.x() < minCameraX) targetCameraPos.setX(minCameraX);
     if (targetCameraPos.y() < minCameraY) targetCameraPos.setY(minCameraY);
     if (targetCameraPos.x() > maxCameraX) targetCameraPos.setX(maxCameraX);
@@ -744,9 +666,8 @@ void GrasslandScene::updateCamera()
     
     // Update the view - this makes the camera follow the player
     scene->setSceneRect(cameraPos.x(), cameraPos.y(), VIEW_WIDTH, VIEW_HEIGHT);
-    
-    // Debug info
-    qDebug() << "Camera at:" << cameraPos << "Player at:" << playerPos;
+    // The wild Pokémon are culled through the streamer's viewChanged()
+    game->getWorldStreamer()->setView(QRectF(cameraPos, QSizeF(VIEW_WIDTH, VIEW_HEIGHT)));
     
     // Update dialogue box position if active
     if (isDialogueActive && dialogBoxItem) {
@@ -772,21 +693,13 @@ void GrasslandScene::updateCamera()
 bool GrasslandScene::checkCollision()
 {
     // Boundary checking
-    if (playerPos.x() < 0 || playerPos.x() > GRASSLAND_WIDTH - 35 ||
-        playerPos.y() < 0 || playerPos.y() > GRASSLAND_HEIGHT - 48) {
+    if (!MapLayout::areaRect(MapLayout::AREA_GRASSLAND).adjusted(0, 0, -35, -48).contains(playerPos)) {
         return true;
     }
 
     // Check collision with barriers - use smaller hitbox at player's feet
     QRectF playerRect(playerPos.x() + 5, playerPos.y() + 30, 25, 18);
-    
-    for (const QGraphicsRectItem* barrier : barrierItems) {
-        if (playerRect.intersects(barrier->rect())) {
-            return true;
-        }
-    }
-
-    return false;
+    return collisionWorld.overlapsSolid(playerRect);
 }
 
 void GrasslandScene::updatePlayerPosition()
@@ -814,6 +727,7 @@ void GrasslandScene::toggleBag()
         // Update the display to show the Pokémon in the bag
         updateBagDisplay();
     }
+    updatePlayerFreeze();
 }
 
 void GrasslandScene::clearBagDisplayItems()
@@ -955,7 +869,7 @@ void GrasslandScene::updateBagDisplay()
                 
                 // Add count text ("x1", "x2", etc.)
                 QFont countFont("Arial", 10, QFont::Bold);
-                QGraphicsTextItem* countText = scene->addText("x" + QString::number(count), countFont);
+                BitmapTextItem* countText = BitmapTextItem::create(scene, "x" + QString::number(count), countFont);
                 countText->setDefaultTextColor(Qt::black);
                 countText->setZValue(102);
                 // Position text closer to icon to save space
@@ -997,24 +911,19 @@ void GrasslandScene::updateBagDisplay()
     for (int i = 0; i < playerPokemon.size() && i < 4; i++) {
         Pokemon* pokemon = playerPokemon[i];
         
-        // Load the Pokémon image
-        QPixmap pokemonImage(pokemon->getImagePath());
+        // Shared icon, already scaled to fit the row height
+        QPixmap pokemonImage = SpriteCache::instance().sprite(pokemon->getName(), SpriteCache::BAG_ICON);
         if (pokemonImage.isNull()) {
             qDebug() << "Failed to load Pokémon image for" << pokemon->getName() << "at" << pokemon->getImagePath();
             continue;
         }
         
-        // Scale the image to fit the row height
-        pokemonImage = pokemonImage.scaled(ROW_HEIGHT, ROW_HEIGHT, 
-                                          Qt::KeepAspectRatio, 
-                                          Qt::SmoothTransformation);
-        
         // Calculate row position with even spacing
         float rowY = startY + i * (ROW_HEIGHT + ROW_SPACING);
         
         // Create the Pokémon name text first (on the left)
         QFont nameFont("Arial", 12, QFont::Bold);
-        QGraphicsTextItem* nameText = scene->addText(pokemon->getName(), nameFont);
+        BitmapTextItem* nameText = BitmapTextItem::create(scene, StringTable::name(pokemon->getName()), nameFont);
         nameText->setDefaultTextColor(Qt::black);
         nameText->setZValue(102); // Above both bag and row
         
@@ -1075,7 +984,7 @@ void GrasslandScene::showDialogueBox(const QString &text)
     
     // Create text with appropriate font
     QFont dialogFont("Arial", 11);
-    dialogTextItem = scene->addText(text, dialogFont);
+    dialogTextItem = BitmapTextItem::create(scene, text, dialogFont);
     dialogTextItem->setDefaultTextColor(Qt::black);
     
     // Position the text inside the dialogue box with some padding
@@ -1085,11 +994,11 @@ void GrasslandScene::showDialogueBox(const QString &text)
     dialogTextItem->setZValue(91); // Above dialogue box
     
     // Set text width to wrap long lines
-    QTextDocument* doc = dialogTextItem->document();
-    doc->setTextWidth(VIEW_WIDTH - 50); // Allow text to wrap with more room
+    dialogTextItem->setTextWidth(VIEW_WIDTH - 50); // Allow text to wrap with more room
     
     // Set dialogue as active
     isDialogueActive = true;
+    updatePlayerFreeze();
 }
 
 void GrasslandScene::showDialogue(const QString &text)
@@ -1100,10 +1009,31 @@ void GrasslandScene::showDialogue(const QString &text)
 
 void GrasslandScene::handleDialogue()
 {
-    // For now, just close the dialogue when A is pressed
+    // Scripted dialogue decides what A does next
+    ScriptEngine *scripts = game->getScripts();
+    if (scripts->isRunning()) {
+        scripts->advance();
+        return;
+    }
+    
+    closeDialogue();
+}
+
+void GrasslandScene::scriptSay(const QString &text)
+{
+    showDialogue(text);
+}
+
+void GrasslandScene::scriptEnd()
+{
     closeDialogue();
 }
 
+void GrasslandScene::scriptStartBattle(const QString &species)
+{
+    startBattle(species);
+}
+
 void GrasslandScene::closeDialogue()
 {
     // Remove dialogue box and text
@@ -1122,330 +1052,179 @@ void GrasslandScene::closeDialogue()
     // Reset dialogue state
     isDialogueActive = false;
     currentDialogueState = 0;
+    updatePlayerFreeze();
 }
 
-bool GrasslandScene::isPlayerNearTownPortal() const
+void GrasslandScene::update()
 {
-    // Get player's feet position (collision box)
-    QRectF playerFeet(playerPos.x() + 5, playerPos.y() + 30, 25, 18);
-    
-    if (!townPortalItem) {
-        qDebug() << "Town portal item is null!";
-        return false;
+    // Skip updates if dialogue or bag is open or in battle
+    if (isDialogueActive || isBagOpen || inBattleScene) {
+        return;
     }
-    
-    QRectF portalRect = townPortalItem->rect();
-    
-    // Check if player's feet area intersects with the portal
-    bool isOnPortal = playerFeet.intersects(portalRect);
-    
-    // Removed debug output to reduce console spam
-    
-    // Player must be directly on the portal to transport
-    return isOnPortal;
+
+    // Update scene state
+    updateScene();
 }
 
-bool GrasslandScene::isPlayerNearBulletinBoard() const
+void GrasslandScene::startBattle(const QString& pokemonType)
 {
-    // Get player's feet position (collision box)
-    QRectF playerFeet(playerPos.x() + 5, playerPos.y() + 30, 25, 18);
-    
-    if (!bulletinBoardItem) {
-        qDebug() << "Bulletin board item is null!";
-        return false;
-    }
-    
-    QRectF boardRect = bulletinBoardItem->rect();
-    
-    // Create an expanded detection area around the bulletin board
-    QRectF expandedArea = boardRect.adjusted(-20, -20, 20, 20);
+    qDebug() << "Starting battle with wild" << pokemonType << "- initializing battle sequence";
     
-    // Check if player's feet area intersects with the expanded detection area
-    bool isNearBoard = playerFeet.intersects(expandedArea);
+    // Reset wild Pokemon HP to full at start of battle
+    wildPokemonHp = BattleState::WILD_MAX_HP;
     
-    // Debug output
-    qDebug() << "Bulletin board at:" << boardRect
-             << "player feet at:" << playerFeet
-             << "isNearBoard:" << isNearBoard;
+    // First we need to disable movement
+    game->getSimulation()->releaseAllKeys();
     
-    return isNearBoard;
-}
+    // Store the Pokémon type
+    currentBattlePokemonType = pokemonType;
 
-bool GrasslandScene::isPlayerJumpingDownLedge(const QPointF& newPos) const
-{
-    // Get player's current position and the new position after movement
-    QRectF currentPlayerRect(playerPos.x() + 5, playerPos.y() + 30, 25, 18); // Current feet position
-    QRectF newPlayerRect(newPos.x() + 5, newPos.y() + 30, 25, 18); // New feet position
+    // Get player's Pokémon
+    const QVector<Pokemon*>& playerPokemon = game->getPokemon();
+    qDebug() << "Player has" << playerPokemon.size() << "Pokemon available for battle";
     
-    // Only check for ledge jumping if moving downward
-    if (newPos.y() <= playerPos.y()) {
-        return false; // Not moving down, so not jumping a ledge
+    if (playerPokemon.isEmpty()) {
+        // If player has no Pokémon, show warning and return to game
+        qDebug() << "No Pokemon available - showing warning and returning";
+        game->getScripts()->start("grassland_no_pokemon", this);
+        return;
     }
-    
-    // Check each ledge
-    for (const QGraphicsRectItem* ledge : ledgeItems) {
-        QRectF ledgeRect = ledge->rect();
-        
-        // Check if:
-        // 1. Current position is above or on the ledge
-        // 2. New position is below the ledge
-        // 3. Player is horizontally within the ledge width
-        
-        bool currentlyAboveLedge = currentPlayerRect.bottom() <= ledgeRect.top() + 2; // +2 for a bit of tolerance
-        bool movingBelowLedge = newPlayerRect.top() > ledgeRect.bottom();
-        bool horizontallyAligned = (newPlayerRect.left() <= ledgeRect.right() && 
-                                   newPlayerRect.right() >= ledgeRect.left());
-        
-        if (currentlyAboveLedge && horizontallyAligned && movingBelowLedge) {
-            // Allow jumping down
-            qDebug() << "Player jumping down ledge at" << ledgeRect;
-            return true;
-        }
+
+    // Reset battle state flags
+    inBattleScene = false;
+    isMoveSelectionActive = false;
+    isBattleBagOpen = false;
+    selectedBattleOption = FIGHT;
+
+    // Build the selection dialogue text
+    QString &dialogText = textBuffer;
+    StringTable::format(dialogText, STR_WILD_APPEARED, {StringTable::name(pokemonType)});
+    dialogText += "\n\n";
+    StringTable::append(dialogText, STR_CHOOSE_POKEMON);
+    dialogText += '\n';
+    for (int i = 0; i < playerPokemon.size(); i++) {
+        Pokemon* pokemon = playerPokemon[i];
+        StringTable::append(dialogText, STR_PARTY_OPTION, {i + 1, StringTable::name(pokemon->getName()),
+                                                           pokemon->getCurrentHp(), pokemon->getMaxHp()});
+        dialogText += '\n';
     }
-    
-    return false;
+    dialogText += '\n';
+    StringTable::append(dialogText, STR_RUN_AWAY_HINT);
+
+    qDebug() << "Showing Pokemon selection dialogue with options";
+    // Show the selection dialogue
+    isBattleStarting = true;
+    showPokemonSelectionDialogue(dialogText);
+
+    // The battle plays out in the simulation on copies of the party and
+    // the bag; its events bring the results back
+    BattleState::Setup setup;
+    setup.wildSpecies = pokemonType;
+    setup.party.reserve(playerPokemon.size());
+    for (const Pokemon* pokemon : playerPokemon) {
+        setup.party.append(*pokemon);
+    }
+    setup.items = game->getItems();
+    game->getSimulation()->startBattle(setup);
 }
 
-void GrasslandScene::update()
+void GrasslandScene::handleBattleEvent(const BattleState::Event &event)
 {
-    // Skip updates if dialogue or bag is open or in battle
-    if (isDialogueActive || isBagOpen || inBattleScene) {
-        return;
-    }
-    
-    // If player steps into a tall grass area
-    int areaIndex;
-    bool inGrass = isPlayerInGrassArea(&areaIndex);
-    
-    // Handle entering/exiting grass areas
-    if (inGrass) {
-        if (currentGrassArea != areaIndex) {
-            // Player entered a new grass area
-            qDebug() << "Player moved from grass area" << currentGrassArea << "to" << areaIndex;
-            currentGrassArea = areaIndex;
-            
-            // Check if there's an active Pokémon in this area
-            bool hasPokemonInArea = false;
-            for (const WildPokemon& pokemon : wildPokemons) {
-                if (!pokemon.encountered && pokemon.spriteItem) {
-                    QRectF grassRect = tallGrassItems[areaIndex]->rect();
-                    if (grassRect.contains(pokemon.position)) {
-                        hasPokemonInArea = true;
-                        break;
-                    }
-                }
-            }
-            
-            // If no active Pokémon in this area, spawn one
-            if (!hasPokemonInArea) {
-                qDebug() << "No active Pokémon in grass area" << areaIndex << "- spawning new wild Pokémon";
-                spawnWildPokemon(areaIndex);
-                grassAreaVisited[areaIndex] = true;
-            }
-        }
-        
-        // Check for collisions with wild Pokémon
-        checkWildPokemonCollision();
-    } else if (currentGrassArea != -1) {
-        // Player exited a grass area
-        qDebug() << "Player exited grass area" << currentGrassArea;
-        currentGrassArea = -1;
-    }
-}
+    const QVector<Pokemon*>& playerPokemon = game->getPokemon();
 
-bool GrasslandScene::isPlayerInGrassArea(int* areaIndex)
-{
-    // Get player's feet position (collision box)
-    QRectF playerFeet(playerPos.x() + 5, playerPos.y() + 30, 25, 18);
-    
-    // Check if player is in any tall grass area
-    for (int i = 0; i < tallGrassItems.size(); ++i) {
-        QRectF grassRect = tallGrassItems[i]->rect();
-        if (playerFeet.intersects(grassRect)) {
-            if (areaIndex) {
-                *areaIndex = i;
+    switch (event.type) {
+        case BattleState::Event::PARTY_CHOSEN:
+            // Move selected Pokémon to front
+            game->movePokemonToFront(event.value);
+            closeDialogue();
+            break;
+
+        case BattleState::Event::OPENED:
+            isBattleStarting = false;
+            inBattleScene = true;
+            selectedBattleOption = FIGHT;
+            showBattleScene();
+            break;
+
+        case BattleState::Event::MESSAGE: {
+            QPointF pos;
+            switch (event.slot) {
+                case BattleState::PLAYER_SIDE: pos = QPointF(50, 150); break;               // Above player's Pokémon
+                case BattleState::WILD_SIDE:   pos = QPointF(290, 20); break;               // Above the wild Pokémon
+                case BattleState::WILD_MOVE:   pos = QPointF(282, 20); break;               // Middle of the view
+                case BattleState::WILD_DAMAGE: pos = QPointF(282, 40); break;               // Below the move text
+                default:                       pos = QPointF(25, VIEW_HEIGHT - 90); break;  // Over the menu
             }
-            qDebug() << "Player entered grass area" << i << "at position" << playerPos;
-            return true;
+            battleMessageTickets.insert(event.id, battleMessages.show(event.text, cameraPos + pos));
+            break;
         }
-    }
-    
-    return false;
-}
 
-void GrasslandScene::spawnWildPokemon(int grassAreaIndex)
-{
-    if (grassAreaIndex < 0 || grassAreaIndex >= tallGrassItems.size()) {
-        return;
-    }
-    
-    QRectF grassRect = tallGrassItems[grassAreaIndex]->rect();
-    
-    // Choose a random Pokémon type
-    QStringList pokemonTypes = {"Bulbasaur", "Charmander", "Squirtle"};
-    QString type = pokemonTypes[QRandomGenerator::global()->bounded(pokemonTypes.size())];
-    
-    // Get player's position to ensure the Pokémon isn't spawned too close
-    QPointF playerCenter(playerPos.x() + 15, playerPos.y() + 20);
-    
-    // Try to spawn the Pokémon at least 50 pixels away from the player
-    const int MIN_DISTANCE = 50;
-    int randomX, randomY;
-    QPointF pokemonPos;
-    int attempts = 0;
-    const int MAX_ATTEMPTS = 10;
-    qreal dx = 0, dy = 0; // Move declarations outside the loop for later use
-    qreal distanceSquared = 0;
-    
-    do {
-        // Choose a random position within the grass area
-        randomX = QRandomGenerator::global()->bounded(
-            static_cast<int>(grassRect.left() + 30), 
-            static_cast<int>(grassRect.right() - 30)
-        );
-        randomY = QRandomGenerator::global()->bounded(
-            static_cast<int>(grassRect.top() + 30), 
-            static_cast<int>(grassRect.bottom() - 30)
-        );
-        
-        pokemonPos = QPointF(randomX, randomY);
-        
-        // Calculate distance from player
-        dx = playerCenter.x() - pokemonPos.x();
-        dy = playerCenter.y() - pokemonPos.y();
-        distanceSquared = dx * dx + dy * dy;
-        
-        attempts++;
-        
-        // Accept if distance is good or we've tried too many times
-        if (distanceSquared >= MIN_DISTANCE * MIN_DISTANCE || attempts >= MAX_ATTEMPTS) {
+        case BattleState::Event::HIDE_MESSAGE:
+            battleMessages.hide(battleMessageTickets.value(event.value, 0));
+            battleMessageTickets.remove(event.value);
             break;
-        }
-    } while (true);
-    
-    // Create the wild Pokémon data
-    WildPokemon pokemon;
-    pokemon.type = type;
-    pokemon.position = pokemonPos;
-    pokemon.encountered = false;
-    
-    // Choose sprite based on type - using the correct battle image paths
-    QString spriteFile;
-    if (type == "Bulbasaur") {
-        spriteFile = ":/Dataset/Image/battle/bulbasaur.png";
-    } else if (type == "Charmander") {
-        spriteFile = ":/Dataset/Image/battle/charmander.png";
-    } else { // Squirtle
-        spriteFile = ":/Dataset/Image/battle/squirtle.png";
-    }
-    
-    // Load and create sprite item
-    QPixmap pokemonPixmap(spriteFile);
-    if (!pokemonPixmap.isNull()) {
-        // Exactly 40x40 pixels as requested
-        pokemonPixmap = pokemonPixmap.scaled(40, 40, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-        QGraphicsPixmapItem* spriteItem = scene->addPixmap(pokemonPixmap);
-        spriteItem->setPos(pokemon.position.x() - 20, pokemon.position.y() - 20); // Center sprite
-        spriteItem->setZValue(10); // Increased zValue to ensure visibility
-        spriteItem->setVisible(true); // Explicitly make always visible
-        pokemon.spriteItem = spriteItem;
-        
-        qDebug() << "SUCCESS: Spawned wild" << type << "in grass area" << grassAreaIndex 
-             << "at position" << randomX << "," << randomY << "with sprite from" << spriteFile
-             << "(distance from player:" << sqrt(dx*dx + dy*dy) << ")";
-    } else {
-        qDebug() << "ERROR: Failed to load Pokémon sprite from" << spriteFile;
-        pokemon.spriteItem = nullptr;
-    }
-    
-    // Add to wild Pokémon list
-    wildPokemons.append(pokemon);
-}
 
-void GrasslandScene::checkWildPokemonCollision()
-{
-    // Get player's collision box
-    QRectF playerBox(playerPos.x() + 5, playerPos.y() + 10, 25, 35);
-    
-    for (WildPokemon& pokemon : wildPokemons) {
-        // Skip already encountered Pokémon
-        if (pokemon.encountered || !pokemon.spriteItem) {
-            continue;
-        }
-        
-        // Create Pokémon collision box
-        QRectF pokemonBox(
-            pokemon.position.x() - 20,
-            pokemon.position.y() - 20,
-            40, 40
-        );
-        
-        // Check for collision
-        if (playerBox.intersects(pokemonBox)) {
-            // Mark as encountered to prevent multiple encounters
-            pokemon.encountered = true;
-            
-            // Hide the sprite
-            pokemon.spriteItem->setVisible(false);
-            
-            // Start battle with this Pokémon
-            startBattle(pokemon.type);
+        case BattleState::Event::REFRESH:
+            // Item results and turns end with the menu back on screen
+            isBattleBagOpen = false;
+            showBattleScene();
             break;
-        }
-    }
-}
 
-void GrasslandScene::startBattle(const QString& pokemonType)
-{
-    qDebug() << "Starting battle with wild" << pokemonType << "- initializing battle sequence";
-    
-    // Reset wild Pokemon HP to full at start of battle
-    wildPokemonHp = 30;
-    
-    // First we need to disable movement
-    currentPressedKey = 0;
-    pressedKeys.clear();
-    
-    // Stop movement timer
-    if (movementTimer && movementTimer->isActive()) {
-        movementTimer->stop();
-    }
-    
-    // Store the Pokémon type
-    currentBattlePokemonType = pokemonType;
+        case BattleState::Event::NEXT_TURN:
+            // Return to battle menu
+            isBattleBagOpen = false;
+            selectedBattleOption = FIGHT;
+            showBattleScene();
+            break;
 
-    // Get player's Pokémon
-    const QVector<Pokemon*>& playerPokemon = game->getPokemon();
-    qDebug() << "Player has" << playerPokemon.size() << "Pokemon available for battle";
-    
-    if (playerPokemon.isEmpty()) {
-        // If player has no Pokémon, show warning and return to game
-        qDebug() << "No Pokemon available - showing warning and returning";
-        showDialogue("You have no Pokémon to battle with! Run away!");
-        return;
-    }
+        case BattleState::Event::WILD_HP:
+            wildPokemonHp = event.value;
+            break;
 
-    // Reset battle state flags
-    inBattleScene = false;
-    isMoveSelectionActive = false;
-    isBattleBagOpen = false;
-    selectedBattleOption = FIGHT;
+        case BattleState::Event::POKEMON_CHANGED:
+            if (!playerPokemon.isEmpty()) {
+                Pokemon* activePokemon = playerPokemon.first();
+                activePokemon->setCurrentHp(event.value);
+                activePokemon->setLevel(event.level);
+                for (int i = 0; i < event.pp.size(); ++i) {
+                    activePokemon->setMovePp(i, event.pp[i]);
+                }
+                game->notifyPokemonChanged(activePokemon);
+            }
+            break;
 
-    // Build the selection dialogue text
-    QString dialogText = "A wild " + pokemonType + " appeared!\n\nChoose your Pokémon:\n";
-    for (int i = 0; i < playerPokemon.size(); i++) {
-        Pokemon* pokemon = playerPokemon[i];
-        dialogText += QString("Press %1: %2 (HP: %3/%4)\n")
-            .arg(i + 1)
-            .arg(pokemon->getName())
-            .arg(pokemon->getCurrentHp())
-            .arg(pokemon->getMaxHp());
-    }
-    dialogText += "\nPress ESC to run away";
+        case BattleState::Event::ITEM_USED: {
+            // Get items as a copy since we can't modify the original directly
+            QMap<QString, int> inventory = game->getItems();
+            inventory[event.text]--;
+            if (inventory[event.text] <= 0) {
+                inventory.remove(event.text);
+            }
+            game->setItems(inventory);
+            break;
+        }
 
-    qDebug() << "Showing Pokemon selection dialogue with options";
-    // Show the selection dialogue
-    showPokemonSelectionDialogue(dialogText);
+        case BattleState::Event::CAUGHT: {
+            Pokemon::Type pokemonType;
+            if (!Pokemon::typeFromName(event.text, pokemonType)) {
+                qDebug() << "ERROR: Caught unknown species" << event.text;
+                break;
+            }
+            Pokemon* newPokemon = new Pokemon(pokemonType);
+            newPokemon->setCurrentHp(event.value); // Keep the current HP
+            game->addPokemon(newPokemon);
+            break;
+        }
+
+        case BattleState::Event::ENDED:
+            // Ran from the party selection, or the battle is over
+            if (isBattleStarting) {
+                isBattleStarting = false;
+                closeDialogue();
+            }
+            exitBattleScene();
+            break;
+    }
 }
 
 void GrasslandScene::showPokemonSelectionDialogue(const QString& text)
@@ -1480,7 +1259,7 @@ void GrasslandScene::showPokemonSelectionDialogue(const QString& text)
     
     // Create text with appropriate font
     QFont dialogFont("Arial", 11);
-    dialogTextItem = scene->addText(text, dialogFont);
+    dialogTextItem = BitmapTextItem::create(scene, text, dialogFont);
     dialogTextItem->setDefaultTextColor(Qt::black);
     
     // Position the text inside the dialogue box with some padding
@@ -1490,12 +1269,11 @@ void GrasslandScene::showPokemonSelectionDialogue(const QString& text)
     dialogTextItem->setZValue(91);
     
     // Set text width to wrap long lines
-    QTextDocument* doc = dialogTextItem->document();
-    doc->setTextWidth(VIEW_WIDTH - 50);
+    dialogTextItem->setTextWidth(VIEW_WIDTH - 50);
     
-    // Set dialogue as active and mark it as a Pokémon selection dialogue
+    // The selection itself is answered through the simulation's battle
     isDialogueActive = true;
-    isPokemonSelectionDialogue = true;
+    updatePlayerFreeze();
 }
 
 void GrasslandScene::showBattleScene()
@@ -1505,264 +1283,202 @@ void GrasslandScene::showBattleScene()
     // Set battle state flag
     inBattleScene = true;
     
-    // Clear any existing battle menu items
-    for (auto rect : battleMenuRects) {
-        if (rect) {
-            scene->removeItem(rect);
-            delete rect;
+    showBattleView(true);
+    battleMessages.hideAll();
+
+    // Player's Pokémon: back view on the left with its HP bar and stats
+    const QVector<Pokemon*>& party = game->getPokemon();
+    QPixmap playerPokemonImage;
+    if (!party.isEmpty()) {
+        playerPokemonImage = SpriteCache::instance().sprite(party.first()->getName(), SpriteCache::BACK);
+    }
+    battlePlayerSprite->setVisible(!playerPokemonImage.isNull());
+    battlePlayerHpBar->setVisible(!playerPokemonImage.isNull());
+    if (!playerPokemonImage.isNull()) {
+        Pokemon* playerPokemon = party.first();
+        if (battlePlayerSprite->pixmap().cacheKey() != playerPokemonImage.cacheKey()) {
+            battlePlayerSprite->setPixmap(playerPokemonImage);
         }
+
+        int currentHp = playerPokemon->getCurrentHp();
+        int maxHp = playerPokemon->getMaxHp();
+        float hpPercentage = static_cast<float>(currentHp) / maxHp;
+        battlePlayerHpFill->setRect(0, 0, 100 * hpPercentage, 10);
+        battlePlayerHpFill->setBrush(hpPercentage > 0.5 ? Qt::green : (hpPercentage > 0.2 ? Qt::yellow : Qt::red));
+        battlePlayerStats->setPlainText(StringTable::format(textBuffer, STR_PLAYER_STATS,
+                                                            {StringTable::name(playerPokemon->getName()), playerPokemon->getLevel(), currentHp, maxHp}));
     }
-    battleMenuRects.clear();
     
-    for (auto text : battleMenuTexts) {
-        if (text) {
-            scene->removeItem(text);
-            delete text;
+    // Wild Pokémon: front view on the right with its HP bar and stats
+    QPixmap pokemonImage = SpriteCache::instance().sprite(currentBattlePokemonType, SpriteCache::FRONT);
+    battleWildSprite->setVisible(!pokemonImage.isNull());
+    battleWildHpBar->setVisible(!pokemonImage.isNull());
+    if (!pokemonImage.isNull()) {
+        if (battleWildSprite->pixmap().cacheKey() != pokemonImage.cacheKey()) {
+            battleWildSprite->setPixmap(pokemonImage);
         }
-    }
-    battleMenuTexts.clear();
 
-    // Load battle scene background
-    QPixmap battleBackground(":/Dataset/Image/battle/battle_scene.png");
-    if (battleBackground.isNull()) {
-        qDebug() << "Failed to load battle scene image! Creating fallback background";
-        battleBackground = QPixmap(525, 450);
-        battleBackground.fill(QColor(100, 100, 200));
-    } else {
-        qDebug() << "Successfully loaded battle scene background";
-    }
-    
-    // Create a white background rectangle first
-    QGraphicsRectItem* whiteBackground = scene->addRect(0, 0, VIEW_WIDTH, VIEW_HEIGHT,
-        QPen(Qt::transparent), QBrush(Qt::white));
-    whiteBackground->setPos(cameraPos);
-    whiteBackground->setZValue(199);  // Just below battle background
-    battleMenuRects.append(whiteBackground);
-    
-    // Make sure the scene has the battle background
-    if (!battleSceneItem) {
-        battleSceneItem = scene->addPixmap(battleBackground);
-    } else {
-        battleSceneItem->setPixmap(battleBackground);
+        float wildHpPercentage = static_cast<float>(wildPokemonHp) / 30;
+        battleWildHpFill->setRect(0, 0, 100 * wildHpPercentage, 10);
+        battleWildHpFill->setBrush(wildHpPercentage > 0.5 ? Qt::green : (wildHpPercentage > 0.2 ? Qt::yellow : Qt::red));
+        battleWildStats->setPlainText(StringTable::format(textBuffer, STR_WILD_STATS,
+                                                          {StringTable::name(currentBattlePokemonType), wildPokemonHp}));
     }
-    battleSceneItem->setZValue(200);
-    battleSceneItem->setVisible(true);
-    
-    // Position battle scene relative to camera view
-    battleSceneItem->setPos(cameraPos);
-    qDebug() << "Battle scene positioned at" << cameraPos;
 
-    // Add player's Pokémon back view on the left and show its stats
-    if (!game->getPokemon().isEmpty()) {
-        Pokemon* playerPokemon = game->getPokemon().first();
-        QString playerPokemonName = playerPokemon->getName();
-        QString backImagePath = QString(":/Dataset/Image/battle/%1_back.png").arg(playerPokemonName.toLower());
-        QPixmap playerPokemonImage(backImagePath);
-        
-        if (!playerPokemonImage.isNull()) {
-            playerPokemonImage = playerPokemonImage.scaled(120, 120, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-            QGraphicsPixmapItem* playerPokemonItem = scene->addPixmap(playerPokemonImage);
-            playerPokemonItem->setPos(cameraPos.x() + 50, cameraPos.y() + 200);
-            playerPokemonItem->setZValue(201);
-            bagPokemonSprites.append(playerPokemonItem);
-
-            // Add player Pokémon stats (name, level, HP)
-            float hpBarY = cameraPos.y() + 180;
-            
-            // Add HP bar for player's Pokemon
-            int currentHp = playerPokemon->getCurrentHp();
-            int maxHp = playerPokemon->getMaxHp();
-            float hpPercentage = static_cast<float>(currentHp) / maxHp;
-            
-            QGraphicsRectItem* hpBarBg = scene->addRect(0, 0, 100, 10, QPen(Qt::black), QBrush(Qt::lightGray));
-            QGraphicsRectItem* hpBarFg = scene->addRect(0, 0, 100 * hpPercentage, 10, QPen(Qt::transparent), 
-                QBrush(hpPercentage > 0.5 ? Qt::green : (hpPercentage > 0.2 ? Qt::yellow : Qt::red)));
-            
-            hpBarBg->setPos(cameraPos.x() + 50, hpBarY);
-            hpBarFg->setPos(cameraPos.x() + 50, hpBarY);
-            hpBarBg->setZValue(202);
-            hpBarFg->setZValue(203);
-            battleMenuRects.append(hpBarBg);
-            battleMenuRects.append(hpBarFg);
-
-            // Add stats text
-            QString statsText = QString("%1  Lv%2\nHP: %3/%4")
-                .arg(playerPokemonName)
-                .arg(playerPokemon->getLevel())
-                .arg(currentHp)
-                .arg(maxHp);
-            
-            QGraphicsTextItem* statsTextItem = scene->addText(statsText, QFont("Arial", 12, QFont::Bold));
-            statsTextItem->setDefaultTextColor(Qt::black);
-            statsTextItem->setPos(cameraPos.x() + 50, hpBarY - 40);
-            statsTextItem->setZValue(202);
-            battleMenuTexts.append(statsTextItem);
+    QString pokemonName = party.isEmpty() ? StringTable::get(STR_EMPTY_PARTY_NAME)
+                                          : StringTable::name(party.first()->getName());
+    battlePromptText->setPlainText(StringTable::format(textBuffer, STR_WHAT_WILL_DO, {pokemonName}));
+    updateBattleMenuSelection();
+}
+
+void GrasslandScene::createBattleItems()
+{
+    // Load battle scene background once; every battle reuses it
+    if (battleBackground.isNull()) {
+        battleBackground = QPixmap(":/Dataset/Image/battle/battle_scene.png");
+        if (battleBackground.isNull()) {
+            qDebug() << "Failed to load battle scene image! Creating fallback background";
+            battleBackground = QPixmap(525, 450);
+            battleBackground.fill(QColor(100, 100, 200));
         }
     }
-    
-    // Add wild Pokémon image on the right and show its stats
-    QString pokemonImagePath;
-    if (currentBattlePokemonType == "Bulbasaur") {
-        pokemonImagePath = ":/Dataset/Image/battle/bulbasaur.png";
-    } else if (currentBattlePokemonType == "Charmander") {
-        pokemonImagePath = ":/Dataset/Image/battle/charmander.png";
-    } else { // Squirtle
-        pokemonImagePath = ":/Dataset/Image/battle/squirtle.png";
-    }
-    
-    QPixmap pokemonImage(pokemonImagePath);
-    if (!pokemonImage.isNull()) {
-        pokemonImage = pokemonImage.scaled(120, 120, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-        QGraphicsPixmapItem* pokemonItem = scene->addPixmap(pokemonImage);
-        pokemonItem->setPos(cameraPos.x() + 350, cameraPos.y() + 150);
-        pokemonItem->setZValue(201);
-        bagPokemonSprites.append(pokemonItem);
-
-        // Add wild Pokémon stats
-        float wildHpBarY = cameraPos.y() + 130;
-        
-        // Add HP bar for wild Pokemon
-        float wildHpPercentage = static_cast<float>(wildPokemonHp) / 30;
-        QGraphicsRectItem* wildHpBarBg = scene->addRect(0, 0, 100, 10, QPen(Qt::black), QBrush(Qt::lightGray));
-        QGraphicsRectItem* wildHpBarFg = scene->addRect(0, 0, 100 * wildHpPercentage, 10, QPen(Qt::transparent), 
-            QBrush(wildHpPercentage > 0.5 ? Qt::green : (wildHpPercentage > 0.2 ? Qt::yellow : Qt::red)));
-        
-        wildHpBarBg->setPos(cameraPos.x() + 350, wildHpBarY);
-        wildHpBarFg->setPos(cameraPos.x() + 350, wildHpBarY);
-        wildHpBarBg->setZValue(202);
-        wildHpBarFg->setZValue(203);
-        battleMenuRects.append(wildHpBarBg);
-        battleMenuRects.append(wildHpBarFg);
-
-        // Add wild Pokemon stats text
-        QString wildStatsText = QString("Wild %1  Lv1\nHP: %2/30")
-            .arg(currentBattlePokemonType)
-            .arg(wildPokemonHp);
-        
-        QGraphicsTextItem* wildStatsTextItem = scene->addText(wildStatsText, QFont("Arial", 12, QFont::Bold));
-        wildStatsTextItem->setDefaultTextColor(Qt::black);
-        wildStatsTextItem->setPos(cameraPos.x() + 350, wildHpBarY - 40);
-        wildStatsTextItem->setZValue(202);
-        battleMenuTexts.append(wildStatsTextItem);
-    }
-
-    // Create battle menu at the bottom with a semi-transparent background
-    QGraphicsRectItem* menuBackground = scene->addRect(
-        cameraPos.x(), cameraPos.y() + VIEW_HEIGHT - 130,
-        VIEW_WIDTH, 130,
-        QPen(Qt::transparent),
-        QBrush(QColor(255, 255, 255, 200))
-    );
-    menuBackground->setZValue(201);
-    battleMenuRects.append(menuBackground);
-
-    QString pokemonName = game->getPokemon().isEmpty() ? "POKEMON" : game->getPokemon().first()->getName().toUpper();
-    QString promptText = QString("What will\n%1 do?").arg(pokemonName);
-    
-    QGraphicsTextItem* promptTextItem = scene->addText(promptText, QFont("Arial", 12, QFont::Bold));
-    promptTextItem->setDefaultTextColor(Qt::black);
-    promptTextItem->setPos(cameraPos.x() + 25, cameraPos.y() + VIEW_HEIGHT - 120);
-    promptTextItem->setZValue(202);
-    battleMenuTexts.append(promptTextItem);
-    
-    // Create the 4 menu options
-    QStringList menuOptions = {"FIGHT", "BAG", "POKéMON", "RUN"};
-    float startX = cameraPos.x() + VIEW_WIDTH / 2;
-    float startY = cameraPos.y() + VIEW_HEIGHT - 120;
+
+    // White backdrop under the background; everything else is its child,
+    // so positions below are relative to the top-left of the view
+    battleRoot = scene->addRect(0, 0, VIEW_WIDTH, VIEW_HEIGHT, QPen(Qt::transparent), QBrush(Qt::white));
+    battleRoot->setZValue(199);
+    battleRoot->setVisible(false);
+
+    battleSceneItem = new QGraphicsPixmapItem(battleBackground, battleRoot);
+
+    battlePlayerSprite = new QGraphicsPixmapItem(battleRoot);
+    battlePlayerSprite->setPos(50, 200);
+    battlePlayerSprite->setZValue(1);
+
+    battleWildSprite = new QGraphicsPixmapItem(battleRoot);
+    battleWildSprite->setPos(350, 150);
+    battleWildSprite->setZValue(1);
+
+    // HP bars, with the stats line 40px above each
+    QGraphicsRectItem** hpBars[2] = {&battlePlayerHpBar, &battleWildHpBar};
+    QGraphicsRectItem** hpFills[2] = {&battlePlayerHpFill, &battleWildHpFill};
+    BitmapTextItem** stats[2] = {&battlePlayerStats, &battleWildStats};
+    const QPointF hpBarPos[2] = {QPointF(50, 180), QPointF(350, 130)};
+    for (int i = 0; i < 2; i++) {
+        QGraphicsRectItem* bar = new QGraphicsRectItem(0, 0, 100, 10, battleRoot);
+        bar->setPen(QPen(Qt::black));
+        bar->setBrush(Qt::lightGray);
+        bar->setPos(hpBarPos[i]);
+        bar->setZValue(2);
+
+        QGraphicsRectItem* fill = new QGraphicsRectItem(0, 0, 100, 10, bar);
+        fill->setPen(QPen(Qt::transparent));
+
+        BitmapTextItem* text = new BitmapTextItem(QString(), BattleMessagePool::font(), bar);
+        text->setDefaultTextColor(Qt::black);
+        text->setPos(0, -40);
+
+        *hpBars[i] = bar;
+        *hpFills[i] = fill;
+        *stats[i] = text;
+    }
+
+    // Menu at the bottom with a semi-transparent background
+    battleMenuItem = new QGraphicsRectItem(0, VIEW_HEIGHT - 130, VIEW_WIDTH, 130, battleRoot);
+    battleMenuItem->setPen(QPen(Qt::transparent));
+    battleMenuItem->setBrush(QColor(255, 255, 255, 200));
+    battleMenuItem->setZValue(1);
+
+    battlePromptText = new BitmapTextItem(QString(), BattleMessagePool::font(), battleMenuItem);
+    battlePromptText->setDefaultTextColor(Qt::black);
+    battlePromptText->setPos(25, VIEW_HEIGHT - 120);
+
+    // The 4 menu options
+    const StringId menuOptions[4] = {STR_MENU_FIGHT, STR_MENU_BAG, STR_MENU_POKEMON, STR_MENU_RUN};
+    float startX = VIEW_WIDTH / 2;
+    float startY = VIEW_HEIGHT - 120;
     float optionWidth = (VIEW_WIDTH / 2) / 2;
     float optionHeight = 50;
     
     for (int i = 0; i < 4; i++) {
-        int row = i / 2;
-        int col = i % 2;
+        float x = startX + (i % 2) * optionWidth;
+        float y = startY + (i / 2) * optionHeight;
         
-        float x = startX + col * optionWidth;
-        float y = startY + row * optionHeight;
+        QGraphicsRectItem* optionRect = new QGraphicsRectItem(x, y, optionWidth, optionHeight, battleMenuItem);
+        optionRect->setPen(QPen(Qt::black));
+        optionRect->setBrush(optionBrush);
+        battleOptionRects[i] = optionRect;
         
-        // Create a background rectangle for the option
-        QGraphicsRectItem* optionRect = scene->addRect(
-            x, y, optionWidth, optionHeight,
-            QPen(Qt::black),
-            QBrush(static_cast<BattleOption>(i) == selectedBattleOption ? 
-                   QColor(200, 200, 200, 100) : QColor(255, 255, 255, 100))
-        );
-        optionRect->setZValue(202);
-        battleMenuRects.append(optionRect);
-        
-        // Add the text
-        QGraphicsTextItem* optionText = scene->addText(menuOptions[i], QFont("Arial", 12, QFont::Bold));
+        BitmapTextItem* optionText = new BitmapTextItem(StringTable::get(menuOptions[i]), BattleMessagePool::font(), battleMenuItem);
         optionText->setDefaultTextColor(Qt::black);
         optionText->setPos(x + 20, y + 10);
-        optionText->setZValue(203);
-        battleMenuTexts.append(optionText);
-        
-        // Add selection marker for current option
-        if (static_cast<BattleOption>(i) == selectedBattleOption) {
-            QPolygonF triangle;
-            triangle << QPointF(0, 0) << QPointF(10, 5) << QPointF(0, 10);
-            
-            QGraphicsPolygonItem* marker = scene->addPolygon(triangle, QPen(Qt::black), QBrush(Qt::black));
-            marker->setPos(x + 5, y + 15);
-            marker->setZValue(204);
-            battleMenuRects.append(marker);
-        }
+        optionText->setZValue(1);
     }
-    
-    // Update the view to ensure everything is visible
-    scene->update();
-    qDebug() << "Battle scene shown with menu options";
+
+    QPolygonF triangle;
+    triangle << QPointF(0, 0) << QPointF(10, 5) << QPointF(0, 10);
+    battleMarker = new QGraphicsPolygonItem(triangle, battleMenuItem);
+    battleMarker->setPen(QPen(Qt::black));
+    battleMarker->setBrush(Qt::black);
+    battleMarker->setZValue(2);
+
+    // Move and item lists take the menu's place
+    battleListText = new BitmapTextItem(QString(), QFont("Arial", 12), battleRoot);
+    battleListText->setDefaultTextColor(Qt::black);
+    battleListText->setPos(25, VIEW_HEIGHT - 120);
+    battleListText->setZValue(2);
 }
 
-void GrasslandScene::exitBattleScene()
+void GrasslandScene::showBattleView(bool menu)
 {
-    qDebug() << "Exiting battle scene";
-    
-    // Clean up battle scene items
-    if (battleSceneItem) {
-        battleSceneItem->setVisible(false);
+    if (!battleRoot) {
+        createBattleItems();
     }
-    
-    // Clean up menu items
-    for (auto rect : battleMenuRects) {
-        if (rect) {
-            scene->removeItem(rect);
-            delete rect;
+
+    // The camera stays put while the battle lasts
+    battleRoot->setPos(cameraPos);
+    battleRoot->setVisible(true);
+
+    // The move and item lists showed over the bare background and sprites
+    battleRoot->setBrush(menu ? QBrush(Qt::white) : QBrush(Qt::NoBrush));
+    battlePlayerHpBar->setVisible(menu && battlePlayerSprite->isVisible());
+    battleWildHpBar->setVisible(menu && battleWildSprite->isVisible());
+    battleMenuItem->setVisible(menu);
+    battleListText->setVisible(!menu);
+}
+
+void GrasslandScene::updateBattleMenuSelection()
+{
+    if (!battleMenuItem || !battleMenuItem->isVisible()) {
+        showBattleScene();  // The menu isn't on screen yet
+        return;
+    }
+
+    for (int i = 0; i < 4; i++) {
+        const bool selected = static_cast<BattleOption>(i) == selectedBattleOption;
+        battleOptionRects[i]->setBrush(selected ? selectedOptionBrush : optionBrush);
+        if (selected) {
+            battleMarker->setPos(battleOptionRects[i]->rect().topLeft() + QPointF(5, 15));
         }
     }
-    battleMenuRects.clear();
+}
+
+void GrasslandScene::exitBattleScene()
+{
+    qDebug() << "Exiting battle scene";
     
-    for (auto text : battleMenuTexts) {
-        if (text) {
-            scene->removeItem(text);
-            delete text;
-        }
+    // Hide the battle screen; the next battle shows it again
+    if (battleRoot) {
+        battleRoot->setVisible(false);
     }
-    battleMenuTexts.clear();
+    battleMessages.hideAll();
+    battleMessageTickets.clear();
     
     // Reset battle state
     inBattleScene = false;
-    
-    // Clean up wild Pokémon in battle
-    for (auto sprite : bagPokemonSprites) {
-        if (sprite) {
-            scene->removeItem(sprite);
-            delete sprite;
-        }
-    }
-    bagPokemonSprites.clear();
-    
-    for (auto text : bagPokemonNames) {
-        if (text) {
-            scene->removeItem(text);
-            delete text;
-        }
-    }
-    bagPokemonNames.clear();
-    
-    // Resume player movement
-    if (movementTimer && !movementTimer->isActive()) {
-        movementTimer->start(60);
-    }
+    isMoveSelectionActive = false;
+    isBattleBagOpen = false;
+    updatePlayerFreeze();
     
     qDebug() << "Battle scene exited";
 }
@@ -1772,275 +1488,43 @@ void GrasslandScene::showBattleBag()
     // Set battle bag state
     isBattleBagOpen = true;
     
-    // Clear any existing battle menu items
-    for (auto rect : battleMenuRects) {
-        if (rect) {
-            scene->removeItem(rect);
-            delete rect;
-        }
-    }
-    battleMenuRects.clear();
-    
-    for (auto text : battleMenuTexts) {
-        if (text) {
-            scene->removeItem(text);
-            delete text;
-        }
-    }
-    battleMenuTexts.clear();
+    // The item list replaces the menu
+    showBattleView(false);
+    battleMessages.hideAll();
 
     // Get player's inventory
     QMap<QString, int> inventory = game->getItems();
 
     // Create text showing available items with counts
-    QString bagText = "Choose an item to use:\n\n";
+    QString &bagText = textBuffer;
+    StringTable::format(bagText, STR_BAG_PROMPT);
+    bagText += "\n\n";
     
     // Add Poké Ball option
     int pokeballs = inventory.value("Poké Ball", 0);
     if (pokeballs > 0) {
-        bagText += QString("Press 1: Use Poké Ball (%1 left)\n").arg(pokeballs);
+        StringTable::append(bagText, STR_BAG_POKEBALL, {pokeballs});
+        bagText += '\n';
     }
     
     // Add Potion option
     int potions = inventory.value("Potion", 0);
     if (potions > 0) {
-        bagText += QString("Press 2: Use Potion (%1 left)\n").arg(potions);
+        StringTable::append(bagText, STR_BAG_POTION, {potions});
+        bagText += '\n';
     }
     
     // Add Ether option
     int ethers = inventory.value("Ether", 0);
     if (ethers > 0) {
-        bagText += QString("Press 3: Use Ether (%1 left)\n").arg(ethers);
+        StringTable::append(bagText, STR_BAG_ETHER, {ethers});
+        bagText += '\n';
     }
     
-    bagText += "\nPress B to return";
-
-    // Create and position the text
-    QFont textFont("Arial", 12);
-    QGraphicsTextItem* bagTextItem = scene->addText(bagText, textFont);
-    bagTextItem->setDefaultTextColor(Qt::black);
-    bagTextItem->setPos(cameraPos.x() + 25, cameraPos.y() + VIEW_HEIGHT - 120);
-    bagTextItem->setZValue(202);
-    battleMenuTexts.append(bagTextItem);
-}
+    bagText += '\n';
+    StringTable::append(bagText, STR_PRESS_B_RETURN);
 
-void GrasslandScene::handleBagSelection(int itemIndex)
-{
-    // Get items as a copy since we can't modify the original directly
-    QMap<QString, int> inventory = game->getItems();
-    QString itemName;
-    bool itemUsed = false;
-    QString resultMessage;
-    
-    // Get player's active Pokémon
-    const QVector<Pokemon*>& playerPokemon = game->getPokemon();
-    if (playerPokemon.isEmpty()) {
-        return;
-    }
-    Pokemon* activePokemon = playerPokemon.first();
-    
-    switch (itemIndex) {
-        case 1: // Poké Ball
-            if (inventory.value("Poké Ball", 0) > 0) {
-                itemName = "Poké Ball";
-                itemUsed = true;
-                
-                // 50% chance to catch
-                bool catchSuccess = (QRandomGenerator::global()->bounded(100) < 50);
-                
-                if (catchSuccess) {
-                    // Check if player already has this type of Pokemon
-                    bool alreadyHasPokemon = false;
-                    for (const Pokemon* pokemon : playerPokemon) {
-                        if (pokemon->getName() == currentBattlePokemonType) {
-                            alreadyHasPokemon = true;
-                            break;
-                        }
-                    }
-                    
-                    if (alreadyHasPokemon) {
-                        // Show message that player already has this Pokemon
-                        QGraphicsTextItem* messageText = scene->addText("You already have this Pokemon!", QFont("Arial", 12, QFont::Bold));
-                        messageText->setDefaultTextColor(Qt::black);
-                        messageText->setPos(cameraPos.x() + 50, cameraPos.y() + 150);
-                        messageText->setZValue(205);
-                        battleMenuTexts.append(messageText);
-                        
-                        // Return to battle menu after 2 seconds
-                        QTimer::singleShot(2000, [this]() {
-                            isBattleBagOpen = false;
-                            showBattleScene();
-                        });
-                        return;
-                    }
-                    
-                    // Convert string type to Pokemon::Type enum
-                    Pokemon::Type pokemonType;
-                    if (currentBattlePokemonType == "Bulbasaur") {
-                        pokemonType = Pokemon::BULBASAUR;
-                    } else if (currentBattlePokemonType == "Charmander") {
-                        pokemonType = Pokemon::CHARMANDER;
-                    } else { // Squirtle
-                        pokemonType = Pokemon::SQUIRTLE;
-                    }
-                    
-                    // Create a new Pokemon with the correct type
-                    Pokemon* newPokemon = new Pokemon(pokemonType);
-                    newPokemon->setCurrentHp(wildPokemonHp); // Keep the current HP
-                    
-                    // Add to player's Pokemon collection
-                    game->addPokemon(newPokemon);
-                    
-                    // Update inventory
-                    inventory["Poké Ball"]--;
-                    if (inventory["Poké Ball"] <= 0) {
-                        inventory.remove("Poké Ball");
-                    }
-                    game->setItems(inventory);
-                    
-                    // Show success message
-                    QGraphicsTextItem* messageText = scene->addText("Pokemon is captured!", QFont("Arial", 12, QFont::Bold));
-                    messageText->setDefaultTextColor(Qt::black);
-                    messageText->setPos(cameraPos.x() + 50, cameraPos.y() + 150);
-                    messageText->setZValue(205);
-                    battleMenuTexts.append(messageText);
-                    
-                    // Exit battle scene after 2 seconds
-                    QTimer::singleShot(2000, [this]() {
-                        exitBattleScene();
-                    });
-                    return;
-                } else {
-                    // Failed capture
-                    // Update inventory
-                    inventory["Poké Ball"]--;
-                    if (inventory["Poké Ball"] <= 0) {
-                        inventory.remove("Poké Ball");
-                    }
-                    game->setItems(inventory);
-                    
-                    // Show failure message above wild Pokemon
-                    QGraphicsTextItem* messageText = scene->addText("Unsuccessful capture", QFont("Arial", 12, QFont::Bold));
-                    messageText->setDefaultTextColor(Qt::black);
-                    messageText->setPos(cameraPos.x() + 290, cameraPos.y() + 20);
-                    messageText->setZValue(205);
-                    battleMenuTexts.append(messageText);
-                    
-                    // Show message for 2 seconds, then wait 2 more seconds before wild Pokemon attacks
-                    QTimer::singleShot(2000, [this, messageText]() {
-                        // Remove the message after 2 seconds
-                        scene->removeItem(messageText);
-                        battleMenuTexts.removeOne(messageText);
-                        delete messageText;
-                        
-                        // Wait 2 more seconds before wild Pokemon attacks
-                        QTimer::singleShot(2000, [this]() {
-                            isBattleBagOpen = false;
-                            wildPokemonTurn();
-                        });
-                    });
-                    return;
-                }
-            }
-            break;
-            
-        case 2: // Potion
-            if (inventory.value("Potion", 0) > 0) {
-                itemName = "Potion";
-                // Heal 10 HP
-                int currentHp = activePokemon->getCurrentHp();
-                int maxHp = activePokemon->getMaxHp();
-                if (currentHp < maxHp) { // Only heal if not at max HP
-                    int healAmount = 10;
-                    int newHp = qMin(currentHp + healAmount, maxHp);
-                    activePokemon->setCurrentHp(newHp);
-                    itemUsed = true;
-                    resultMessage = QString("%1 recovered 10 HP!").arg(activePokemon->getName());
-                    
-                    // Update inventory immediately
-                    inventory["Potion"]--;
-                    if (inventory["Potion"] <= 0) {
-                        inventory.remove("Potion");
-                    }
-                    game->setItems(inventory);
-                    
-                    // Show recovery message
-                    QGraphicsTextItem* messageText = scene->addText(resultMessage, QFont("Arial", 12, QFont::Bold));
-                    messageText->setDefaultTextColor(Qt::black);
-                    messageText->setPos(cameraPos.x() + 50, cameraPos.y() + 150); // Above player's Pokémon
-                    messageText->setZValue(205);
-                    battleMenuTexts.append(messageText);
-                    
-                    // Update battle scene to show new HP after 2 seconds
-                    QTimer::singleShot(2000, [this]() {
-                        showBattleScene();
-                        // Start wild Pokémon's turn after showing updated HP
-                        QTimer::singleShot(2000, [this]() {
-                            isBattleBagOpen = false;
-                            wildPokemonTurn();
-                        });
-                    });
-                    return;
-                } else {
-                    resultMessage = "HP is already full!";
-                    itemUsed = false;
-                }
-            }
-            break;
-            
-        case 3: // Ether
-            if (inventory.value("Ether", 0) > 0) {
-                itemName = "Ether";
-                // Restore PP of all moves
-                QVector<Pokemon::Move>& moves = const_cast<QVector<Pokemon::Move>&>(activePokemon->getMoves());
-                for (Pokemon::Move& move : moves) {
-                    move.pp = 20; // Reset to max PP
-                }
-                itemUsed = true;
-                resultMessage = "All move PP is restored now!";
-                
-                // Update inventory immediately
-                inventory["Ether"]--;
-                if (inventory["Ether"] <= 0) {
-                    inventory.remove("Ether");
-                }
-                game->setItems(inventory);
-                
-                // Show PP restore message
-                QGraphicsTextItem* messageText = scene->addText(resultMessage, QFont("Arial", 12, QFont::Bold));
-                messageText->setDefaultTextColor(Qt::black);
-                messageText->setPos(cameraPos.x() + 50, cameraPos.y() + 150); // Above player's Pokémon
-                messageText->setZValue(205);
-                battleMenuTexts.append(messageText);
-                
-                // Wait 3 seconds before wild Pokémon's turn
-                QTimer::singleShot(3000, [this]() {
-                    isBattleBagOpen = false;
-                    wildPokemonTurn();
-                });
-                return;
-            }
-            break;
-    }
-    
-    if (!itemUsed && !resultMessage.isEmpty()) {
-        // Show error message (e.g., HP already full)
-        QGraphicsTextItem* messageText = scene->addText(resultMessage, QFont("Arial", 12, QFont::Bold));
-        messageText->setDefaultTextColor(Qt::black);
-        messageText->setPos(cameraPos.x() + 50, cameraPos.y() + 150); // Above player's Pokémon
-        messageText->setZValue(205);
-        battleMenuTexts.append(messageText);
-        
-        // Return to battle menu after a short delay
-        QTimer::singleShot(1000, [this]() {
-            isBattleBagOpen = false;
-            showBattleScene();
-        });
-    } else if (!itemUsed) {
-        // If no message, just return to battle menu
-        isBattleBagOpen = false;
-        showBattleScene();
-    }
+    battleListText->setPlainText(bagText);
 }
 
 void GrasslandScene::showMoveSelection()
@@ -2048,22 +1532,9 @@ void GrasslandScene::showMoveSelection()
     // Set move selection state
     isMoveSelectionActive = true;
     
-    // Clear any existing battle menu items
-    for (auto rect : battleMenuRects) {
-        if (rect) {
-            scene->removeItem(rect);
-            delete rect;
-        }
-    }
-    battleMenuRects.clear();
-    
-    for (auto text : battleMenuTexts) {
-        if (text) {
-            scene->removeItem(text);
-            delete text;
-        }
-    }
-    battleMenuTexts.clear();
+    // The move list replaces the menu
+    showBattleView(false);
+    battleMessages.hideAll();
 
     // Get player's active Pokémon
     const QVector<Pokemon*>& playerPokemon = game->getPokemon();
@@ -2075,221 +1546,30 @@ void GrasslandScene::showMoveSelection()
     const QVector<Pokemon::Move>& moves = activePokemon->getMoves();
 
     // Create text showing available moves based on level
-    QString moveText;
+    QString &moveText = textBuffer;
+    moveText.resize(0);
+    QString moveLine;
     int pokemonLevel = activePokemon->getLevel();
     
-    // At level 1, only show the first move
-    if (pokemonLevel == 1) {
-        if (!moves.isEmpty()) {
-            // Show move with PP, gray out if PP is 0
-            QString moveStr = QString("Press 1: %1 (PP: %2/20)")
-                .arg(moves[0].name)
-                .arg(moves[0].pp);
-            
-            if (moves[0].pp <= 0) {
-                moveStr = QString("[OUT OF PP] %1").arg(moveStr);
-            }
-            moveText += moveStr + "\n";
-        }
-    } else {
-        // At level 2, show both moves
-        for (int i = 0; i < moves.size(); ++i) {
-            // Show move with PP, gray out if PP is 0
-            QString moveStr = QString("Press %1: %2 (PP: %3/20)")
-                .arg(i + 1)
-                .arg(moves[i].name)
-                .arg(moves[i].pp);
-            
-            if (moves[i].pp <= 0) {
-                moveStr = QString("[OUT OF PP] %1").arg(moveStr);
-            }
-            moveText += moveStr + "\n";
-        }
-    }
-    
-    moveText += "\nPress C: Do Nothing\n";
-    moveText += "Press B to return";
-
-    // Create and position the text
-    QFont textFont("Arial", 12);
-    QGraphicsTextItem* moveTextItem = scene->addText(moveText, textFont);
-    moveTextItem->setDefaultTextColor(Qt::black);
-    moveTextItem->setPos(cameraPos.x() + 25, cameraPos.y() + VIEW_HEIGHT - 120);
-    moveTextItem->setZValue(202);
-    battleMenuTexts.append(moveTextItem);
-}
-
-void GrasslandScene::handleMoveSelection(int moveIndex)
-{
-    // Get player's active Pokémon
-    const QVector<Pokemon*>& playerPokemon = game->getPokemon();
-    if (playerPokemon.isEmpty()) {
-        return;
-    }
-
-    Pokemon* activePokemon = playerPokemon.first();
-    const QVector<Pokemon::Move>& moves = activePokemon->getMoves();
-
-    // Clear move selection text
-    isMoveSelectionActive = false;
-    showBattleScene();
-
-    // Handle "Do Nothing" option
-    if (moveIndex == -1) {
-        // Start timer for opponent's turn without showing any text
-        if (!battleTimer) {
-            battleTimer = new QTimer(this);
-            connect(battleTimer, &QTimer::timeout, this, &GrasslandScene::wildPokemonTurn);
-            battleTimer->setSingleShot(true);
+    // At level 1, only show the first move; at level 2, show both moves
+    int shownMoves = pokemonLevel == 1 ? qMin(1, moves.size()) : moves.size();
+    for (int i = 0; i < shownMoves; ++i) {
+        // Show move with PP, gray out if PP is 0
+        StringTable::format(moveLine, STR_MOVE_OPTION, {i + 1, StringTable::name(moves[i].name), moves[i].pp});
+        if (moves[i].pp <= 0) {
+            StringTable::append(moveText, STR_OUT_OF_PP, {moveLine});
+        } else {
+            moveText += moveLine;
         }
-        battleTimer->start(1000);
-        return;
+        moveText += '\n';
     }
-
-    // Check if move index is valid and has PP
-    if (moveIndex >= moves.size() || moves[moveIndex].pp <= 0) {
-        return;
-    }
-
-    // Get the selected move
-    const Pokemon::Move& selectedMove = moves[moveIndex];
-
-    // Calculate damage using the formula: Damage = (Power + User's Attack - Opponent's Defense) × Level
-    int power = selectedMove.power; // Use the move's actual power
-    int userAttack = activePokemon->getAttack();
-    int opponentDefense = 5; // Base defense for wild Pokémon
-    int damage = (power + userAttack - opponentDefense) * activePokemon->getLevel();
-    if (damage < 1) damage = 1; // Minimum damage is 1
-
-    // Decrease PP (need to cast away const to modify)
-    const_cast<Pokemon::Move&>(selectedMove).pp--;
-
-    // Apply damage to wild Pokemon
-    wildPokemonHp -= damage;
-    if (wildPokemonHp < 0) wildPokemonHp = 0;
-
-    // Show the move and damage in battle scene
-    QString moveText = QString("%1 used %2!\nDealt %3 damage!")
-        .arg(activePokemon->getName())
-        .arg(selectedMove.name)
-        .arg(damage);
     
-    QGraphicsTextItem* actionText = scene->addText(moveText, QFont("Arial", 12, QFont::Bold));
-    actionText->setDefaultTextColor(Qt::black);
-    actionText->setPos(cameraPos.x() + 25, cameraPos.y() + VIEW_HEIGHT - 90);
-    actionText->setZValue(205);
-    battleMenuTexts.append(actionText);
-
-    // Update battle display to show new HP
-    showBattleScene();
-
-    // Check if battle should end
-    if (wildPokemonHp <= 0) {
-        // Level up the player's Pokémon
-        activePokemon->setLevel(activePokemon->getLevel() + 1);
-        
-        // Show victory and level up message in battle scene
-        QString victoryText = QString("%1 won the battle!\n%1 grew to level %2!")
-            .arg(activePokemon->getName())
-            .arg(activePokemon->getLevel());
-            
-        QGraphicsTextItem* battleText = scene->addText(
-            victoryText,
-            QFont("Arial", 12, QFont::Bold)
-        );
-        battleText->setDefaultTextColor(Qt::black);
-        battleText->setPos(cameraPos.x() + 25, cameraPos.y() + VIEW_HEIGHT - 90);
-        battleText->setZValue(205);
-        battleMenuTexts.append(battleText);
-        
-        // Exit battle scene after a delay
-        QTimer::singleShot(2000, [this]() {
-            exitBattleScene();
-        });
-        return;
-    }
-
-    // Start timer for opponent's turn
-    if (!battleTimer) {
-        battleTimer = new QTimer(this);
-        connect(battleTimer, &QTimer::timeout, this, &GrasslandScene::wildPokemonTurn);
-        battleTimer->setSingleShot(true);
-    }
-    battleTimer->start(2000);
-}
-
-void GrasslandScene::wildPokemonTurn()
-{
-    // Get player's active Pokémon
-    const QVector<Pokemon*>& playerPokemon = game->getPokemon();
-    if (playerPokemon.isEmpty()) {
-        return;
-    }
+    moveText += '\n';
+    StringTable::append(moveText, STR_DO_NOTHING);
+    moveText += '\n';
+    StringTable::append(moveText, STR_PRESS_B_RETURN);
 
-    Pokemon* activePokemon = playerPokemon.first();
-
-    // Calculate damage using the same formula: Damage = (Power + User's Attack - Opponent's Defense) × Level
-    int power = 10; // Base power for wild Pokémon moves
-    int wildAttack = 5; // Same attack as player Pokémon
-    int playerDefense = 5; // Base defense for player's Pokémon
-    int wildLevel = 1; // Wild Pokémon are always level 1
-    int damage = (power + wildAttack - playerDefense) * wildLevel;
-    if (damage < 1) damage = 1; // Minimum damage is 1
-
-    QString move = "Tackle"; // Default move for wild Pokémon
-    
-    // Split the move text into two separate text items for better visibility
-    QString moveText = QString("Wild %1 used %2!").arg(currentBattlePokemonType).arg(move);
-    QString damageText = QString("Dealt %1 damage!").arg(damage);
-    
-    // Add move text - position at the middle of the view
-    QGraphicsTextItem* moveTextItem = scene->addText(moveText, QFont("Arial", 12, QFont::Bold));
-    moveTextItem->setDefaultTextColor(Qt::black);
-    moveTextItem->setPos(cameraPos.x() + 282, cameraPos.y() + 20); // Center position
-    moveTextItem->setZValue(205);
-    battleMenuTexts.append(moveTextItem);
-
-    // Add damage text below move text
-    QGraphicsTextItem* damageTextItem = scene->addText(damageText, QFont("Arial", 12, QFont::Bold));
-    damageTextItem->setDefaultTextColor(Qt::black);
-    damageTextItem->setPos(cameraPos.x() + 282, cameraPos.y() + 40); // Below move text, same horizontal alignment
-    damageTextItem->setZValue(205);
-    battleMenuTexts.append(damageTextItem);
-
-    // Apply damage and ensure HP doesn't go below 0
-    int currentHp = activePokemon->getCurrentHp();
-    int newHp = currentHp - damage;
-    if (newHp < 0) newHp = 0;
-    activePokemon->setCurrentHp(newHp);
-
-    // Update battle display after a short delay
-    QTimer::singleShot(2000, [this]() {
-        showBattleScene();
-
-        // Check if battle should end
-        const QVector<Pokemon*>& playerPokemon = game->getPokemon();
-        if (!playerPokemon.isEmpty() && playerPokemon.first()->getCurrentHp() <= 0) {
-            // Show defeat message in battle scene - moved left
-            QGraphicsTextItem* defeatText = scene->addText(
-                QString("Your %1 fainted!").arg(playerPokemon.first()->getName()),
-                QFont("Arial", 12, QFont::Bold)
-            );
-            defeatText->setDefaultTextColor(Qt::black);
-            defeatText->setPos(cameraPos.x() + 290, cameraPos.y() + 20); // Moved left to match wild Pokemon text
-            defeatText->setZValue(205);
-            battleMenuTexts.append(defeatText);
-            
-            // Exit battle scene after a delay without showing additional text
-            QTimer::singleShot(2000, [this]() {
-                exitBattleScene();
-            });
-            return;
-        }
-
-        // Return to battle menu
-        selectedBattleOption = FIGHT;
-        showBattleScene();
-    });
+    battleListText->setPlainText(moveText);
 }
 
 void GrasslandScene::showPokemonSelectionDialogue()
@@ -2301,18 +1581,19 @@ void GrasslandScene::showPokemonSelectionDialogue()
     }
 
     // Build the selection dialogue text
-    QString dialogText = "Choose your Pokémon:\n\n";
+    QString &dialogText = textBuffer;
+    StringTable::format(dialogText, STR_CHOOSE_POKEMON);
+    dialogText += "\n\n";
     for (int i = 0; i < playerPokemon.size(); i++) {
-        dialogText += QString("Press %1: %2 (HP: %3/%4)\n")
-            .arg(i + 1)
-            .arg(playerPokemon[i]->getName())
-            .arg(playerPokemon[i]->getCurrentHp())
-            .arg(playerPokemon[i]->getMaxHp());
+        StringTable::append(dialogText, STR_PARTY_OPTION, {i + 1, StringTable::name(playerPokemon[i]->getName()),
+                                                           playerPokemon[i]->getCurrentHp(), playerPokemon[i]->getMaxHp()});
+        dialogText += '\n';
     }
-    dialogText += "\nPress ESC to return";
+    dialogText += '\n';
+    StringTable::append(dialogText, STR_RETURN_HINT);
 
     // Show the selection dialogue with the built text
     showPokemonSelectionDialogue(dialogText);
 }
 
-// ... existing code ... 
\ No newline at end of file
+// ... existing code ... 
\ No newline at end of file
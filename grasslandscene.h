@@ -2,13 +2,26 @@
 #define GRASSLANDSCENE_H
 
 #include "scene.h"
+#include "frameloop.h"
+#include "collisionworld.h"
+#include "kinematicmover.h"
+#include "pathfinder.h"
 #include "pokemon.h"
+#include "wildspawner.h"
+#include "entitypool.h"
+#include "spritepool.h"
+#include "viewportculler.h"
+#include "battlemessagepool.h"
+#include "battlestate.h"
+#include "debugoverlayitem.h"
+#include "bitmaptextitem.h"
 #include <QGraphicsScene>
 #include <QGraphicsPixmapItem>
 #include <QGraphicsRectItem>
+#include <QGraphicsPolygonItem>
 #include <QTimer>
 #include <QSet>
-#include <QRandomGenerator>
+#include <QHash>
 #include <QMap>
 
 class Game;
@@ -22,22 +35,28 @@ public:
     ~GrasslandScene() override;
 
     void initialize() override;
-    void handleKeyPress(int key) override;
-    void handleKeyRelease(int key);
+    void handleAction(InputSystem::Action action) override;
+    void handleActionRelease(InputSystem::Action action) override;
     void cleanup() override;
     void update();
 
+    void addToWorld(WorldContent &content) override;
+    void enterArea(const QPointF &position) override;
+    void leaveArea() override;
+    // Keeps the wild Pokémon up to date while the player looks on from the town
+    void snapshotTaken(const WorldSnapshot &snapshot) override;
+
+    // Barriers, one-way ledges and the walkable grid of the grassland, in
+    // world coordinates. Built from MapLayout only, which lets the
+    // title-screen warm-up prepare them.
+    static void buildWorld(CollisionWorld &world, Pathfinder &pathfinder);
+
 protected:
 
 private slots:
     void updateScene();
-    void processMovement();
 
 private:
-    // Constants for grassland dimensions
-    const int GRASSLAND_WIDTH = 1000;
-    const int GRASSLAND_HEIGHT = 1667;
-
     // Battle menu options
     enum BattleOption {
         FIGHT = 0,
@@ -47,84 +66,118 @@ private:
     };
     BattleOption selectedBattleOption = FIGHT;  // Changed from int to BattleOption
 
-    // Battle menu items
-    QVector<QGraphicsItem*> battleMenuRects;
-    QVector<QGraphicsTextItem*> battleMenuTexts;
     bool isMoveSelectionActive{false};  // New flag for move selection
 
+    // Barrier and ledge geometry for swept player movement
+    CollisionWorld collisionWorld;
+    KinematicMover playerMover;
+    Pathfinder pathfinder;  // Walkable grid for scripted/automatic walks
+
     // Timers
-    QTimer *updateTimer{nullptr};
-    QTimer *movementTimer{nullptr};
+    FrameLoop *frameLoop{nullptr};
 
-    // Graphics items
-    QGraphicsPixmapItem *backgroundItem{nullptr};
+    // Trigger state from the simulation's snapshots
+    int pendingArea{-1};        // Area the player walked into, handled in updateScene
+    int occupiedBulletin{-1};   // Bulletin board volume the player stands in
+
+    // Map geometry in world coordinates - plain rects, drawn only by the debug overlay
+    QVector<QRectF> barrierRects;
+    QVector<QRectF> ledgeRects;        // One-way barriers (can jump down, can't climb up)
+    QVector<QRectF> tallGrassRects;    // Tall grass areas for wild Pokémon encounters
+    QRectF townPathRect;               // Where the path leads down into the town
+    QRectF bulletinBoardRect;          // Bulletin board for conversation
+    DebugOverlayItem *debugOverlay{nullptr};  // Debug builds only
+
+    // Graphics items; the player is hidden while in another area
     QGraphicsPixmapItem *playerItem{nullptr};
-    QVector<QGraphicsRectItem*> barrierItems;
-    QGraphicsRectItem *townPortalItem{nullptr};  // Portal to return to town
-    QGraphicsRectItem *bulletinBoardItem{nullptr};  // Bulletin board for conversation
     
     // Dialogue items
     QGraphicsItem* dialogBoxItem{nullptr};
-    QGraphicsTextItem* dialogTextItem{nullptr};
+    BitmapTextItem* dialogTextItem{nullptr};
     bool isDialogueActive{false};
-    bool isPokemonSelectionDialogue{false};
     int currentDialogueState{0};
 
     // Bag items
     QGraphicsPixmapItem* bagBackgroundItem{nullptr};
     QVector<QGraphicsPixmapItem*> bagPokemonSprites;
-    QVector<QGraphicsTextItem*> bagPokemonNames;
+    QVector<BitmapTextItem*> bagPokemonNames;
     QVector<QGraphicsRectItem*> bagSlotRects;
     bool isBagOpen{false};
 
     // Player state
-    QPointF playerPos{500, 500}; // Default starting position (center of grassland)
+    QPointF playerPos; // World position, set when the player enters the grassland
     QPointF cameraPos{0, 0}; // Camera position for viewing
     QString playerDirection{"F"}; // F=front, B=back, L=left, R=right
     int walkFrame{0};
-    
-    // Input handling
-    QSet<int> pressedKeys;
-    int currentPressedKey{0};
 
-    // Ledge items for one-way barriers (can jump down, can't climb up)
-    QVector<QGraphicsRectItem*> ledgeItems;
-    
     // Wild Pokémon encounter struct
     struct WildPokemon {
-        QString type;                     // Pokémon type (Bulbasaur, Charmander, Squirtle)
-        QPointF position;                 // Position in the scene
-        QGraphicsPixmapItem* spriteItem;  // Sprite item in the scene
-        bool encountered;                 // Whether this Pokémon has been encountered
+        QString type;                              // Pokémon type (Bulbasaur, Charmander, Squirtle)
+        QPointF position;                          // Position in the scene
+        QGraphicsPixmapItem* spriteItem{nullptr};  // Pooled sprite item in the scene
+        int spawnToken{-1};                        // Handle from the spawner, released on encounter
     };
 
-    // Tall grass areas for wild Pokémon encounters
-    QVector<QGraphicsRectItem*> tallGrassItems;
-    
-    // Wild Pokémon data
-    QVector<WildPokemon> wildPokemons;
-    
-    // Grass area tracking
-    QMap<int, bool> grassAreaVisited;   // Maps grass area index to visited status
-    int currentGrassArea;               // Index of current grass area (-1 if not in grass)
+    // Sprites for the simulation's wild Pokémon - encountered Pokémon go
+    // back to the pools, so memory and per-tick cost stay flat over long sessions
+    const int MAX_WILD_POKEMON = 16;
+    const int WILD_RESPAWN_DELAY_MS = 5000;
+    EntityPool<WildPokemon> wildPokemons{MAX_WILD_POKEMON};
+    SpritePool wildSpritePool;
+    quint32 wildVersion{0};              // Snapshot wild list the sprites show
+    QHash<int, int> wildSpawnIndex;      // Spawn token -> index, reused by syncWildPokemon()
+
+    // Keeps wild Pokémon out of the scene while off screen, following
+    // whichever scene's camera is in charge
+    ViewportCuller viewportCuller;
+
+    // Reused lines for the battle messages, so turns allocate no text items
+    BattleMessagePool battleMessages;
+    QHash<int, quint32> battleMessageTickets;  // BattleState message id -> pool ticket
     
     // Battle scene elements
     bool inBattleScene{false};
+    bool isBattleStarting{false};  // Party selection is up, the battle screen is not
     bool isBattleBagOpen{false};
+    bool battleBusy{false};        // The simulation is still playing out the last choice
+    // The battle screen is built on the first battle of a visit and then only
+    // updated: every item is a descendant of battleRoot, which is moved to
+    // the camera and hidden again when the battle ends
+    QGraphicsRectItem* battleRoot{nullptr};         // White backdrop
     QGraphicsPixmapItem* battleSceneItem{nullptr};
+    QPixmap battleBackground;  // Loaded on the first battle
+    QGraphicsPixmapItem* battlePlayerSprite{nullptr};
+    QGraphicsPixmapItem* battleWildSprite{nullptr};
+    QGraphicsRectItem* battlePlayerHpBar{nullptr};  // Parent of the fill and the stats line
+    QGraphicsRectItem* battlePlayerHpFill{nullptr};
+    BitmapTextItem* battlePlayerStats{nullptr};
+    QGraphicsRectItem* battleWildHpBar{nullptr};
+    QGraphicsRectItem* battleWildHpFill{nullptr};
+    BitmapTextItem* battleWildStats{nullptr};
+    QGraphicsRectItem* battleMenuItem{nullptr};     // Menu background, parent of the menu below
+    BitmapTextItem* battlePromptText{nullptr};
+    QGraphicsRectItem* battleOptionRects[4] = {};  // FIGHT, BAG, POKEMON, RUN boxes
+    QGraphicsPolygonItem* battleMarker{nullptr};    // Cursor next to the selected option
+    BitmapTextItem* battleListText{nullptr};        // Move or item list, in place of the menu
+    QBrush optionBrush{QColor(255, 255, 255, 100)};
+    QBrush selectedOptionBrush{QColor(200, 200, 200, 100)};
     QString currentBattlePokemonType;
+    QString textBuffer;  // Reused for the formatted battle and dialogue text
     
-    // Battle mechanics
-    Pokemon* wildPokemon{nullptr};  // Store the current wild Pokemon
-    int wildPokemonHp{30};         // Wild Pokemon's current HP
-    bool isPlayerTurn{true};       // Track whose turn it is
-    QTimer* battleTimer{nullptr};  // Timer for battle animations and delays
+    // Battle display; the battle itself runs in the simulation
+    int wildPokemonHp{BattleState::WILD_MAX_HP};  // Wild Pokemon's current HP
     
     // Methods
     void createBackground();
     void createPlayer();
     void createBarriers();
     void updatePlayerSprite();
+    void applySimulationSnapshot();
+    void syncWildPokemon(const QVector<WildSpawner::Spawn> &spawns);
+    // Dialogues, the bag and battles stop the player; called where they open and close
+    void updatePlayerFreeze();
+    // Frame loop: whether the next frame has work to do
+    bool isFrameBusy() const;
     void updatePlayerPosition();
     void updateCamera();
     bool checkCollision();
@@ -135,29 +188,26 @@ private:
     void showDialogue(const QString &text);
     void closeDialogue();
     void handleDialogue();
-    bool isPlayerNearTownPortal() const;
-    bool isPlayerNearBulletinBoard() const;
-    bool isPlayerJumpingDownLedge(const QPointF& newPos) const;
+
+    // Event scripts (grassland_bulletin, grassland_no_pokemon)
+    void scriptSay(const QString &text) override;
+    void scriptEnd() override;
+    void scriptStartBattle(const QString &species) override;
+
     void createTallGrassAreas();
-    void spawnWildPokemon(int grassAreaIndex);
-    bool isPlayerInGrassArea(int* areaIndex = nullptr);
-    void checkWildPokemonCollision();
     void startBattle(const QString& pokemonType);
+    void handleBattleEvent(const BattleState::Event &event);
     void showBattleScene();
+    void updateBattleMenuSelection();  // Cursor moved: restyle the menu already on screen
+    void createBattleItems();
+    // Brings up the battle screen with either the status bars and menu or
+    // the move / item list
+    void showBattleView(bool menu);
     void showBattleBag();
     void showMoveSelection();
     void exitBattleScene();
     void showPokemonSelectionDialogue(const QString& text);
     void showPokemonSelectionDialogue();
-    void handleBagSelection(int itemIndex);
-    
-    // Battle mechanics methods
-    void handleMoveSelection(int moveIndex);  // Handle when player selects a move
-    void calculateDamage(Pokemon* attacker, const Pokemon::Move& move, Pokemon* defender);  // Calculate damage
-    void applyDamage(int damage, bool toWildPokemon);  // Apply damage to either Pokemon
-    void wildPokemonTurn();  // Handle wild Pokemon's turn
-    void checkBattleEnd();   // Check if battle should end
-    void showBattleMessage(const QString& message);  // Show battle messages
 };
 
 #endif // GRASSLANDSCENE_H 
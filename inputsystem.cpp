@@ -0,0 +1,177 @@
+#include "inputsystem.h"
+#include <QDebug>
+#include <QEvent>
+#include <QGraphicsScene>
+#include <QGraphicsView>
+
+// How often latency numbers are logged while input keeps coming
+static const int REPORT_INTERVAL_MS = 10000;
+
+InputSystem::InputSystem(QObject *parent)
+    : QObject(parent)
+{
+    clock.start();
+    reportClock.start();
+
+    bind(Qt::Key_Up, MOVE_UP);
+    bind(Qt::Key_Down, MOVE_DOWN);
+    bind(Qt::Key_Left, MOVE_LEFT);
+    bind(Qt::Key_Right, MOVE_RIGHT);
+    bind(Qt::Key_A, CONFIRM);
+    bind(Qt::Key_Return, CONFIRM);
+    bind(Qt::Key_Enter, CONFIRM);
+    bind(Qt::Key_Escape, CANCEL);
+    bind(Qt::Key_B, MENU);
+    for (int n = 0; n < 9; ++n) {
+        bind(Qt::Key_1 + n, static_cast<Action>(SELECT_1 + n));
+    }
+    bind(Qt::Key_C, PASS);
+    bind(Qt::Key_L, SWITCH_LANGUAGE);
+}
+
+void InputSystem::bind(int key, Action action)
+{
+    bindings.insert(key, action);
+}
+
+void InputSystem::keyPressed(int key)
+{
+    lastPress = nowNs();
+
+    const int action = actionForKey(key);
+    if (action < 0) {
+        return;
+    }
+
+    // The stamp goes out before the count, so a reader that sees the press sees its time
+    pressTimes[action].store(lastPress);
+    held.fetch_or(1u << action);
+    if (MOVEMENT_ACTIONS & (1u << action)) {
+        latest = action;
+    }
+    pressCounts[action].fetch_add(1);
+}
+
+void InputSystem::keyReleased(int key)
+{
+    const int action = actionForKey(key);
+    if (action < 0) {
+        return;
+    }
+
+    held.fetch_and(~(1u << action));
+    releaseCounts[action].fetch_add(1);
+}
+
+void InputSystem::releaseAll()
+{
+    // Keys still down count again only once pressed again, and presses no
+    // consumer has sampled yet are dropped
+    held = 0;
+    latest = -1;
+    ++epoch;
+}
+
+InputSystem::Sample InputSystem::sample(Reader &reader)
+{
+    Sample result;
+    const quint32 currentEpoch = epoch.load();
+    const bool dropEdges = reader.epoch != currentEpoch;
+    reader.epoch = currentEpoch;
+
+    for (int action = 0; action < ACTION_COUNT; ++action) {
+        const quint32 presses = pressCounts[action].load();
+        if (presses != reader.presses[action] && !dropEdges) {
+            result.pressed |= 1u << action;
+            result.pressedAtNs[action] = pressTimes[action].load();
+        }
+        reader.presses[action] = presses;
+
+        const quint32 releases = releaseCounts[action].load();
+        if (releases != reader.releases[action] && !dropEdges) {
+            result.released |= 1u << action;
+        }
+        reader.releases[action] = releases;
+    }
+    result.held = held.load();
+
+    // The newest movement key wins while several are down; if it was let
+    // go, fall back to one still held
+    const quint32 candidates = (result.held | result.pressed) & MOVEMENT_ACTIONS;
+    result.latest = latest.load();
+    if (result.latest < 0 || !(candidates & (1u << result.latest))) {
+        result.latest = -1;
+        for (int action = 0; action < ACTION_COUNT; ++action) {
+            if (result.held & MOVEMENT_ACTIONS & (1u << action)) {
+                result.latest = action;
+                break;
+            }
+        }
+    }
+    return result;
+}
+
+qint64 InputSystem::Sample::firstPressNs(quint32 actions) const
+{
+    qint64 first = 0;
+    for (int action = 0; action < ACTION_COUNT; ++action) {
+        if ((pressed & actions & (1u << action)) && (first == 0 || pressedAtNs[action] < first)) {
+            first = pressedAtNs[action];
+        }
+    }
+    return first;
+}
+
+void InputSystem::markApplied(qint64 pressedAtNs, LatencyKind kind)
+{
+    // Keep the oldest press still waiting for a paint
+    if (pressedAtNs > 0 && (awaitingPaint[kind] == 0 || pressedAtNs < awaitingPaint[kind])) {
+        awaitingPaint[kind] = pressedAtNs;
+    }
+}
+
+void InputSystem::watchViews(QGraphicsScene *scene)
+{
+    for (QGraphicsView *view : scene->views()) {
+        view->viewport()->installEventFilter(this);
+    }
+}
+
+bool InputSystem::eventFilter(QObject *watched, QEvent *event)
+{
+    if (event->type() == QEvent::Paint) {
+        const qint64 now = nowNs();
+        for (int kind = 0; kind < LATENCY_KIND_COUNT; ++kind) {
+            if (awaitingPaint[kind] == 0) {
+                continue;
+            }
+            const qint64 latency = now - awaitingPaint[kind];
+            awaitingPaint[kind] = 0;
+
+            LatencyStats &kindStats = stats[kind];
+            kindStats.count++;
+            kindStats.totalNs += latency;
+            kindStats.maxNs = qMax(kindStats.maxNs, latency);
+        }
+
+        if (reportClock.elapsed() >= REPORT_INTERVAL_MS) {
+            report();
+        }
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+void InputSystem::report()
+{
+    static const char *const NAMES[LATENCY_KIND_COUNT] = {"walk", "menu"};
+    for (int kind = 0; kind < LATENCY_KIND_COUNT; ++kind) {
+        LatencyStats &kindStats = stats[kind];
+        if (kindStats.count == 0) {
+            continue;
+        }
+        qDebug() << "Input latency for" << NAMES[kind] << "keys:" << kindStats.count << "presses, avg"
+                 << kindStats.totalNs / kindStats.count / 1000000.0 << "ms, max" << kindStats.maxNs / 1000000.0 << "ms";
+        kindStats = LatencyStats();
+    }
+    reportClock.restart();
+}
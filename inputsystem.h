@@ -0,0 +1,146 @@
+#ifndef INPUTSYSTEM_H
+#define INPUTSYSTEM_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <atomic>
+
+class QGraphicsScene;
+
+// Keyboard state shared by the GUI thread and the simulation.
+//
+// Key events only set and clear bits in an atomic action set, through a
+// key -> action map, so several keys can be held at once and a binding can
+// be changed without touching the code that moves the player or drives a
+// menu. Consumers sample the set once per tick - the simulation per step,
+// Game for the scenes' menus and dialogues - and each sees one consistent
+// state per tick. Presses and releases are counted per action, and every
+// consumer keeps its own Reader of those counts, so a tap shorter than a
+// tick is never lost and one consumer never takes an edge from another.
+//
+// It also measures latency. Each press is stamped. A walking press travels
+// with the WorldSnapshot of the step that answered it, and a menu press is
+// marked straight after the scene handled it. The first paint of the view
+// after that closes the measurement, and the numbers are logged every ten
+// seconds while keys are being pressed.
+class InputSystem : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Action {
+        MOVE_UP,
+        MOVE_DOWN,
+        MOVE_LEFT,
+        MOVE_RIGHT,
+        CONFIRM,          // Talk, read, accept (A, Enter)
+        CANCEL,           // Run away, back out (Esc)
+        MENU,             // Bag; "back" in the battle lists (B)
+        SELECT_1,         // Numbered choices, SELECT_1 + n - 1 for choice n (1-9)
+        SELECT_2,
+        SELECT_3,
+        SELECT_4,
+        SELECT_5,
+        SELECT_6,
+        SELECT_7,
+        SELECT_8,
+        SELECT_9,
+        PASS,             // Do nothing this turn (C)
+        SWITCH_LANGUAGE,  // Title screen (L)
+        ACTION_COUNT
+    };
+
+    enum : quint32 {
+        MOVEMENT_ACTIONS = (1u << MOVE_UP) | (1u << MOVE_DOWN) | (1u << MOVE_LEFT) | (1u << MOVE_RIGHT)
+    };
+
+    // Choice number 1-9 of a SELECT_ action, 0 for any other action
+    static int selection(int action) { return action >= SELECT_1 && action <= SELECT_9 ? action - SELECT_1 + 1 : 0; }
+
+    enum LatencyKind {
+        WALK_LATENCY,  // Key down -> frame showing the player's step
+        MENU_LATENCY,  // Key down -> frame showing the scene's reaction
+        LATENCY_KIND_COUNT
+    };
+
+    // What one tick sees
+    struct Sample {
+        quint32 held{0};         // Bit per action
+        quint32 pressed{0};      // Went down since the last sample, even if up again already
+        quint32 released{0};
+        int latest{-1};          // Most recently pressed movement still held, else any held movement
+        qint64 pressedAtNs[ACTION_COUNT] = {};  // Press of each action in pressed
+
+        bool isHeld(int action) const { return held & (1u << action); }
+        bool wasPressed(int action) const { return pressed & (1u << action); }
+        bool wasReleased(int action) const { return released & (1u << action); }
+        // Earliest press among the given actions, 0 if none of them went down
+        qint64 firstPressNs(quint32 actions) const;
+    };
+
+    // Edge counts one consumer has seen. Each consumer owns one and passes
+    // it to every sample() it takes, always from the same thread.
+    struct Reader {
+        quint32 presses[ACTION_COUNT] = {};
+        quint32 releases[ACTION_COUNT] = {};
+        quint32 epoch{0};
+    };
+
+    explicit InputSystem(QObject *parent = nullptr);
+
+    // Bindings, one action per key; see the constructor for the defaults.
+    // Binding a key again moves it to the new action.
+    void bind(int key, Action action);
+    int actionForKey(int key) const { return bindings.value(key, -1); }
+
+    // GUI thread
+    void keyPressed(int key);
+    void keyReleased(int key);
+    void releaseAll();
+    qint64 lastPressNs() const { return lastPress; }
+
+    // Any thread, once per tick of the consumer owning reader
+    Sample sample(Reader &reader);
+    bool anyHeld(quint32 actions = ~0u) const { return (held.load() & actions) != 0; }
+
+    // Time base of all the stamps here
+    qint64 nowNs() const { return clock.nsecsElapsed(); }
+
+    // GUI thread: the press stamped pressedAtNs is now shown by the scene's
+    // items; the next paint of a watched view makes it visible
+    void markApplied(qint64 pressedAtNs, LatencyKind kind);
+    // Starts measuring paints of the scene's views
+    void watchViews(QGraphicsScene *scene);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    QElapsedTimer clock;
+    QHash<int, int> bindings;  // Qt key -> Action
+
+    // Shared with the consumers
+    std::atomic<quint32> held{0};
+    std::atomic<quint32> pressCounts[ACTION_COUNT] = {};
+    std::atomic<quint32> releaseCounts[ACTION_COUNT] = {};
+    std::atomic<qint64> pressTimes[ACTION_COUNT] = {};
+    std::atomic<int> latest{-1};      // Movement action
+    std::atomic<quint32> epoch{0};    // Bumped by releaseAll(): earlier edges are dropped
+
+    // GUI thread only
+    qint64 lastPress{0};
+    qint64 awaitingPaint[LATENCY_KIND_COUNT] = {};
+
+    struct LatencyStats {
+        int count{0};
+        qint64 totalNs{0};
+        qint64 maxNs{0};
+    };
+    LatencyStats stats[LATENCY_KIND_COUNT];
+    QElapsedTimer reportClock;
+
+    void report();
+};
+
+#endif // INPUTSYSTEM_H
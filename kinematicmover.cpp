@@ -0,0 +1,111 @@
+#include "kinematicmover.h"
+#include "collisionworld.h"
+
+KinematicMover::KinematicMover(const QRectF &hitbox)
+    : hitbox(hitbox)
+{
+}
+
+KinematicMover::Result KinematicMover::move(const CollisionWorld &world, const QPointF &position,
+                                            const QPointF &delta) const
+{
+    Result result;
+    QRectF box = hitbox.translated(position);
+
+    // Horizontal first, then vertical from wherever the first sweep ended
+    qreal dx = sweepX(world, box, delta.x());
+    box.translate(dx, 0);
+    qreal dy = sweepY(world, box, delta.y());
+
+    result.position = QPointF(position.x() + dx, position.y() + dy);
+    result.blockedX = dx != delta.x();
+    result.blockedY = dy != delta.y();
+    return result;
+}
+
+qreal KinematicMover::sweepX(const CollisionWorld &world, const QRectF &box, qreal dx) const
+{
+    if (dx == 0) {
+        return 0;
+    }
+
+    QRectF swept = dx > 0 ? QRectF(box.right(), box.top(), dx, box.height())
+                          : QRectF(box.left() + dx, box.top(), -dx, box.height());
+
+    candidates.clear();
+    world.querySolids(swept, candidates);
+
+    for (int index : candidates) {
+        const QRectF &solid = world.solids()[index];
+
+        // Only rects sharing rows with the box can be hit
+        if (solid.top() >= box.bottom() || solid.bottom() <= box.top()) {
+            continue;
+        }
+
+        // Already overlapping - never trap the player inside a barrier
+        if (solid.left() < box.right() && solid.right() > box.left()) {
+            continue;
+        }
+
+        if (dx > 0 && solid.left() >= box.right()) {
+            dx = qMin(dx, solid.left() - box.right());
+        } else if (dx < 0 && solid.right() <= box.left()) {
+            dx = qMax(dx, solid.right() - box.left());
+        }
+    }
+
+    return dx;
+}
+
+qreal KinematicMover::sweepY(const CollisionWorld &world, const QRectF &box, qreal dy) const
+{
+    if (dy == 0) {
+        return 0;
+    }
+
+    QRectF swept = dy > 0 ? QRectF(box.left(), box.bottom(), box.width(), dy)
+                          : QRectF(box.left(), box.top() + dy, box.width(), -dy);
+
+    candidates.clear();
+    world.querySolids(swept, candidates);
+
+    for (int index : candidates) {
+        const QRectF &solid = world.solids()[index];
+
+        if (solid.left() >= box.right() || solid.right() <= box.left()) {
+            continue;
+        }
+
+        if (solid.top() < box.bottom() && solid.bottom() > box.top()) {
+            continue;
+        }
+
+        if (dy > 0 && solid.top() >= box.bottom()) {
+            dy = qMin(dy, solid.top() - box.bottom());
+        } else if (dy < 0 && solid.bottom() <= box.top()) {
+            dy = qMax(dy, solid.bottom() - box.top());
+        }
+    }
+
+    // One-way rule: coming from below, the top of the box may not climb
+    // past a ledge's bottom edge. Jumping down is always allowed.
+    if (dy < 0) {
+        candidates.clear();
+        world.queryLedges(swept, candidates);
+
+        for (int index : candidates) {
+            const QRectF &ledge = world.ledges()[index];
+
+            if (ledge.left() >= box.right() || ledge.right() <= box.left()) {
+                continue;
+            }
+
+            if (box.top() > ledge.top()) {
+                dy = qMax(dy, qMin<qreal>(0, ledge.bottom() - box.top()));
+            }
+        }
+    }
+
+    return dy;
+}
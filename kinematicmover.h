@@ -0,0 +1,38 @@
+#ifndef KINEMATICMOVER_H
+#define KINEMATICMOVER_H
+
+#include <QPointF>
+#include <QRectF>
+#include <QVector>
+
+class CollisionWorld;
+
+// Moves a hitbox through a CollisionWorld without tunnelling.
+//
+// Each axis is swept separately: the box travels until it touches the
+// first solid in its path and stops flush against it, and a blocked axis
+// does not cancel the other one, so the player slides along walls. Ledges
+// only stop upward movement that would climb them from below.
+class KinematicMover
+{
+public:
+    struct Result {
+        QPointF position;
+        bool blockedX{false};
+        bool blockedY{false};
+    };
+
+    // hitbox: collision box relative to the sprite position (player feet by default)
+    explicit KinematicMover(const QRectF &hitbox = QRectF(5, 30, 25, 18));
+
+    Result move(const CollisionWorld &world, const QPointF &position, const QPointF &delta) const;
+
+private:
+    QRectF hitbox;
+    mutable QVector<int> candidates;  // Reused between sweeps
+
+    qreal sweepX(const CollisionWorld &world, const QRectF &box, qreal dx) const;
+    qreal sweepY(const CollisionWorld &world, const QRectF &box, qreal dy) const;
+};
+
+#endif // KINEMATICMOVER_H
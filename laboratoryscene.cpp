@@ -1,95 +1,106 @@
 #include "laboratoryscene.h"
+#include "allocationtracker.h"
 #include "game.h"
+#include "maplayout.h"
+#include "simulation.h"
+#include "spritecache.h"
+#include "stringtable.h"
+#include "warmup.h"
+#include "worldstreamer.h"
 #include <QDebug>
-#include <QGraphicsTextItem>
 #include <QFont>
 #include <QDirIterator>
 #include <QApplication>
 #include <QGuiApplication>
-#include <QTextDocument>
+
+// Where the professor stands, in the lab's own coordinates
+const QPointF NPC_POS(195, 105);
 
 LaboratoryScene::LaboratoryScene(Game *game, QGraphicsScene *scene, QObject *parent)
     : Scene(game, scene, parent)
 {
-    // Create update timer
-    updateTimer = new QTimer(this);
-    connect(updateTimer, &QTimer::timeout, this, &LaboratoryScene::updateScene);
-    updateTimer->start(100);  // Update every 100ms
-    
-    // Create movement timer for continuous walking
-    movementTimer = new QTimer(this);
-    connect(movementTimer, &QTimer::timeout, this, &LaboratoryScene::processMovement);
-    movementTimer->setInterval(60);  // smaller number = faster walking speed
+    // Frames run while something moves and stop once the scene is still;
+    // input and new simulation snapshots start them again
+    frameLoop = new FrameLoop(16, this);
+    connect(frameLoop, &FrameLoop::frame, this, [this]() {
+        updateScene();
+        frameLoop->frameDone(this->game->getScripts()->needsTick());
+    });
+    connect(game->getSimulation(), &Simulation::snapshotPublished, frameLoop, &FrameLoop::wake, Qt::QueuedConnection);
 }
 
 LaboratoryScene::~LaboratoryScene()
 {
     cleanup();
-    if (updateTimer) {
-        updateTimer->stop();
-    delete updateTimer;
-    }
-    if (movementTimer) {
-        movementTimer->stop();
-        delete movementTimer;
-    }
 }
 
 void LaboratoryScene::initialize()
 {
     qDebug() << "Initializing Laboratory Scene";
 
-    // Debug: print all available resources
-    printAvailableResources();
-
     // Create scene elements
+    collisionWorld.clear();
+    pendingArea = -1;
     createBackground();
     createNPC();
     createLabTable();
     createBarriers();
+    // Usually prebuilt while the title screen was up
+    if (const WarmUp::AreaWorld *prebuilt = game->getWarmUp()->world(MapLayout::AREA_LAB)) {
+        collisionWorld = prebuilt->collision;
+        pathfinder = prebuilt->pathfinder;
+    } else {
+        buildWorld(collisionWorld, pathfinder);
+    }
     createPlayer();
+}
 
-    // Set initial camera position to center lab in view
-    centerLabInitially();
+void LaboratoryScene::addToWorld(WorldContent &content)
+{
+    // Game adds the door out. The professor and the table answer to where
+    // the player stands and faces, so the lab needs no other volumes.
+    content.addCollision(collisionWorld);
 
-    // Start update timer
-    updateTimer->start(16); // 60 FPS
-    // Start movement timer for continuous movement
-    movementTimer->start(100);
+    WorldContent::Walk &walk = content.walks[MapLayout::AREA_LAB];
+    walk.bounds = MapLayout::areaRect(MapLayout::AREA_LAB).adjusted(0, 0, -25, -58);
+    walk.baseSpeed = 6;
+    walk.fastSpeed = 9;  // 50% faster after a few steps
 }
 
-void LaboratoryScene::centerLabInitially()
+void LaboratoryScene::enterArea(const QPointF &position)
 {
-    // Calculate the position to center the lab in the larger scene
-    float labOffsetX = (SCENE_WIDTH - LAB_WIDTH) / 2;
-    float labOffsetY = (SCENE_HEIGHT - LAB_HEIGHT) / 2;
-    
-    // The background is already positioned in createBackground, so we don't reposition it here
-    
-    // Don't reposition NPC and Pokeballs - they're already positioned in their create methods
-    // Skip repositioning NPCs and Pokeballs to avoid conflicts
-    qDebug() << "centerLabInitially: Using NPC position set in createNPC";
-    qDebug() << "centerLabInitially: Using Pokeball positions set in createLabTable";
-    
-    // Position the player in the lab (with offset)
-    playerPos.setX(labOffsetX + 220);
-    playerPos.setY(labOffsetY + 350);
-    
+    qDebug() << "Player entered the lab at" << position.x() << "," << position.y();
+    playerPos = position;
+    pendingArea = -1;
     if (playerItem) {
         playerItem->setPos(playerPos);
-        qDebug() << "Player positioned at:" << playerPos;
-    }
-    
-    // Position barriers
-    for (QGraphicsRectItem* barrier : barrierItems) {
-        QRectF rect = barrier->rect();
-        barrier->setRect(rect.x() + labOffsetX, rect.y() + labOffsetY, rect.width(), rect.height());
+        playerItem->setVisible(true);
     }
-    
-    // Initial camera setup - center on the player
+    updatePlayerFreeze();
     updateCamera();
-    
-    qDebug() << "Laboratory scene initialized with camera following player";
+
+    // Start the frame loop
+    frameLoop->start();
+}
+
+void LaboratoryScene::leaveArea()
+{
+    frameLoop->stop();
+
+    // An event still waiting for the player must not resume once they have left
+    game->getScripts()->stop();
+    if (isDialogueActive) {
+        closeDialogue();
+    }
+    if (isBagOpen) {
+        toggleBag();
+    }
+    if (playerItem) {
+        playerItem->setVisible(false);
+    }
+    if (debugOverlay) {
+        debugOverlay->hideAllocationStats();
+    }
 }
 
 void LaboratoryScene::cleanup()
@@ -97,374 +108,210 @@ void LaboratoryScene::cleanup()
     qDebug() << "Cleaning up laboratory scene";
     
     // Stop timers first
-    if (updateTimer && updateTimer->isActive()) {
-        updateTimer->stop();
-    }
-    
-    if (movementTimer && movementTimer->isActive()) {
-        movementTimer->stop();
-    }
+    frameLoop->stop();
+
+    // An event still waiting for the player must not resume in an unloaded scene
+    game->getScripts()->stop();
 
     // Clear bag display items explicitly
     clearBagDisplayItems();
-    
-    // Reset movement state
-    currentPressedKey = 0;
-    pressedKeys.clear();
 
     // We shouldn't remove or delete scene items here since the scene is managed by Game
     // Just reset our pointers so we don't try to use them later
-    backgroundItem = nullptr;
     playerItem = nullptr;
-    npcItem = nullptr;
     labTableItem = nullptr;
-    barrierItems.clear();
-    pokeBallItems.clear();
-    transitionBoxItem = nullptr;
+    barrierRects.clear();
+    collisionWorld.clear();
+    pathfinder.clear();
+    pendingArea = -1;
+    debugOverlay = nullptr;
+
+    // Game's WorldStreamer drops the NPC and Pokéball sprites
+    npcSprite = -1;
+    pokeBallSprites.clear();
     
     // Don't clear the scene, as it's managed by Game
     qDebug() << "Laboratory scene cleanup complete";
 }
 
-void LaboratoryScene::handleKeyPress(int key)
+void LaboratoryScene::handleAction(InputSystem::Action action)
 {
-    qDebug() << "Lab scene key pressed:" << key;
+    frameLoop->wake();
+
+    qDebug() << "Lab scene action:" << action;
 
-    // If bag is open, only allow B key to close it
+    // If bag is open, only allow the menu key (B) to close it
     if (isBagOpen) {
-        if (key == Qt::Key_B) {
+        if (action == InputSystem::MENU) {
             toggleBag();
         }
         return; // Block all other key presses while bag is open
     }
 
-    // If dialogue is active, only allow A to advance or number keys for Pokémon selection
+    // If dialogue is active, only allow confirm (A) to advance or a number to answer a choice
     if (isDialogueActive) {
-        if (pokemonSelectionActive && (key == Qt::Key_1 || key == Qt::Key_2 || key == Qt::Key_3)) {
-            handlePokemonSelection(key);
+        ScriptEngine *scripts = game->getScripts();
+        if (scripts->isWaitingForChoice()) {
+            if (InputSystem::selection(action) > 0) {
+                scripts->choose(InputSystem::selection(action));
+            } else if (action == InputSystem::CANCEL) {
+                // Back out without taking a Pokémon; the balls stay on the table
+                scripts->cancel();
+            }
             return;
         }
         
-        if (key == Qt::Key_A) {
+        if (action == InputSystem::CONFIRM) {
             handleDialogue();
         }
         return;
     }
 
-    // Add key to pressed keys set for movement
-    pressedKeys.insert(key);
-    qDebug() << "Key pressed: " << key;
-
-    // For arrow keys, set as current pressed key for continuous movement
-    // and also take a small step immediately for responsive feel
-    if (key == Qt::Key_Up || key == Qt::Key_Down || key == Qt::Key_Left || key == Qt::Key_Right) {
-        QPointF prevPos = playerPos;
-        bool moved = false;
-        
-        // Take immediate step (5 pixels) - more reliable than 3 pixels
-        if (key == Qt::Key_Up) {
-            playerDirection = "B";
-            playerPos.setY(playerPos.y() - 5);
-            moved = true;
-        } else if (key == Qt::Key_Down) {
-            playerDirection = "F";
-            playerPos.setY(playerPos.y() + 5);
-            moved = true;
-        } else if (key == Qt::Key_Left) {
-            playerDirection = "L";
-            playerPos.setX(playerPos.x() - 5);
-            moved = true;
-        } else if (key == Qt::Key_Right) {
-            playerDirection = "R";
-            playerPos.setX(playerPos.x() + 5);
-            moved = true;
-        }
-        
-        if (moved) {
-            // Calculate the lab offset for boundary checking
-            float labOffsetX = (SCENE_WIDTH - LAB_WIDTH) / 2;
-            float labOffsetY = (SCENE_HEIGHT - LAB_HEIGHT) / 2;
-            
-            // Boundary checking - don't allow player to go outside lab area
-            if (playerPos.x() < labOffsetX) {
-                playerPos.setX(labOffsetX);
-            } else if (playerPos.x() > labOffsetX + LAB_WIDTH - 25) {
-                playerPos.setX(labOffsetX + LAB_WIDTH - 25);
-            }
-
-            if (playerPos.y() < labOffsetY) {
-                playerPos.setY(labOffsetY);
-            } else if (playerPos.y() > labOffsetY + LAB_HEIGHT - 63) {  // Raised by 10 more pixels (from -53 to -63)
-                // Strictly prevent walking outside the lab at the bottom
-                playerPos.setY(labOffsetY + LAB_HEIGHT - 63);
-            }
-            
-            // Collision check
-            QRectF playerRect(playerPos.x() + 5, playerPos.y() + 30, 25, 18);
-            bool collision = false;
-            
-            for (const QGraphicsRectItem* barrier : barrierItems) {
-                QRectF barrierRect = barrier->rect();
-                if (playerRect.intersects(barrierRect)) {
-                    collision = true;
-                    break;
-                }
-            }
-            
-            if (collision) {
-                playerPos = prevPos;
-            } else {
-                // Update position and sprite
-                if (playerItem) {
-                    playerItem->setPos(playerPos);
-                    qDebug() << "Immediate step: player position updated to:" << playerPos;
-                }
-                walkFrame = (walkFrame + 1) % 3;
-                updatePlayerSprite();
-                updateCamera();
-            }
-        }
-        
-        // Set current key for continuous movement
-        currentPressedKey = key;
-        // Start the movement timer if it's not already running
-        if (!movementTimer->isActive()) {
-            movementTimer->start(100);
-        }
-    }
+    // Arrow keys already reached the simulation through Game's input state:
+    // one short step right away, then steps for as long as the key stays down
 
-    // Check for B key to open bag
-    if (key == Qt::Key_B) {
+    // Menu key (B) opens the bag
+    if (action == InputSystem::MENU) {
         toggleBag();
         return;
     }
 
-    // Check for A key to interact with NPCs or objects
-    if (key == Qt::Key_A) {
+    // Confirm (A) interacts with NPCs or objects
+    if (action == InputSystem::CONFIRM) {
         if (isPlayerNearNPC()) {
-            if (!isDialogueActive) {
-                currentDialogueState = 0;
-                handleDialogue();
-            }
+            game->getScripts()->start("lab_professor", this);
         } else if (isPlayerNearDoor()) {
-            showDialogue("Would you like to go outside to the town?");
-            currentDialogueState = 2; // Special state for door dialogue
+            game->getScripts()->start("lab_door", this);
         } else {
             int ballIndex = -1;
             if (isPlayerNearPokeball(ballIndex)) {
-                startPokemonSelection();
+                game->getScripts()->start("lab_pokeball", this);
             }
         }
     }
 }
 
-void LaboratoryScene::handleKeyRelease(int key)
+void LaboratoryScene::handleActionRelease(InputSystem::Action action)
 {
-    // Remove key from pressed keys set
-    pressedKeys.remove(key);
-    
-    // If the released key was the current movement key, reset it
-    if (key == currentPressedKey) {
-        currentPressedKey = 0;
-        
-        // Stop the movement timer if no arrow keys are pressed
-        if (!pressedKeys.contains(Qt::Key_Up) && 
-            !pressedKeys.contains(Qt::Key_Down) && 
-            !pressedKeys.contains(Qt::Key_Left) && 
-            !pressedKeys.contains(Qt::Key_Right)) {
-            movementTimer->stop();
-        }
-    }
+    Q_UNUSED(action);
+
+    // The simulation already saw the release through the input state
+    frameLoop->wake();
 }
 
-void LaboratoryScene::processMovement()
+void LaboratoryScene::applySimulationSnapshot()
 {
-    // Do nothing if no key is pressed or dialogue/bag is open
-    if (currentPressedKey == 0 || isDialogueActive || isBagOpen) {
+    AllocationTracker::Scope allocationScope(AllocationTracker::WALK);
+    WorldSnapshot snapshot;
+    if (!game->takeWorldSnapshot(snapshot)) {
         return;
     }
-    
-    QPointF prevPos = playerPos;
-    bool moved = false;
-
-    // Calculate the position to center the lab in the larger scene
-    float labOffsetX = (SCENE_WIDTH - LAB_WIDTH) / 2;
-    float labOffsetY = (SCENE_HEIGHT - LAB_HEIGHT) / 2;
+    // The items below show the step the press asked for from the next paint
+    game->getInput()->markApplied(snapshot.inputNs, InputSystem::WALK_LATENCY);
 
-    // Speed increases after holding the key for some time
-    static int stepCounter = 0;
-    int moveSpeed = 6;
-    
-    // Increase speed by 50% after a few steps (not 100%)
-    if (stepCounter > 3) {
-        moveSpeed = 9; // 50% faster (not twice as fast)
-    }
-
-    // Movement based on currently pressed key
-    if (currentPressedKey == Qt::Key_Up) {
-        playerPos.setY(playerPos.y() - moveSpeed);
-        playerDirection = "B";
-        moved = true;
-    } else if (currentPressedKey == Qt::Key_Down) {
-        playerPos.setY(playerPos.y() + moveSpeed);
-        playerDirection = "F";
-        moved = true;
-    } else if (currentPressedKey == Qt::Key_Left) {
-        playerPos.setX(playerPos.x() - moveSpeed);
-        playerDirection = "L";
-        moved = true;
-    } else if (currentPressedKey == Qt::Key_Right) {
-        playerPos.setX(playerPos.x() + moveSpeed);
-        playerDirection = "R";
-        moved = true;
+    // Written in place: assigning a new QString would allocate on every turn
+    const QChar direction = QLatin1Char(snapshot.direction);
+    if (direction != playerDirection.at(0) || snapshot.walkFrame != walkFrame) {
+        playerDirection[0] = direction;
+        walkFrame = snapshot.walkFrame;
+        updatePlayerSprite();
     }
 
-    if (moved) {
-        // Boundary checking - don't allow player to go outside lab area
-        if (playerPos.x() < labOffsetX) {
-            playerPos.setX(labOffsetX);
-        } else if (playerPos.x() > labOffsetX + LAB_WIDTH - 25) {
-            playerPos.setX(labOffsetX + LAB_WIDTH - 25);
-        }
-
-        if (playerPos.y() < labOffsetY) {
-            playerPos.setY(labOffsetY);
-        } else if (playerPos.y() > labOffsetY + LAB_HEIGHT - 58) {  // Changed from -63 to -58 (5 pixels lower)
-            // Strictly prevent walking outside the lab at the bottom
-            playerPos.setY(labOffsetY + LAB_HEIGHT - 58);
-        }
-
-        // Check collision with barriers using a smaller hitbox at player's feet
-        QRectF playerRect(playerPos.x() + 5, playerPos.y() + 30, 25, 18);
-        bool collision = false;
-        
-        for (const QGraphicsRectItem* barrier : barrierItems) {
-            QRectF barrierRect = barrier->rect();
-            if (playerRect.intersects(barrierRect)) {
-                collision = true;
-                break;
-            }
+    if (snapshot.playerPos != playerPos) {
+        playerPos = snapshot.playerPos;
+        if (playerItem) {
+            playerItem->setPos(playerPos);
         }
+        updateCamera();
+    }
 
-        if (collision) {
-            playerPos = prevPos;
-            stepCounter = 0; // Reset counter when collision occurs
-        } else {
-            // Check if player is on the transition area
-            if (isPlayerOnTransitionArea()) {
-                // Reset movement state before changing scene
-                currentPressedKey = 0;
-                pressedKeys.clear();
-                movementTimer->stop();
-                stepCounter = 0; // Reset counter when transitioning
-                
-                // Transition to Town scene
-                qDebug() << "Player is on transition area - changing to Town scene";
-                game->changeScene(GameState::TOWN);
-                return;
-            }
-            
-            // Update walk frame only if we actually moved
-            walkFrame = (walkFrame + 1) % 3;
-            stepCounter++; // Increment counter only when movement is successful
-            
-            // Update player visual position
-            if (playerItem) {
-                playerItem->setPos(playerPos);
-                qDebug() << "Continuous movement: player position updated to:" << playerPos;
-            }
-            
-            // Update player sprite based on direction and walk frame
-            updatePlayerSprite();
-            
-            // Update camera to follow player
-            updateCamera();
+    // The door's portal volume is tested on the simulation thread and
+    // numbered as MapLayout::portalLinks()
+    const QVector<MapLayout::PortalLink> portals = MapLayout::portalLinks();
+    for (int i = snapshot.firstNewEvent; i < snapshot.events.size(); ++i) {
+        const WorldEvent &event = snapshot.events[i];
+        if (event.type == WorldEvent::TRIGGER_ENTERED && event.trigger == TriggerSystem::Kind::Portal
+            && event.index >= 0 && event.index < portals.size()) {
+            pendingArea = portals[event.index].to;
         }
-    } else {
-        stepCounter = 0; // Reset counter if no movement happened
     }
 }
 
 void LaboratoryScene::updateScene()
 {
+    // Everything allocated from here on counts towards this frame
+    AllocationTracker::beginFrame();
+    if (debugOverlay) {
+        debugOverlay->showAllocationStats(cameraPos);
+    }
+
+    // Menu and dialogue actions from this tick's input sample
+    game->pollInput();
+    if (game->getCurrentScene() != this) {
+        return;
+    }
+
+    // Events that used up their step budget carry on here
+    {
+        AllocationTracker::Scope allocationScope(AllocationTracker::SCRIPTS);
+        game->getScripts()->tick();
+    }
+
     // If bag is open or dialogue is active, don't update
     if (isBagOpen || isDialogueActive) {
         return;
     }
 
-    // This method now just handles general scene updates
-    // Movement is handled by processMovement when arrow keys are pressed
-}
+    applySimulationSnapshot();
 
-void LaboratoryScene::createBackground()
-{
-    // First create a large black background for the entire scene
-    QGraphicsRectItem* blackBackground = scene->addRect(0, 0, SCENE_WIDTH, SCENE_HEIGHT, 
-        QPen(Qt::transparent), QBrush(Qt::black));
-    blackBackground->setZValue(-1);
-    qDebug() << "Black background created with size:" << SCENE_WIDTH << "x" << SCENE_HEIGHT;
-
-    // Load laboratory background
-    QPixmap background(":/Dataset/Image/scene/lab.png");
-
-    if (background.isNull()) {
-        qDebug() << "Laboratory background image not found. Check the path.";
-        background = QPixmap(LAB_WIDTH, LAB_HEIGHT);
-        background.fill(Qt::white);
-    } else {
-        qDebug() << "Laboratory background loaded successfully, size:" << background.width() << "x" << background.height();
-        
-        // Scale the image to match our desired lab dimensions if needed
-        if (background.height() < LAB_HEIGHT) {
-            background = background.scaled(LAB_WIDTH, LAB_HEIGHT, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
-            qDebug() << "Laboratory background scaled to:" << background.width() << "x" << background.height();
-        }
+    // Hand the player over once they have stepped onto the door, here
+    // rather than in the snapshot handler so nothing in the lab runs on
+    // after the next area has taken over
+    if (pendingArea >= 0) {
+        qDebug() << "Player left the lab for area" << pendingArea;
+        const GameState next = Game::areaState(static_cast<MapLayout::Area>(pendingArea));
+        pendingArea = -1;
+        game->changeScene(next);
     }
+}
 
-    // Calculate the position to center the lab in the larger scene
-    float labOffsetX = (SCENE_WIDTH - LAB_WIDTH) / 2;
-    float labOffsetY = (SCENE_HEIGHT - LAB_HEIGHT) / 2;
-
-    backgroundItem = scene->addPixmap(background);
-    backgroundItem->setPos(labOffsetX, labOffsetY);  // Center the lab in the scene
-    backgroundItem->setZValue(0);
+void LaboratoryScene::updatePlayerFreeze()
+{
+    // The player stands still while the bag or a dialogue is open
+    game->getSimulation()->setFrozen(isBagOpen || isDialogueActive);
+}
 
-    qDebug() << "Laboratory background positioned at:" << labOffsetX << "," << labOffsetY;
-    
-    // Create a blue transition area at the bottom of the lab that covers only the red door
-    // Make it square in shape to cover exactly the red door object
-    QRect transitionRect(LAB_WIDTH/2 - 24, LAB_HEIGHT - 37, 55, 38);  
-    QGraphicsRectItem* transitionArea = scene->addRect(transitionRect, QPen(Qt::blue, 2), QBrush(QColor(0, 0, 255, 100)));
-    transitionArea->setPos(labOffsetX, labOffsetY);
-    transitionArea->setZValue(1);
-    transitionBoxItem = transitionArea; // Store reference to the transition box
-    
-    // Make sure the scene background is also black
+void LaboratoryScene::createBackground()
+{
+    // Game's WorldStreamer streams the laboratory background in chunks
+    // around the camera; the frame around the lab shows black
     scene->setBackgroundBrush(Qt::black);
+
+    // The door out of the lab covers only the red mat. Debug builds outline
+    // it (and the barriers) in a single overlay item.
+    debugOverlay = DebugOverlayItem::create(scene);
+    if (debugOverlay) {
+        debugOverlay->addRect(MapLayout::toWorld(MapLayout::AREA_LAB, MapLayout::labDoor()),
+                              QPen(Qt::blue, 2), QBrush(QColor(0, 0, 255, 100)));
+    }
 }
 
 void LaboratoryScene::createNPC()
 {
     // Load NPC sprite using the correct path
-    QPixmap npcSprite(":/Dataset/Image/NPC.png");
-    if (npcSprite.isNull()) {
+    QPixmap npcPixmap(":/Dataset/Image/NPC.png");
+    if (npcPixmap.isNull()) {
         qDebug() << "NPC sprite not found at :/Dataset/Image/NPC.png, creating a placeholder";
         // Create a placeholder since the image doesn't exist
-        npcSprite = QPixmap(35, 48);
-        npcSprite.fill(Qt::blue);
+        npcPixmap = QPixmap(35, 48);
+        npcPixmap.fill(Qt::blue);
     }
     
-    // Calculate the position to center the lab in the larger scene
-    float labOffsetX = (SCENE_WIDTH - LAB_WIDTH) / 2;
-    float labOffsetY = (SCENE_HEIGHT - LAB_HEIGHT) / 2;
-    
     // Position NPC in the upper center of the lab aligned with the barrier at (116,60)
-    // Adjusted to better position
-    QPointF npcPos(labOffsetX + 195, labOffsetY + 105); // Moved up from 255
+    QPointF npcPos = MapLayout::toWorld(MapLayout::AREA_LAB, NPC_POS);
     
-    npcItem = scene->addPixmap(npcSprite);
-    npcItem->setPos(npcPos);
-    npcItem->setZValue(3); // Same as player
+    // Same z as the player; shown while the camera is near it
+    npcSprite = game->getWorldStreamer()->addSprite(npcPixmap, npcPos, 3);
     qDebug() << "NPC positioned at:" << npcPos;
 }
 
@@ -482,17 +329,12 @@ void LaboratoryScene::createPlayer()
     }
 
     playerItem = scene->addPixmap(playerSprite);
-    playerItem->setPos(playerPos); // Set initial position without camera offset
     playerItem->setZValue(3); // Ensure player is on top of other elements
-    qDebug() << "Initial player position:" << playerPos.x() << playerPos.y();
+    playerItem->setVisible(false); // Until the player enters the lab
 }
 
 void LaboratoryScene::createLabTable()
 {
-    // Calculate the position to center the lab in the larger scene
-    float labOffsetX = (SCENE_WIDTH - LAB_WIDTH) / 2;
-    float labOffsetY = (SCENE_HEIGHT - LAB_HEIGHT) / 2;
-
     // Create Pokeball sprites using the correct path
     QPixmap pokeBallPixmap(":/Dataset/Image/ball.png");
     if (pokeBallPixmap.isNull()) {
@@ -513,95 +355,42 @@ void LaboratoryScene::createLabTable()
     
     // Position the Pokeballs on the table using the barrier coordinates (116,60, 100, 67)
     // Center the balls horizontally on the table with equal spacing
-    float tableCenter = labOffsetX + 312; // Center X of table barrier
+    float tableCenter = 312; // Center X of table barrier
     float ballSpacing = 30; // Space between balls
     
-    // Adjusted to better position
-    QPointF ballPos1(tableCenter - ballSpacing, labOffsetY + 185); // Moved up from 220
-    QPointF ballPos2(tableCenter, labOffsetY + 185);              // Moved up from 220
-    QPointF ballPos3(tableCenter + ballSpacing, labOffsetY + 185); // Moved up from 220
-    
-    QGraphicsPixmapItem* ball1 = scene->addPixmap(pokeBallPixmap);
-    QGraphicsPixmapItem* ball2 = scene->addPixmap(pokeBallPixmap);
-    QGraphicsPixmapItem* ball3 = scene->addPixmap(pokeBallPixmap);
-    
-    ball1->setPos(ballPos1);
-    ball2->setPos(ballPos2);
-    ball3->setPos(ballPos3);
-    
-    ball1->setZValue(2);
-    ball2->setZValue(2);
-    ball3->setZValue(2);
-    
-    pokeBallItems.append(ball1);
-    pokeBallItems.append(ball2);
-    pokeBallItems.append(ball3);
+    for (int i = -1; i <= 1; ++i) {
+        QPointF ballPos = MapLayout::toWorld(MapLayout::AREA_LAB, QPointF(tableCenter + i * ballSpacing, 185));
+        pokeBallSprites.append(game->getWorldStreamer()->addSprite(pokeBallPixmap, ballPos, 2));
+    }
     
-    qDebug() << "Created pokeballs at:" << ballPos1 << ballPos2 << ballPos3;
+    qDebug() << "Created" << pokeBallSprites.size() << "pokeballs on the lab table";
+}
+
+void LaboratoryScene::buildWorld(CollisionWorld &world, Pathfinder &pathfinder)
+{
+    for (const QRectF &rect : MapLayout::toWorld(MapLayout::AREA_LAB, MapLayout::labBarriers())) {
+        world.addSolid(rect);
+    }
+    pathfinder.build(world, MapLayout::areaRect(MapLayout::AREA_LAB).adjusted(0, 0, -25, -58));
 }
 
 void LaboratoryScene::createBarriers()
 {
-    // Calculate the position to center the lab in the larger scene
-    float labOffsetX = (SCENE_WIDTH - LAB_WIDTH) / 2;
-    float labOffsetY = (SCENE_HEIGHT - LAB_HEIGHT) / 2;
-    
-    // Define barrier rectangles relative to the lab position
-    QVector<QRect> barrierRects = {
-        // Left wall area
-        QRect(-157, -100, LAB_WIDTH, 90),
-        QRect(-157, 10, 30, 90),
-        QRect(-125, 32, 70, 105), // red dot machine
-        QRect(-157, 215, 170, 80), //left bookshelf
-        QRect(118, 215, 170, 80), //right bookshelf
-        QRect(-157, 377, 33, 70), //left plant
-        QRect(245, 377, 33, 70), //right plant
-        QRect(116,60, 100, 67), //pokeball table
-        QRect(41, 7, 33, 46), //NPC
-    };
-    
-    // Add barriers (with visible red outlines for debugging)
-    for (const QRect &rect : barrierRects) {
-        QRect adjustedRect(rect.x() + labOffsetX, rect.y() + labOffsetY, rect.width(), rect.height());
-        QGraphicsRectItem *barrier = scene->addRect(adjustedRect, QPen(Qt::red, 1), QBrush(Qt::transparent));
-        // use below one if you want to make barriers invisible
-        //QGraphicsRectItem *barrier = scene->addRect(adjustedRect, QPen(Qt::transparent), QBrush(Qt::transparent));
-        barrier->setZValue(5); // Higher zValue to be visible for debugging
-        barrierItems.append(barrier);
+    // Barrier rectangles come from the shared map layout, moved to where the lab is in the world.
+    // They are plain rects; debug builds outline them in the overlay item.
+    barrierRects = MapLayout::toWorld(MapLayout::AREA_LAB, MapLayout::labBarriers());
+    if (debugOverlay) {
+        debugOverlay->addRects(barrierRects, QPen(Qt::red, 1));
     }
     
-    qDebug() << "Created" << barrierItems.size() << "barriers for laboratory at lab offset:" << labOffsetX << "," << labOffsetY;
+    qDebug() << "Created" << barrierRects.size() << "barriers for laboratory";
 }
 
 void LaboratoryScene::updatePlayerSprite()
 {
-    QString basePath = ":/Dataset/Image/player/player_";
-    QString spritePath;
-
-    // If not moving or first frame, use the base sprite for that direction
-    if (walkFrame == 0) {
-        spritePath = basePath + playerDirection + ".png";
-    } else {
-        // Use the walking animation frames (W1 or W2)
-        spritePath = basePath + playerDirection + "W" + QString::number(walkFrame) + ".png";
-    }
-    
-    QPixmap playerSprite(spritePath);
-    
-    if (playerSprite.isNull()) {
-        qDebug() << "Failed to load sprite:" << spritePath;
-        // Fallback to default sprite if animation frame not found
-        if (playerDirection == "F") {
-            playerSprite = QPixmap(":/Dataset/Image/player/player_F.png");
-        } else {
-            // If even the fallback fails, create a colored rectangle
-            playerSprite = QPixmap(35, 48);
-            playerSprite.fill(Qt::red);
-        }
-    }
-    
+    // Walk frames are decoded once and shared, so a step only swaps pixmaps
     if (playerItem) {
-        playerItem->setPixmap(playerSprite);
+        playerItem->setPixmap(SpriteCache::instance().playerFrame(playerDirection.at(0), walkFrame));
     }
 }
 
@@ -621,6 +410,7 @@ void LaboratoryScene::toggleBag()
         // Update the display to show the Pokémon in the bag
         updateBagDisplay();
     }
+    updatePlayerFreeze();
 }
 
 // Method to clear all bag display items
@@ -763,7 +553,7 @@ void LaboratoryScene::updateBagDisplay()
                 
                 // Add count text ("x1", "x2", etc.)
                 QFont countFont("Arial", 10, QFont::Bold);
-                QGraphicsTextItem* countText = scene->addText("x" + QString::number(count), countFont);
+                BitmapTextItem* countText = BitmapTextItem::create(scene, "x" + QString::number(count), countFont);
                 countText->setDefaultTextColor(Qt::black);
                 countText->setZValue(102);
                 // Position text closer to icon to save space
@@ -805,24 +595,19 @@ void LaboratoryScene::updateBagDisplay()
     for (int i = 0; i < playerPokemon.size() && i < 4; i++) {
         Pokemon* pokemon = playerPokemon[i];
         
-        // Load the Pokémon image
-        QPixmap pokemonImage(pokemon->getImagePath());
+        // Shared icon, already scaled to fit the row height
+        QPixmap pokemonImage = SpriteCache::instance().sprite(pokemon->getName(), SpriteCache::BAG_ICON);
         if (pokemonImage.isNull()) {
             qDebug() << "Failed to load Pokémon image for" << pokemon->getName() << "at" << pokemon->getImagePath();
             continue;
         }
         
-        // Scale the image to fit the row height
-        pokemonImage = pokemonImage.scaled(ROW_HEIGHT, ROW_HEIGHT, 
-                                          Qt::KeepAspectRatio, 
-                                          Qt::SmoothTransformation);
-        
         // Calculate row position with even spacing
         float rowY = startY + i * (ROW_HEIGHT + ROW_SPACING);
         
         // Create the Pokémon name text first (on the left)
         QFont nameFont("Arial", 12, QFont::Bold);
-        QGraphicsTextItem* nameText = scene->addText(pokemon->getName(), nameFont);
+        BitmapTextItem* nameText = BitmapTextItem::create(scene, StringTable::name(pokemon->getName()), nameFont);
         nameText->setDefaultTextColor(Qt::black);
         nameText->setZValue(102); // Above both bag and row
         
@@ -864,12 +649,13 @@ void LaboratoryScene::updateCamera()
     targetCameraPos.setX(playerCenter.x() - VIEW_WIDTH / 2);
     targetCameraPos.setY(playerCenter.y() - VIEW_HEIGHT / 2);
     
-    // Calculate boundary constraints for the entire scene, not just the lab
+    // Calculate boundary constraints for the frame around the lab, not just the lab
     // These define the limits of camera movement ensuring black background is visible on both sides
-    float minCameraX = 0; // Left edge of the entire scene
-    float maxCameraX = SCENE_WIDTH - VIEW_WIDTH; // Right edge of the entire scene
-    float minCameraY = 0; // Top edge of the entire scene
-    float maxCameraY = SCENE_HEIGHT - VIEW_HEIGHT; // Bottom edge of the entire scene
+    const QRectF region = MapLayout::regionRect(MapLayout::AREA_LAB);
+    float minCameraX = region.left(); // Left edge of the frame
+    float maxCameraX = region.right() - VIEW_WIDTH; // Right edge of the frame
+    float minCameraY = region.top(); // Top edge of the frame
+    float maxCameraY = region.bottom() - VIEW_HEIGHT; // Bottom edge of the frame
     
     // Apply constraints - prevent camera from going outside the entire scene
     if (targetCameraPos.x() < minCameraX) targetCameraPos.setX(minCameraX);
@@ -882,6 +668,7 @@ void LaboratoryScene::updateCamera()
     
     // Update the view
     scene->setSceneRect(cameraPos.x(), cameraPos.y(), VIEW_WIDTH, VIEW_HEIGHT);
+    game->getWorldStreamer()->setView(QRectF(cameraPos, QSizeF(VIEW_WIDTH, VIEW_HEIGHT)));
     
     // Update dialogue box position if active
     if (isDialogueActive && dialogBoxItem) {
@@ -922,7 +709,7 @@ void LaboratoryScene::showDialogueBox(const QString &text)
     
     // Create text with appropriate font
     QFont dialogFont("Arial", 12);
-    dialogTextItem = scene->addText(text, dialogFont);
+    dialogTextItem = BitmapTextItem::create(scene, text, dialogFont);
     dialogTextItem->setDefaultTextColor(Qt::black);
     
     // Position the text inside the dialogue box with some padding
@@ -932,8 +719,7 @@ void LaboratoryScene::showDialogueBox(const QString &text)
     dialogTextItem->setZValue(91); // Above dialogue box
     
     // Set text width to wrap long lines
-    QTextDocument* doc = dialogTextItem->document();
-    doc->setTextWidth(VIEW_WIDTH - 40); // Allow text to wrap
+    dialogTextItem->setTextWidth(VIEW_WIDTH - 40); // Allow text to wrap
     
     // Adjust dialog box height if needed for multiline text
     float textHeight = dialogTextItem->boundingRect().height();
@@ -944,53 +730,18 @@ void LaboratoryScene::showDialogueBox(const QString &text)
 
     // Set dialogue as active
     isDialogueActive = true;
+    updatePlayerFreeze();
 }
 
 void LaboratoryScene::handleDialogue()
 {
-    // Don't handle dialogue if we're in pokémon selection mode
-    if (pokemonSelectionActive) {
-        return;
-    }
-    
-    // If no dialogue active, check if we should trigger the NPC dialogue
-    if (!isDialogueActive) {
-        if (isPlayerNearNPC()) {
-            currentDialogueState = 0;
-            showDialogue("I am Professor Oak. Welcome to my laboratory!");
-        }
+    // Scripted dialogue decides what A does next
+    ScriptEngine *scripts = game->getScripts();
+    if (scripts->isRunning()) {
+        scripts->advance();
         return;
     }
     
-    // Handle door dialogue (special state)
-    if (currentDialogueState == 2) {
-        currentDialogueState++;
-        if (currentDialogueState == 3) {
-            // Reset movement state before changing scene
-            currentPressedKey = 0;
-            pressedKeys.clear();
-            movementTimer->stop();
-            
-            // Transition to town scene
-            closeDialogue();
-            game->changeScene(GameState::TOWN);
-            return;
-        }
-    }
-    
-    // Advance through dialogue states for NPC
-    if (isPlayerNearNPC()) {
-        currentDialogueState++;
-        
-        if (currentDialogueState == 1) {
-            showDialogue("You can choose one from three Poké Balls as your initial Pokémon in Laboratory.");
-        } else {
-            closeDialogue();
-        }
-        return;
-    }
-    
-    // For other dialogues (like pokémon selection confirmation), just close after one more press
     closeDialogue();
 }
 
@@ -1011,8 +762,7 @@ void LaboratoryScene::closeDialogue()
     
     // Reset dialogue state
     isDialogueActive = false;
-    pokemonSelectionActive = false;
-    currentDialogueState = 0;
+    updatePlayerFreeze();
 }
 
 void LaboratoryScene::showDialogue(const QString &text)
@@ -1021,14 +771,40 @@ void LaboratoryScene::showDialogue(const QString &text)
     showDialogueBox(text);
 }
 
+void LaboratoryScene::scriptSay(const QString &text)
+{
+    showDialogue(text);
+}
+
+void LaboratoryScene::scriptEnd()
+{
+    closeDialogue();
+}
+
+void LaboratoryScene::scriptGivePokemon(const QString &species)
+{
+    // The only Pokémon the lab hands out is the starter
+    Scene::scriptGivePokemon(species);
+    game->setLaboratoryCompleted(true);
+}
+
+void LaboratoryScene::scriptCall(const QString &hook)
+{
+    if (hook == "remove_pokeballs") {
+        // The player has made their choice
+        for (int ball : pokeBallSprites) {
+            game->getWorldStreamer()->removeSprite(ball);
+        }
+        pokeBallSprites.clear();
+        return;
+    }
+    Scene::scriptCall(hook);
+}
+
 bool LaboratoryScene::isPlayerNearNPC() const
 {
-    // Calculate the position to center the lab in the larger scene
-    float labOffsetX = (SCENE_WIDTH - LAB_WIDTH) / 2;
-    float labOffsetY = (SCENE_HEIGHT - LAB_HEIGHT) / 2;
-    
     // Use the same NPC position as in createNPC method
-    QPointF npcPos(labOffsetX + 195, labOffsetY + 105);
+    QPointF npcPos = MapLayout::toWorld(MapLayout::AREA_LAB, NPC_POS);
     
     // Create a larger detection area BELOW the NPC, not offset by y+40
     // This allows the player to stand in front of the NPC and interact
@@ -1044,43 +820,20 @@ bool LaboratoryScene::isPlayerNearNPC() const
     return isInRange && isFacingNPC;
 }
 
-void LaboratoryScene::printAvailableResources()
-{
-    qDebug() << "Checking for critical resources:";
-    
-    // Pokemon images
-    QStringList criticalImages = {
-        ":/Dataset/Image/battle/charmander.png",
-        ":/Dataset/Image/battle/squirtle.png",
-        ":/Dataset/Image/battle/bulbasaur.png",
-        ":/Dataset/Image/bag.png",
-        ":/Dataset/Image/dialog.png",
-        ":/Dataset/Image/ball.png"
-    };
-    
-    for (const QString& path : criticalImages) {
-        QPixmap img(path);
-        if (img.isNull()) {
-            qDebug() << "RESOURCE MISSING:" << path;
-        } else {
-            qDebug() << "Resource found:" << path;
-        }
-    }
-}
-
 bool LaboratoryScene::checkCollision()
 {
     // Boundary checking
-    if (playerPos.x() < 0 || playerPos.x() > LAB_WIDTH - 35 ||
-        playerPos.y() < 0 || playerPos.y() > LAB_HEIGHT - 48) {
+    const QRectF lab = MapLayout::areaRect(MapLayout::AREA_LAB);
+    if (playerPos.x() < lab.left() || playerPos.x() > lab.right() - 35 ||
+        playerPos.y() < lab.top() || playerPos.y() > lab.bottom() - 48) {
         return true;
     }
 
     // Check collision with barriers - use smaller hitbox at player's feet
     QRectF playerRect(playerPos.x() + 5, playerPos.y() + 30, 25, 18);
     
-    for (const QGraphicsRectItem* barrier : barrierItems) {
-        if (playerRect.intersects(barrier->rect())) {
+    for (const QRectF &barrier : barrierRects) {
+        if (playerRect.intersects(barrier)) {
             return true;
         }
     }
@@ -1099,18 +852,12 @@ void LaboratoryScene::updatePlayerPosition()
 
 bool LaboratoryScene::isPlayerNearPokeball(int &ballIndex) const
 {
-    // Calculate the position to center the lab in the larger scene
-    float labOffsetX = (SCENE_WIDTH - LAB_WIDTH) / 2;
-    float labOffsetY = (SCENE_HEIGHT - LAB_HEIGHT) / 2;
-    
     // Create a detection area covering the table and area in front, 20% smaller than before
-    // Adjust for the lab offset
     float width = 150 * 0.8;    // 20% smaller width (changed from 0.85)
     float height = 100 * 0.8;   // 20% smaller height (changed from 0.85)
-    // Adjust starting position to keep centered
-    float x = labOffsetX + 258;  // Aligned with the table barrier
-    float y = labOffsetY + 170;  // Just below the table barrier
-    QRectF tableArea(x, y, width, height);
+    // Aligned with the table barrier, just below it
+    QPointF topLeft = MapLayout::toWorld(MapLayout::AREA_LAB, QPointF(258, 170));
+    QRectF tableArea(topLeft, QSizeF(width, height));
     
     // Check if player is within the designated area
     if (tableArea.contains(playerPos)) {
@@ -1122,130 +869,12 @@ bool LaboratoryScene::isPlayerNearPokeball(int &ballIndex) const
     return false;
 }
 
-void LaboratoryScene::startPokemonSelection()
-{
-    // Check if player has already chosen a starter Pokémon
-    if (hasChosenPokemon) {
-        // Show message that they've already chosen
-        showDialogue("You have already chosen your starter Pokémon.");
-        
-        // We're not entering Pokémon selection mode, just showing a message
-        pokemonSelectionActive = false;
-        return;
-    }
-    
-    // If they haven't chosen yet, proceed with selection
-    showDialogue("Choose your Pokemon: Press 1 for Squirtle, 2 for Charmander, or 3 for Bulbasaur.");
-    
-    // Set flag to indicate we're in Pokémon selection mode
-    pokemonSelectionActive = true;
-}
-
-void LaboratoryScene::handlePokemonSelection(int key)
-{
-    int selectedIndex = -1;
-    
-    // Convert key to selection index
-    if (key == Qt::Key_1) {
-        qDebug() << "Player selected Squirtle";
-        selectedIndex = 0; // Squirtle
-    }
-    else if (key == Qt::Key_2) {
-        qDebug() << "Player selected Charmander";
-        selectedIndex = 1; // Charmander
-    }
-    else if (key == Qt::Key_3) {
-        qDebug() << "Player selected Bulbasaur";
-        selectedIndex = 2; // Bulbasaur
-    }
-    else if (key == Qt::Key_Escape) {
-        qDebug() << "Player cancelled pokémon selection";
-        closeDialogue();
-        pokemonSelectionActive = false;
-        return;
-    }
-    else {
-        return; // Invalid key, do nothing
-    }
-    
-    // Process the selection
-    choosePokemon(selectedIndex);
-}
-
-void LaboratoryScene::choosePokemon(int pokemonIndex)
-{
-    // Map the selection numbers to the correct Pokémon types
-    Pokemon::Type type;
-    QString pokemonName;
-    
-    switch (pokemonIndex) {
-        case 0:
-            type = Pokemon::SQUIRTLE;
-            pokemonName = "Squirtle";
-            break;
-        case 1:
-            type = Pokemon::CHARMANDER;
-            pokemonName = "Charmander";
-            break;
-        case 2:
-            type = Pokemon::BULBASAUR;
-            pokemonName = "Bulbasaur";
-            break;
-        default:
-            qDebug() << "Invalid Pokémon index:" << pokemonIndex;
-            return;
-    }
-    
-    // Create a new Pokémon and add it to player's collection
-    Pokemon* selectedPokemon = new Pokemon(type);
-    if (!selectedPokemon) {
-        qDebug() << "ERROR: Failed to create Pokémon of type" << static_cast<int>(type);
-        return;
-    }
-    
-    qDebug() << "Created a new Pokémon:" << selectedPokemon->getName() << "with image path:" << selectedPokemon->getImagePath();
-    
-    // Add Pokémon to player's collection
-    game->addPokemon(selectedPokemon);
-    
-    // Verify the Pokémon was added successfully
-    const QVector<Pokemon*>& playerPokemon = game->getPokemon();
-    qDebug() << "After adding, player now has" << playerPokemon.size() << "Pokémon";
-    
-    if (!playerPokemon.isEmpty()) {
-        qDebug() << "First Pokémon in collection is:" << playerPokemon[0]->getName();
-    }
-    
-    // Show a confirmation message
-    showDialogue("You chose " + pokemonName + " as your partner!");
-    
-    // Set flag to indicate player has chosen a Pokémon
-    hasChosenPokemon = true;
-    
-    // Reset pokémon selection state but keep dialogue active for confirmation
-    pokemonSelectionActive = false;
-    
-    // Remove all pokeball sprites since the player has made their choice
-    for (auto ball : pokeBallItems) {
-        if (ball) {
-            scene->removeItem(ball);
-            delete ball;
-        }
-    }
-    pokeBallItems.clear();
-    
-    qDebug() << "Pokémon selection complete. Press A to close dialogue, then B to open your bag.";
-}
-
-// New method to check if player is near the laboratory door
 bool LaboratoryScene::isPlayerNearDoor() const
 {
-    // Calculate the position to center the lab in the larger scene
-    float labOffsetX = (SCENE_WIDTH - LAB_WIDTH) / 2;
-    float labOffsetY = (SCENE_HEIGHT - LAB_HEIGHT) / 2;
-    
     // Define door area (center bottom of lab)
-    QRectF doorArea(labOffsetX + LAB_WIDTH/2 - 30, labOffsetY + LAB_HEIGHT - 60, 60, 20);
+    const int LAB_WIDTH = MapLayout::LAB_WIDTH;
+    const int LAB_HEIGHT = MapLayout::LAB_HEIGHT;
+    QRectF doorArea = MapLayout::toWorld(MapLayout::AREA_LAB, QRectF(LAB_WIDTH/2 - 30, LAB_HEIGHT - 60, 60, 20));
     
     // Check if player is within the door area and facing down
     bool isInRange = doorArea.contains(playerPos);
@@ -1254,38 +883,6 @@ bool LaboratoryScene::isPlayerNearDoor() const
     return isInRange && isFacingDoor;
 }
 
-bool LaboratoryScene::isPlayerOnTransitionArea() const
-{
-    if (!transitionBoxItem) {
-        qDebug() << "Transition box not created!";
-        return false;
-    }
-    
-    // Get the transition box rect (this rect already has the lab offset applied)
-    QRectF transitionRect = transitionBoxItem->rect();
-    
-    // Adjust for the position of the box
-    QRectF adjustedRect(
-        transitionRect.x() + transitionBoxItem->pos().x(),
-        transitionRect.y() + transitionBoxItem->pos().y(),
-        transitionRect.width(), 
-        transitionRect.height()
-    );
-    
-    // Use the player's feet position for detection
-    QPointF playerFeet(playerPos.x() + 17, playerPos.y() + 40);
-    
-    // Check if player is inside the transition area
-    bool isInTransitionArea = adjustedRect.contains(playerFeet);
-    
-    qDebug() << "Transition check: Player at" << playerFeet 
-             << "Transition area:" << adjustedRect
-             << "Result:" << isInTransitionArea
-             << "hasChosenPokemon:" << hasChosenPokemon;
-    
-    return isInTransitionArea;
-}
-
 void LaboratoryScene::update()
 {
     // Skip updates if dialogue or bag is open
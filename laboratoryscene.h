@@ -2,9 +2,14 @@
 #define LABORATORYSCENE_H
 
 #include "scene.h"
+#include "frameloop.h"
+#include "collisionworld.h"
+#include "kinematicmover.h"
+#include "pathfinder.h"
+#include "debugoverlayitem.h"
+#include "bitmaptextitem.h"
 #include <QGraphicsPixmapItem>
 #include <QGraphicsRectItem>
-#include <QGraphicsTextItem>
 #include <QVector>
 #include <QTimer>
 #include <QDirIterator>
@@ -20,60 +25,64 @@ public:
 
     void initialize() override;
     void cleanup() override;
-    void handleKeyPress(int key) override;
-    void handleKeyRelease(int key) override;
+    void handleAction(InputSystem::Action action) override;
+    void handleActionRelease(InputSystem::Action action) override;
     void update() override;
 
+    void addToWorld(WorldContent &content) override;
+    void enterArea(const QPointF &position) override;
+    void leaveArea() override;
+
+    // The lab's barriers and its walkable grid, in world coordinates. Needs
+    // nothing but MapLayout, so the warm-up builds it ahead of time.
+    static void buildWorld(CollisionWorld &world, Pathfinder &pathfinder);
+
 protected:
     void updatePlayerSprite();
     bool checkCollision();
     void updatePlayerPosition();
 
 private:
-    static const int SCENE_WIDTH = 750;  // Total scene width (black background)
-    static const int SCENE_HEIGHT = 750; // Total scene height (black background)
-    static const int LAB_WIDTH = 438;    // Lab width - updated to match actual image size
-    static const int LAB_HEIGHT = 550;   // Lab height - increased to ensure proper scrolling
     static const int VIEW_WIDTH = 525;   // Window width from requirements
     static const int VIEW_HEIGHT = 450;  // Window height from requirements
 
-    QGraphicsPixmapItem* backgroundItem{nullptr};
+    // The player is hidden while in another area; the NPC and the balls
+    // are WorldStreamer sprites, shown while the camera is near them
     QGraphicsPixmapItem* playerItem{nullptr};
-    QGraphicsPixmapItem* npcItem{nullptr};
+    int npcSprite{-1};
     QGraphicsPixmapItem* labTableItem{nullptr};
-    QVector<QGraphicsPixmapItem*> pokeBallItems;
-    QVector<QGraphicsRectItem*> barrierItems;
-    QGraphicsRectItem* transitionBoxItem{nullptr}; // Area that transitions to Town scene
+    QVector<int> pokeBallSprites;
+
+    // Map geometry in world coordinates - plain rects, drawn only by the debug overlay
+    QVector<QRectF> barrierRects;
+    int pendingArea{-1};  // Area the door leads to, handled in updateScene
+    DebugOverlayItem* debugOverlay{nullptr};  // Debug builds only
+
+    // Barrier geometry for swept player movement
+    CollisionWorld collisionWorld;
+    KinematicMover playerMover;
+    Pathfinder pathfinder;  // Walkable grid for scripted/automatic walks
     
     // Bag related items
     QGraphicsPixmapItem* bagBackgroundItem{nullptr}; // Store bag background separately
     QVector<QGraphicsPixmapItem*> bagPokemonSprites;
-    QVector<QGraphicsTextItem*> bagPokemonNames;
+    QVector<BitmapTextItem*> bagPokemonNames;
     QVector<QGraphicsItem*> bagSlotRects; // Change to store generic QGraphicsItem*
     bool isBagOpen{false};
 
     // Player animation and movement
     int walkFrame{0};
     QString playerDirection{"F"};
-    QTimer* updateTimer{nullptr};
-    QTimer* movementTimer{nullptr};
-    int currentPressedKey{0};
-    QSet<int> pressedKeys;  // Set to track currently pressed keys
+    FrameLoop* frameLoop{nullptr};
 
     // Player position and camera
-    QPointF playerPos{220, 350};
+    QPointF playerPos;  // World position, set when the player enters the lab
     QPointF cameraPos{0, 0};
 
     QGraphicsItem* dialogBoxItem{nullptr};
-    QGraphicsTextItem* dialogTextItem{nullptr};
-    int currentDialogueState{0};
+    BitmapTextItem* dialogTextItem{nullptr};
     bool isDialogueActive{false};
 
-    // Pokémon selection
-    bool pokemonSelectionActive{false};
-    int selectedPokemonType{-1}; // -1: None, 0: Squirtle, 1: Charmander, 2: Bulbasaur
-    bool hasChosenPokemon{false}; // Flag to track if player has already chosen a Pokémon
-
     void createBackground();
     void createNPC();
     void createPlayer();
@@ -82,7 +91,6 @@ private:
     void createTransitionPoint();
     void updateCamera();
     void showDialogue(const QString &text);
-    void printAvailableResources();
 
     // Bag functions
     void toggleBag();
@@ -94,14 +102,17 @@ private:
     bool isPlayerNearNPC() const;
     bool isPlayerNearDoor() const;
     bool isPlayerNearPokeball(int &ballIndex) const;
-    bool isPlayerOnTransitionArea() const; // Check if player is on the transition area
     void closeDialogue();
     void updateScene();
-    void processMovement();
-    void centerLabInitially();
-    void handlePokemonSelection(int key);
-    void choosePokemon(int pokemonIndex);
-    void startPokemonSelection();
+    void applySimulationSnapshot();
+    // The bag and dialogues stop the player; called where they open and close
+    void updatePlayerFreeze();
+
+    // Event scripts (lab_professor, lab_door, lab_pokeball)
+    void scriptSay(const QString &text) override;
+    void scriptEnd() override;
+    void scriptGivePokemon(const QString &species) override;
+    void scriptCall(const QString &hook) override;
 };
 
 #endif // LABORATORYSCENE_H
@@ -1,9 +1,33 @@
 #include "mainwindow.h"
+#include "benchmarks.h"
+#include "startupprofile.h"
+#include "stresstest.h"
+#include "stringtable.h"
 #include <QApplication>
 
 int main(int argc, char *argv[])
 {
+    // Command-line benchmarks run headless and never open the window
+    int benchmark = Benchmarks::runFromArguments(argc, argv);
+    if (benchmark >= 0) {
+        return benchmark;
+    }
+
     QApplication a(argc, argv);
+    StartupProfile::mark(StartupProfile::APPLICATION_CREATED);
+
+    // --stress plays the normal game with scaled-up entity counts
+    StressTest::configureFromArguments(argc, argv);
+
+    // --lang=en or --lang=zh_TW; otherwise the language follows the system locale
+    StringTable::setLanguage(StringTable::systemLanguage());
+    for (int i = 1; i < argc; ++i) {
+        const QString argument = QString::fromLocal8Bit(argv[i]);
+        StringTable::Language language;
+        if (argument.startsWith("--lang=") && StringTable::languageFromName(argument.section('=', 1), language)) {
+            StringTable::setLanguage(language);
+        }
+    }
 
     MainWindow w;
     w.setFixedSize(525, 450); // Set required size from specs
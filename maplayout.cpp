@@ -0,0 +1,207 @@
+#include "maplayout.h"
+
+namespace MapLayout {
+
+QVector<QRectF> townBarriers()
+{
+    // Define barriers for the town based on 1000x1000 dimensions and the reference image
+    return {
+        // Tree barriers around the perimeter
+        QRectF(0, 0, 492, 100),  // Top left trees
+        QRectF(585, 0, 470, 100),  // Top right trees
+        QRectF(0, 0, 80, TOWN_HEIGHT),  // Left trees
+        QRectF(TOWN_WIDTH - 87, 0, 100, TOWN_HEIGHT),  // Right trees
+
+        // Upper buildings (houses)
+        QRectF(205, 175, 210, 219),  // Left house
+        QRectF(586, 175, 210, 219),  // Right house
+        QRectF(173, 326, 31, 68),  // Mailbox beside Left house
+        QRectF(550, 326, 31, 68),  // Mailbox beside Right house
+
+        // Center-left fence
+        QRectF(208, 549, 214, 46),
+        // Bottom fence
+        QRectF(546, 801, 249, 41),
+
+        QRectF(550, 470, 281, 225),  // Center main building
+
+        QRectF(297, 849, 152, 145),  // Lake at bottom
+    };
+}
+
+QVector<QRectF> townBulletinBoards()
+{
+    return {
+        QRectF(209, 698, 42, 46),  // Bottom-left bulletin board
+        QRectF(377, 548, 45, 45),  // Center-left fence bulletin board
+        QRectF(669, 801, 45, 45),  // Bottom fence bulletin board
+    };
+}
+
+QRectF townLabPortal()
+{
+    return QRectF(669, 700, 45, 45);
+}
+
+QRectF townGrasslandPath()
+{
+    return QRectF(490, 0, 90, 90);
+}
+
+QVector<QRectF> grasslandBarriers()
+{
+    // Define barriers for the grassland based on 1000x1667 dimensions
+    return {
+        // Boundary barriers to prevent player from walking off the map
+        QRectF(0, 0, 422, 75),  // Top left barrier
+        QRectF(570, 0, 458, 75),  // Top right barrier
+        QRectF(0, 0, 75, GRASSLAND_HEIGHT),  // Left barrier
+        QRectF(GRASSLAND_WIDTH - 75, 0, 50, GRASSLAND_HEIGHT),  // Right barrier
+        QRectF(0, GRASSLAND_HEIGHT - 100, 488, 100),  // Bottom left barrier
+        QRectF(582, GRASSLAND_HEIGHT - 100, 500, 100),  // Bottom right barrier
+
+        // Added barriers for the interior areas based on the red lines in the image
+        QRectF(85, 1010, 410, 105),  // Bottom left tree
+        QRectF(85, 600, 80, 100),  // Center left alone tree
+        QRectF(422, 600, 240, 100),  // Beside center left alone tree (3 tree)
+        QRectF(338, 128, 80, 358),
+    };
+}
+
+QVector<QRectF> grasslandLedges()
+{
+    // Looking at the brown ledges in the image
+    return {
+        QRectF(82, 231, 246, 20),
+        QRectF(420, 231, 244, 20),
+        QRectF(82, 440, 248, 20),
+
+        QRectF(170, 646, 240, 20),
+        QRectF(85, 851, 77, 20),
+        QRectF(213, 851, 160, 20),
+        QRectF(469, 851, 650, 20),
+
+        QRectF(GRASSLAND_WIDTH - 253, 1105, 175, 20),
+        QRectF(82, 1315, 163, 20),
+        QRectF(417, 1315, 550, 20),
+    };
+}
+
+QVector<QRectF> grasslandTallGrass()
+{
+    return {
+        QRectF(82, 1337, 374, 168),  // First tall grass area
+        QRectF(632, 1337, 295, 168),  // Second tall grass area
+        QRectF(500, 1457, 90, 112),  // Third tall grass area
+        QRectF(500, 1006, 256, 210),  // Fourth tall grass area
+        QRectF(428, 251, 483, 207),  // Fifth tall grass area
+        QRectF(662, 533, 244, 210),  // Sixth tall grass area
+    };
+}
+
+QRectF grasslandTownPath()
+{
+    return QRectF(GRASSLAND_WIDTH / 2 - 50 + 35, GRASSLAND_HEIGHT - 90, 100, 90);
+}
+
+QRectF grasslandBulletinBoard()
+{
+    // Fixed position to match the tent/sign
+    return QRectF(373, 1295, 40, 40);
+}
+
+QVector<QRectF> labBarriers()
+{
+    return {
+        // Left wall area
+        QRectF(-1, 0, LAB_WIDTH, 90),
+        QRectF(-1, 110, 30, 90),
+        QRectF(31, 132, 70, 105),  // red dot machine
+        QRectF(-1, 315, 170, 80),  // left bookshelf
+        QRectF(274, 315, 170, 80),  // right bookshelf
+        QRectF(-1, 477, 33, 70),  // left plant
+        QRectF(401, 477, 33, 70),  // right plant
+        QRectF(272, 160, 100, 67),  // pokeball table
+        QRectF(197, 107, 33, 46),  // NPC
+    };
+}
+
+QRectF labDoor()
+{
+    return QRectF(LAB_WIDTH / 2 - 24, LAB_HEIGHT - 37, 55, 38);
+}
+
+AreaInfo areaInfo(Area area)
+{
+    switch (area) {
+    case AREA_LAB:
+        return {":/Dataset/Image/scene/lab.png", QSize(LAB_WIDTH, LAB_HEIGHT),
+                QPointF(TOWN_WIDTH + 512, 0), QPointF(220, 350)};
+    case AREA_TOWN:
+        return {":/Dataset/Image/scene/Town.png", QSize(TOWN_WIDTH, TOWN_HEIGHT),
+                QPointF(0, 0), QPointF(500, 500)};
+    case AREA_GRASSLAND:
+    default:
+        return {":/Dataset/Image/scene/GrassLand.png", QSize(GRASSLAND_WIDTH, GRASSLAND_HEIGHT),
+                QPointF(0, -GRASSLAND_HEIGHT), QPointF(500, 1317)};
+    }
+}
+
+QRectF areaRect(Area area)
+{
+    const AreaInfo info = areaInfo(area);
+    return QRectF(info.worldOrigin, QSizeF(info.size));
+}
+
+QPointF toWorld(Area area, const QPointF &local)
+{
+    return local + areaInfo(area).worldOrigin;
+}
+
+QRectF toWorld(Area area, const QRectF &local)
+{
+    return local.translated(areaInfo(area).worldOrigin);
+}
+
+QVector<QRectF> toWorld(Area area, const QVector<QRectF> &local)
+{
+    const QPointF origin = areaInfo(area).worldOrigin;
+    QVector<QRectF> world;
+    world.reserve(local.size());
+    for (const QRectF &rect : local) {
+        world.append(rect.translated(origin));
+    }
+    return world;
+}
+
+Area playerArea(const QPointF &playerPos)
+{
+    const QPointF feet = playerPos + QPointF(17, 40);
+    for (int area = 0; area < AREA_COUNT; ++area) {
+        if (areaRect(static_cast<Area>(area)).contains(feet)) {
+            return static_cast<Area>(area);
+        }
+    }
+    return AREA_COUNT;
+}
+
+QRectF regionRect(Area area)
+{
+    if (area == AREA_LAB) {
+        const qreal marginX = (LAB_FRAME_SIZE - LAB_WIDTH) / 2;
+        const qreal marginY = (LAB_FRAME_SIZE - LAB_HEIGHT) / 2;
+        return areaRect(AREA_LAB).adjusted(-marginX, -marginY, marginX, marginY);
+    }
+    return areaRect(AREA_TOWN).united(areaRect(AREA_GRASSLAND));
+}
+
+QVector<PortalLink> portalLinks()
+{
+    // Out of the lab the player stands just below the lab's entrance
+    return {
+        {AREA_LAB, toWorld(AREA_LAB, labDoor()), AREA_TOWN, toWorld(AREA_TOWN, QPointF(669, 750))},
+        {AREA_TOWN, toWorld(AREA_TOWN, townLabPortal()), AREA_LAB, toWorld(AREA_LAB, areaInfo(AREA_LAB).entry)},
+    };
+}
+
+}
@@ -0,0 +1,101 @@
+#ifndef MAPLAYOUT_H
+#define MAPLAYOUT_H
+
+#include <QPointF>
+#include <QRectF>
+#include <QSize>
+#include <QVector>
+
+// Static map geometry shared by the scenes and by Game.
+// Keeping it in one place means the box placement in Game and the
+// barriers drawn by TownScene can never drift apart again.
+namespace MapLayout {
+
+// Town dimensions - must match the Town.png background
+const int TOWN_WIDTH = 1000;
+const int TOWN_HEIGHT = 1000;
+
+// Side of a town box sprite; Game places boxes of this size and TownScene draws them
+const int TOWN_BOX_SIZE = 40;
+
+// Keep-out margins used when scattering boxes around the town
+const qreal TOWN_BULLETIN_KEEP_OUT = 60.0;
+const qreal TOWN_PORTAL_KEEP_OUT = 40.0;
+
+QVector<QRectF> townBarriers();        // Trees, houses, fences, lake (bulletin boards excluded)
+QVector<QRectF> townBulletinBoards();  // Bulletin boards (also solid)
+QRectF townLabPortal();
+QRectF townGrasslandPath();             // Where the path leaves the town for the grassland
+
+// Grassland dimensions - must match the grassland background
+const int GRASSLAND_WIDTH = 1000;
+const int GRASSLAND_HEIGHT = 1667;
+
+QVector<QRectF> grasslandBarriers();   // Map edges and trees
+QVector<QRectF> grasslandLedges();     // One-way: can jump down, can't climb up
+QVector<QRectF> grasslandTallGrass();  // Wild Pokémon areas
+QRectF grasslandTownPath();             // Where the path leaves the grassland for the town
+QRectF grasslandBulletinBoard();
+
+// Laboratory dimensions - must match LaboratoryScene
+const int LAB_WIDTH = 438;
+const int LAB_HEIGHT = 550;
+
+QVector<QRectF> labBarriers();
+QRectF labDoor();                      // Exit to the town
+// The lab is drawn in the middle of a frame this size, as it always was
+const int LAB_FRAME_SIZE = 750;
+
+// The geometry above is in each area's own coordinates, with the area's
+// top-left corner at (0, 0). The areas themselves share one world
+// coordinate space: the town sits at the origin and the grassland right
+// above it, so the path out of the top of the town runs on into the bottom
+// of the grassland and the player simply walks across. The lab is an
+// interior, off to the east where no path reaches and no view of the town
+// shows it; only its door portals lead in and out.
+enum Area {
+    AREA_LAB = 0,
+    AREA_TOWN = 1,
+    AREA_GRASSLAND = 2,
+    AREA_COUNT = 3
+};
+
+// Side of the squares the world is streamed in: background tiles on the
+// GUI thread, colliders, triggers and grass in the simulation
+const int CHUNK_SIZE = 256;
+
+struct AreaInfo {
+    const char *background;  // Resource path of the background image
+    QSize size;              // Size the background is drawn at
+    QPointF worldOrigin;     // Where its top-left corner is in the world
+    QPointF entry;           // Local player position when a new game, a save or a script puts the player here
+};
+
+AreaInfo areaInfo(Area area);
+
+QRectF areaRect(Area area);  // In world coordinates
+QPointF toWorld(Area area, const QPointF &local);
+QRectF toWorld(Area area, const QRectF &local);
+QVector<QRectF> toWorld(Area area, const QVector<QRectF> &local);
+
+// Area under the player's feet (playerPos is the sprite's top-left corner),
+// AREA_COUNT when they are on no area at all
+Area playerArea(const QPointF &playerPos);
+// The part of the world the camera and the player keep to while in area:
+// the town and the grassland share theirs
+QRectF regionRect(Area area);
+
+// Walking onto rect takes the player to arrival, in another area that no
+// path leads to (world coordinates)
+struct PortalLink {
+    Area from;
+    QRectF rect;
+    Area to;
+    QPointF arrival;
+};
+
+QVector<PortalLink> portalLinks();
+
+}
+
+#endif // MAPLAYOUT_H
@@ -0,0 +1,261 @@
+#include "pathfinder.h"
+#include "collisionworld.h"
+#include "kinematicmover.h"
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+
+// Cached paths kept before the cache is flushed
+static const int MAX_CACHED_PATHS = 512;
+// How far (in nodes) a blocked start or goal may be snapped
+static const int MAX_SNAP_RADIUS = 4;
+
+namespace {
+// Min-heap on f, ties broken towards the deeper node
+struct OpenNodeGreater {
+    template <typename Node>
+    bool operator()(const Node &a, const Node &b) const
+    {
+        return a.f > b.f || (a.f == b.f && a.g < b.g);
+    }
+};
+}
+
+Pathfinder::Pathfinder(qreal cellSize, const QRectF &hitbox)
+    : cellSize(cellSize > 0 ? cellSize : 8.0),
+      hitbox(hitbox)
+{
+}
+
+void Pathfinder::clear()
+{
+    cols = 0;
+    rows = 0;
+    walkableCells = 0;
+    cells.clear();
+    gScore.clear();
+    parent.clear();
+    seenStamp.clear();
+    closedStamp.clear();
+    open.clear();
+    cache.clear();
+}
+
+void Pathfinder::build(const CollisionWorld &world, const QRectF &area)
+{
+    clear();
+    bounds = area;
+    cols = qMax(0, static_cast<int>(std::floor(area.width() / cellSize)) + 1);
+    rows = qMax(0, static_cast<int>(std::floor(area.height() / cellSize)) + 1);
+
+    const int count = cols * rows;
+    cells.fill(0, count);
+
+    KinematicMover mover(hitbox);
+    for (int cell = 0; cell < count; ++cell) {
+        QPointF position = positionOf(cell);
+        if (world.overlapsSolid(hitbox.translated(position))) {
+            continue;
+        }
+        cells[cell] = WALKABLE;
+        walkableCells++;
+
+        // Use the real movement rules for the one-way ledges
+        if (mover.move(world, position, QPointF(0, -cellSize)).blockedY) {
+            cells[cell] |= BLOCK_UP;
+        }
+    }
+
+    gScore.fill(0, count);
+    parent.fill(-1, count);
+    seenStamp.fill(0, count);
+    closedStamp.fill(0, count);
+    open.reserve(count);
+    searchStamp = 0;
+
+    qDebug() << "Navigation grid built:" << cols << "x" << rows << "nodes," << walkableCells << "walkable";
+}
+
+void Pathfinder::setCacheEnabled(bool enabled)
+{
+    cacheEnabled = enabled;
+    if (!enabled) {
+        cache.clear();
+    }
+}
+
+int Pathfinder::cellAt(const QPointF &position) const
+{
+    int col = qBound(0, qRound((position.x() - bounds.left()) / cellSize), cols - 1);
+    int row = qBound(0, qRound((position.y() - bounds.top()) / cellSize), rows - 1);
+    return row * cols + col;
+}
+
+QPointF Pathfinder::positionOf(int cell) const
+{
+    return QPointF(bounds.left() + (cell % cols) * cellSize, bounds.top() + (cell / cols) * cellSize);
+}
+
+bool Pathfinder::isWalkable(const QPointF &position) const
+{
+    if (!isBuilt()) {
+        return false;
+    }
+    return cells[cellAt(position)] & WALKABLE;
+}
+
+int Pathfinder::nearestWalkable(int cell) const
+{
+    if (cells[cell] & WALKABLE) {
+        return cell;
+    }
+
+    // Check rings of growing radius around the node
+    const int col = cell % cols;
+    const int row = cell / cols;
+    for (int radius = 1; radius <= MAX_SNAP_RADIUS; ++radius) {
+        for (int dy = -radius; dy <= radius; ++dy) {
+            for (int dx = -radius; dx <= radius; ++dx) {
+                if (qAbs(dx) != radius && qAbs(dy) != radius) {
+                    continue;
+                }
+                int x = col + dx;
+                int y = row + dy;
+                if (x < 0 || y < 0 || x >= cols || y >= rows) {
+                    continue;
+                }
+                if (cells[y * cols + x] & WALKABLE) {
+                    return y * cols + x;
+                }
+            }
+        }
+    }
+    return -1;
+}
+
+bool Pathfinder::search(int start, int goal, QVector<int> &result)
+{
+    // A fresh stamp invalidates all per-node state from the previous search
+    if (++searchStamp == 0) {
+        seenStamp.fill(0);
+        closedStamp.fill(0);
+        searchStamp = 1;
+    }
+
+    const int goalCol = goal % cols;
+    const int goalRow = goal / cols;
+    auto heuristic = [&](int cell) {
+        return qAbs(cell % cols - goalCol) + qAbs(cell / cols - goalRow);
+    };
+
+    open.clear();
+    expandedCount = 0;
+    gScore[start] = 0;
+    parent[start] = -1;
+    seenStamp[start] = searchStamp;
+    open.append({heuristic(start), 0, start});
+
+    const int offsets[4] = {-cols, cols, -1, 1};  // Up, down, left, right
+
+    while (!open.isEmpty()) {
+        std::pop_heap(open.begin(), open.end(), OpenNodeGreater());
+        OpenNode node = open.last();
+        open.removeLast();
+
+        if (closedStamp[node.cell] == searchStamp || node.g != gScore[node.cell]) {
+            continue;  // Stale heap entry
+        }
+        closedStamp[node.cell] = searchStamp;
+        expandedCount++;
+
+        if (node.cell == goal) {
+            result.clear();
+            for (int cell = goal; cell != start; cell = parent[cell]) {
+                result.append(cell);
+            }
+            std::reverse(result.begin(), result.end());
+            return true;
+        }
+
+        const int col = node.cell % cols;
+        for (int direction = 0; direction < 4; ++direction) {
+            if (direction == 0 && (cells[node.cell] & BLOCK_UP)) {
+                continue;
+            }
+            if ((direction == 2 && col == 0) || (direction == 3 && col == cols - 1)) {
+                continue;
+            }
+
+            int next = node.cell + offsets[direction];
+            if (next < 0 || next >= cells.size() || !(cells[next] & WALKABLE)
+                || closedStamp[next] == searchStamp) {
+                continue;
+            }
+
+            int g = node.g + 1;
+            if (seenStamp[next] == searchStamp && g >= gScore[next]) {
+                continue;
+            }
+
+            seenStamp[next] = searchStamp;
+            gScore[next] = g;
+            parent[next] = node.cell;
+            open.append({g + heuristic(next), g, next});
+            std::push_heap(open.begin(), open.end(), OpenNodeGreater());
+        }
+    }
+
+    return false;
+}
+
+bool Pathfinder::findPath(const QPointF &start, const QPointF &goal, QVector<QPointF> &path)
+{
+    path.clear();
+    if (!isBuilt()) {
+        return false;
+    }
+
+    int startCell = nearestWalkable(cellAt(start));
+    int goalCell = nearestWalkable(cellAt(goal));
+    if (startCell < 0 || goalCell < 0) {
+        return false;
+    }
+
+    const qint64 key = (static_cast<qint64>(startCell) << 32) | static_cast<quint32>(goalCell);
+    const QVector<int> *nodes = nullptr;
+
+    if (cacheEnabled) {
+        auto it = cache.constFind(key);
+        if (it != cache.constEnd()) {
+            hits++;
+            nodes = &it.value();
+        }
+    }
+
+    if (!nodes) {
+        misses++;
+        if (!search(startCell, goalCell, scratchCells)) {
+            // Remember failures too, so bots probing a closed-off spot stay cheap
+            scratchCells.clear();
+            scratchCells.append(-1);
+        }
+        nodes = &scratchCells;
+
+        if (cacheEnabled) {
+            if (cache.size() >= MAX_CACHED_PATHS) {
+                cache.clear();
+            }
+            nodes = &cache.insert(key, scratchCells).value();
+        }
+    }
+
+    if (!nodes->isEmpty() && nodes->first() < 0) {
+        return false;  // Cached as unreachable
+    }
+
+    path.reserve(nodes->size());
+    for (int cell : *nodes) {
+        path.append(positionOf(cell));
+    }
+    return true;
+}
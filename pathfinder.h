@@ -0,0 +1,88 @@
+#ifndef PATHFINDER_H
+#define PATHFINDER_H
+
+#include <QHash>
+#include <QPointF>
+#include <QRectF>
+#include <QVector>
+
+class CollisionWorld;
+
+// A* pathfinding over a navigation grid rasterised from a CollisionWorld.
+//
+// Grid nodes are player sprite positions (top-left, like playerPos) spaced
+// cellSize apart. A node is walkable when the player's feet hitbox placed
+// there overlaps no solid, and moving up out of a node is forbidden when it
+// would climb a ledge, so paths obey the same rules as KinematicMover.
+//
+// Search state is preallocated per grid and reset with a stamp instead of
+// being cleared, and recent results are cached, so repeated queries (NPC
+// patrols, bots) cost a hash lookup.
+class Pathfinder
+{
+public:
+    explicit Pathfinder(qreal cellSize = 8.0, const QRectF &hitbox = QRectF(5, 30, 25, 18));
+
+    // bounds: region the sprite position may occupy
+    void build(const CollisionWorld &world, const QRectF &bounds);
+    void clear();
+    bool isBuilt() const { return !cells.isEmpty(); }
+
+    int columns() const { return cols; }
+    int rowCount() const { return rows; }
+    int walkableCount() const { return walkableCells; }
+    bool isWalkable(const QPointF &position) const;
+
+    // Fills path with the sprite positions to walk through, start excluded
+    // and goal included. Start and goal snap to the nearest walkable node.
+    // Returns false when the goal cannot be reached.
+    bool findPath(const QPointF &start, const QPointF &goal, QVector<QPointF> &path);
+
+    void setCacheEnabled(bool enabled);
+    int cacheHits() const { return hits; }
+    int cacheMisses() const { return misses; }
+    int lastExpandedCount() const { return expandedCount; }
+
+private:
+    enum CellFlags : quint8 {
+        WALKABLE = 1,
+        BLOCK_UP = 2  // A ledge stops upward movement out of this node
+    };
+
+    struct OpenNode {
+        int f;
+        int g;
+        int cell;
+    };
+
+    qreal cellSize;
+    QRectF hitbox;
+    QRectF bounds;
+    int cols{0};
+    int rows{0};
+    int walkableCells{0};
+    QVector<quint8> cells;
+
+    // A* scratch, sized once per grid
+    QVector<int> gScore;
+    QVector<int> parent;
+    QVector<quint32> seenStamp;
+    QVector<quint32> closedStamp;
+    quint32 searchStamp{0};
+    QVector<OpenNode> open;
+    QVector<int> scratchCells;
+    int expandedCount{0};
+
+    // Start/goal node pair -> node path
+    QHash<qint64, QVector<int>> cache;
+    bool cacheEnabled{true};
+    int hits{0};
+    int misses{0};
+
+    int cellAt(const QPointF &position) const;
+    QPointF positionOf(int cell) const;
+    int nearestWalkable(int cell) const;
+    bool search(int start, int goal, QVector<int> &result);
+};
+
+#endif // PATHFINDER_H
@@ -0,0 +1,235 @@
+#include "placementengine.h"
+#include <QDebug>
+#include <QRandomGenerator>
+#include <QtMath>
+#include <cmath>
+
+// Number of candidates tried around an active sample before it is retired (Bridson's k)
+static const int CANDIDATES_PER_SAMPLE = 30;
+
+PlacementEngine::PlacementEngine(const QRectF &area, const QSizeF &itemSize, qreal cellSize)
+    : area(area),
+      itemSize(itemSize),
+      cellSize(cellSize > 0 ? cellSize : 1.0)
+{
+    // Only whole cells are used so every free cell lies completely inside the area
+    cols = qMax(0, static_cast<int>(std::floor(area.width() / this->cellSize)));
+    rows = qMax(0, static_cast<int>(std::floor(area.height() / this->cellSize)));
+}
+
+void PlacementEngine::addObstacle(const QRectF &rect, qreal margin)
+{
+    obstacles.append(rect.adjusted(-margin, -margin, margin, margin));
+    maskDirty = true;
+}
+
+void PlacementEngine::setRandomGenerator(QRandomGenerator *generator)
+{
+    random = generator;
+}
+
+int PlacementEngine::freeCellCount()
+{
+    if (maskDirty) {
+        buildMask();
+    }
+    return freeCells.size();
+}
+
+void PlacementEngine::buildMask()
+{
+    freeMask.fill(true, cols * rows);
+
+    for (const QRectF &obstacle : obstacles) {
+        // An item with top-left p overlaps the obstacle when
+        // p.x is in (left - itemWidth, right) and p.y is in (top - itemHeight, bottom).
+        // Block every cell that has any point inside that window.
+        int firstCol = static_cast<int>(std::floor((obstacle.left() - itemSize.width() - area.left()) / cellSize));
+        int lastCol = static_cast<int>(std::ceil((obstacle.right() - area.left()) / cellSize)) - 1;
+        int firstRow = static_cast<int>(std::floor((obstacle.top() - itemSize.height() - area.top()) / cellSize));
+        int lastRow = static_cast<int>(std::ceil((obstacle.bottom() - area.top()) / cellSize)) - 1;
+
+        firstCol = qMax(firstCol, 0);
+        firstRow = qMax(firstRow, 0);
+        lastCol = qMin(lastCol, cols - 1);
+        lastRow = qMin(lastRow, rows - 1);
+
+        for (int row = firstRow; row <= lastRow; ++row) {
+            for (int col = firstCol; col <= lastCol; ++col) {
+                freeMask[row * cols + col] = false;
+            }
+        }
+    }
+
+    freeCells.clear();
+    for (int i = 0; i < freeMask.size(); ++i) {
+        if (freeMask[i]) {
+            freeCells.append(i);
+        }
+    }
+
+    maskDirty = false;
+    qDebug() << "Placement mask built:" << freeCells.size() << "of" << freeMask.size()
+             << "cells free," << obstacles.size() << "obstacles";
+}
+
+bool PlacementEngine::isFree(const QPointF &pos) const
+{
+    qreal localX = pos.x() - area.left();
+    qreal localY = pos.y() - area.top();
+    if (localX < 0 || localY < 0) {
+        return false;
+    }
+
+    int col = static_cast<int>(localX / cellSize);
+    int row = static_cast<int>(localY / cellSize);
+    if (col >= cols || row >= rows) {
+        return false;
+    }
+
+    return freeMask[row * cols + col];
+}
+
+int PlacementEngine::sampleRound(qreal minSpacing, QVector<QPointF> &samples)
+{
+    QRandomGenerator *rng = random ? random : QRandomGenerator::global();
+
+    // Background grid for O(1) neighbour checks; with this cell size a grid
+    // cell can hold at most one sample and only the 5x5 neighbourhood matters.
+    // Both still hold for AXIS_ALIGNED: two points in one cell are closer
+    // than minSpacing on both axes, and a conflict needs |dx| and |dy| below
+    // minSpacing, which is under two cells.
+    const qreal gridCell = minSpacing / M_SQRT2;
+    const int gridCols = static_cast<int>(std::ceil(area.width() / gridCell)) + 1;
+    const int gridRows = static_cast<int>(std::ceil(area.height() / gridCell)) + 1;
+    const qreal minSpacingSquared = minSpacing * minSpacing;
+    QVector<int> grid(gridCols * gridRows, -1);
+
+    auto gridIndexOf = [&](const QPointF &pos, int &gx, int &gy) {
+        gx = static_cast<int>((pos.x() - area.left()) / gridCell);
+        gy = static_cast<int>((pos.y() - area.top()) / gridCell);
+    };
+
+    auto tooClose = [&](const QPointF &pos) -> bool {
+        int gx, gy;
+        gridIndexOf(pos, gx, gy);
+        for (int y = qMax(gy - 2, 0); y <= qMin(gy + 2, gridRows - 1); ++y) {
+            for (int x = qMax(gx - 2, 0); x <= qMin(gx + 2, gridCols - 1); ++x) {
+                int sampleIndex = grid[y * gridCols + x];
+                if (sampleIndex < 0) {
+                    continue;
+                }
+                qreal dx = samples[sampleIndex].x() - pos.x();
+                qreal dy = samples[sampleIndex].y() - pos.y();
+                bool close = spacingMetric == AXIS_ALIGNED
+                        ? qMax(qAbs(dx), qAbs(dy)) < minSpacing
+                        : dx * dx + dy * dy < minSpacingSquared;
+                if (close) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    };
+
+    QVector<int> active;
+    auto addSample = [&](const QPointF &pos) {
+        int gx, gy;
+        gridIndexOf(pos, gx, gy);
+        grid[gy * gridCols + gx] = samples.size();
+        active.append(samples.size());
+        samples.append(pos);
+    };
+
+    // Visit the free cells in random order; each one that is not already
+    // covered seeds a new Bridson expansion. This also reaches free regions
+    // that are cut off from each other by buildings.
+    QVector<int> seedOrder = freeCells;
+    for (int i = seedOrder.size() - 1; i > 0; --i) {
+        int j = rng->bounded(i + 1);
+        std::swap(seedOrder[i], seedOrder[j]);
+    }
+
+    for (int cellIndex : seedOrder) {
+        QPointF seed(area.left() + (cellIndex % cols + rng->generateDouble()) * cellSize,
+                     area.top() + (cellIndex / cols + rng->generateDouble()) * cellSize);
+        if (tooClose(seed)) {
+            continue;
+        }
+        addSample(seed);
+
+        while (!active.isEmpty()) {
+            int activeSlot = rng->bounded(active.size());
+            QPointF base = samples[active[activeSlot]];
+            bool found = false;
+
+            for (int attempt = 0; attempt < CANDIDATES_PER_SAMPLE; ++attempt) {
+                qreal angle = rng->generateDouble() * 2.0 * M_PI;
+                qreal radius = minSpacing * (1.0 + rng->generateDouble());
+                QPointF candidate(base.x() + radius * qCos(angle), base.y() + radius * qSin(angle));
+
+                if (isFree(candidate) && !tooClose(candidate)) {
+                    addSample(candidate);
+                    found = true;
+                    break;
+                }
+            }
+
+            if (!found) {
+                // Retire this sample - swap-remove keeps it O(1)
+                active[activeSlot] = active.last();
+                active.removeLast();
+            }
+        }
+    }
+
+    return samples.size();
+}
+
+bool PlacementEngine::place(int count, qreal minSpacing, QVector<QPointF> &positions, int maxRounds)
+{
+    positions.clear();
+    if (count <= 0) {
+        return true;
+    }
+
+    if (maskDirty) {
+        buildMask();
+    }
+
+    if (freeCells.isEmpty()) {
+        qDebug() << "Placement infeasible: no free space left for items of size" << itemSize;
+        return false;
+    }
+
+    // Spacing below the mask resolution adds nothing but samples
+    minSpacing = qMax(minSpacing, cellSize);
+
+    QRandomGenerator *rng = random ? random : QRandomGenerator::global();
+
+    for (int round = 0; round < maxRounds; ++round) {
+        QVector<QPointF> samples;
+        int sampleCount = sampleRound(minSpacing, samples);
+
+        if (sampleCount >= count) {
+            // Pick count samples uniformly (partial Fisher-Yates) so the
+            // result is not biased towards where the first seed landed
+            for (int i = 0; i < count; ++i) {
+                int j = i + rng->bounded(sampleCount - i);
+                std::swap(samples[i], samples[j]);
+            }
+            samples.resize(count);
+            positions = samples;
+
+            qDebug() << "Placed" << count << "items in round" << round + 1
+                     << "from" << sampleCount << "Poisson samples";
+            return true;
+        }
+
+        qDebug() << "Placement round" << round + 1 << "only fit" << sampleCount << "of" << count << "items";
+    }
+
+    qDebug() << "Placement infeasible:" << count << "items with spacing" << minSpacing
+             << "do not fit after" << maxRounds << "rounds";
+    return false;
+}
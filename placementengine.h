@@ -0,0 +1,62 @@
+#ifndef PLACEMENTENGINE_H
+#define PLACEMENTENGINE_H
+
+#include <QPointF>
+#include <QRectF>
+#include <QSizeF>
+#include <QVector>
+
+class QRandomGenerator;
+
+// Scatters fixed-size items (town boxes, spawn points) over an area using
+// Bridson Poisson-disk sampling on top of a precomputed free-space mask.
+//
+// The mask is a grid over the allowed top-left positions; a cell is free only
+// if an item placed anywhere inside that cell stays clear of every obstacle
+// (plus its keep-out margin). Sampling therefore never has to test obstacles,
+// and every pass visits each free cell at most once, so place() always
+// finishes in bounded time.
+class PlacementEngine
+{
+public:
+    // How minSpacing is measured between two top-left points
+    enum SpacingMetric {
+        EUCLIDEAN,    // Straight-line distance
+        AXIS_ALIGNED  // Larger of the x and y distances: a gap on at least one axis
+    };
+
+    // area: region the item's top-left corner may occupy
+    PlacementEngine(const QRectF &area, const QSizeF &itemSize, qreal cellSize = 5.0);
+
+    void addObstacle(const QRectF &rect, qreal margin = 0.0);
+    void setRandomGenerator(QRandomGenerator *generator);
+    void setSpacingMetric(SpacingMetric metric) { spacingMetric = metric; }
+
+    // Fills positions with exactly count top-left points, each at least
+    // minSpacing apart (measured with the spacing metric, EUCLIDEAN by default). Returns false (and leaves positions empty) when the
+    // free space cannot hold that many items after maxRounds passes.
+    bool place(int count, qreal minSpacing, QVector<QPointF> &positions, int maxRounds = 8);
+
+    int freeCellCount();
+
+private:
+    QRectF area;
+    QSizeF itemSize;
+    qreal cellSize;
+    int cols;
+    int rows;
+
+    QVector<QRectF> obstacles;  // Already expanded by their margins
+    QVector<bool> freeMask;     // cols * rows, true = item fits here
+    QVector<int> freeCells;     // Indices of free mask cells
+    bool maskDirty{true};
+
+    QRandomGenerator *random{nullptr};
+    SpacingMetric spacingMetric{EUCLIDEAN};
+
+    void buildMask();
+    bool isFree(const QPointF &pos) const;
+    int sampleRound(qreal minSpacing, QVector<QPointF> &samples);
+};
+
+#endif // PLACEMENTENGINE_H
@@ -1,4 +1,5 @@
 #include "pokemon.h"
+#include "spritecache.h"
 #include <QDebug>
 
 Pokemon::Pokemon(Type type) : type(type) {
@@ -25,8 +26,23 @@ Pokemon::Pokemon(Type type) : type(type) {
     qDebug() << "Created Pokemon:" << name << "with image path:" << imagePath;
 }
 
+bool Pokemon::typeFromName(const QString& name, Type& type) {
+    const QString lower = name.toLower();
+    if (lower == "charmander") {
+        type = CHARMANDER;
+    } else if (lower == "squirtle") {
+        type = SQUIRTLE;
+    } else if (lower == "bulbasaur") {
+        type = BULBASAUR;
+    } else {
+        return false;
+    }
+    return true;
+}
+
 QPixmap Pokemon::getSprite() const {
-    QPixmap sprite(imagePath);
+    // Unscaled front sprite, shared with every other user of this species
+    QPixmap sprite = SpriteCache::instance().sprite(name, SpriteCache::ORIGINAL);
     if (sprite.isNull()) {
         qDebug() << "Failed to load pokemon sprite:" << imagePath;
         QPixmap fallback(32, 32);
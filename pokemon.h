@@ -28,6 +28,9 @@ public:
     };
 
     Pokemon(Type type);
+
+    // Looks up a species by its display name ("Squirtle"); false if unknown
+    static bool typeFromName(const QString& name, Type& type);
     
     // Getters
     QString getName() const { return name; }
@@ -45,6 +48,7 @@ public:
     void setLevel(int newLevel) { level = newLevel; }
     void setCurrentHp(int hp) { currentHp = hp; }
     void addMove(const QString& name, int power, int pp) { moves.append(Move(name, power, pp)); }
+    void setMovePp(int index, int pp) { if (index >= 0 && index < moves.size()) moves[index].pp = pp; }
 
 private:
     QString name;
@@ -0,0 +1,307 @@
+#include "savegame.h"
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThreadPool>
+#include <QtEndian>
+
+// "PKSV" in the first four bytes of every save
+static const quint32 SAVE_MAGIC = 0x504B5356;
+// Version 2 added the journal generation
+static const quint16 SAVE_VERSION = 2;
+static const int HEADER_SIZE = 16;
+
+// Sanity limits so a damaged file can't make us allocate gigabytes
+static const int MAX_PARTY_SIZE = 1 << 20;
+static const quint32 MAX_PAYLOAD_SIZE = 256u << 20;
+
+namespace {
+
+// Writes autosaves on a single background thread
+class SaveTask : public QRunnable
+{
+public:
+    SaveTask(const QString &path, const SaveData &data)
+        : path(path), data(data)
+    {
+    }
+
+    void run() override
+    {
+        QString error;
+        if (!SaveGame::writeFile(path, data, &error)) {
+            qDebug() << "Autosave failed:" << error;
+        }
+    }
+
+private:
+    QString path;
+    SaveData data;
+};
+
+// One thread, so queued autosaves run in the order they were taken
+struct SavePool : public QThreadPool
+{
+    SavePool() { setMaxThreadCount(1); }
+};
+
+QThreadPool *savePool()
+{
+    static SavePool pool;
+    return &pool;
+}
+
+struct Crc32Table
+{
+    quint32 values[256];
+
+    Crc32Table()
+    {
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 value = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                value = (value & 1) ? (value >> 1) ^ 0xEDB88320u : value >> 1;
+            }
+            values[i] = value;
+        }
+    }
+};
+
+void setError(QString *error, const QString &message)
+{
+    if (error) {
+        *error = message;
+    }
+}
+
+}
+
+namespace SaveGame
+{
+
+quint32 crc32(const char *data, int size, quint32 crc)
+{
+    // Built once, on first use from whichever thread gets here first
+    static const Crc32Table table;
+
+    crc = ~crc;
+    for (int i = 0; i < size; ++i) {
+        crc = table.values[(crc ^ static_cast<quint8>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+void prepareStream(QDataStream &stream)
+{
+    stream.setVersion(QDataStream::Qt_5_12);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+}
+
+void writePokemon(QDataStream &out, const SaveData::PokemonRecord &pokemon)
+{
+    // Levels, HP and PP are small, so they are stored in 16 bits
+    out << static_cast<quint8>(pokemon.type) << static_cast<quint16>(pokemon.level)
+        << static_cast<quint16>(pokemon.currentHp) << static_cast<quint8>(pokemon.movePp.size());
+    for (int pp : pokemon.movePp) {
+        out << static_cast<quint16>(pp);
+    }
+}
+
+bool readPokemon(QDataStream &in, SaveData::PokemonRecord &pokemon)
+{
+    quint8 type = 0;
+    quint16 level = 0;
+    quint16 hp = 0;
+    quint8 moveCount = 0;
+    in >> type >> level >> hp >> moveCount;
+
+    pokemon.type = type;
+    pokemon.level = level;
+    pokemon.currentHp = hp;
+    pokemon.movePp.clear();
+    pokemon.movePp.reserve(moveCount);
+    for (int move = 0; move < moveCount; ++move) {
+        quint16 pp = 0;
+        in >> pp;
+        pokemon.movePp.append(pp);
+    }
+    return in.status() == QDataStream::Ok;
+}
+
+QByteArray serialize(const SaveData &data)
+{
+    QByteArray payload;
+    {
+        QDataStream out(&payload, QIODevice::WriteOnly);
+        prepareStream(out);
+
+        out << data.generation << static_cast<quint8>(data.scene) << data.laboratoryCompleted;
+
+        out << static_cast<quint32>(data.party.size());
+        for (const SaveData::PokemonRecord &pokemon : data.party) {
+            writePokemon(out, pokemon);
+        }
+
+        // Strings as UTF-8, which is half the size of QDataStream's UTF-16
+        out << static_cast<quint32>(data.inventory.size());
+        for (auto it = data.inventory.constBegin(); it != data.inventory.constEnd(); ++it) {
+            out << it.key().toUtf8() << static_cast<qint32>(it.value());
+        }
+
+        out << data.townBoxesInitialized << static_cast<quint32>(data.townBoxPositions.size());
+        for (int i = 0; i < data.townBoxPositions.size(); ++i) {
+            const QPointF &position = data.townBoxPositions[i];
+            out << static_cast<float>(position.x()) << static_cast<float>(position.y())
+                << data.townBoxOpenedStates.value(i, false)
+                << data.townBoxContents.value(i).toUtf8();
+        }
+    }
+
+    QByteArray bytes(HEADER_SIZE, '\0');
+    uchar *header = reinterpret_cast<uchar *>(bytes.data());
+    qToLittleEndian<quint32>(SAVE_MAGIC, header);
+    qToLittleEndian<quint16>(SAVE_VERSION, header + 4);
+    qToLittleEndian<quint16>(0, header + 6);  // Reserved
+    qToLittleEndian<quint32>(static_cast<quint32>(payload.size()), header + 8);
+    qToLittleEndian<quint32>(crc32(payload.constData(), payload.size()), header + 12);
+    bytes.append(payload);
+    return bytes;
+}
+
+bool deserialize(const QByteArray &bytes, SaveData &data, QString *error)
+{
+    if (bytes.size() < HEADER_SIZE) {
+        setError(error, "file is too short");
+        return false;
+    }
+
+    const uchar *header = reinterpret_cast<const uchar *>(bytes.constData());
+    if (qFromLittleEndian<quint32>(header) != SAVE_MAGIC) {
+        setError(error, "not a save file");
+        return false;
+    }
+    quint16 version = qFromLittleEndian<quint16>(header + 4);
+    if (version < 1 || version > SAVE_VERSION) {
+        setError(error, QString("unsupported save version %1").arg(version));
+        return false;
+    }
+    quint32 payloadSize = qFromLittleEndian<quint32>(header + 8);
+    if (payloadSize > MAX_PAYLOAD_SIZE || payloadSize != static_cast<quint32>(bytes.size() - HEADER_SIZE)) {
+        setError(error, "truncated save file");
+        return false;
+    }
+    const char *payload = bytes.constData() + HEADER_SIZE;
+    if (crc32(payload, static_cast<int>(payloadSize)) != qFromLittleEndian<quint32>(header + 12)) {
+        setError(error, "checksum mismatch");
+        return false;
+    }
+
+    // Parse into a scratch copy so a bad file never leaves data half-filled
+    SaveData loaded;
+    QByteArray payloadBytes = QByteArray::fromRawData(payload, static_cast<int>(payloadSize));
+    QDataStream in(payloadBytes);
+    prepareStream(in);
+
+    if (version >= 2) {
+        in >> loaded.generation;
+    }
+    quint8 scene = 0;
+    in >> scene >> loaded.laboratoryCompleted;
+    loaded.scene = scene;
+
+    quint32 partySize = 0;
+    in >> partySize;
+    if (partySize > static_cast<quint32>(MAX_PARTY_SIZE)) {
+        setError(error, "party size out of range");
+        return false;
+    }
+    loaded.party.reserve(static_cast<int>(partySize));
+    for (quint32 i = 0; i < partySize && in.status() == QDataStream::Ok; ++i) {
+        SaveData::PokemonRecord pokemon;
+        if (!readPokemon(in, pokemon)) {
+            setError(error, "corrupt Pokemon record");
+            return false;
+        }
+        loaded.party.append(pokemon);
+    }
+
+    quint32 itemCount = 0;
+    in >> itemCount;
+    for (quint32 i = 0; i < itemCount && in.status() == QDataStream::Ok; ++i) {
+        QByteArray name;
+        qint32 quantity = 0;
+        in >> name >> quantity;
+        loaded.inventory.insert(QString::fromUtf8(name), quantity);
+    }
+
+    quint32 boxCount = 0;
+    in >> loaded.townBoxesInitialized >> boxCount;
+    for (quint32 i = 0; i < boxCount && in.status() == QDataStream::Ok; ++i) {
+        float x = 0;
+        float y = 0;
+        bool opened = false;
+        QByteArray contents;
+        in >> x >> y >> opened >> contents;
+        int index = loaded.townBoxPositions.size();
+        loaded.townBoxPositions.append(QPointF(x, y));
+        loaded.townBoxOpenedStates.insert(index, opened);
+        loaded.townBoxContents.insert(index, QString::fromUtf8(contents));
+    }
+
+    if (in.status() != QDataStream::Ok || !in.atEnd()) {
+        setError(error, "corrupt save payload");
+        return false;
+    }
+
+    data = loaded;
+    return true;
+}
+
+bool writeFile(const QString &path, const SaveData &data, QString *error)
+{
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        setError(error, file.errorString());
+        return false;
+    }
+    QByteArray bytes = serialize(data);
+    if (file.write(bytes) != bytes.size() || !file.commit()) {
+        setError(error, file.errorString());
+        return false;
+    }
+    return true;
+}
+
+bool readFile(const QString &path, SaveData &data, QString *error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        setError(error, file.errorString());
+        return false;
+    }
+    return deserialize(file.readAll(), data, error);
+}
+
+void writeFileAsync(const QString &path, const SaveData &data)
+{
+    savePool()->start(new SaveTask(path, data));
+}
+
+void waitForPendingWrites()
+{
+    savePool()->waitForDone();
+}
+
+QString defaultPath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/save.dat";
+}
+
+}
@@ -0,0 +1,69 @@
+#ifndef SAVEGAME_H
+#define SAVEGAME_H
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QMap>
+#include <QPointF>
+#include <QString>
+#include <QVector>
+
+// Everything Game needs to pick a session back up.
+//
+// SaveData is a plain value built only from Qt's implicitly shared
+// containers. Copying it is a copy-on-write snapshot: the game keeps
+// playing and changing its own copy while a worker thread serializes the
+// snapshot it was handed.
+struct SaveData {
+    struct PokemonRecord {
+        int type{0};        // Pokemon::Type
+        int level{1};
+        int currentHp{0};
+        QVector<int> movePp;
+    };
+
+    quint32 generation{0};  // Journal generation this snapshot starts (see SaveJournal)
+    int scene{0};           // GameState the save was taken in
+    bool laboratoryCompleted{false};
+    QVector<PokemonRecord> party;
+    QMap<QString, int> inventory;
+
+    bool townBoxesInitialized{false};
+    QVector<QPointF> townBoxPositions;
+    QMap<int, bool> townBoxOpenedStates;
+    QMap<int, QString> townBoxContents;
+};
+
+// Versioned binary save files.
+//
+// A file is a fixed 16 byte header (magic, format version, payload size and
+// a CRC-32 of the payload) followed by a QDataStream payload. Files are
+// written through QSaveFile, so a crash mid-write leaves the previous save
+// intact, and are fully validated before any of their data is used.
+namespace SaveGame
+{
+    QByteArray serialize(const SaveData &data);
+    bool deserialize(const QByteArray &bytes, SaveData &data, QString *error = nullptr);
+
+    bool writeFile(const QString &path, const SaveData &data, QString *error = nullptr);
+    bool readFile(const QString &path, SaveData &data, QString *error = nullptr);
+
+    // Serializes and writes on a background thread. Autosaves run one at a
+    // time and in order, so the newest snapshot always wins.
+    void writeFileAsync(const QString &path, const SaveData &data);
+    void waitForPendingWrites();
+
+    // save.dat in the per-user application data directory
+    QString defaultPath();
+
+    quint32 crc32(const char *data, int size, quint32 crc = 0);
+
+    // Shared with the journal, which stores Pokemon the same way
+    void writePokemon(QDataStream &out, const SaveData::PokemonRecord &pokemon);
+    bool readPokemon(QDataStream &in, SaveData::PokemonRecord &pokemon);
+
+    // Stream settings every save and journal payload is written with
+    void prepareStream(QDataStream &stream);
+}
+
+#endif // SAVEGAME_H
@@ -0,0 +1,351 @@
+#include "savejournal.h"
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QtEndian>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// "PKJL" in the first four bytes of every journal
+static const quint32 JOURNAL_MAGIC = 0x504B4A4C;
+static const quint16 JOURNAL_VERSION = 1;
+static const int JOURNAL_HEADER_SIZE = 12;
+
+// A record is a 4 byte length, the payload and a CRC-32 of the payload
+static const int RECORD_OVERHEAD = 8;
+static const quint32 MAX_RECORD_SIZE = 1 << 16;
+
+// Pushes written data through the OS cache onto the disk
+static bool syncToDisk(QFile &file)
+{
+    if (!file.flush()) {
+        return false;
+    }
+#ifdef Q_OS_WIN
+    return _commit(file.handle()) == 0;
+#else
+    return ::fsync(file.handle()) == 0;
+#endif
+}
+
+SaveJournal::SaveJournal(const QString &basePath)
+    : basePath(basePath),
+      journalPath(basePath + ".journal"),
+      previousJournalPath(basePath + ".journal.old")
+{
+    // A zero interval fires once the event loop is back, after the action
+    // that recorded the events has finished
+    flushTimer.setSingleShot(true);
+    flushTimer.setInterval(0);
+    QObject::connect(&flushTimer, &QTimer::timeout, &flushTimer, [this]() { flush(); });
+}
+
+SaveJournal::~SaveJournal()
+{
+    flush();
+    if (file.isOpen()) {
+        syncToDisk(file);
+        file.close();
+    }
+}
+
+bool SaveJournal::load(SaveData &data, QString *error)
+{
+    if (!SaveGame::readFile(basePath, data, error)) {
+        return false;
+    }
+
+    // Older journal first: it only applies if the snapshot written at the
+    // last compaction never made it to disk
+    int replayed = 0;
+    if (replay(previousJournalPath, data, &replayed)) {
+        data.generation++;
+    }
+    if (replay(journalPath, data, &replayed)) {
+        data.generation++;
+    }
+
+    qDebug() << "Replayed" << replayed << "journal events on top of save generation" << data.generation;
+    return true;
+}
+
+void SaveJournal::compact(SaveData data)
+{
+    // Never let more than one snapshot be in flight, or a crash could leave
+    // a gap between the newest snapshot on disk and the oldest journal kept
+    SaveGame::waitForPendingWrites();
+
+    quint32 next = qMax(generation, data.generation) + 1;
+    data.generation = next;
+
+    // Events from here on go to a journal of the new generation. The
+    // current one is kept until the new snapshot is safely written.
+    flush();
+    if (file.isOpen()) {
+        syncToDisk(file);
+        file.close();
+    }
+    QFile::remove(previousJournalPath);
+    QFile::rename(journalPath, previousJournalPath);
+
+    if (!startJournal(next)) {
+        qDebug() << "Could not start save journal" << journalPath << "-" << file.errorString();
+    }
+
+    SaveGame::writeFileAsync(basePath, data);
+}
+
+bool SaveJournal::startJournal(quint32 newGeneration)
+{
+    QDir().mkpath(QFileInfo(journalPath).absolutePath());
+
+    file.setFileName(journalPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+
+    uchar header[JOURNAL_HEADER_SIZE];
+    qToLittleEndian<quint32>(JOURNAL_MAGIC, header);
+    qToLittleEndian<quint16>(JOURNAL_VERSION, header + 4);
+    qToLittleEndian<quint16>(0, header + 6);  // Reserved
+    qToLittleEndian<quint32>(newGeneration, header + 8);
+    file.write(reinterpret_cast<const char *>(header), JOURNAL_HEADER_SIZE);
+
+    generation = newGeneration;
+    events = 0;
+    return syncToDisk(file);
+}
+
+void SaveJournal::append(const QByteArray &payload)
+{
+    // Nothing is journaled until the first snapshot exists
+    if (!file.isOpen()) {
+        return;
+    }
+
+    uchar field[4];
+    qToLittleEndian<quint32>(static_cast<quint32>(payload.size()), field);
+    pending.append(reinterpret_cast<const char *>(field), 4);
+    pending.append(payload);
+    qToLittleEndian<quint32>(SaveGame::crc32(payload.constData(), payload.size()), field);
+    pending.append(reinterpret_cast<const char *>(field), 4);
+    pendingEvents++;
+
+    if (!flushTimer.isActive()) {
+        flushTimer.start();
+    }
+}
+
+void SaveJournal::flush()
+{
+    flushTimer.stop();
+    if (pending.isEmpty()) {
+        return;
+    }
+
+    // One write call and one sync for everything the action recorded
+    if (file.write(pending) != pending.size() || !syncToDisk(file)) {
+        qDebug() << "Save journal write failed:" << file.errorString();
+    } else {
+        events += pendingEvents;
+    }
+    pending.clear();
+    pendingEvents = 0;
+}
+
+void SaveJournal::recordItemCount(const QString &name, int quantity)
+{
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    SaveGame::prepareStream(out);
+    out << static_cast<quint8>(ITEM_COUNT) << name.toUtf8() << static_cast<qint32>(quantity);
+    append(payload);
+}
+
+void SaveJournal::recordBoxOpened(int index, bool opened)
+{
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    SaveGame::prepareStream(out);
+    out << static_cast<quint8>(BOX_OPENED) << static_cast<quint16>(index) << opened;
+    append(payload);
+}
+
+void SaveJournal::recordPokemonAdded(const SaveData::PokemonRecord &pokemon)
+{
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    SaveGame::prepareStream(out);
+    out << static_cast<quint8>(POKEMON_ADDED);
+    SaveGame::writePokemon(out, pokemon);
+    append(payload);
+}
+
+void SaveJournal::recordPokemonUpdated(int index, const SaveData::PokemonRecord &pokemon)
+{
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    SaveGame::prepareStream(out);
+    out << static_cast<quint8>(POKEMON_UPDATED) << static_cast<quint32>(index);
+    SaveGame::writePokemon(out, pokemon);
+    append(payload);
+}
+
+void SaveJournal::recordPokemonMovedToFront(int index)
+{
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    SaveGame::prepareStream(out);
+    out << static_cast<quint8>(POKEMON_TO_FRONT) << static_cast<quint32>(index);
+    append(payload);
+}
+
+void SaveJournal::recordLaboratoryCompleted(bool completed)
+{
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    SaveGame::prepareStream(out);
+    out << static_cast<quint8>(LAB_COMPLETED) << completed;
+    append(payload);
+}
+
+void SaveJournal::recordScene(int scene)
+{
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    SaveGame::prepareStream(out);
+    out << static_cast<quint8>(SCENE) << static_cast<quint8>(scene);
+    append(payload);
+}
+
+bool SaveJournal::replay(const QString &path, SaveData &data, int *replayed)
+{
+    QFile journal(path);
+    if (!journal.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QByteArray bytes = journal.readAll();
+    if (bytes.size() < JOURNAL_HEADER_SIZE) {
+        return false;
+    }
+
+    const uchar *header = reinterpret_cast<const uchar *>(bytes.constData());
+    if (qFromLittleEndian<quint32>(header) != JOURNAL_MAGIC
+        || qFromLittleEndian<quint16>(header + 4) != JOURNAL_VERSION
+        || qFromLittleEndian<quint32>(header + 8) != data.generation) {
+        return false;
+    }
+
+    int offset = JOURNAL_HEADER_SIZE;
+    while (bytes.size() - offset >= RECORD_OVERHEAD) {
+        const uchar *record = reinterpret_cast<const uchar *>(bytes.constData()) + offset;
+        quint32 size = qFromLittleEndian<quint32>(record);
+        if (size > MAX_RECORD_SIZE || static_cast<quint32>(bytes.size() - offset - RECORD_OVERHEAD) < size) {
+            break;  // Torn write at the end of the journal
+        }
+
+        const char *payload = bytes.constData() + offset + 4;
+        if (SaveGame::crc32(payload, static_cast<int>(size)) != qFromLittleEndian<quint32>(record + 4 + size)) {
+            break;
+        }
+        if (!applyEvent(QByteArray::fromRawData(payload, static_cast<int>(size)), data)) {
+            qDebug() << "Skipping unreadable journal event in" << path;
+        }
+
+        (*replayed)++;
+        offset += RECORD_OVERHEAD + static_cast<int>(size);
+    }
+
+    if (offset != bytes.size()) {
+        qDebug() << "Save journal" << path << "ends in a damaged record, dropped" << bytes.size() - offset << "bytes";
+    }
+    return true;
+}
+
+bool SaveJournal::applyEvent(const QByteArray &payload, SaveData &data)
+{
+    QDataStream in(payload);
+    SaveGame::prepareStream(in);
+
+    quint8 type = 0;
+    in >> type;
+
+    switch (type) {
+    case ITEM_COUNT: {
+        QByteArray name;
+        qint32 quantity = 0;
+        in >> name >> quantity;
+        if (in.status() != QDataStream::Ok) {
+            return false;
+        }
+        if (quantity > 0) {
+            data.inventory.insert(QString::fromUtf8(name), quantity);
+        } else {
+            data.inventory.remove(QString::fromUtf8(name));
+        }
+        return true;
+    }
+    case BOX_OPENED: {
+        quint16 index = 0;
+        bool opened = false;
+        in >> index >> opened;
+        if (in.status() != QDataStream::Ok || index >= data.townBoxPositions.size()) {
+            return false;
+        }
+        data.townBoxOpenedStates.insert(index, opened);
+        return true;
+    }
+    case POKEMON_ADDED: {
+        SaveData::PokemonRecord pokemon;
+        if (!SaveGame::readPokemon(in, pokemon)) {
+            return false;
+        }
+        data.party.append(pokemon);
+        return true;
+    }
+    case POKEMON_UPDATED: {
+        quint32 index = 0;
+        in >> index;
+        SaveData::PokemonRecord pokemon;
+        if (!SaveGame::readPokemon(in, pokemon) || index >= static_cast<quint32>(data.party.size())) {
+            return false;
+        }
+        data.party[static_cast<int>(index)] = pokemon;
+        return true;
+    }
+    case POKEMON_TO_FRONT: {
+        quint32 index = 0;
+        in >> index;
+        if (in.status() != QDataStream::Ok || index >= static_cast<quint32>(data.party.size())) {
+            return false;
+        }
+        data.party.move(static_cast<int>(index), 0);
+        return true;
+    }
+    case LAB_COMPLETED: {
+        bool completed = false;
+        in >> completed;
+        if (in.status() != QDataStream::Ok) {
+            return false;
+        }
+        data.laboratoryCompleted = completed;
+        return true;
+    }
+    case SCENE: {
+        quint8 scene = 0;
+        in >> scene;
+        if (in.status() != QDataStream::Ok) {
+            return false;
+        }
+        data.scene = scene;
+        return true;
+    }
+    default:
+        return false;
+    }
+}
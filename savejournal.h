@@ -0,0 +1,88 @@
+#ifndef SAVEJOURNAL_H
+#define SAVEJOURNAL_H
+
+#include "savegame.h"
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QTimer>
+
+// Crash-safe save storage: a full snapshot plus an append-only journal.
+//
+// Every gameplay change (item count, box opened, Pokemon caught or
+// changed, ...) is appended to the journal as a small checksummed record.
+// The records one action produces (a bag change can be several) are
+// collected while the current event is handled and then written and
+// synced to disk together, so an action costs one short sequential write
+// and one sync. Every now and then compact() folds everything into a new
+// snapshot and starts an empty journal.
+//
+// Snapshots and journals are tied together by a generation number: a
+// journal of generation N holds the events that happened after snapshot N.
+// The journal that was current before the last compaction is kept until the
+// next one, so recovery works no matter where a crash hit:
+//   snapshot N + journal N + journal N+1, or snapshot N+1 + journal N+1.
+// A record torn by a power cut fails its checksum and ends the replay, so
+// at most the action being written is lost.
+class SaveJournal
+{
+public:
+    // basePath: snapshot file; the journals live next to it
+    explicit SaveJournal(const QString &basePath);
+    ~SaveJournal();
+
+    // Loads the snapshot and replays whatever journals belong to it
+    bool load(SaveData &data, QString *error = nullptr);
+
+    // Starts a new generation from a full copy of the game state. The
+    // snapshot is written in the background.
+    void compact(SaveData data);
+
+    void recordItemCount(const QString &name, int quantity);
+    void recordBoxOpened(int index, bool opened);
+    void recordPokemonAdded(const SaveData::PokemonRecord &pokemon);
+    void recordPokemonUpdated(int index, const SaveData::PokemonRecord &pokemon);
+    void recordPokemonMovedToFront(int index);
+    void recordLaboratoryCompleted(bool completed);
+    void recordScene(int scene);
+
+    // Writes and syncs the records collected so far. Runs by itself once
+    // the event that recorded them has been handled.
+    void flush();
+
+    bool isOpen() const { return file.isOpen(); }
+    int eventCount() const { return events + pendingEvents; }
+
+private:
+    enum EventType : quint8 {
+        ITEM_COUNT = 1,
+        BOX_OPENED = 2,
+        POKEMON_ADDED = 3,
+        POKEMON_UPDATED = 4,
+        POKEMON_TO_FRONT = 5,
+        LAB_COMPLETED = 6,
+        SCENE = 7
+    };
+
+    QString basePath;
+    QString journalPath;
+    QString previousJournalPath;
+    QFile file;
+    quint32 generation{0};
+    int events{0};
+
+    // Records waiting for flush()
+    QByteArray pending;
+    int pendingEvents{0};
+    QTimer flushTimer;
+
+    bool startJournal(quint32 generation);
+    void append(const QByteArray &payload);
+
+    // Replays one journal file if it belongs to data's generation.
+    // Returns false when the file does not exist or is for another generation.
+    static bool replay(const QString &path, SaveData &data, int *replayed);
+    static bool applyEvent(const QByteArray &payload, SaveData &data);
+};
+
+#endif // SAVEJOURNAL_H
@@ -1,5 +1,8 @@
 #include "scene.h"
 #include "game.h"
+#include "pokemon.h"
+#include "simulation.h"
+#include <QDebug>
 
 Scene::Scene(Game *game, QGraphicsScene *scene, QObject *parent)
     : QObject(parent),
@@ -11,3 +14,56 @@ Scene::Scene(Game *game, QGraphicsScene *scene, QObject *parent)
 Scene::~Scene()
 {
 }
+
+void Scene::scriptSay(const QString &text)
+{
+    qDebug() << "Script text with no dialogue box:" << text;
+}
+
+void Scene::scriptEnd()
+{
+}
+
+void Scene::scriptGiveItem(const QString &item, int count)
+{
+    game->addItem(item, count);
+}
+
+void Scene::scriptGivePokemon(const QString &species)
+{
+    Pokemon::Type type;
+    if (!Pokemon::typeFromName(species, type)) {
+        qDebug() << "Script gave unknown Pokémon:" << species;
+        return;
+    }
+    game->addPokemon(new Pokemon(type));
+}
+
+void Scene::scriptStartBattle(const QString &species)
+{
+    qDebug() << "Battles only start in the grassland, ignoring battle with" << species;
+}
+
+void Scene::scriptChangeScene(const QString &target)
+{
+    GameState state;
+    if (target == "lab") {
+        state = GameState::LABORATORY;
+    } else if (target == "town") {
+        state = GameState::TOWN;
+    } else if (target == "grassland") {
+        state = GameState::GRASSLAND;
+    } else {
+        qDebug() << "Script asked for unknown scene:" << target;
+        return;
+    }
+
+    // Reset movement state before changing scene
+    game->getSimulation()->releaseAllKeys();
+    game->changeScene(state);
+}
+
+void Scene::scriptCall(const QString &hook)
+{
+    qDebug() << "Script called unknown hook:" << hook;
+}
@@ -1,12 +1,19 @@
 #ifndef SCENE_H
 #define SCENE_H
 
+#include "inputsystem.h"
+#include "scenearena.h"
+#include "scriptengine.h"
 #include <QObject>
 #include <QGraphicsScene>
 
 class Game;
+struct WorldContent;
+struct WorldSnapshot;
 
-class Scene : public QObject
+// Scenes also run event scripts. The defaults below act on Game directly;
+// scenes with a dialogue box override scriptSay() and scriptEnd().
+class Scene : public QObject, public ScriptHost
 {
     Q_OBJECT
 
@@ -15,14 +22,37 @@ public:
     virtual ~Scene();
 
     virtual void initialize() = 0;
-    virtual void handleKeyPress(int key) = 0;
+    // Input actions from Game's input tick, see InputSystem for the bindings
+    virtual void handleAction(InputSystem::Action action) = 0;
     virtual void cleanup() = 0;
     virtual void update() = 0;
-    virtual void handleKeyRelease(int key) = 0;
+    virtual void handleActionRelease(InputSystem::Action action) = 0;
+
+    // The lab, the town and the grassland are one world. Game initializes
+    // all three when the world is entered, has each add its colliders,
+    // volumes and grass, and from then on hands the player from one to the
+    // next as they walk or go through a door. Only the scene the player is
+    // in takes input and runs frames; the others keep their items in the
+    // scene and follow along through snapshotTaken().
+    virtual void addToWorld(WorldContent &content) { Q_UNUSED(content); }
+    virtual void enterArea(const QPointF &playerPos) { Q_UNUSED(playerPos); }
+    virtual void leaveArea() {}
+    virtual void snapshotTaken(const WorldSnapshot &snapshot) { Q_UNUSED(snapshot); }
+
+    void scriptSay(const QString &text) override;
+    void scriptEnd() override;
+    void scriptGiveItem(const QString &item, int count) override;
+    void scriptGivePokemon(const QString &species) override;
+    void scriptStartBattle(const QString &species) override;
+    void scriptChangeScene(const QString &target) override;
+    void scriptCall(const QString &hook) override;
 
 protected:
     Game *game;
     QGraphicsScene *scene;
+
+    // Scene-lifetime data; scenes that use it reset it at the end of cleanup()
+    SceneArena arena;
 };
 
 #endif // SCENE_H
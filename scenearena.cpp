@@ -0,0 +1,57 @@
+#include "scenearena.h"
+
+SceneArena::SceneArena(std::size_t blockSize)
+    : blockSize(blockSize > 0 ? blockSize : 64 * 1024)
+{
+}
+
+SceneArena::~SceneArena()
+{
+    for (const Block &block : blocks) {
+        ::operator delete(block.memory);
+    }
+}
+
+void *SceneArena::allocate(std::size_t size, std::size_t alignment)
+{
+    // Blocks kept from before a reset are used again in order; a request
+    // that does not fit the rest of a block moves on to the next one
+    while (current < blocks.size()) {
+        const Block &block = blocks[current];
+        const quintptr base = reinterpret_cast<quintptr>(block.memory);
+        const quintptr start = (base + offset + alignment - 1) & ~static_cast<quintptr>(alignment - 1);
+        const std::size_t end = static_cast<std::size_t>(start - base) + size;
+        if (end <= block.size) {
+            offset = end;
+            return reinterpret_cast<void *>(start);
+        }
+        usedInEarlierBlocks += offset;
+        current++;
+        offset = 0;
+    }
+
+    // Out of blocks: add one, larger than usual if the request needs it
+    Block block;
+    block.size = qMax(blockSize, size + alignment);
+    block.memory = static_cast<char *>(::operator new(block.size));
+    blocks.append(block);
+    current = blocks.size() - 1;
+    offset = 0;
+    return allocate(size, alignment);
+}
+
+void SceneArena::reset()
+{
+    current = 0;
+    offset = 0;
+    usedInEarlierBlocks = 0;
+}
+
+std::size_t SceneArena::capacity() const
+{
+    std::size_t total = 0;
+    for (const Block &block : blocks) {
+        total += block.size;
+    }
+    return total;
+}
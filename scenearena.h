@@ -0,0 +1,117 @@
+#ifndef SCENEARENA_H
+#define SCENEARENA_H
+
+#include <QVector>
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+// Monotonic memory for data that lives exactly as long as a scene is
+// loaded. Only the grassland uses it, for the wild Pokémon spawner: its
+// lattice, cells, areas and free lists. Scene rect lists, the collision
+// world and everything in the town and the lab stay on the heap; they are
+// Qt containers, which cannot take their memory from an arena.
+//
+// Allocating bumps a pointer through large blocks and nothing is freed on
+// its own. reset() takes everything back at once but keeps the blocks, so
+// loading the scene again reuses the same memory instead of going back to
+// the heap. reset() runs no destructors, so only trivially destructible
+// types may live here, and whoever points into the arena must let go of it
+// before the reset.
+class SceneArena
+{
+public:
+    explicit SceneArena(std::size_t blockSize = 64 * 1024);
+    ~SceneArena();
+
+    void *allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t));
+
+    // count value-initialised Ts
+    template <typename T>
+    T *allocateArray(int count)
+    {
+        static_assert(std::is_trivially_destructible<T>::value, "reset() runs no destructors");
+        T *array = static_cast<T *>(allocate(sizeof(T) * static_cast<std::size_t>(qMax(count, 0)), alignof(T)));
+        for (int i = 0; i < count; ++i) {
+            new (array + i) T();
+        }
+        return array;
+    }
+
+    void reset();
+
+    std::size_t bytesUsed() const { return usedInEarlierBlocks + offset; }
+    std::size_t capacity() const;
+
+private:
+    struct Block {
+        char *memory;
+        std::size_t size;
+    };
+
+    std::size_t blockSize;
+    QVector<Block> blocks;
+    int current{0};                      // Block being bumped through
+    std::size_t offset{0};               // Bytes handed out from the current block
+    std::size_t usedInEarlierBlocks{0};
+
+    Q_DISABLE_COPY(SceneArena)
+};
+
+// A growable array in a SceneArena, for plain structs. Growing copies the
+// elements into a new array twice the size; the old one stays in the arena
+// until reset(), like all arena memory.
+template <typename T>
+class ArenaArray
+{
+    static_assert(std::is_trivially_copyable<T>::value, "elements are copied bytewise when growing");
+
+public:
+    // Starts over, empty, taking memory from arena from now on
+    void attach(SceneArena &arena)
+    {
+        this->arena = &arena;
+        elements = nullptr;
+        count = 0;
+        reserved = 0;
+    }
+
+    // Lets go of the memory; call before the arena is reset
+    void clear()
+    {
+        arena = nullptr;
+        elements = nullptr;
+        count = 0;
+        reserved = 0;
+    }
+
+    void append(const T &value)
+    {
+        if (count == reserved) {
+            const int grown = qMax(16, reserved * 2);
+            T *larger = static_cast<T *>(arena->allocate(sizeof(T) * static_cast<std::size_t>(grown), alignof(T)));
+            std::copy(elements, elements + count, larger);
+            elements = larger;
+            reserved = grown;
+        }
+        elements[count++] = value;
+    }
+
+    int size() const { return count; }
+    bool isEmpty() const { return count == 0; }
+    T &operator[](int index) { return elements[index]; }
+    const T &operator[](int index) const { return elements[index]; }
+    T *begin() { return elements; }
+    T *end() { return elements + count; }
+    const T *begin() const { return elements; }
+    const T *end() const { return elements + count; }
+
+private:
+    SceneArena *arena{nullptr};
+    T *elements{nullptr};
+    int count{0};
+    int reserved{0};
+};
+
+#endif // SCENEARENA_H
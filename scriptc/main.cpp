@@ -0,0 +1,54 @@
+#include "../scriptengine.h"
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QTextStream>
+
+// Build-time script compiler: scriptc INPUT.evs OUTPUT.cpp
+//
+// Compiles the event scripts with the game's own ScriptEngine and writes the
+// bytecode out as a C++ source that defines ScriptEngine::builtInBytecode().
+// Errors are printed as file:line: message and fail the build.
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    const QStringList arguments = app.arguments();
+    QTextStream err(stderr);
+    if (arguments.size() != 3) {
+        err << "usage: scriptc INPUT.evs OUTPUT.cpp\n";
+        return 2;
+    }
+
+    ScriptEngine engine;
+    if (!engine.load(arguments[1])) {
+        err << arguments[1] << ": event scripts failed to compile\n";
+        return 1;
+    }
+    const QByteArray bytecode = engine.saveBytecode();
+
+    QSaveFile file(arguments[2]);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        err << "Could not write " << arguments[2] << "\n";
+        return 1;
+    }
+    QTextStream out(&file);
+    out << "// Generated by scriptc from " << QFileInfo(arguments[1]).fileName() << " - edit the script, not this file\n"
+        << "#include \"scriptengine.h\"\n\n"
+        << "namespace {\n"
+        << "const char BYTECODE[] = {";
+    for (int i = 0; i < bytecode.size(); ++i) {
+        out << (i % 16 == 0 ? "\n    " : " ") << static_cast<int>(static_cast<signed char>(bytecode[i])) << ",";
+    }
+    out << "\n};\n"
+        << "}\n\n"
+        << "QByteArray ScriptEngine::builtInBytecode()\n"
+        << "{\n"
+        << "    return QByteArray::fromRawData(BYTECODE, sizeof(BYTECODE));\n"
+        << "}\n";
+    out.flush();
+    if (!file.commit()) {
+        err << "Could not write " << arguments[2] << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,20 @@
+# Host tool that compiles Script/*.evs while the game is built; see
+# SCRIPTC in term_project.pro, which builds and runs it
+QT       = core
+CONFIG  += c++11 console
+CONFIG  -= app_bundle debug_and_release
+
+TARGET   = scriptc
+# term_project.pro expects the tool right here, not in debug/ or release/
+DESTDIR  = $$OUT_PWD
+
+INCLUDEPATH += ..
+
+SOURCES += \
+    main.cpp \
+    ../scriptengine.cpp \
+    ../stringtable.cpp
+
+HEADERS += \
+    ../scriptengine.h \
+    ../stringtable.h
@@ -0,0 +1,480 @@
+#include "scriptengine.h"
+#include <QDataStream>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+
+// "EVSB" at the start of saved bytecode
+static const quint32 BYTECODE_MAGIC = 0x45565342;
+static const quint16 BYTECODE_VERSION = 1;
+
+namespace {
+// Splits a line into words and "quoted strings"; stops at a # comment
+QStringList tokenize(const QString &line, bool &ok)
+{
+    QStringList tokens;
+    ok = true;
+    int i = 0;
+    while (i < line.size()) {
+        const QChar c = line[i];
+        if (c.isSpace()) {
+            i++;
+        } else if (c == QLatin1Char('#')) {
+            break;
+        } else if (c == QLatin1Char('"')) {
+            QString text;
+            i++;
+            while (i < line.size() && line[i] != QLatin1Char('"')) {
+                if (line[i] == QLatin1Char('\\') && i + 1 < line.size()) {
+                    i++;
+                    text += line[i] == QLatin1Char('n') ? QChar('\n') : line[i];
+                } else {
+                    text += line[i];
+                }
+                i++;
+            }
+            if (i >= line.size()) {
+                ok = false;  // Unterminated string
+                return tokens;
+            }
+            i++;
+            tokens.append(text);
+        } else {
+            int start = i;
+            while (i < line.size() && !line[i].isSpace() && line[i] != QLatin1Char('#')) {
+                i++;
+            }
+            tokens.append(line.mid(start, i - start));
+        }
+    }
+    return tokens;
+}
+}
+
+bool ScriptEngine::load(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qDebug() << "Failed to open script file:" << path;
+        return false;
+    }
+    return compile(QString::fromUtf8(file.readAll()), path);
+}
+
+int ScriptEngine::internString(const QString &text)
+{
+    auto it = stringIndex.constFind(text);
+    if (it != stringIndex.constEnd()) {
+        return it.value();
+    }
+    strings.append(text);
+    stringIndex.insert(text, strings.size() - 1);
+    return strings.size() - 1;
+}
+
+const QString &ScriptEngine::localizedString(int index) const
+{
+    const QVector<QString> &localized = translations[StringTable::language()];
+    if (index < localized.size() && !localized[index].isEmpty()) {
+        return localized[index];
+    }
+    return strings.at(index);
+}
+
+int ScriptEngine::internFlag(const QString &name)
+{
+    auto it = flagIndex.constFind(name);
+    if (it != flagIndex.constEnd()) {
+        return it.value();
+    }
+    flags.append(0);
+    flagIndex.insert(name, flags.size() - 1);
+    return flags.size() - 1;
+}
+
+bool ScriptEngine::compile(const QString &source, const QString &fileName)
+{
+    if (isRunning()) {
+        qDebug() << "Cannot compile scripts while an event is running";
+        return false;
+    }
+
+    const int oldCodeSize = code.size();
+    QStringList newEvents;
+    QVector<int> openIfs;  // Operand to patch when the block closes
+    QString currentEvent;
+    int lastText = -1;  // String of the say/choose a language line translates
+    bool ok = true;
+
+    const QStringList lines = source.split(QLatin1Char('\n'));
+    for (int lineNumber = 1; lineNumber <= lines.size(); ++lineNumber) {
+        auto fail = [&](const QString &message) {
+            qDebug().noquote() << QString("%1:%2: %3").arg(fileName).arg(lineNumber).arg(message);
+            ok = false;
+        };
+
+        bool tokensOk = true;
+        const QStringList tokens = tokenize(lines[lineNumber - 1], tokensOk);
+        if (!tokensOk) {
+            fail("unterminated string");
+            continue;
+        }
+        if (tokens.isEmpty()) {
+            continue;
+        }
+        const QString &command = tokens[0];
+        const int argc = tokens.size() - 1;
+
+        StringTable::Language language;
+        if (StringTable::languageFromName(command, language) && !currentEvent.isEmpty()) {
+            if (argc != 1 || lastText < 0) {
+                fail("expected '" + command + " \"text\"' right after a say or choose");
+                continue;
+            }
+            QVector<QString> &localized = translations[language];
+            if (localized.size() < strings.size()) {
+                localized.resize(strings.size());
+            }
+            localized[lastText] = tokens[1];
+            continue;
+        }
+        lastText = -1;
+
+        if (currentEvent.isEmpty()) {
+            if (command != "event" || argc != 1) {
+                fail("expected 'event NAME'");
+            } else if (events.contains(tokens[1]) || newEvents.contains(tokens[1])) {
+                fail("event '" + tokens[1] + "' defined twice");
+            } else {
+                currentEvent = tokens[1];
+                newEvents.append(currentEvent);
+                events.insert(currentEvent, code.size());
+            }
+            continue;
+        }
+
+        bool numberOk = true;
+        if (command == "end" && argc == 0) {
+            if (!openIfs.isEmpty()) {
+                fail("missing endif");
+                openIfs.clear();
+            }
+            code << OP_END;
+            currentEvent.clear();
+        } else if (command == "say" && argc == 1) {
+            lastText = internString(tokens[1]);
+            code << OP_SAY << lastText;
+        } else if (command == "choose" && argc == 2) {
+            const int count = tokens[1].toInt(&numberOk);
+            if (!numberOk || count < 1 || count > 9) {
+                fail("choose needs a count from 1 to 9");
+            }
+            lastText = internString(tokens[2]);
+            code << OP_CHOOSE << lastText << count;
+        } else if (command == "if") {
+            const bool negate = argc >= 1 && tokens[1] == "not";
+            const QStringList condition = tokens.mid(negate ? 2 : 1);
+            if (condition.size() == 2 && condition[0] == "flag") {
+                code << (negate ? OP_JUMP_IF_FLAG : OP_JUMP_UNLESS_FLAG) << internFlag(condition[1]) << -1;
+            } else if (condition.size() == 2 && condition[0] == "choice" && !negate) {
+                code << OP_JUMP_UNLESS_CHOICE << condition[1].toInt(&numberOk) << -1;
+                if (!numberOk) {
+                    fail("choice needs a number");
+                }
+            } else {
+                fail("expected 'if [not] flag NAME' or 'if choice N'");
+                code << OP_JUMP << -1;
+            }
+            openIfs.append(code.size() - 1);
+        } else if (command == "else" && argc == 0) {
+            if (openIfs.isEmpty()) {
+                fail("else without if");
+                continue;
+            }
+            // The taken branch skips the else part
+            code << OP_JUMP << -1;
+            code[openIfs.last()] = code.size();
+            openIfs.last() = code.size() - 1;
+        } else if (command == "endif" && argc == 0) {
+            if (openIfs.isEmpty()) {
+                fail("endif without if");
+                continue;
+            }
+            code[openIfs.takeLast()] = code.size();
+        } else if ((command == "set" || command == "clear") && argc == 2 && tokens[1] == "flag") {
+            code << (command == "set" ? OP_SET_FLAG : OP_CLEAR_FLAG) << internFlag(tokens[2]);
+        } else if (command == "give_item" && argc == 2) {
+            const int count = tokens[2].toInt(&numberOk);
+            if (!numberOk || count < 1) {
+                fail("give_item needs a positive count");
+            }
+            code << OP_GIVE_ITEM << internString(tokens[1]) << count;
+        } else if (command == "give_pokemon" && argc == 1) {
+            code << OP_GIVE_POKEMON << internString(tokens[1]);
+        } else if (command == "start_battle" && argc == 1) {
+            code << OP_START_BATTLE << internString(tokens[1]);
+        } else if (command == "change_scene" && argc == 1) {
+            code << OP_CHANGE_SCENE << internString(tokens[1]);
+        } else if (command == "call" && argc == 1) {
+            code << OP_CALL << internString(tokens[1]);
+        } else if (command == "stop" && argc == 0) {
+            code << OP_END;
+        } else {
+            fail("unknown command '" + tokens.join(' ') + "'");
+        }
+    }
+
+    if (!currentEvent.isEmpty()) {
+        qDebug().noquote() << QString("%1: event '%2' has no end").arg(fileName, currentEvent);
+        ok = false;
+    }
+
+    if (!ok) {
+        // Leave the program as it was before this file
+        code.resize(oldCodeSize);
+        for (const QString &event : newEvents) {
+            events.remove(event);
+        }
+        return false;
+    }
+
+    qDebug() << "Compiled" << newEvents.size() << "script events from" << fileName
+             << "-" << (code.size() - oldCodeSize) << "words of bytecode";
+    return true;
+}
+
+QByteArray ScriptEngine::saveBytecode() const
+{
+    // Flags are stored by name in slot order, so the loaded program keeps its slots
+    QStringList flagNames;
+    flagNames.reserve(flagIndex.size());
+    for (int slot = 0; slot < flags.size(); ++slot) {
+        flagNames.append(flagIndex.key(slot));
+    }
+
+    QByteArray bytes;
+    QDataStream out(&bytes, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_12);
+    out << BYTECODE_MAGIC << BYTECODE_VERSION << code << strings;
+    for (int language = 0; language < StringTable::LANGUAGE_COUNT; ++language) {
+        out << translations[language];
+    }
+    out << events << flagNames;
+    return bytes;
+}
+
+bool ScriptEngine::loadBytecode(const QByteArray &bytes)
+{
+    if (isRunning()) {
+        qDebug() << "Cannot load scripts while an event is running";
+        return false;
+    }
+
+    QDataStream in(bytes);
+    in.setVersion(QDataStream::Qt_5_12);
+    quint32 magic = 0;
+    quint16 version = 0;
+    in >> magic >> version;
+    if (magic != BYTECODE_MAGIC || version != BYTECODE_VERSION) {
+        qDebug() << "Script bytecode has the wrong format (version" << version << ")";
+        return false;
+    }
+
+    QVector<qint32> newCode;
+    QStringList newStrings;
+    QVector<QString> newTranslations[StringTable::LANGUAGE_COUNT];
+    QHash<QString, int> newEvents;
+    QStringList flagNames;
+    in >> newCode >> newStrings;
+    for (int language = 0; language < StringTable::LANGUAGE_COUNT; ++language) {
+        in >> newTranslations[language];
+    }
+    in >> newEvents >> flagNames;
+    if (in.status() != QDataStream::Ok) {
+        qDebug() << "Script bytecode is truncated";
+        return false;
+    }
+    for (int entry : newEvents) {
+        if (entry < 0 || entry >= newCode.size()) {
+            qDebug() << "Script bytecode has an event outside its code";
+            return false;
+        }
+    }
+
+    code = newCode;
+    strings = newStrings;
+    for (int language = 0; language < StringTable::LANGUAGE_COUNT; ++language) {
+        translations[language] = newTranslations[language];
+    }
+    events = newEvents;
+    stringIndex.clear();
+    for (int i = 0; i < strings.size(); ++i) {
+        stringIndex.insert(strings[i], i);
+    }
+    flagIndex.clear();
+    for (int slot = 0; slot < flagNames.size(); ++slot) {
+        flagIndex.insert(flagNames[slot], slot);
+    }
+    flags.fill(0, flagNames.size());
+
+    qDebug() << "Loaded" << events.size() << "script events -" << code.size() << "words of bytecode";
+    return true;
+}
+
+bool ScriptEngine::start(const QString &event, ScriptHost *host)
+{
+    if (isRunning()) {
+        qDebug() << "Script" << runningEvent << "still running, not starting" << event;
+        return false;
+    }
+    auto it = events.constFind(event);
+    if (it == events.constEnd() || !host) {
+        qDebug() << "Unknown script event:" << event;
+        return false;
+    }
+
+    this->host = host;
+    pc = it.value();
+    waiting = WAIT_NONE;
+    choice = 0;
+    pendingChoices = 0;
+    runningEvent = event;
+    run();
+    return true;
+}
+
+void ScriptEngine::advance()
+{
+    if (host && waiting == WAIT_ADVANCE) {
+        waiting = WAIT_NONE;
+        run();
+    }
+}
+
+void ScriptEngine::choose(int option)
+{
+    if (host && waiting == WAIT_CHOICE && option >= 1 && option <= pendingChoices) {
+        choice = option;
+        waiting = WAIT_NONE;
+        run();
+    }
+}
+
+void ScriptEngine::tick()
+{
+    if (host && waiting == WAIT_NONE) {
+        run();
+    }
+}
+
+void ScriptEngine::stop()
+{
+    host = nullptr;
+    waiting = WAIT_NONE;
+}
+
+void ScriptEngine::cancel()
+{
+    if (host) {
+        finish();
+    }
+}
+
+bool ScriptEngine::flag(const QString &name) const
+{
+    int index = flagIndex.value(name, -1);
+    return index >= 0 && flags[index];
+}
+
+void ScriptEngine::setFlag(const QString &name, bool value)
+{
+    flags[internFlag(name)] = value ? 1 : 0;
+}
+
+void ScriptEngine::finish()
+{
+    // Clear the state first: the host may start another event from here
+    ScriptHost *finishedHost = host;
+    host = nullptr;
+    waiting = WAIT_NONE;
+    finishedHost->scriptEnd();
+}
+
+void ScriptEngine::run()
+{
+    QElapsedTimer timer;
+    timer.start();
+    int steps = 0;
+
+    while (host && waiting == WAIT_NONE && steps < MAX_STEPS_PER_TICK) {
+        steps++;
+        const qint32 op = code[pc++];
+        switch (op) {
+        case OP_END:
+            finish();
+            break;
+        case OP_SAY:
+            waiting = WAIT_ADVANCE;
+            host->scriptSay(localizedString(code[pc++]));
+            break;
+        case OP_CHOOSE:
+            waiting = WAIT_CHOICE;
+            pendingChoices = code[pc + 1];
+            host->scriptSay(localizedString(code[pc]));
+            pc += 2;
+            break;
+        case OP_JUMP:
+            pc = code[pc];
+            break;
+        case OP_JUMP_IF_FLAG:
+            pc = flags[code[pc]] ? code[pc + 1] : pc + 2;
+            break;
+        case OP_JUMP_UNLESS_FLAG:
+            pc = flags[code[pc]] ? pc + 2 : code[pc + 1];
+            break;
+        case OP_JUMP_UNLESS_CHOICE:
+            pc = choice == code[pc] ? pc + 2 : code[pc + 1];
+            break;
+        case OP_SET_FLAG:
+            flags[code[pc++]] = 1;
+            break;
+        case OP_CLEAR_FLAG:
+            flags[code[pc++]] = 0;
+            break;
+        case OP_GIVE_ITEM:
+            host->scriptGiveItem(strings.at(code[pc]), code[pc + 1]);
+            pc += 2;
+            break;
+        case OP_GIVE_POKEMON:
+            host->scriptGivePokemon(strings.at(code[pc++]));
+            break;
+        case OP_START_BATTLE: {
+            // The battle takes over the screen, so the event ends here
+            ScriptHost *battleHost = host;
+            const QString &species = strings.at(code[pc++]);
+            finish();
+            battleHost->scriptStartBattle(species);
+            break;
+        }
+        case OP_CHANGE_SCENE: {
+            // The host is cleaned up by the scene change, so finish first
+            ScriptHost *sceneHost = host;
+            const QString &target = strings.at(code[pc++]);
+            finish();
+            sceneHost->scriptChangeScene(target);
+            break;
+        }
+        case OP_CALL:
+            host->scriptCall(strings.at(code[pc++]));
+            break;
+        default:
+            qDebug() << "Bad script opcode" << op << "in" << runningEvent;
+            stop();
+            break;
+        }
+    }
+
+    totalInstructions += steps;
+    totalNs += timer.nsecsElapsed();
+    longestRunInstructions = qMax(longestRunInstructions, steps);
+}
@@ -0,0 +1,156 @@
+#ifndef SCRIPTENGINE_H
+#define SCRIPTENGINE_H
+
+#include "stringtable.h"
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// What a running script can do to the game. Scenes implement this; the
+// dialogue calls are the only ones without a sensible default.
+class ScriptHost
+{
+public:
+    virtual ~ScriptHost() = default;
+
+    // Shows text in the dialogue box until the player presses A
+    virtual void scriptSay(const QString &text) = 0;
+    // Closes the dialogue box when the event is over
+    virtual void scriptEnd() = 0;
+
+    virtual void scriptGiveItem(const QString &item, int count) = 0;
+    virtual void scriptGivePokemon(const QString &species) = 0;
+    virtual void scriptStartBattle(const QString &species) = 0;
+    // scene: lab, town or grassland
+    virtual void scriptChangeScene(const QString &scene) = 0;
+    // Scene-specific hook, e.g. "remove_pokeballs"
+    virtual void scriptCall(const QString &hook) = 0;
+};
+
+// Event scripts for dialogue and story beats.
+//
+// Scripts are plain text (Script/events.evs). scriptc, a host tool built
+// around this class, compiles them into a flat bytecode array while the
+// game is built, so a script error fails the build; the game only loads
+// the embedded bytecode. Running an event then only walks that array, so
+// the interpreter allocates nothing. A script stops at every say/choose
+// until the player answers, and otherwise runs at most
+// MAX_STEPS_PER_TICK instructions per call before yielding to the game
+// loop, so a broken loop in a script cannot hang a frame.
+//
+//   # Comment
+//   event lab_door
+//       say "Would you like to go outside to the town?"
+//           zh_TW "要到外面的城鎮去嗎？"
+//       change_scene town
+//   end
+//
+// Commands: say "text", choose N "text", if [not] flag NAME / if choice N,
+// else, endif, set flag NAME, clear flag NAME, give_item "name" COUNT,
+// give_pokemon SPECIES, start_battle SPECIES, change_scene SCENE,
+// call HOOK, stop. A language line (zh_TW "text") right after a say or
+// choose gives its text in that language; the English text is the fallback.
+class ScriptEngine
+{
+public:
+    static const int MAX_STEPS_PER_TICK = 256;
+
+    ScriptEngine() = default;
+
+    // Compiles a script file; false (with the errors logged) if it has any
+    bool load(const QString &path);
+    bool compile(const QString &source, const QString &fileName = QString("script"));
+
+    // The compiled program, as scriptc writes it into the game
+    QByteArray saveBytecode() const;
+    // Replaces the program with one from saveBytecode(); every flag starts cleared
+    bool loadBytecode(const QByteArray &bytes);
+    // Script/events.evs as compiled during the build (defined in the
+    // events_bytecode.cpp scriptc generates)
+    static QByteArray builtInBytecode();
+
+    bool hasEvent(const QString &event) const { return events.contains(event); }
+
+    // Runs an event until it waits for the player or ends. False when the
+    // event does not exist or another one is still running.
+    bool start(const QString &event, ScriptHost *host);
+    // Continues after a say (A pressed)
+    void advance();
+    // Answers a choose with an option from 1 to its count
+    void choose(int option);
+    // Continues a script that used up its step budget
+    void tick();
+    // Drops the running event without calling the host again
+    void stop();
+    // Ends the running event as if it had reached its end, so the host
+    // closes its dialogue; how the player backs out of a choice
+    void cancel();
+
+    bool isRunning() const { return host != nullptr; }
+    // Running and not waiting for the player, so tick() has work to do
+    bool needsTick() const { return host && waiting == WAIT_NONE; }
+    bool isWaitingForChoice() const { return host && waiting == WAIT_CHOICE; }
+    int choiceCount() const { return pendingChoices; }
+
+    bool flag(const QString &name) const;
+    void setFlag(const QString &name, bool value);
+
+    // Execution cost since start-up
+    quint64 instructionCount() const { return totalInstructions; }
+    qint64 busyNanoseconds() const { return totalNs; }
+    int longestRun() const { return longestRunInstructions; }
+
+private:
+    enum Opcode : qint32 {
+        OP_END,
+        OP_SAY,              // string
+        OP_CHOOSE,           // string, count
+        OP_JUMP,             // target
+        OP_JUMP_IF_FLAG,     // flag, target
+        OP_JUMP_UNLESS_FLAG, // flag, target
+        OP_JUMP_UNLESS_CHOICE, // choice, target
+        OP_SET_FLAG,         // flag
+        OP_CLEAR_FLAG,       // flag
+        OP_GIVE_ITEM,        // string, count
+        OP_GIVE_POKEMON,     // string
+        OP_START_BATTLE,     // string
+        OP_CHANGE_SCENE,     // string
+        OP_CALL              // string
+    };
+
+    enum Wait {
+        WAIT_NONE,
+        WAIT_ADVANCE,
+        WAIT_CHOICE
+    };
+
+    QVector<qint32> code;
+    QStringList strings;
+    QVector<QString> translations[StringTable::LANGUAGE_COUNT];  // Parallel to strings, empty = untranslated
+    QHash<QString, int> stringIndex;
+    QHash<QString, int> events;      // Event name -> entry point
+    QHash<QString, int> flagIndex;   // Flag name -> slot in flags
+    QVector<quint8> flags;
+
+    // Running event
+    ScriptHost *host{nullptr};
+    int pc{0};
+    Wait waiting{WAIT_NONE};
+    int choice{0};
+    int pendingChoices{0};
+    QString runningEvent;
+
+    quint64 totalInstructions{0};
+    qint64 totalNs{0};
+    int longestRunInstructions{0};
+
+    void run();
+    void finish();
+    int internString(const QString &text);
+    const QString &localizedString(int index) const;
+    int internFlag(const QString &name);
+};
+
+#endif // SCRIPTENGINE_H
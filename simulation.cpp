@@ -0,0 +1,685 @@
+#include "simulation.h"
+#include "inputsystem.h"
+#include "stresstest.h"
+#include <QDebug>
+#include <QTimer>
+
+// Steps needed before walking speeds up
+static const int STEPS_BEFORE_FAST = 3;
+
+// Wild Pokémon never appear closer than this to the player
+static const int SPAWN_MIN_PLAYER_DISTANCE = 50;
+
+// Battle delays are checked this often while one is running
+static const int BATTLE_TICK_MS = 16;
+
+// Chunks this many chunks from the player's are loaded, so everything
+// within a chunk's reach is there before the player gets to it...
+static const int LOAD_RADIUS = 1;
+// ...and stay until the player is this far away, so walking along a chunk
+// border does not load and drop the same chunks on every step
+static const int UNLOAD_RADIUS = 2;
+
+Simulation::Simulation(InputSystem *input, QObject *parent)
+    : QObject(parent),
+      input(input),
+      random(QRandomGenerator::global()->generate()),
+      spawner(StressTest::isEnabled() ? WildSpawner(5.0, 30.0, 40.0, 0.0) : WildSpawner()),  // Stress runs pack spawns densely
+      battle(&random)
+{
+    spawner.setRandomGenerator(&random);
+}
+
+quint32 Simulation::loadWorld(const WorldContent &content, const QPointF &playerPos)
+{
+    quint32 generation = ++generationCounter;
+    input->releaseAll();
+    frozen = false;
+
+    // The copy is cheap (implicitly shared) and belongs to the worker from here on
+    QMetaObject::invokeMethod(this, [this, playerPos, content, generation]() {
+        ensureTimers();
+        this->content = content;
+        worldGeneration = generation;
+        position = playerPos;
+        direction = 'F';
+        walkFrame = 0;
+        heldSteps = 0;
+        loaded = true;
+        events.resize(0);  // The old world's scene is gone
+        battle.cancel();
+
+        // Nothing is loaded until streamChunks() looks around the player
+        world.clear();
+        triggers->clear();
+        loadedChunks.resize(0);
+        hasPlayerChunk = false;
+        solidRefs.fill(0, content.solids.size());
+        ledgeRefs.fill(0, content.ledges.size());
+        triggerRefs.fill(0, content.triggers.size());
+        grassRefs.fill(0, content.grassAreas.size());
+
+        // Build the spawn lattice once; grass areas spawn while their chunks are loaded
+        wild.resize(0);
+        wild.reserve(content.maxWildPokemon);
+        wildVersion++;
+        spawner.clear();
+        spawnArena.reset();
+        if (!content.grassAreas.isEmpty()) {
+            spawner.begin(spawnArena, content.spawnBounds);
+            for (const QRectF &rect : content.spawnBlockers) {
+                spawner.addBlocker(rect);
+            }
+            for (const QRectF &rect : content.grassAreas) {
+                const int grassArea = spawner.addArea(rect, WildSpawner::defaultTable(), content.respawnDelayMs);
+                spawner.setAreaEnabled(grassArea, false);
+            }
+        }
+
+        // Volumes under the start position fire right away
+        updateArea();
+        streamChunks();
+        triggers->updatePlayer(position);
+        encounterCheckPending = false;
+
+        stepTimer->start(walk().stepIntervalMs);
+        publish();
+        qDebug() << "Simulation loaded world" << generation << "with" << loadedChunks.size() << "chunks around the player";
+    }, Qt::QueuedConnection);
+
+    return generation;
+}
+
+quint32 Simulation::moveTo(const QPointF &playerPos)
+{
+    quint32 generation = ++generationCounter;
+    input->releaseAll();
+
+    QMetaObject::invokeMethod(this, [this, playerPos, generation]() {
+        if (!loaded) {
+            return;
+        }
+        worldGeneration = generation;
+        position = playerPos;
+        walkFrame = 0;
+        heldSteps = 0;
+
+        // Whatever the player left behind unloads, exits included
+        updateArea();
+        streamChunks();
+        triggers->updatePlayer(position);
+        encounterCheckPending = false;
+        publish();
+    }, Qt::QueuedConnection);
+
+    return generation;
+}
+
+void Simulation::ensureTimers()
+{
+    if (stepTimer) {
+        return;
+    }
+
+    // Created on the worker thread, so they fire there
+    stepTimer = new QTimer(this);
+    connect(stepTimer, &QTimer::timeout, this, &Simulation::step);
+    respawnTimer = new QTimer(this);
+    respawnTimer->setSingleShot(true);
+    connect(respawnTimer, &QTimer::timeout, this, &Simulation::updateSpawns);
+    battleTimer = new QTimer(this);
+    battleTimer->setInterval(BATTLE_TICK_MS);
+    connect(battleTimer, &QTimer::timeout, this, &Simulation::advanceBattle);
+    clock.start();
+
+    triggers = new TriggerSystem(4.0, this);
+    connect(triggers, &TriggerSystem::entered, this, [this](TriggerSystem::Kind kind, int index) {
+        raiseTrigger(WorldEvent::TRIGGER_ENTERED, kind, index);
+        if (kind == TriggerSystem::Kind::Grass) {
+            encounterCheckPending = true;
+        }
+    });
+    connect(triggers, &TriggerSystem::exited, this, [this](TriggerSystem::Kind kind, int index) {
+        raiseTrigger(WorldEvent::TRIGGER_EXITED, kind, index);
+    });
+    connect(triggers, &TriggerSystem::stayed, this, [this](TriggerSystem::Kind kind, int index) {
+        // Only the encounter check cares about every step inside a volume
+        Q_UNUSED(index);
+        if (kind == TriggerSystem::Kind::Grass) {
+            encounterCheckPending = true;
+        }
+    });
+}
+
+void Simulation::unloadWorld()
+{
+    // Any snapshot still in flight belongs to an older generation now
+    ++generationCounter;
+    input->releaseAll();
+
+    QMetaObject::invokeMethod(this, [this]() {
+        loaded = false;
+        world.clear();
+        loadedChunks.resize(0);
+        hasPlayerChunk = false;
+        if (stepTimer) {
+            stepTimer->stop();
+            respawnTimer->stop();
+            battleTimer->stop();
+            triggers->clear();
+        }
+        battle.cancel();
+        spawner.clear();
+        spawnArena.reset();
+        wild.resize(0);
+        events.resize(0);
+    }, Qt::QueuedConnection);
+}
+
+void Simulation::pressKey(int key)
+{
+    input->keyPressed(key);
+    const int action = input->actionForKey(key);
+    if (action < 0 || !(InputSystem::MOVEMENT_ACTIONS & (1u << action))) {
+        return;
+    }
+
+    // Take the immediate step now and time the held steps from this press
+    QMetaObject::invokeMethod(this, [this]() {
+        if (!loaded) {
+            return;
+        }
+        heldSteps = 0;
+        stepTimer->start(walk().stepIntervalMs);
+        step();
+    }, Qt::QueuedConnection);
+}
+
+void Simulation::releaseKey(int key)
+{
+    // Another key still held keeps the player walking at the next step
+    input->keyReleased(key);
+}
+
+void Simulation::releaseAllKeys()
+{
+    input->releaseAll();
+}
+
+void Simulation::setFrozen(bool frozen)
+{
+    // A key held through a dialogue walks on once it closes, and the grass
+    // refills again, so the idle timers have to come back
+    if (this->frozen.exchange(frozen) && !frozen) {
+        const bool walking = input->anyHeld(InputSystem::MOVEMENT_ACTIONS);
+        QMetaObject::invokeMethod(this, [this, walking]() {
+            if (!loaded) {
+                return;
+            }
+            if (walking && !stepTimer->isActive()) {
+                stepTimer->start(walk().stepIntervalMs);
+            }
+            updateSpawns();
+        }, Qt::QueuedConnection);
+    }
+}
+
+void Simulation::startBattle(const BattleState::Setup &setup)
+{
+    frozen = true;
+    QMetaObject::invokeMethod(this, [this, setup]() {
+        if (!loaded) {
+            return;
+        }
+        battle.start(setup, clock.elapsed());
+        flushBattle();
+    }, Qt::QueuedConnection);
+}
+
+void Simulation::battleAction(int action)
+{
+    QMetaObject::invokeMethod(this, [this, action]() {
+        if (!loaded || !battle.isActive()) {
+            return;
+        }
+        battle.choose(action, clock.elapsed());
+        flushBattle();
+    }, Qt::QueuedConnection);
+}
+
+void Simulation::battleCommand(BattleState::Command command, int index)
+{
+    QMetaObject::invokeMethod(this, [this, command, index]() {
+        if (!loaded || !battle.isActive()) {
+            return;
+        }
+        battle.command(command, index, clock.elapsed());
+        flushBattle();
+    }, Qt::QueuedConnection);
+}
+
+void Simulation::setBattleTimeScale(qreal scale)
+{
+    QMetaObject::invokeMethod(this, [this, scale]() {
+        battle.setTimeScale(scale);
+    }, Qt::QueuedConnection);
+}
+
+bool Simulation::takeSnapshot(quint32 generation, WorldSnapshot &snapshot)
+{
+    if (!snapshots.update()) {
+        return false;
+    }
+    const WorldSnapshot &latest = snapshots.readBuffer();
+    if (latest.generation != generation) {
+        return false;
+    }
+    snapshot = latest;
+
+    // Skip the events an earlier snapshot already delivered, and let the
+    // worker drop everything up to here
+    snapshot.firstNewEvent = 0;
+    while (snapshot.firstNewEvent < snapshot.events.size()
+           && snapshot.events[snapshot.firstNewEvent].sequence <= seenEventSequence) {
+        snapshot.firstNewEvent++;
+    }
+    if (!snapshot.events.isEmpty()) {
+        seenEventSequence = snapshot.events.last().sequence;
+        takenEventSequence = seenEventSequence;
+    }
+    return true;
+}
+
+void Simulation::step()
+{
+    if (!loaded) {
+        return;
+    }
+
+    // One look at the keyboard per step. A key that went down since the last
+    // step takes the short nudge step; held keys walk.
+    const InputSystem::Sample keys = input->sample(inputReader);
+    const bool nudge = (keys.pressed & InputSystem::MOVEMENT_ACTIONS) != 0;
+    const int action = keys.latest;
+    if (frozen || action < 0) {
+        // Nothing to step until a key goes down or the freeze ends
+        heldSteps = 0;
+        stepTimer->stop();
+        return;
+    }
+
+    const WorldContent::Walk &settings = walk();
+    qreal distance = nudge ? settings.nudgeDistance
+                           : (heldSteps > STEPS_BEFORE_FAST ? settings.fastSpeed : settings.baseSpeed);
+
+    QPointF delta;
+    if (action == InputSystem::MOVE_UP) {
+        delta.setY(-distance);
+        direction = 'B';
+    } else if (action == InputSystem::MOVE_DOWN) {
+        delta.setY(distance);
+        direction = 'F';
+    } else if (action == InputSystem::MOVE_LEFT) {
+        delta.setX(-distance);
+        direction = 'L';
+    } else if (action == InputSystem::MOVE_RIGHT) {
+        delta.setX(distance);
+        direction = 'R';
+    }
+
+    // Clamp to the walkable area first, then sweep against barriers and ledges
+    QPointF target = position + delta;
+    target.setX(qBound(settings.bounds.left(), target.x(), settings.bounds.right()));
+    target.setY(qBound(settings.bounds.top(), target.y(), settings.bounds.bottom()));
+    QPointF next = mover.move(world, position, target - position).position;
+
+    if (next == position) {
+        heldSteps = 0;  // Walking into a wall starts the speed-up over
+    } else {
+        position = next;
+        walkFrame = (walkFrame + 1) % 3;
+        if (!nudge) {
+            heldSteps++;
+        }
+
+        // Bring in what lies ahead, then raise portal, bulletin board, box
+        // and grass events for the new position
+        updateArea();
+        streamChunks();
+        triggers->updatePlayer(position);
+    }
+
+    // Wild Pokémon never spawn on top of the player, so an encounter can
+    // only start after the player has moved inside tall grass
+    if (encounterCheckPending) {
+        encounterCheckPending = false;
+        checkEncounter();
+    }
+
+    answeredInputNs = keys.firstPressNs(InputSystem::MOVEMENT_ACTIONS);
+    publish();
+}
+
+void Simulation::updateArea()
+{
+    // Between areas, e.g. in the gap of a path, the last area still holds
+    const MapLayout::Area under = MapLayout::playerArea(position);
+    if (under != MapLayout::AREA_COUNT) {
+        area = under;
+    }
+}
+
+void Simulation::streamChunks()
+{
+    const QPoint chunk(WorldContent::chunkOf(position.x()), WorldContent::chunkOf(position.y()));
+    if (hasPlayerChunk && chunk == playerChunk) {
+        return;
+    }
+    hasPlayerChunk = true;
+    playerChunk = chunk;
+
+    // Drop the chunks left behind, then load the ones that came into reach
+    bool collisionChanged = false;
+    for (int i = loadedChunks.size() - 1; i >= 0; --i) {
+        const QPoint loadedChunk = loadedChunks[i];
+        if (qAbs(loadedChunk.x() - chunk.x()) > UNLOAD_RADIUS || qAbs(loadedChunk.y() - chunk.y()) > UNLOAD_RADIUS) {
+            collisionChanged |= unloadChunk(loadedChunk);
+            loadedChunks.remove(i);
+        }
+    }
+    for (int row = chunk.y() - LOAD_RADIUS; row <= chunk.y() + LOAD_RADIUS; ++row) {
+        for (int column = chunk.x() - LOAD_RADIUS; column <= chunk.x() + LOAD_RADIUS; ++column) {
+            const QPoint nearChunk(column, row);
+            if (!loadedChunks.contains(nearChunk)) {
+                loadedChunks.append(nearChunk);
+                collisionChanged |= loadChunk(nearChunk);
+            }
+        }
+    }
+
+    if (collisionChanged) {
+        rebuildCollision();
+    }
+    // Grass that came into reach spawns right away if it is due
+    updateSpawns();
+}
+
+bool Simulation::loadChunk(const QPoint &chunk)
+{
+    const WorldContent::Chunk *contents = content.chunk(chunk.x(), chunk.y());
+    if (!contents) {
+        return false;
+    }
+
+    bool collisionChanged = false;
+    for (int solid : contents->solids) {
+        collisionChanged |= solidRefs[solid]++ == 0;
+    }
+    for (int ledge : contents->ledges) {
+        collisionChanged |= ledgeRefs[ledge]++ == 0;
+    }
+    for (int trigger : contents->triggers) {
+        if (triggerRefs[trigger]++ == 0) {
+            addTrigger(trigger);
+        }
+    }
+    // The grass spawns at the next updateSpawns()
+    for (int grassArea : contents->grassAreas) {
+        if (grassRefs[grassArea]++ == 0) {
+            spawner.setAreaEnabled(grassArea, true);
+        }
+    }
+    return collisionChanged;
+}
+
+bool Simulation::unloadChunk(const QPoint &chunk)
+{
+    const WorldContent::Chunk *contents = content.chunk(chunk.x(), chunk.y());
+    if (!contents) {
+        return false;
+    }
+
+    bool collisionChanged = false;
+    for (int solid : contents->solids) {
+        collisionChanged |= --solidRefs[solid] == 0;
+    }
+    for (int ledge : contents->ledges) {
+        collisionChanged |= --ledgeRefs[ledge] == 0;
+    }
+    for (int trigger : contents->triggers) {
+        if (--triggerRefs[trigger] == 0) {
+            const WorldContent::Trigger &volume = content.triggers[trigger];
+            triggers->remove(volume.kind, volume.index);
+        }
+    }
+    for (int grassArea : contents->grassAreas) {
+        if (--grassRefs[grassArea] == 0) {
+            removeGrass(grassArea);
+        }
+    }
+    return collisionChanged;
+}
+
+void Simulation::addTrigger(int trigger)
+{
+    const WorldContent::Trigger &volume = content.triggers[trigger];
+    if (volume.radius > 0) {
+        triggers->addRadius(volume.kind, volume.index, volume.center, volume.radius);
+    } else {
+        triggers->addRect(volume.kind, volume.index, volume.rect);
+    }
+}
+
+void Simulation::removeGrass(int grassArea)
+{
+    // Its Pokémon go with it; the area fills again once it is back in reach
+    // and its respawn timer has run out
+    const qint64 now = clock.elapsed();
+    for (int i = wild.size() - 1; i >= 0; --i) {
+        if (wild[i].area == grassArea) {
+            spawner.release(wild[i].token, now);
+            wild.remove(i);
+            wildVersion++;
+        }
+    }
+    spawner.setAreaEnabled(grassArea, false);
+}
+
+void Simulation::rebuildCollision()
+{
+    // A few dozen rects at most; rebuilding the grid is simpler than patching it
+    world.clear();
+    for (int i = 0; i < solidRefs.size(); ++i) {
+        if (solidRefs[i] > 0) {
+            world.addSolid(content.solids[i]);
+        }
+    }
+    for (int i = 0; i < ledgeRefs.size(); ++i) {
+        if (ledgeRefs[i] > 0) {
+            world.addLedge(content.ledges[i]);
+        }
+    }
+}
+
+void Simulation::publish()
+{
+    WorldSnapshot &snapshot = snapshots.writeBuffer();
+    snapshot.tick = ++tick;
+    snapshot.generation = worldGeneration;
+    snapshot.playerPos = position;
+    snapshot.area = area;
+    snapshot.direction = direction;
+    snapshot.walkFrame = walkFrame;
+    snapshot.inputNs = answeredInputNs;
+    answeredInputNs = 0;
+
+    for (int kind = 0; kind < TriggerSystem::KIND_COUNT; ++kind) {
+        snapshot.occupied[kind] = triggers ? triggers->occupied(static_cast<TriggerSystem::Kind>(kind)) : -1;
+    }
+    snapshot.wild = wild;  // Shared; only copied when the next spawn changes it
+    snapshot.wildVersion = wildVersion;
+    snapshot.battleBusy = battle.isBusy();
+
+    // Events the GUI thread has taken are dropped; the rest go out again
+    const quint64 taken = takenEventSequence.load();
+    int takenCount = 0;
+    while (takenCount < events.size() && events[takenCount].sequence <= taken) {
+        takenCount++;
+    }
+    if (takenCount > 0) {
+        events.remove(0, takenCount);
+    }
+    snapshot.events = events;
+    snapshot.firstNewEvent = 0;
+
+    snapshots.publish();
+    emit snapshotPublished();
+}
+
+void Simulation::raise(WorldEvent &event)
+{
+    event.sequence = ++eventSequence;
+    events.append(event);
+}
+
+void Simulation::raiseTrigger(WorldEvent::Type type, TriggerSystem::Kind kind, int index)
+{
+    WorldEvent event;
+    event.type = type;
+    event.trigger = kind;
+    event.index = index;
+    raise(event);
+}
+
+void Simulation::spawnWildPokemon(int area)
+{
+    if (wild.size() >= content.maxWildPokemon) {
+        qDebug() << "Wild Pokémon pool is full - not spawning in grass area" << area;
+        return;
+    }
+
+    // The spawner only hands out cells that are clear of barriers, other
+    // Pokémon and far enough from the player - or nothing at all
+    QPointF playerCenter(position.x() + 15, position.y() + 20);
+    WildSpawner::Spawn spawn;
+    if (!spawner.spawn(area, playerCenter, SPAWN_MIN_PLAYER_DISTANCE, spawn)) {
+        return;
+    }
+    wild.append(spawn);
+    wildVersion++;
+}
+
+void Simulation::updateSpawns()
+{
+    // Respawns wait while the world is frozen; unfreezing comes back here
+    if (!loaded || frozen || spawner.areaCount() == 0) {
+        if (respawnTimer) {
+            respawnTimer->stop();
+        }
+        return;
+    }
+
+    // Refill empty grass areas once their respawn timer has run out
+    const quint32 before = wildVersion;
+    const qint64 now = clock.elapsed();
+    for (int i = 0; i < spawner.areaCount(); ++i) {
+        if (spawner.isRespawnDue(i, now)) {
+            spawnWildPokemon(i);
+        }
+    }
+
+    // Keep going round the loaded areas until the pool or the grass is full
+    if (content.fillGrass) {
+        int before = -1;
+        while (wild.size() < content.maxWildPokemon && wild.size() != before) {
+            before = wild.size();
+            for (int i = 0; i < spawner.areaCount() && wild.size() < content.maxWildPokemon; i++) {
+                if (grassRefs[i] > 0) {
+                    spawnWildPokemon(i);
+                }
+            }
+        }
+    }
+
+    // Still due after this: the area had no free cell away from the player,
+    // so try again a little later
+    const qint64 respawnAt = spawner.nextRespawnAtMs();
+    if (respawnAt < 0) {
+        respawnTimer->stop();
+    } else {
+        const qint64 dueIn = respawnAt - now;
+        respawnTimer->start(dueIn > 0 ? static_cast<int>(dueIn) : 250);
+    }
+
+    if (wildVersion != before) {
+        publish();
+    }
+}
+
+bool Simulation::checkEncounter()
+{
+    if (!content.encounters) {
+        return false;
+    }
+
+    QRectF playerBox(position.x() + 5, position.y() + 10, 25, 35);
+    for (int i = 0; i < wild.size(); ++i) {
+        const WildSpawner::Spawn &pokemon = wild[i];
+        QRectF pokemonBox(pokemon.position.x() - 20, pokemon.position.y() - 20, 40, 40);
+        if (!playerBox.intersects(pokemonBox)) {
+            continue;
+        }
+
+        WorldEvent event;
+        event.type = WorldEvent::ENCOUNTER;
+        event.species = pokemon.species;
+
+        // Free its spot and start the area's respawn timer; it cannot be
+        // encountered again
+        spawner.release(pokemon.token, clock.elapsed());
+        wild.remove(i);
+        wildVersion++;
+
+        // The battle starts here: nothing walks on until the scene is done with it
+        frozen = true;
+        heldSteps = 0;
+        stepTimer->stop();
+        respawnTimer->stop();
+        raise(event);
+        qDebug() << "Player ran into a wild" << event.species;
+        return true;
+    }
+    return false;
+}
+
+void Simulation::flushBattle()
+{
+    battle.takeEvents(battleEvents);
+    for (const BattleState::Event &battleEvent : battleEvents) {
+        WorldEvent event;
+        event.type = WorldEvent::BATTLE;
+        event.battle = battleEvent;
+        raise(event);
+    }
+    const bool changed = !battleEvents.isEmpty();
+    battleEvents.resize(0);
+
+    // Delays need the battle timer; waiting for the player does not
+    if (battle.isRunning()) {
+        if (!battleTimer->isActive()) {
+            battleTimer->start();
+        }
+    } else {
+        battleTimer->stop();
+    }
+
+    if (changed) {
+        publish();
+    }
+}
+
+void Simulation::advanceBattle()
+{
+    battle.advance(clock.elapsed());
+    flushBattle();
+}
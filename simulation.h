@@ -0,0 +1,207 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include "battlestate.h"
+#include "collisionworld.h"
+#include "inputsystem.h"
+#include "kinematicmover.h"
+#include "scenearena.h"
+#include "triggersystem.h"
+#include "triplebuffer.h"
+#include "wildspawner.h"
+#include "worldcontent.h"
+#include <QElapsedTimer>
+#include <QObject>
+#include <QPoint>
+#include <QPointF>
+#include <QRandomGenerator>
+#include <QRectF>
+#include <QVector>
+#include <atomic>
+
+class QTimer;
+
+// Something the simulation did that the scene has to act on
+struct WorldEvent {
+    enum Type {
+        TRIGGER_ENTERED,  // trigger, index
+        TRIGGER_EXITED,
+        ENCOUNTER,        // species: the player walked into a wild Pokémon; the world is frozen
+        BATTLE            // battle
+    };
+
+    quint64 sequence{0};
+    Type type{TRIGGER_ENTERED};
+    TriggerSystem::Kind trigger{TriggerSystem::Kind::Portal};
+    int index{-1};
+    QString species;
+    BattleState::Event battle;
+};
+
+// Immutable result of one simulation tick, handed to the GUI thread
+struct WorldSnapshot {
+    quint64 tick{0};
+    quint32 generation{0};  // loadWorld() or moveTo() call the snapshot belongs to
+    QPointF playerPos;
+    MapLayout::Area area{MapLayout::AREA_TOWN};  // Area the player is in
+    char direction{'F'};    // F, B, L or R, as used in the sprite names
+    int walkFrame{0};
+    qint64 inputNs{0};      // Press this step answered (InputSystem clock), 0 if none
+
+    // First occupied volume of each TriggerSystem::Kind, -1 if none
+    int occupied[TriggerSystem::KIND_COUNT] = {-1, -1, -1, -1};
+    int occupiedTrigger(TriggerSystem::Kind kind) const { return occupied[static_cast<int>(kind)]; }
+
+    QVector<WildSpawner::Spawn> wild;  // Wild Pokémon on the map
+    quint32 wildVersion{0};            // Changes whenever wild does
+    bool battleBusy{false};            // A battle choice is still playing out
+
+    // Events stay in every snapshot until the GUI thread has taken them, so
+    // a snapshot replaced before it was read loses none. takeSnapshot()
+    // points firstNewEvent past the ones taken with an earlier snapshot.
+    QVector<WorldEvent> events;
+    int firstNewEvent{0};
+};
+
+// Runs the game world on its own thread: player movement, trigger volumes,
+// wild Pokémon spawns and encounters, and battles.
+//
+// Game hands over the whole world's collision geometry, trigger volumes and
+// grass areas with loadWorld(). Of these only the chunks around the player
+// are loaded: as the player walks, chunks ahead come in and chunks left
+// behind go, taking their colliders, volumes and wild Pokémon with them.
+// Key presses go into the shared InputSystem, which each step samples; the
+// simulation steps the player at a fixed interval, tests the triggers,
+// refills the grass on its own respawn timer and plays battles out on its
+// own clock and random generator. After every
+// change it publishes a WorldSnapshot through a triple buffer. The GUI
+// thread only copies the newest snapshot onto its graphics items and acts
+// on its events, so a slow repaint never delays the game and the game never
+// blocks a repaint. While nothing is going on every timer is off, and
+// snapshotPublished() tells a sleeping frame loop that there is something
+// new to show.
+//
+// Everything public is safe to call from the GUI thread.
+class Simulation : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit Simulation(InputSystem *input, QObject *parent = nullptr);
+
+    // Starts simulating the world with the player at playerPos. Returns the
+    // generation its snapshots carry.
+    quint32 loadWorld(const WorldContent &content, const QPointF &playerPos);
+    // Puts the player somewhere else in the loaded world, e.g. through a
+    // door. Snapshots from before the move carry an older generation.
+    quint32 moveTo(const QPointF &playerPos);
+    void unloadWorld();
+
+    // Update the input state; a movement press also starts a step right away
+    void pressKey(int key);
+    void releaseKey(int key);
+    void releaseAllKeys();
+
+    // Dialogues, menus and battles freeze the player in place, and the
+    // respawn timers with it. Set it where they open and close.
+    void setFrozen(bool frozen);
+
+    // Battles, see BattleState. The scene shows the party selection and
+    // passes the player's answer to battleAction(); the menu's choices go
+    // to battleCommand(). Results come back as BATTLE events.
+    void startBattle(const BattleState::Setup &setup);
+    void battleAction(int action);
+    void battleCommand(BattleState::Command command, int index = 0);
+    // Battle pacing for bots and tests, e.g. 10 or 0 for instant
+    void setBattleTimeScale(qreal scale);
+
+    // Copies out the newest snapshot of the given world, if there is one
+    // the caller has not seen yet
+    bool takeSnapshot(quint32 generation, WorldSnapshot &snapshot);
+
+signals:
+    // Emitted on the worker thread; connect with a queued connection
+    void snapshotPublished();
+
+private:
+    InputSystem *input;
+    InputSystem::Reader inputReader;  // Worker thread
+
+    // Worker thread state
+    WorldContent content;
+    CollisionWorld world;  // Colliders of the loaded chunks
+    KinematicMover mover;
+    MapLayout::Area area{MapLayout::AREA_TOWN};
+    QTimer *stepTimer{nullptr};
+    bool loaded{false};
+    quint32 worldGeneration{0};
+    quint64 tick{0};
+    QPointF position;
+    char direction{'F'};
+    int walkFrame{0};
+    int heldSteps{0};
+    qint64 answeredInputNs{0};  // Goes out with the next snapshot
+    QElapsedTimer clock;        // Respawn timers and battles
+    QRandomGenerator random;    // Spawns and battles
+
+    TriggerSystem *triggers{nullptr};
+    bool encounterCheckPending{false};  // Stepped inside tall grass
+
+    WildSpawner spawner;
+    SceneArena spawnArena;
+    QVector<WildSpawner::Spawn> wild;
+    quint32 wildVersion{0};
+    QTimer *respawnTimer{nullptr};
+
+    // Loaded chunks, and for every collider, volume and grass area the
+    // number of loaded chunks it touches; it is in the world while that is
+    // above zero
+    QVector<QPoint> loadedChunks;
+    QPoint playerChunk;
+    bool hasPlayerChunk{false};
+    QVector<int> solidRefs;
+    QVector<int> ledgeRefs;
+    QVector<int> triggerRefs;
+    QVector<int> grassRefs;
+
+    BattleState battle;
+    QTimer *battleTimer{nullptr};
+    QVector<BattleState::Event> battleEvents;  // Reused between flushes
+
+    QVector<WorldEvent> events;  // Not yet taken by the GUI thread
+    quint64 eventSequence{0};
+
+    // GUI thread only
+    quint64 seenEventSequence{0};
+
+    // Shared with the GUI thread
+    std::atomic<bool> frozen{false};
+    std::atomic<quint32> generationCounter{0};
+    std::atomic<quint64> takenEventSequence{0};
+    TripleBuffer<WorldSnapshot> snapshots;
+
+    void ensureTimers();
+    void step();
+    void publish();
+    const WorldContent::Walk &walk() const { return content.walks[area]; }
+
+    void updateArea();
+    void streamChunks();
+    bool loadChunk(const QPoint &chunk);
+    bool unloadChunk(const QPoint &chunk);
+    void addTrigger(int trigger);
+    void removeGrass(int grassArea);
+    void rebuildCollision();
+
+    void raise(WorldEvent &event);
+    void raiseTrigger(WorldEvent::Type type, TriggerSystem::Kind kind, int index);
+
+    void spawnWildPokemon(int area);
+    void updateSpawns();
+    bool checkEncounter();
+
+    void flushBattle();
+    void advanceBattle();
+};
+
+#endif // SIMULATION_H
@@ -0,0 +1,120 @@
+#include "spritecache.h"
+#include <QDebug>
+
+SpriteCache &SpriteCache::instance()
+{
+    static SpriteCache cache;
+    return cache;
+}
+
+QPixmap SpriteCache::sprite(const QString &species, Variant variant)
+{
+    const QString key = species.toLower();
+    auto it = entries.constFind(key);
+    if (it != entries.constEnd()) {
+        hits++;
+        return it->variants[variant];
+    }
+
+    misses++;
+    return entries.insert(key, toPixmaps(key, decode(key)))->variants[variant];
+}
+
+void SpriteCache::insert(const QString &species, const Images &images)
+{
+    const QString key = species.toLower();
+    if (!entries.contains(key)) {
+        entries.insert(key, toPixmaps(key, images));
+    }
+}
+
+int SpriteCache::directionIndex(QChar direction)
+{
+    static const char DIRECTIONS[] = "FBLR";
+    for (int i = 0; i < 4; ++i) {
+        if (direction == QLatin1Char(DIRECTIONS[i])) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+const QPixmap &SpriteCache::playerFrame(QChar direction, int walkFrame)
+{
+    const int directionIndex = SpriteCache::directionIndex(direction);
+    walkFrame = qBound(0, walkFrame, 2);
+
+    QPixmap &frame = playerFrames[directionIndex][walkFrame];
+    if (!frame.isNull()) {
+        return frame;
+    }
+
+    frame = QPixmap::fromImage(decodePlayerFrame(direction, walkFrame));
+
+    if (frame.isNull()) {
+        // Fallback to the standing front sprite, or a colored rectangle if even that is missing
+        if (directionIndex != 0 || walkFrame != 0) {
+            frame = playerFrame(QLatin1Char('F'), 0);
+        } else {
+            frame = QPixmap(35, 48);
+            frame.fill(Qt::red);
+        }
+    }
+    return frame;
+}
+
+void SpriteCache::insertPlayerFrame(QChar direction, int walkFrame, const QImage &image)
+{
+    QPixmap &frame = playerFrames[directionIndex(direction)][qBound(0, walkFrame, 2)];
+    if (frame.isNull() && !image.isNull()) {
+        frame = QPixmap::fromImage(image);
+    }
+}
+
+QImage SpriteCache::decodePlayerFrame(QChar direction, int walkFrame)
+{
+    QString path = QString(":/Dataset/Image/player/player_%1").arg(direction);
+    if (walkFrame > 0) {
+        path += QString("W%1").arg(walkFrame);
+    }
+
+    QImage image(path + ".png");
+    if (image.isNull()) {
+        qDebug() << "Failed to load sprite:" << path;
+    }
+    return image;
+}
+
+SpriteCache::Images SpriteCache::decode(const QString &species)
+{
+    Images images;
+
+    QImage front(QString(":/Dataset/Image/battle/%1.png").arg(species));
+    if (front.isNull()) {
+        qDebug() << "Failed to load Pokémon sprite for" << species;
+    } else {
+        images.variants[ORIGINAL] = front;
+        images.variants[FRONT] = front.scaled(BATTLE_SIZE, BATTLE_SIZE, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        images.variants[BAG_ICON] = front.scaled(BAG_ICON_SIZE, BAG_ICON_SIZE, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        images.variants[OVERWORLD] = front.scaled(OVERWORLD_SIZE, OVERWORLD_SIZE, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+
+    QImage back(QString(":/Dataset/Image/battle/%1_back.png").arg(species));
+    if (back.isNull()) {
+        qDebug() << "Failed to load Pokémon back sprite for" << species;
+    } else {
+        images.variants[BACK] = back.scaled(BATTLE_SIZE, BATTLE_SIZE, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+
+    return images;
+}
+
+SpriteCache::Entry SpriteCache::toPixmaps(const QString &species, const Images &images)
+{
+    Entry entry;
+    for (int variant = 0; variant < VARIANT_COUNT; ++variant) {
+        entry.variants[variant] = QPixmap::fromImage(images.variants[variant]);
+    }
+    qDebug() << "Cached sprites for" << species;
+    return entry;
+}
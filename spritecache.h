@@ -0,0 +1,83 @@
+#ifndef SPRITECACHE_H
+#define SPRITECACHE_H
+
+#include <QHash>
+#include <QImage>
+#include <QPixmap>
+#include <QString>
+
+// Pokémon sprites, loaded and scaled once per species and shared by every
+// scene.
+//
+// The first request for a species decodes its front and back images and
+// builds all variants; later requests are a hash lookup returning an
+// implicitly shared QPixmap. Missing images are remembered too, so a bad
+// path is reported once instead of on every frame.
+//
+// The player's walk frames are kept here as well, so a step swaps between
+// decoded pixmaps instead of building a path and loading a PNG.
+//
+// Decoding and scaling work on QImages and may run on any thread, which is
+// how the title screen warms the cache; the pixmaps themselves are only
+// made and stored on the GUI thread.
+class SpriteCache
+{
+public:
+    enum Variant {
+        FRONT,      // Battle size, facing the player (wild Pokémon)
+        BACK,       // Battle size, seen from behind (the player's Pokémon)
+        BAG_ICON,   // Fits a bag row
+        OVERWORLD,  // Wild Pokémon standing in the grass
+        ORIGINAL,   // Front image at the size it is stored (Pokemon::getSprite)
+        VARIANT_COUNT
+    };
+
+    static const int BATTLE_SIZE = 120;
+    static const int BAG_ICON_SIZE = 40;
+    static const int OVERWORLD_SIZE = 40;
+
+    static SpriteCache &instance();
+
+    // species: Pokémon name as shown in game, e.g. "Bulbasaur". Returns a
+    // null pixmap when the image is missing.
+    QPixmap sprite(const QString &species, Variant variant);
+
+    // direction: F, B, L or R; walkFrame: 0 standing, 1 or 2 walking.
+    // Falls back to the standing front sprite, then to a red box.
+    const QPixmap &playerFrame(QChar direction, int walkFrame);
+
+    // Every variant of a species as images, or null images where the
+    // files are missing. Safe on any thread.
+    struct Images {
+        QImage variants[VARIANT_COUNT];
+    };
+    static Images decode(const QString &species);
+    // Caches what decode() returned, unless the species is cached already
+    void insert(const QString &species, const Images &images);
+
+    // The image behind a player frame, null if missing. Safe on any thread.
+    static QImage decodePlayerFrame(QChar direction, int walkFrame);
+    // Caches a decoded player frame, unless that frame is loaded already
+    void insertPlayerFrame(QChar direction, int walkFrame, const QImage &image);
+
+    int hitCount() const { return hits; }
+    int missCount() const { return misses; }
+    int speciesCount() const { return entries.size(); }
+
+private:
+    SpriteCache() = default;
+
+    struct Entry {
+        QPixmap variants[VARIANT_COUNT];
+    };
+
+    QHash<QString, Entry> entries;  // Lower-case species name -> sprites
+    QPixmap playerFrames[4][3];     // Direction (F, B, L, R) x walk frame, loaded on first use
+    int hits{0};
+    int misses{0};
+
+    static Entry toPixmaps(const QString &species, const Images &images);
+    static int directionIndex(QChar direction);
+};
+
+#endif // SPRITECACHE_H
@@ -0,0 +1,52 @@
+#include "spritepool.h"
+#include <QDebug>
+
+SpritePool::SpritePool(QGraphicsScene *scene)
+    : scene(scene)
+{
+}
+
+SpritePool::~SpritePool()
+{
+    clear();
+}
+
+QGraphicsPixmapItem *SpritePool::acquire(const QPixmap &pixmap)
+{
+    QGraphicsPixmapItem *item = nullptr;
+
+    if (!freeItems.isEmpty()) {
+        item = freeItems.last();
+        freeItems.removeLast();
+        item->setPixmap(pixmap);
+    } else {
+        item = scene->addPixmap(pixmap);
+        items.append(item);
+        qDebug() << "Sprite pool grew to" << items.size() << "items";
+    }
+
+    item->setVisible(true);
+    return item;
+}
+
+void SpritePool::release(QGraphicsPixmapItem *item)
+{
+    if (!item) {
+        return;
+    }
+
+    item->setVisible(false);
+    freeItems.append(item);
+}
+
+void SpritePool::clear()
+{
+    for (QGraphicsPixmapItem *item : items) {
+        if (item->scene()) {
+            item->scene()->removeItem(item);
+        }
+        delete item;
+    }
+    items.clear();
+    freeItems.clear();
+}
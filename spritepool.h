@@ -0,0 +1,34 @@
+#ifndef SPRITEPOOL_H
+#define SPRITEPOOL_H
+
+#include <QGraphicsPixmapItem>
+#include <QGraphicsScene>
+#include <QPixmap>
+#include <QVector>
+
+// Recycles QGraphicsPixmapItems for sprites that come and go (wild Pokémon).
+// Released items stay in the scene, hidden, and are handed out again by the
+// next acquire() instead of creating a new item with scene->addPixmap().
+class SpritePool
+{
+public:
+    explicit SpritePool(QGraphicsScene *scene);
+    ~SpritePool();
+
+    // Returns a visible item showing pixmap, reusing a released one if possible
+    QGraphicsPixmapItem *acquire(const QPixmap &pixmap);
+    void release(QGraphicsPixmapItem *item);
+
+    // Removes and deletes every item - call before the scene is cleared
+    void clear();
+
+    int itemCount() const { return items.size(); }
+    int availableCount() const { return freeItems.size(); }
+
+private:
+    QGraphicsScene *scene;
+    QVector<QGraphicsPixmapItem*> items;      // Every item owned by the pool
+    QVector<QGraphicsPixmapItem*> freeItems;  // Hidden, ready for reuse
+};
+
+#endif // SPRITEPOOL_H
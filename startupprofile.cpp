@@ -0,0 +1,98 @@
+#include "startupprofile.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QEvent>
+#include <QGraphicsScene>
+#include <QGraphicsView>
+#include <QObject>
+
+namespace {
+// Started before main() runs
+struct ProcessClock {
+    QElapsedTimer timer;
+    ProcessClock() { timer.start(); }
+};
+ProcessClock processClock;
+
+qint64 reachedAt[StartupProfile::STAGE_COUNT] = {-1, -1, -1, -1, -1, -1};
+bool summaryLogged = false;
+
+void logSummary()
+{
+    using namespace StartupProfile;
+    if (summaryLogged || reachedAt[INTERACTIVE] < 0 || reachedAt[WARM_UP_DONE] < 0) {
+        return;
+    }
+    summaryLogged = true;
+    qDebug().nospace() << "Startup: first frame " << reachedAt[FIRST_FRAME]
+                       << " ms, interactive " << reachedAt[INTERACTIVE]
+                       << " ms, warm-up done " << reachedAt[WARM_UP_DONE] << " ms";
+}
+
+// Marks the first frames from viewport paints, then removes itself
+class PaintWatcher : public QObject
+{
+public:
+    bool eventFilter(QObject *watched, QEvent *event) override
+    {
+        if (event->type() == QEvent::Paint) {
+            StartupProfile::mark(StartupProfile::FIRST_FRAME);
+            if (StartupProfile::elapsedMs(StartupProfile::TITLE_READY) >= 0) {
+                StartupProfile::mark(StartupProfile::INTERACTIVE);
+                watched->removeEventFilter(this);
+            }
+        }
+        return false;
+    }
+};
+}
+
+namespace StartupProfile
+{
+
+void mark(Stage stage)
+{
+    if (reachedAt[stage] >= 0) {
+        return;
+    }
+    reachedAt[stage] = processClock.timer.elapsed();
+    qDebug() << "Startup:" << stageName(stage) << "at" << reachedAt[stage] << "ms";
+    logSummary();
+}
+
+qint64 elapsedMs(Stage stage)
+{
+    return reachedAt[stage];
+}
+
+void watchViews(QGraphicsScene *scene)
+{
+    // One watcher for the whole program; it is small and outlives every view
+    static PaintWatcher *watcher = new PaintWatcher;
+    for (QGraphicsView *view : scene->views()) {
+        view->viewport()->installEventFilter(watcher);
+    }
+}
+
+const char *stageName(Stage stage)
+{
+    switch (stage) {
+    case APPLICATION_CREATED:
+        return "application created";
+    case GAME_CREATED:
+        return "game created";
+    case TITLE_READY:
+        return "title ready";
+    case FIRST_FRAME:
+        return "first frame";
+    case INTERACTIVE:
+        return "first interactive frame";
+    case WARM_UP_DONE:
+        return "warm-up done";
+    case STAGE_COUNT:
+        break;
+    }
+    return "?";
+}
+
+}
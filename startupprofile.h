@@ -0,0 +1,38 @@
+#ifndef STARTUPPROFILE_H
+#define STARTUPPROFILE_H
+
+#include <QtGlobal>
+
+class QGraphicsScene;
+
+// Where start-up time goes, from process start to the first frame the
+// player can act on.
+//
+// Times are measured from a clock started during static initialisation,
+// which is as close to process start as portable code gets. Each stage is
+// recorded once; later marks of the same stage are ignored. Every stage is
+// logged as it is reached, and a one-line summary follows once the first
+// interactive frame is painted and the title-screen warm-up has finished.
+namespace StartupProfile
+{
+    enum Stage {
+        APPLICATION_CREATED,  // QApplication exists
+        GAME_CREATED,         // Game constructed, worker threads running
+        TITLE_READY,          // The title scene is built and takes input
+        FIRST_FRAME,          // First paint of the game view
+        INTERACTIVE,          // First paint once TITLE_READY is reached
+        WARM_UP_DONE,         // Lab, town and grassland prepared in the background
+        STAGE_COUNT
+    };
+
+    void mark(Stage stage);
+    // Milliseconds from process start, or -1 if the stage was not reached
+    qint64 elapsedMs(Stage stage);
+
+    // FIRST_FRAME and INTERACTIVE are marked from the paints of the views on scene
+    void watchViews(QGraphicsScene *scene);
+
+    const char *stageName(Stage stage);
+}
+
+#endif // STARTUPPROFILE_H
@@ -0,0 +1,257 @@
+#include "stresstest.h"
+#include "game.h"
+#include "placementengine.h"
+#include "simulation.h"
+#include "spritecache.h"
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QEvent>
+#include <QFile>
+#include <QGraphicsScene>
+#include <QGraphicsView>
+#include <QTextStream>
+#include <QTimer>
+
+#if defined(Q_OS_LINUX)
+#include <time.h>
+#include <unistd.h>
+#elif defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#endif
+
+// Frame rate the tick timer expects to keep up with
+static const int TICK_INTERVAL_MS = 16;
+// How long the player walks in one direction before turning
+static const int WALK_LEG_MS = 2000;
+
+namespace StressTest
+{
+
+static Config &mutableConfig()
+{
+    static Config settings;
+    return settings;
+}
+
+void configureFromArguments(int argc, char *argv[])
+{
+    Config &settings = mutableConfig();
+    for (int i = 1; i < argc; ++i) {
+        const QString argument = QString::fromLocal8Bit(argv[i]);
+        const QString value = argument.section('=', 1);
+        if (argument == "--stress") {
+            settings.enabled = true;
+        } else if (argument.startsWith("--stress-wild=")) {
+            settings.enabled = true;
+            settings.wildPokemon = qMax(1, value.toInt());
+        } else if (argument.startsWith("--stress-boxes=")) {
+            settings.enabled = true;
+            settings.townBoxes = qMax(1, value.toInt());
+        } else if (argument.startsWith("--stress-seconds=")) {
+            settings.enabled = true;
+            settings.seconds = qMax(2, value.toInt());
+        }
+    }
+
+    if (settings.enabled) {
+        qDebug() << "Stress mode:" << settings.wildPokemon << "wild Pokémon," << settings.townBoxes
+                 << "town boxes," << settings.seconds << "seconds";
+    }
+}
+
+const Config &config()
+{
+    return mutableConfig();
+}
+
+bool isEnabled()
+{
+    return mutableConfig().enabled;
+}
+
+QString savePath()
+{
+    return QDir::temp().filePath("pokemon-stress.sav");
+}
+
+bool placeAsManyAsFit(PlacementEngine &placement, int count, qreal minSpacing, QVector<QPointF> &positions)
+{
+    while (count > 0) {
+        if (placement.place(count, minSpacing, positions)) {
+            return true;
+        }
+        count = count * 9 / 10;
+    }
+    return false;
+}
+
+qint64 residentMemoryBytes()
+{
+#if defined(Q_OS_LINUX)
+    // Second field of statm is the resident page count
+    QFile statm("/proc/self/statm");
+    if (!statm.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+    const QList<QByteArray> fields = statm.readAll().split(' ');
+    if (fields.size() < 2) {
+        return -1;
+    }
+    return fields[1].toLongLong() * sysconf(_SC_PAGESIZE);
+#elif defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return -1;
+    }
+    return static_cast<qint64>(counters.WorkingSetSize);
+#else
+    return -1;
+#endif
+}
+
+qint64 processCpuNanoseconds()
+{
+#if defined(Q_OS_LINUX)
+    timespec time;
+    if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time) != 0) {
+        return -1;
+    }
+    return static_cast<qint64>(time.tv_sec) * 1000000000 + time.tv_nsec;
+#elif defined(Q_OS_WIN)
+    // FILETIMEs count 100 ns units
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+        return -1;
+    }
+    auto toNs = [](const FILETIME &fileTime) {
+        return ((static_cast<qint64>(fileTime.dwHighDateTime) << 32) | fileTime.dwLowDateTime) * 100;
+    };
+    return toNs(kernel) + toNs(user);
+#else
+    return -1;
+#endif
+}
+
+}
+
+StressMonitor::StressMonitor(Game *game, QGraphicsScene *scene, QObject *parent)
+    : QObject(parent),
+      game(game),
+      scene(scene)
+{
+    reportTimer = new QTimer(this);
+    connect(reportTimer, &QTimer::timeout, this, &StressMonitor::report);
+
+    walkTimer = new QTimer(this);
+    connect(walkTimer, &QTimer::timeout, this, &StressMonitor::walk);
+
+    tickTimer = new QTimer(this);
+    tickTimer->setTimerType(Qt::PreciseTimer);
+    connect(tickTimer, &QTimer::timeout, this, [this]() {
+        tickMaxNs = qMax(tickMaxNs, tickClock.nsecsElapsed());
+        tickClock.restart();
+    });
+}
+
+void StressMonitor::start()
+{
+    for (QGraphicsView *view : scene->views()) {
+        view->viewport()->installEventFilter(this);
+    }
+
+    QTextStream(stdout) << "time_s,scene,paints,paint_avg_ms,paint_max_ms,loop_max_ms,rss_mb,scene_items,sprite_hits,sprite_misses\n";
+
+    // Entering a scene is part of what is measured
+    runClock.start();
+    tickClock.start();
+    game->changeScene(GameState::TOWN);
+
+    reportTimer->start(1000);
+    walkTimer->start(WALK_LEG_MS);
+    tickTimer->start(TICK_INTERVAL_MS);
+    walk();
+}
+
+bool StressMonitor::eventFilter(QObject *watched, QEvent *event)
+{
+    // Paint the viewport from here so the paint itself can be timed
+    if (event->type() == QEvent::Paint && !measuringPaint) {
+        measuringPaint = true;
+        QElapsedTimer paintClock;
+        paintClock.start();
+        QCoreApplication::sendEvent(watched, event);
+        qint64 elapsed = paintClock.nsecsElapsed();
+        measuringPaint = false;
+
+        frames++;
+        paintTotalNs += elapsed;
+        paintMaxNs = qMax(paintMaxNs, elapsed);
+        return true;
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+void StressMonitor::walk()
+{
+    // A square walk keeps the camera moving without wandering off
+    static const int keys[4] = {Qt::Key_Right, Qt::Key_Down, Qt::Key_Left, Qt::Key_Up};
+    Simulation *simulation = game->getSimulation();
+    simulation->releaseAllKeys();
+    simulation->pressKey(keys[walkStep % 4]);
+    walkStep++;
+}
+
+void StressMonitor::report()
+{
+    const qint64 memory = StressTest::residentMemoryBytes();
+    const double seconds = runClock.elapsed() / 1000.0;
+
+    QTextStream(stdout) << QString::number(seconds, 'f', 1) << ','
+                        << (grasslandPhase ? "grassland" : "town") << ','
+                        << frames << ','
+                        << QString::number(frames ? paintTotalNs / frames / 1e6 : 0.0, 'f', 2) << ','
+                        << QString::number(paintMaxNs / 1e6, 'f', 2) << ','
+                        << QString::number(tickMaxNs / 1e6, 'f', 2) << ','
+                        << QString::number(memory >= 0 ? memory / (1024.0 * 1024.0) : -1.0, 'f', 1) << ','
+                        << scene->items().size() << ','
+                        << SpriteCache::instance().hitCount() << ','
+                        << SpriteCache::instance().missCount() << "\n";
+
+    phaseWorstPaintNs = qMax(phaseWorstPaintNs, paintMaxNs);
+    phaseWorstTickNs = qMax(phaseWorstTickNs, tickMaxNs);
+    phasePeakMemory = qMax(phasePeakMemory, memory);
+    frames = 0;
+    paintTotalNs = 0;
+    paintMaxNs = 0;
+    tickMaxNs = 0;
+
+    const int halfTime = StressTest::config().seconds * 1000 / 2;
+    if (!grasslandPhase && runClock.elapsed() >= halfTime) {
+        finishPhase("town");
+        grasslandPhase = true;
+        walkStep = 0;
+        game->changeScene(GameState::GRASSLAND);
+        walk();  // Moving the player to the grassland dropped the held key
+    } else if (grasslandPhase && runClock.elapsed() >= 2 * halfTime) {
+        finishPhase("grassland");
+        reportTimer->stop();
+        walkTimer->stop();
+        tickTimer->stop();
+        game->getSimulation()->releaseAllKeys();
+        QCoreApplication::quit();
+    }
+}
+
+void StressMonitor::finishPhase(const char *name)
+{
+    QTextStream(stdout) << "# " << name << ": worst paint " << QString::number(phaseWorstPaintNs / 1e6, 'f', 2)
+                        << " ms, worst loop stall " << QString::number(phaseWorstTickNs / 1e6, 'f', 2)
+                        << " ms, peak rss " << QString::number(phasePeakMemory / (1024.0 * 1024.0), 'f', 1)
+                        << " MB\n";
+    phaseWorstPaintNs = 0;
+    phaseWorstTickNs = 0;
+    phasePeakMemory = 0;
+}
@@ -0,0 +1,92 @@
+#ifndef STRESSTEST_H
+#define STRESSTEST_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QPointF>
+#include <QString>
+#include <QVector>
+
+class Game;
+class PlacementEngine;
+class QGraphicsScene;
+class QTimer;
+
+// Stress mode: the normal game loop with entity counts scaled far past what
+// the maps ship with, to find where the engine falls over.
+//
+//   term_project --stress [--stress-wild=2000] [--stress-boxes=300] [--stress-seconds=60]
+//
+// The run walks the player around the town for the first half and the
+// grassland for the second, logs frame times, memory and scene item counts
+// once a second, then quits. It plays on a scratch save file so the real
+// one is never touched, and wild encounters are off so walking never stops.
+namespace StressTest
+{
+    struct Config {
+        bool enabled{false};
+        int wildPokemon{2000};
+        int townBoxes{300};
+        int seconds{60};
+    };
+
+    // Reads the --stress flags; call once before the game is created
+    void configureFromArguments(int argc, char *argv[]);
+    const Config &config();
+    bool isEnabled();
+
+    QString savePath();
+
+    // Places up to count items, shrinking the count until they fit, since
+    // finding the limit is the point of a stress run
+    bool placeAsManyAsFit(PlacementEngine &placement, int count, qreal minSpacing, QVector<QPointF> &positions);
+
+    // Resident set size of the process, or -1 where it can't be read
+    qint64 residentMemoryBytes();
+    // CPU time used by all of the process' threads, or -1 where it can't be read
+    qint64 processCpuNanoseconds();
+}
+
+// Drives and measures a stress run
+class StressMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    StressMonitor(Game *game, QGraphicsScene *scene, QObject *parent = nullptr);
+
+    void start();
+
+protected:
+    // Counts the view's repaints
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    Game *game;
+    QGraphicsScene *scene;
+    QTimer *reportTimer{nullptr};
+    QTimer *walkTimer{nullptr};
+    QTimer *tickTimer{nullptr};  // Runs at frame rate to see how late the loop gets
+    QElapsedTimer runClock;
+    QElapsedTimer tickClock;
+    bool grasslandPhase{false};
+    bool measuringPaint{false};
+    int walkStep{0};
+
+    // Since the last report
+    int frames{0};
+    qint64 paintTotalNs{0};
+    qint64 paintMaxNs{0};
+    qint64 tickMaxNs{0};
+
+    // Whole phase
+    qint64 phaseWorstPaintNs{0};
+    qint64 phaseWorstTickNs{0};
+    qint64 phasePeakMemory{0};
+
+    void report();
+    void walk();
+    void finishPhase(const char *name);
+};
+
+#endif // STRESSTEST_H
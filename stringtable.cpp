@@ -0,0 +1,199 @@
+#include "stringtable.h"
+#include <QHash>
+#include <QLocale>
+#include <string>
+
+StringTable::Language StringTable::currentLanguage = StringTable::ENGLISH;
+
+namespace {
+// English, Traditional Chinese - one row per StringId, in the enum's order
+const char16_t *const TEXT[][StringTable::LANGUAGE_COUNT] = {
+    // Title
+    {u"Press Enter to Start", u"按 Enter 開始"},
+    {u"L: 中文", u"L: English"},
+
+    // Battle start
+    {u"A wild %1 appeared!", u"野生的%1出現了！"},
+    {u"Choose your Pokémon:", u"選擇你的寶可夢："},
+    {u"Press %1: %2 (HP: %3/%4)", u"按 %1：%2（HP：%3/%4）"},
+    {u"Press ESC to run away", u"按 ESC 逃跑"},
+    {u"Press ESC to return", u"按 ESC 返回"},
+
+    // Battle screen
+    {u"Wild %1  Lv1\nHP: %2/30", u"野生的%1  Lv1\nHP：%2/30"},
+    {u"%1  Lv%2\nHP: %3/%4", u"%1  Lv%2\nHP：%3/%4"},
+    {u"What will\n%1 do?", u"%1\n要做什麼？"},
+    {u"FIGHT", u"戰鬥"},
+    {u"BAG", u"背包"},
+    {u"POKéMON", u"寶可夢"},
+    {u"RUN", u"逃跑"},
+    {u"POKEMON", u"寶可夢"},
+
+    // Battle bag
+    {u"Choose an item to use:", u"選擇要使用的道具："},
+    {u"Press 1: Use Poké Ball (%1 left)", u"按 1：使用精靈球（剩 %1 個）"},
+    {u"Press 2: Use Potion (%1 left)", u"按 2：使用傷藥（剩 %1 個）"},
+    {u"Press 3: Use Ether (%1 left)", u"按 3：使用PP單項小補劑（剩 %1 個）"},
+    {u"Press B to return", u"按 B 返回"},
+    {u"You already have this Pokemon!", u"你已經有這隻寶可夢了！"},
+    {u"Pokemon is captured!", u"成功捕捉寶可夢！"},
+    {u"Unsuccessful capture", u"捕捉失敗"},
+    {u"%1 recovered 10 HP!", u"%1回復了 10 HP！"},
+    {u"HP is already full!", u"HP 已經是滿的！"},
+    {u"All move PP is restored now!", u"所有招式的 PP 都回復了！"},
+
+    // Moves and turns
+    {u"Press %1: %2 (PP: %3/20)", u"按 %1：%2（PP：%3/20）"},
+    {u"[OUT OF PP] %1", u"［PP 用完］%1"},
+    {u"Press C: Do Nothing", u"按 C：什麼都不做"},
+    {u"%1 used %2!\nDealt %3 damage!", u"%1使用了%2！\n造成了 %3 點傷害！"},
+    {u"%1 won the battle!\n%1 grew to level %2!", u"%1贏得了戰鬥！\n%1升到了 %2 級！"},
+    {u"Wild %1 used %2!", u"野生的%1使用了%2！"},
+    {u"Dealt %1 damage!", u"造成了 %1 點傷害！"},
+    {u"Your %1 fainted!", u"你的%1倒下了！"},
+
+    // Town
+    {u"You got %1!", u"你得到了%1！"},
+    {u"Box is empty", u"箱子是空的"},
+
+    // Names
+    {u"Charmander", u"小火龍"},
+    {u"Squirtle", u"傑尼龜"},
+    {u"Bulbasaur", u"妙蛙種子"},
+    {u"Scratch", u"抓"},
+    {u"Growl", u"叫聲"},
+    {u"Tackle", u"撞擊"},
+    {u"Tail Whip", u"搖尾巴"},
+    {u"Poké Ball", u"精靈球"},
+    {u"Potion", u"傷藥"},
+    {u"Ether", u"PP單項小補劑"},
+    {u"Mystery Item", u"神秘道具"},
+};
+static_assert(sizeof(TEXT) / sizeof(TEXT[0]) == STRING_COUNT, "one row of text per StringId");
+
+// QStrings over the literals above, built once; they share the table's
+// memory instead of copying it
+struct WrappedTable {
+    QString text[StringTable::LANGUAGE_COUNT][STRING_COUNT];
+    QHash<QString, StringId> names;  // English name -> id
+
+    WrappedTable()
+    {
+        for (int id = 0; id < STRING_COUNT; ++id) {
+            for (int language = 0; language < StringTable::LANGUAGE_COUNT; ++language) {
+                const char16_t *literal = TEXT[id][language];
+                text[language][id] = QString::fromRawData(reinterpret_cast<const QChar *>(literal),
+                                                          static_cast<int>(std::char_traits<char16_t>::length(literal)));
+            }
+        }
+        for (int id = STR_NAME_CHARMANDER; id < STRING_COUNT; ++id) {
+            names.insert(text[StringTable::ENGLISH][id], static_cast<StringId>(id));
+        }
+    }
+};
+
+const WrappedTable &table()
+{
+    static const WrappedTable wrapped;
+    return wrapped;
+}
+
+void appendNumber(QString &buffer, int number)
+{
+    // Digits are written backwards into a small local array, so no temporary string is built
+    QChar digits[12];
+    int count = 0;
+    unsigned int value = number < 0 ? 0u - static_cast<unsigned int>(number) : static_cast<unsigned int>(number);
+    do {
+        digits[count++] = QLatin1Char(static_cast<char>('0' + value % 10));
+        value /= 10;
+    } while (value > 0);
+
+    if (number < 0) {
+        buffer.append(QLatin1Char('-'));
+    }
+    while (count > 0) {
+        buffer.append(digits[--count]);
+    }
+}
+}
+
+const QString &StringTable::get(StringId id)
+{
+    return table().text[currentLanguage][id];
+}
+
+const QString &StringTable::format(QString &buffer, StringId id, std::initializer_list<StringArg> args)
+{
+    // resize() rather than clear(), which would give the capacity back
+    buffer.resize(0);
+    append(buffer, id, args);
+    return buffer;
+}
+
+void StringTable::append(QString &buffer, StringId id, std::initializer_list<StringArg> args)
+{
+    const QString &pattern = get(id);
+    const QChar *chars = pattern.constData();
+    const int length = pattern.size();
+
+    int runStart = 0;
+    for (int i = 0; i + 1 < length; ++i) {
+        if (chars[i] != QLatin1Char('%')) {
+            continue;
+        }
+        const int argument = chars[i + 1].unicode() - '1';
+        if (argument < 0 || argument > 8 || argument >= static_cast<int>(args.size())) {
+            continue;  // Not a placeholder, or no argument for it: keep the text
+        }
+
+        buffer.append(chars + runStart, i - runStart);
+        const StringArg &arg = *(args.begin() + argument);
+        if (arg.text) {
+            buffer.append(*arg.text);
+        } else {
+            appendNumber(buffer, arg.number);
+        }
+        i++;
+        runStart = i + 1;
+    }
+    buffer.append(chars + runStart, length - runStart);
+}
+
+QString StringTable::name(const QString &key)
+{
+    const WrappedTable &wrapped = table();
+    auto it = wrapped.names.constFind(key);
+    if (it == wrapped.names.constEnd()) {
+        return key;
+    }
+    return wrapped.text[currentLanguage][it.value()];
+}
+
+void StringTable::setLanguage(Language language)
+{
+    currentLanguage = language;
+}
+
+bool StringTable::languageFromName(const QString &name, Language &language)
+{
+    if (name == "en") {
+        language = ENGLISH;
+    } else if (name == "zh_TW") {
+        language = TRADITIONAL_CHINESE;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+StringTable::Language StringTable::systemLanguage()
+{
+    const QLocale locale = QLocale::system();
+    if (locale.language() == QLocale::Chinese
+        && (locale.script() == QLocale::TraditionalChineseScript
+            || locale.country() == QLocale::Taiwan || locale.country() == QLocale::HongKong)) {
+        return TRADITIONAL_CHINESE;
+    }
+    return ENGLISH;
+}
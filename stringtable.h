@@ -0,0 +1,129 @@
+#ifndef STRINGTABLE_H
+#define STRINGTABLE_H
+
+#include <QString>
+#include <initializer_list>
+
+// Every piece of game text the player reads. The order matches the table in
+// stringtable.cpp.
+enum StringId : quint16 {
+    // Title
+    STR_PRESS_START,
+    STR_LANGUAGE_HINT,
+
+    // Battle start
+    STR_WILD_APPEARED,
+    STR_CHOOSE_POKEMON,
+    STR_PARTY_OPTION,
+    STR_RUN_AWAY_HINT,
+    STR_RETURN_HINT,
+
+    // Battle screen
+    STR_WILD_STATS,
+    STR_PLAYER_STATS,
+    STR_WHAT_WILL_DO,
+    STR_MENU_FIGHT,
+    STR_MENU_BAG,
+    STR_MENU_POKEMON,
+    STR_MENU_RUN,
+    STR_EMPTY_PARTY_NAME,
+
+    // Battle bag
+    STR_BAG_PROMPT,
+    STR_BAG_POKEBALL,
+    STR_BAG_POTION,
+    STR_BAG_ETHER,
+    STR_PRESS_B_RETURN,
+    STR_ALREADY_HAVE,
+    STR_CAPTURED,
+    STR_CAPTURE_FAILED,
+    STR_RECOVERED_HP,
+    STR_HP_FULL,
+    STR_PP_RESTORED,
+
+    // Moves and turns
+    STR_MOVE_OPTION,
+    STR_OUT_OF_PP,
+    STR_DO_NOTHING,
+    STR_PLAYER_MOVE,
+    STR_VICTORY,
+    STR_WILD_USED,
+    STR_DEALT_DAMAGE,
+    STR_FAINTED,
+
+    // Town
+    STR_YOU_GOT,
+    STR_BOX_EMPTY,
+
+    // Names of species, moves and items (see StringTable::name)
+    STR_NAME_CHARMANDER,
+    STR_NAME_SQUIRTLE,
+    STR_NAME_BULBASAUR,
+    STR_NAME_SCRATCH,
+    STR_NAME_GROWL,
+    STR_NAME_TACKLE,
+    STR_NAME_TAIL_WHIP,
+    STR_NAME_POKE_BALL,
+    STR_NAME_POTION,
+    STR_NAME_ETHER,
+    STR_NAME_MYSTERY_ITEM,
+
+    STRING_COUNT
+};
+
+// One %1..%9 argument for StringTable::format(); text arguments are
+// referenced, not copied, so they must outlive the call
+class StringArg
+{
+public:
+    StringArg(const QString &text) : text(&text) {}
+    StringArg(int number) : number(number) {}
+
+private:
+    friend class StringTable;
+    const QString *text{nullptr};
+    int number{0};
+};
+
+// Localised game text.
+//
+// All languages are compiled into one dense table of UTF-16 literals, and
+// the QStrings wrapping them point straight at that read-only data, so
+// looking up a string or switching the language never allocates. Text with
+// arguments is written straight into a buffer the caller keeps, instead of
+// through the temporaries of an .arg() chain. Arguments are numbered, so a
+// translation may reorder them.
+class StringTable
+{
+public:
+    enum Language {
+        ENGLISH,
+        TRADITIONAL_CHINESE,
+        LANGUAGE_COUNT
+    };
+
+    static const QString &get(StringId id);
+
+    // Replaces buffer with the string for id, %1..%9 filled in from args
+    static const QString &format(QString &buffer, StringId id, std::initializer_list<StringArg> args = {});
+    // Same, but appends to what buffer already holds
+    static void append(QString &buffer, StringId id, std::initializer_list<StringArg> args = {});
+
+    // Display name of a species, move or item, e.g. "Poké Ball". Data
+    // keys stay English; names without a translation come back as they are.
+    // Returned by value so a temporary key can't dangle; the copy only
+    // shares the table's data and never allocates.
+    static QString name(const QString &key);
+
+    static Language language() { return currentLanguage; }
+    static void setLanguage(Language language);
+    // "en" or "zh_TW"; false for anything else
+    static bool languageFromName(const QString &name, Language &language);
+    // Traditional Chinese for zh_TW/zh_HK/Hant locales, English otherwise
+    static Language systemLanguage();
+
+private:
+    static Language currentLanguage;
+};
+
+#endif // STRINGTABLE_H
@@ -3,6 +3,14 @@ greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
 CONFIG += c++11
 
+# Stress mode reads the process memory use
+win32: LIBS += -lpsapi
+
+# Allocation counting replaces the process-wide allocator, so release builds
+# leave it out; benchmark builds add it with qmake CONFIG+=track_allocations
+CONFIG(debug, debug|release): CONFIG += track_allocations
+track_allocations: DEFINES += TRACK_ALLOCATIONS
+
 # You can make your code fail to compile if it uses deprecated APIs.
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
@@ -16,7 +24,38 @@ SOURCES += \
     scene.cpp \
     titlescene.cpp \
     townscene.cpp \
-    grasslandscene.cpp
+    grasslandscene.cpp \
+    maplayout.cpp \
+    placementengine.cpp \
+    wildspawner.cpp \
+    spritepool.cpp \
+    triggersystem.cpp \
+    collisionworld.cpp \
+    kinematicmover.cpp \
+    pathfinder.cpp \
+    benchmarks.cpp \
+    simulation.cpp \
+    savegame.cpp \
+    savejournal.cpp \
+    worldstreamer.cpp \
+    worldcontent.cpp \
+    viewportculler.cpp \
+    debugoverlayitem.cpp \
+    stresstest.cpp \
+    battlemessagepool.cpp \
+    battlesequencer.cpp \
+    battlestate.cpp \
+    spritecache.cpp \
+    glyphatlas.cpp \
+    bitmaptextitem.cpp \
+    scriptengine.cpp \
+    stringtable.cpp \
+    allocationtracker.cpp \
+    scenearena.cpp \
+    frameloop.cpp \
+    inputsystem.cpp \
+    startupprofile.cpp \
+    warmup.cpp
 
 HEADERS += \
     grasslandscene.h \
@@ -26,17 +65,70 @@ HEADERS += \
     pokemon.h \
     scene.h \
     titlescene.h \
-    townscene.h
-    grasslandscene.h
+    townscene.h \
+    maplayout.h \
+    placementengine.h \
+    wildspawner.h \
+    entitypool.h \
+    spritepool.h \
+    triggersystem.h \
+    collisionworld.h \
+    kinematicmover.h \
+    pathfinder.h \
+    benchmarks.h \
+    simulation.h \
+    triplebuffer.h \
+    savegame.h \
+    savejournal.h \
+    worldstreamer.h \
+    worldcontent.h \
+    viewportculler.h \
+    debugoverlayitem.h \
+    stresstest.h \
+    battlemessagepool.h \
+    battlesequencer.h \
+    battlestate.h \
+    spritecache.h \
+    glyphatlas.h \
+    bitmaptextitem.h \
+    scriptengine.h \
+    stringtable.h \
+    allocationtracker.h \
+    scenearena.h \
+    frameloop.h \
+    inputsystem.h \
+    startupprofile.h \
+    warmup.h
 
 FORMS += \
     mainwindow.ui
 
-TRANSLATIONS += \
-term_project_zh_TW.ts
+# Event scripts are compiled to bytecode while building, by scriptc (a host
+# tool around the game's own ScriptEngine), so a broken script fails the
+# build instead of turning dialogue off at runtime. scriptc is built first,
+# into the build directory, and rebuilt when the script compiler changes.
+EVENT_SCRIPTS = Script/events.evs
+OTHER_FILES += $$EVENT_SCRIPTS
+
+SCRIPTC_DIR = $$OUT_PWD/scriptc
+SCRIPTC = $$SCRIPTC_DIR/scriptc
+win32: SCRIPTC = $${SCRIPTC}.exe
+
+scriptc_tool.target = $$SCRIPTC
+scriptc_tool.depends = $$PWD/scriptc/scriptc.pro $$PWD/scriptc/main.cpp \
+    $$PWD/scriptengine.h $$PWD/scriptengine.cpp $$PWD/stringtable.h $$PWD/stringtable.cpp
+scriptc_tool.commands = $$sprintf($$QMAKE_MKDIR_CMD, $$shell_quote($$shell_path($$SCRIPTC_DIR))) $$escape_expand(\\n\\t) \
+    cd $$shell_quote($$shell_path($$SCRIPTC_DIR)) && $$shell_quote($$shell_path($$QMAKE_QMAKE)) \
+    $$shell_quote($$shell_path($$PWD/scriptc/scriptc.pro)) && $(MAKE)
+QMAKE_EXTRA_TARGETS += scriptc_tool
 
-CONFIG += lrelease
-CONFIG += embed_translations
+event_scripts.input = EVENT_SCRIPTS
+event_scripts.output = ${QMAKE_FILE_BASE}_bytecode.cpp
+event_scripts.commands = $$shell_path($$SCRIPTC) ${QMAKE_FILE_IN} ${QMAKE_FILE_OUT}
+event_scripts.depends = $$SCRIPTC
+event_scripts.variable_out = GENERATED_SOURCES
+event_scripts.name = scriptc ${QMAKE_FILE_IN}
+QMAKE_EXTRA_COMPILERS += event_scripts
 
 # Default rules for deployment.
 qnx: target.path = /tmp/$${TARGET}/bin
@@ -1,5 +1,8 @@
 #include "titlescene.h"
 #include "game.h"
+#include "startupprofile.h"
+#include "stringtable.h"
+#include "warmup.h"
 #include <QGraphicsScene>
 #include <QPixmap>
 #include <QFont>
@@ -42,6 +45,10 @@ void TitleScene::initialize()
     
     // Start blinking animation for "Press Start" text
     blinkTimer->start(500); // Blink every 500ms
+
+    // Get the areas ready on worker threads while the player looks at the title
+    game->getWarmUp()->start();
+    StartupProfile::mark(StartupProfile::TITLE_READY);
 }
 
 void TitleScene::cleanup()
@@ -58,16 +65,27 @@ void TitleScene::cleanup()
     titleTextItem = nullptr;
     pressStartTextItem = nullptr;
     textBackgroundItem = nullptr;
+    languageHintItem = nullptr;
 }
 
-void TitleScene::handleKeyPress(int key)
+void TitleScene::handleAction(InputSystem::Action action)
 {
-    qDebug() << "Title scene key pressed:" << key;
+    qDebug() << "Title scene action:" << action;
 
-    // Only respond to Enter/Return key
-    if (key == Qt::Key_Return || key == Qt::Key_Enter) {
+    // Only respond to confirm (Enter/Return) and the language switch
+    if (action == InputSystem::CONFIRM) {
         qDebug() << "Starting game...";
         emit startGame();
+    } else if (action == InputSystem::SWITCH_LANGUAGE) {
+        // Switch between English and Traditional Chinese
+        StringTable::setLanguage(StringTable::language() == StringTable::ENGLISH
+                                 ? StringTable::TRADITIONAL_CHINESE : StringTable::ENGLISH);
+        qDebug() << "Language switched to" << StringTable::language();
+        if (pressStartTextItem && languageHintItem) {
+            pressStartTextItem->setPlainText(StringTable::get(STR_PRESS_START));
+            languageHintItem->setPlainText(StringTable::get(STR_LANGUAGE_HINT));
+            centerCamera();
+        }
     }
 }
 
@@ -104,7 +122,7 @@ void TitleScene::createTitleText()
     );
     
     // Only add "Press Start" text
-    pressStartTextItem = scene->addText("Press Enter to Start", QFont("Arial", 22, QFont::Bold));
+    pressStartTextItem = scene->addText(StringTable::get(STR_PRESS_START), QFont("Arial", 22, QFont::Bold));
     pressStartTextItem->setDefaultTextColor(Qt::black);
     
     // Position both the background and text
@@ -118,6 +136,11 @@ void TitleScene::createTitleText()
     
     pressStartTextItem->setPos(textX, textY);
     pressStartTextItem->setZValue(2); // Above the background
+
+    // Language switch hint, placed on the black strip at the bottom-left by centerCamera()
+    languageHintItem = scene->addText(StringTable::get(STR_LANGUAGE_HINT), QFont("Arial", 12));
+    languageHintItem->setDefaultTextColor(Qt::white);
+    languageHintItem->setZValue(2);
 }
 
 void TitleScene::centerCamera()
@@ -137,6 +160,11 @@ void TitleScene::centerCamera()
         textBackgroundItem->setPos(textX - 10, textY - 5);
         textBackgroundItem->setRect(0, 0, textRect.width() + 20, textRect.height() + 10);
     }
+
+    if (languageHintItem) {
+        QRectF hintRect = languageHintItem->boundingRect();
+        languageHintItem->setPos(10, TITLE_HEIGHT - hintRect.height() - 10);
+    }
     
     qDebug() << "Title scene camera positioned at 0,0 with size" << TITLE_WIDTH << "x" << TITLE_HEIGHT;
 }
@@ -158,8 +186,8 @@ void TitleScene::update()
     // Title scene doesn't need continuous updates
 }
 
-void TitleScene::handleKeyRelease(int key)
+void TitleScene::handleActionRelease(InputSystem::Action action)
 {
     // Title scene doesn't need to handle key releases
-    Q_UNUSED(key);
+    Q_UNUSED(action);
 }
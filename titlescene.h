@@ -16,9 +16,9 @@ public:
 
     void initialize() override;
     void cleanup() override;
-    void handleKeyPress(int key) override;
+    void handleAction(InputSystem::Action action) override;
     void update() override;
-    void handleKeyRelease(int key) override;
+    void handleActionRelease(InputSystem::Action action) override;
 
 signals:
     void startGame();
@@ -34,6 +34,7 @@ private:
     QGraphicsTextItem* titleTextItem{nullptr};
     QGraphicsTextItem* pressStartTextItem{nullptr};
     QGraphicsRectItem* textBackgroundItem{nullptr};
+    QGraphicsTextItem* languageHintItem{nullptr};  // "L: 中文" / "L: English"
     QTimer* blinkTimer{nullptr};
     bool textVisible{true};
     QPointF cameraPos{0, 0};
@@ -1,73 +1,118 @@
 #include "townscene.h"
+#include "allocationtracker.h"
 #include "game.h"
+#include "maplayout.h"
+#include "simulation.h"
+#include "spritecache.h"
+#include "stringtable.h"
+#include "warmup.h"
+#include "worldstreamer.h"
 #include <QDebug>
-#include <QGraphicsTextItem>
 #include <QFont>
-#include <QTextDocument>
-#include <QRandomGenerator>
 #include <cmath>
 
-// Define constants for the scene size - must match those from Scene class
-const int SCENE_WIDTH = 1000;
-const int SCENE_HEIGHT = 1000;
+// Define constants for the view size
 const int VIEW_WIDTH = 525;   // Reset to original view width (smaller than town)
 const int VIEW_HEIGHT = 450;  // Reset to original view height (smaller than town)
 
 TownScene::TownScene(Game *game, QGraphicsScene *scene, QObject *parent)
     : Scene(game, scene, parent)
 {
-    // Create update timer
-    updateTimer = new QTimer(this);
-    connect(updateTimer, &QTimer::timeout, this, &TownScene::updateScene);
-    updateTimer->start(100);  // Update every 100ms
-    
-    // Create movement timer for continuous walking
-    movementTimer = new QTimer(this);
-    connect(movementTimer, &QTimer::timeout, this, &TownScene::processMovement);
-    movementTimer->setInterval(40);  // smaller number = faster walking speed
+    // Frames run while something moves and stop once the scene is still;
+    // input and new simulation snapshots start them again
+    frameLoop = new FrameLoop(16, this);
+    connect(frameLoop, &FrameLoop::frame, this, [this]() {
+        updateScene();
+        frameLoop->frameDone(this->game->getScripts()->needsTick());
+    });
+    connect(game->getSimulation(), &Simulation::snapshotPublished, frameLoop, &FrameLoop::wake, Qt::QueuedConnection);
 }
 
 TownScene::~TownScene()
 {
     cleanup();
-    if (updateTimer) {
-        updateTimer->stop();
-        delete updateTimer;
-    }
-    if (movementTimer) {
-        movementTimer->stop();
-        delete movementTimer;
-    }
 }
 
 void TownScene::initialize()
 {
     qDebug() << "Initializing Town Scene";
 
-    // Set player position to the exact center of the 1000x1000 town
-    playerPos = QPointF(TOWN_WIDTH / 2, TOWN_HEIGHT / 2);
-    qDebug() << "Player position set to center of town:" << playerPos.x() << "," << playerPos.y();
-
-    // Reset movement state
-    currentPressedKey = 0;
-    pressedKeys.clear();
-    if (movementTimer && movementTimer->isActive()) {
-        movementTimer->stop();
-    }
-
     // Create scene elements
+    collisionWorld.clear();
+    pendingArea = -1;
+    occupiedBulletin = -1;
+    occupiedBox = -1;
     createBackground();
     createBarriers();
+    // Usually prebuilt while the title screen was up
+    if (const WarmUp::AreaWorld *prebuilt = game->getWarmUp()->world(MapLayout::AREA_TOWN)) {
+        collisionWorld = prebuilt->collision;
+        pathfinder = prebuilt->pathfinder;
+    } else {
+        buildWorld(collisionWorld, pathfinder);
+    }
     createBoxes();  // Create the collectible boxes
     createPlayer();
+}
+
+void TownScene::addToWorld(WorldContent &content)
+{
+    content.addCollision(collisionWorld);
+
+    // Boards and boxes can be read and opened from within 25 pixels (circular
+    // radius) of their edge. Game adds the lab's door, the path to the
+    // grassland needs no volume: the player just walks on.
+    const qreal INTERACTION_RADIUS = 25.0;
+    for (int i = 0; i < bulletinBoardRects.size(); ++i) {
+        const QRectF &boardRect = bulletinBoardRects[i];
+        content.addRadius(TriggerSystem::Kind::Bulletin, i, boardRect.center(), INTERACTION_RADIUS + boardRect.width() / 2);
+    }
+    for (int i = 0; i < boxHitboxes.size(); ++i) {
+        // The index is the box's index in Game
+        content.addRadius(TriggerSystem::Kind::Box, i, boxHitboxes[i].center(), INTERACTION_RADIUS + boxHitboxes[i].width() / 2);
+    }
+
+    // The player may walk anywhere in the town and the grassland above it
+    WorldContent::Walk &walk = content.walks[MapLayout::AREA_TOWN];
+    walk.bounds = MapLayout::regionRect(MapLayout::AREA_TOWN).adjusted(0, 0, -25, -48);
+    walk.baseSpeed = 8;
+    walk.fastSpeed = 10;  // 20% faster after a few steps
+}
 
-    // Set initial camera position to center on player
+void TownScene::enterArea(const QPointF &position)
+{
+    qDebug() << "Player entered the town at" << position.x() << "," << position.y();
+    playerPos = position;
+    pendingArea = -1;
+    if (playerItem) {
+        playerItem->setPos(playerPos);
+        playerItem->setVisible(true);
+    }
+    updatePlayerFreeze();
     updateCamera();
 
-    // Start update timer
-    updateTimer->start(16); // 60 FPS
-    // Start movement timer for continuous movement
-    movementTimer->start(100);
+    // Start the frame loop
+    frameLoop->start();
+}
+
+void TownScene::leaveArea()
+{
+    frameLoop->stop();
+
+    // An event still waiting for the player must not resume once they have left
+    game->getScripts()->stop();
+    if (isDialogueActive) {
+        closeDialogue();
+    }
+    if (isBagOpen) {
+        toggleBag();
+    }
+    if (playerItem) {
+        playerItem->setVisible(false);
+    }
+    if (debugOverlay) {
+        debugOverlay->hideAllocationStats();
+    }
 }
 
 void TownScene::cleanup()
@@ -75,34 +120,30 @@ void TownScene::cleanup()
     qDebug() << "Cleaning up town scene";
     
     // Stop timers first
-    if (updateTimer && updateTimer->isActive()) {
-        updateTimer->stop();
-    }
-    
-    if (movementTimer && movementTimer->isActive()) {
-        movementTimer->stop();
-    }
+    frameLoop->stop();
+
+    // An event still waiting for the player must not resume in an unloaded scene
+    game->getScripts()->stop();
 
     // Clear bag display items explicitly
     clearBagDisplayItems();
-    
-    // Reset movement state
-    currentPressedKey = 0;
-    pressedKeys.clear();
 
     // We shouldn't remove or delete scene items here since the scene is managed by Game
     // Just reset our pointers so we don't try to use them later
-    backgroundItem = nullptr;
     playerItem = nullptr;
-    barrierItems.clear();
-    bulletinBoardItems.clear();
-    labPortalItem = nullptr;
-    grasslandPortalItem = nullptr;
-    
-    // Clear box-related items
-    boxItems.clear();
+    debugOverlay = nullptr;
+    barrierRects.clear();
+    collisionWorld.clear();
+    pathfinder.clear();
+    bulletinBoardRects.clear();
+    labPortalRect = QRectF();
+    pendingArea = -1;
+    occupiedBulletin = -1;
+    occupiedBox = -1;
+    
+    // Clear box-related items; Game's WorldStreamer drops the sprites
+    boxSprites.clear();
     boxHitboxes.clear();
-    boxOpened.clear();
     
     // Don't clear the scene, as it's managed by Game
     qDebug() << "Town scene cleanup complete";
@@ -110,37 +151,8 @@ void TownScene::cleanup()
 
 void TownScene::createBackground()
 {
-    // First create a large black background for the entire scene
-    QGraphicsRectItem* blackBackground = scene->addRect(0, 0, SCENE_WIDTH, SCENE_HEIGHT, 
-        QPen(Qt::transparent), QBrush(Qt::black));
-    blackBackground->setZValue(-1);
-    qDebug() << "Black background created with size:" << SCENE_WIDTH << "x" << SCENE_HEIGHT;
-
-    // Load town background
-    QPixmap background(":/Dataset/Image/scene/Town.png");
-
-    if (background.isNull()) {
-        qDebug() << "Town background image not found. Check the path.";
-        background = QPixmap(TOWN_WIDTH, TOWN_HEIGHT);
-        background.fill(Qt::white);
-    } else {
-        qDebug() << "Town background loaded successfully, size:" << background.width() << "x" << background.height();
-        
-        // Scale the image to fill 1000x1000 town area
-        if (background.width() != TOWN_WIDTH || background.height() != TOWN_HEIGHT) {
-            background = background.scaled(TOWN_WIDTH, TOWN_HEIGHT, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
-            qDebug() << "Town background scaled to:" << background.width() << "x" << background.height();
-        }
-    }
-
-    // Position town background at (0,0) in scene
-    backgroundItem = scene->addPixmap(background);
-    backgroundItem->setPos(0, 0);
-    backgroundItem->setZValue(0);
-
-    qDebug() << "Town background positioned for scrolling view";
-    
-    // Make sure the scene background is also black
+    // Game's WorldStreamer streams the town background in chunks around the
+    // camera; where there is no map the scene shows black
     scene->setBackgroundBrush(Qt::black);
 }
 
@@ -158,228 +170,107 @@ void TownScene::createPlayer()
     }
 
     playerItem = scene->addPixmap(playerSprite);
-    playerItem->setPos(playerPos); // Set initial position
     playerItem->setZValue(3); // Ensure player is on top of other elements
-    qDebug() << "Initial player position:" << playerPos.x() << playerPos.y();
+    playerItem->setVisible(false); // Until the player enters the town
 }
 
-void TownScene::createBarriers()
+void TownScene::buildWorld(CollisionWorld &world, Pathfinder &pathfinder)
 {
-    // Define barriers for the town based on 1000x1000 dimensions and the reference image
-    QVector<QRect> barrierRects = {
-        // Tree barriers around the perimeter
-        QRect(0, 0, 492,100),  // Top left trees
-        QRect(585, 0, 470,100),  // Top right trees
-        QRect(0, 0, 80, TOWN_HEIGHT),  // Left trees
-        QRect(TOWN_WIDTH - 87, 0, 100, TOWN_HEIGHT),  // Right trees
-       
-        
-        // Upper buildings (houses)
-        QRect(205, 175, 210, 219),  // Left house
-        QRect(586, 175, 210, 219),  // Right house
-        QRect(173, 326, 31, 68),  // Mailbox beside Left house
-        QRect(550, 326, 31, 68),  // Mailbox beside Right house
-
-        
-        // Center-left fence 
-        QRect(208, 549, 214, 46),  
-        // Bottom fence
-        QRect(546, 801, 249, 41),
-        
-        
-       
-        QRect(209, 698, 42, 46),  // Bottom-left bulletin board
-        QRect(377, 548, 45, 45),  // Center-left fence bulletin board
-        QRect(669, 801, 45, 45),  // Bottom fence bulletin board
-        
-        
-        
-        QRect(550, 470, 281, 225),  // Center main building
-        
-   
-        
-        QRect(297, 849, 152, 145),  // Lake at bottom
-        
+    for (const QRectF &rect : MapLayout::toWorld(MapLayout::AREA_TOWN, MapLayout::townBarriers())) {
+        world.addSolid(rect);
+    }
+    for (const QRectF &rect : MapLayout::toWorld(MapLayout::AREA_TOWN, MapLayout::townBulletinBoards())) {
+        world.addSolid(rect);
+    }
+    pathfinder.build(world, MapLayout::areaRect(MapLayout::AREA_TOWN).adjusted(0, 0, -25, -48));
+}
 
-    };
+void TownScene::createBarriers()
+{
+    // Barriers for the town come from the shared map layout; bulletin boards are solid too.
+    // They are plain rects; debug builds outline them in a single overlay item.
+    debugOverlay = DebugOverlayItem::create(scene);
+    bulletinBoardRects = MapLayout::toWorld(MapLayout::AREA_TOWN, MapLayout::townBulletinBoards());
+    barrierRects = MapLayout::toWorld(MapLayout::AREA_TOWN, MapLayout::townBarriers());
+    barrierRects += bulletinBoardRects;
+    
+    // Door into the lab
+    labPortalRect = MapLayout::toWorld(MapLayout::AREA_TOWN, MapLayout::townLabPortal());
 
-    // Add barriers (with visible red outlines for debugging)
-    for (const QRect &rect : barrierRects) {
-        QGraphicsRectItem *barrier = scene->addRect(rect, QPen(Qt::red, 1), QBrush(Qt::transparent));
-        barrier->setZValue(5); // Higher zValue to be visible for debugging
-        barrierItems.append(barrier);
+    // Red barriers, green boards and a blue portal, as the old debug items were drawn
+    if (debugOverlay) {
+        debugOverlay->addRects(barrierRects, QPen(Qt::red, 1));
+        debugOverlay->addRects(bulletinBoardRects, QPen(Qt::darkGreen, 2), QBrush(QColor(0, 128, 0, 100)));
+        debugOverlay->addRect(labPortalRect, QPen(Qt::blue, 2), QBrush(QColor(0, 0, 255, 100)));
     }
     
-    // Create bulletin boards with green color - MATCH EXACTLY with barrier positions
-    // First bulletin board (bottom-left)
-    QRect bulletinBoard1(209, 698, 42, 46);
-    QGraphicsRectItem *board1 = scene->addRect(bulletinBoard1, QPen(Qt::darkGreen, 2), QBrush(QColor(0, 128, 0, 100)));
-    board1->setZValue(2); // Below player but visible
-    bulletinBoardItems.append(board1);
-    
-    // Second bulletin board (center-left fence)
-    QRect bulletinBoard2(377, 548, 45, 45);
-    QGraphicsRectItem *board2 = scene->addRect(bulletinBoard2, QPen(Qt::darkGreen, 2), QBrush(QColor(0, 128, 0, 100)));
-    board2->setZValue(2);
-    bulletinBoardItems.append(board2);
-    
-    // Third bulletin board (bottom fence)
-    QRect bulletinBoard3(669, 801, 45, 45);
-    QGraphicsRectItem *board3 = scene->addRect(bulletinBoard3, QPen(Qt::darkGreen, 2), QBrush(QColor(0, 128, 0, 100)));
-    board3->setZValue(2);
-    bulletinBoardItems.append(board3);
-    
-    // Create lab transition portal (blue box)
-    QRect labPortalRect(669, 700, 45, 45);
-    QGraphicsRectItem *labPortal = scene->addRect(labPortalRect, QPen(Qt::blue, 2), QBrush(QColor(0, 0, 255, 100)));
-    labPortal->setZValue(2); // Below player but visible
-    labPortalItem = labPortal;
-    
-    // Create grassland transition portal (blue box)
-    QRect grasslandPortalRect(490, 0, 90, 90);
-    QGraphicsRectItem *grasslandPortal = scene->addRect(grasslandPortalRect, QPen(Qt::blue, 2), QBrush(QColor(0, 0, 255, 100)));
-    grasslandPortal->setZValue(2); // Below player but visible
-    grasslandPortalItem = grasslandPortal;
-    
-    qDebug() << "Created" << barrierItems.size() << "barriers," << bulletinBoardItems.size() 
-             << "bulletin boards, and 2 portals for town";
+    qDebug() << "Created" << barrierRects.size() << "barriers," << bulletinBoardRects.size() 
+             << "bulletin boards, and the lab portal for town";
 }
 
-void TownScene::handleKeyPress(int key)
+void TownScene::handleAction(InputSystem::Action action)
 {
-    qDebug() << "Town scene key pressed:" << key;
+    frameLoop->wake();
+
+    qDebug() << "Town scene action:" << action;
 
-    // If bag is open, only allow B key to close it
+    // If bag is open, only allow the menu key (B) to close it
     if (isBagOpen) {
-        if (key == Qt::Key_B) {
+        if (action == InputSystem::MENU) {
             toggleBag();
         }
         return; // Block all other key presses while bag is open
     }
 
-    // If dialogue is active, only allow A to advance
+    // If dialogue is active, only allow confirm (A) to advance
     if (isDialogueActive) {
-        if (key == Qt::Key_A) {
+        if (action == InputSystem::CONFIRM) {
             handleDialogue();
         }
         return;
     }
 
-    // Add key to pressed keys set for movement
-    pressedKeys.insert(key);
-    qDebug() << "Key pressed: " << key;
-
-    // For arrow keys, set as current pressed key for continuous movement
-    // and also take a small step immediately for responsive feel
-    if (key == Qt::Key_Up || key == Qt::Key_Down || key == Qt::Key_Left || key == Qt::Key_Right) {
-        QPointF prevPos = playerPos;
-        bool moved = false;
-        
-        // Take immediate step (5 pixels)
-        if (key == Qt::Key_Up) {
-            playerDirection = "B";
-            playerPos.setY(playerPos.y() - 5);
-            moved = true;
-        } else if (key == Qt::Key_Down) {
-            playerDirection = "F";
-            playerPos.setY(playerPos.y() + 5);
-            moved = true;
-        } else if (key == Qt::Key_Left) {
-            playerDirection = "L";
-            playerPos.setX(playerPos.x() - 5);
-            moved = true;
-        } else if (key == Qt::Key_Right) {
-            playerDirection = "R";
-            playerPos.setX(playerPos.x() + 5);
-            moved = true;
-        }
-        
-        if (moved) {
-            // Boundary checks
-            if (playerPos.x() < 0) {
-                playerPos.setX(0);
-            } else if (playerPos.x() > TOWN_WIDTH - 25) {
-                playerPos.setX(TOWN_WIDTH - 25);
-            }
-
-            if (playerPos.y() < 0) {
-                playerPos.setY(0);
-            } else if (playerPos.y() > TOWN_HEIGHT - 48) {
-                playerPos.setY(TOWN_HEIGHT - 48);
-            }
-            
-            // Collision check
-            QRectF playerRect(playerPos.x() + 5, playerPos.y() + 30, 25, 18);
-            bool collision = false;
-            
-            for (const QGraphicsRectItem* barrier : barrierItems) {
-                QRectF barrierRect = barrier->rect();
-                if (playerRect.intersects(barrierRect)) {
-                    collision = true;
-                    break;
-                }
-            }
-            
-            if (collision) {
-                playerPos = prevPos;
-            } else {
-                // Update position and sprite
-                if (playerItem) {
-                    playerItem->setPos(playerPos);
-                    qDebug() << "Immediate step: player position updated to:" << playerPos;
-                }
-                walkFrame = (walkFrame + 1) % 3;
-                updatePlayerSprite();
-                updateCamera();
-            }
-        }
-        
-        // Set current key for continuous movement
-        currentPressedKey = key;
-        // Start the movement timer if it's not already running
-        if (!movementTimer->isActive()) {
-            movementTimer->start(100);
-        }
-    }
+    // Arrow keys already reached the simulation through Game's input state:
+    // one short step right away, then steps for as long as the key stays down
 
-    // Check for B key to open bag
-    if (key == Qt::Key_B) {
+    // Menu key (B) opens the bag
+    if (action == InputSystem::MENU) {
         toggleBag();
         return;
     }
 
-    // Check for A key to interact with objects
-    if (key == Qt::Key_A) {
+    // Confirm (A) interacts with objects
+    if (action == InputSystem::CONFIRM) {
         // Check both bulletin boards and boxes and prioritize bulletin boards
-        int boardIndex = -1;
-        int boxIndex = -1;
-        bool nearBulletinBoard = isPlayerNearBulletinBoard(boardIndex);
-        bool nearBox = isPlayerNearBox(boxIndex);
+        int boardIndex = occupiedBulletin;
+        int boxIndex = occupiedBox;
+        bool nearBulletinBoard = boardIndex >= 0;
+        bool nearBox = boxIndex >= 0;
         
         // Prioritize bulletin board if near both
         if (nearBulletinBoard) {
-            // Show the Pallet Town message for all bulletin boards
-            showDialogue("This is Pallet Town. Begin your adventure!");
+            // Every bulletin board shows the Pallet Town message
+            game->getScripts()->start("town_bulletin", this);
             qDebug() << "Activated bulletin board dialogue at index:" << boardIndex;
             return;
         }
         // Then check boxes if not near a bulletin board
         else if (nearBox) {
-            if (!boxOpened[boxIndex]) {
-                // Get the item from Game class instead of generating a random one
+            // Box indexes are Game's, so opened flags and contents survive saves and re-entering
+            if (!game->getTownBoxOpenedStates().value(boxIndex, false)) {
                 QString itemName = game->getTownBoxContents().value(boxIndex, "Mystery Item");
-                QString itemMessage = "You got " + itemName + "!";
+                QString itemMessage;
+                StringTable::format(itemMessage, STR_YOU_GOT, {StringTable::name(itemName)});
                 
                 showDialogue(itemMessage);
-                boxOpened[boxIndex] = true;
                 
                 // Add the item to the player's inventory
                 game->addItem(itemName, 1);
                 
-                // Report the box state back to Game
+                // Game keeps the opened flag and journals it
                 game->setTownBoxOpenedState(boxIndex, true);
             } else {
-                showDialogue("Box is empty");
+                showDialogue(StringTable::get(STR_BOX_EMPTY));
             }
             return;
         }
@@ -388,188 +279,120 @@ void TownScene::handleKeyPress(int key)
     }
 }
 
-void TownScene::handleKeyRelease(int key)
+void TownScene::handleActionRelease(InputSystem::Action action)
 {
-    // Remove key from pressed keys set
-    pressedKeys.remove(key);
-    
-    // If the released key was the current movement key, reset it
-    if (key == currentPressedKey) {
-        currentPressedKey = 0;
-        
-        // Stop the movement timer if no arrow keys are pressed
-        if (!pressedKeys.contains(Qt::Key_Up) && 
-            !pressedKeys.contains(Qt::Key_Down) && 
-            !pressedKeys.contains(Qt::Key_Left) && 
-            !pressedKeys.contains(Qt::Key_Right)) {
-            movementTimer->stop();
-        }
-    }
+    Q_UNUSED(action);
+
+    // The simulation already saw the release through the input state
+    frameLoop->wake();
 }
 
-void TownScene::processMovement()
+void TownScene::applySimulationSnapshot()
 {
-    // Do nothing if no key is pressed or dialogue/bag is open
-    if (currentPressedKey == 0 || isDialogueActive || isBagOpen) {
-        static int stepCounter = 0;
-        stepCounter = 0; // Reset counter when not moving
+    AllocationTracker::Scope allocationScope(AllocationTracker::WALK);
+    WorldSnapshot snapshot;
+    if (!game->takeWorldSnapshot(snapshot)) {
         return;
     }
-    
-    QPointF prevPos = playerPos;
-    bool moved = false;
-
-    // Calculate the position to center the town in the larger scene
-    float townOffsetX = (SCENE_WIDTH - TOWN_WIDTH) / 2;
-    float townOffsetY = (SCENE_HEIGHT - TOWN_HEIGHT) / 2;
+    // The items below show the step the press asked for from the next paint
+    game->getInput()->markApplied(snapshot.inputNs, InputSystem::WALK_LATENCY);
 
-    // Speed increases after holding the key for some time
-    static int stepCounter = 0;
-    int moveSpeed = 8; // Base speed
-    
-    // Increase speed after a few steps (by 20%)
-    if (stepCounter > 3) {
-        moveSpeed = 10; // Increased by 20% from base
-    }
-    stepCounter++;
-
-    // Movement based on currently pressed key
-    if (currentPressedKey == Qt::Key_Up) {
-        playerPos.setY(playerPos.y() - moveSpeed);
-        playerDirection = "B";
-        moved = true;
-    } else if (currentPressedKey == Qt::Key_Down) {
-        playerPos.setY(playerPos.y() + moveSpeed);
-        playerDirection = "F";
-        moved = true;
-    } else if (currentPressedKey == Qt::Key_Left) {
-        playerPos.setX(playerPos.x() - moveSpeed);
-        playerDirection = "L";
-        moved = true;
-    } else if (currentPressedKey == Qt::Key_Right) {
-        playerPos.setX(playerPos.x() + moveSpeed);
-        playerDirection = "R";
-        moved = true;
+    // Written in place: assigning a new QString would allocate on every turn
+    const QChar direction = QLatin1Char(snapshot.direction);
+    if (direction != playerDirection.at(0) || snapshot.walkFrame != walkFrame) {
+        playerDirection[0] = direction;
+        walkFrame = snapshot.walkFrame;
+        updatePlayerSprite();
     }
 
-    if (moved) {
-        // Boundary checking - don't allow player to go outside town area
-        if (playerPos.x() < 0) {
-            playerPos.setX(0);
-        } else if (playerPos.x() > TOWN_WIDTH - 25) {
-            playerPos.setX(TOWN_WIDTH - 25);
+    if (snapshot.playerPos != playerPos) {
+        playerPos = snapshot.playerPos;
+        if (playerItem) {
+            playerItem->setPos(playerPos);
         }
+        updateCamera();
+    }
 
-        if (playerPos.y() < 0) {
-            playerPos.setY(0);
-        } else if (playerPos.y() > TOWN_HEIGHT - 48) {
-            playerPos.setY(TOWN_HEIGHT - 48);
-        }
+    // Walked out of the town: the next area's scene takes over
+    if (snapshot.area != MapLayout::AREA_TOWN) {
+        pendingArea = snapshot.area;
+    }
 
-        // Check collision with barriers using a smaller hitbox at player's feet
-        QRectF playerRect(playerPos.x() + 5, playerPos.y() + 30, 25, 18);
-        bool collision = false;
-        
-        for (const QGraphicsRectItem* barrier : barrierItems) {
-            QRectF barrierRect = barrier->rect();
-            if (playerRect.intersects(barrierRect)) {
-                collision = true;
-                break;
-            }
+    // Portal, bulletin board and box volumes are tested on the simulation thread
+    occupiedBulletin = snapshot.occupiedTrigger(TriggerSystem::Kind::Bulletin);
+    occupiedBox = snapshot.occupiedTrigger(TriggerSystem::Kind::Box);
+    for (int i = snapshot.firstNewEvent; i < snapshot.events.size(); ++i) {
+        const WorldEvent &event = snapshot.events[i];
+        if (event.type == WorldEvent::TRIGGER_ENTERED) {
+            onTriggerEntered(event.trigger, event.index);
         }
-
-        if (collision) {
-            playerPos = prevPos;
-            stepCounter = 0; // Reset counter when collision occurs
-        } else {
-            // Update walk frame only if we actually moved
-            walkFrame = (walkFrame + 1) % 3;
-            
-            // Update player visual position
-            if (playerItem) {
-                playerItem->setPos(playerPos);
-                qDebug() << "Continuous movement: player position updated to:" << playerPos;
-            }
-            
-            // Update player sprite based on direction and walk frame
-            updatePlayerSprite();
-            
-            // Update camera to follow player
-            updateCamera();
-            
-            // Check if player is now on the lab portal - automatic transport
-            if (isPlayerNearLabPortal()) {
-                qDebug() << "Player walked into the portal to return to lab";
-                
-                // Reset movement state before changing scene
-                currentPressedKey = 0;
-                pressedKeys.clear();
-                movementTimer->stop();
-                
-                game->changeScene(GameState::LABORATORY);
-                return;
-            }
-        }
-    } else {
-        stepCounter = 0; // Reset counter if no movement happened
     }
 }
 
+void TownScene::updatePlayerFreeze()
+{
+    // The player stands still while the bag or a dialogue is open
+    game->getSimulation()->setFrozen(isBagOpen || isDialogueActive);
+}
+
 void TownScene::updateScene()
 {
-    // If bag is open or dialogue is active, don't update
-    if (isBagOpen || isDialogueActive) {
+    // Everything allocated from here on counts towards this frame
+    AllocationTracker::beginFrame();
+    if (debugOverlay) {
+        debugOverlay->showAllocationStats(cameraPos);
+    }
+
+    // Menu and dialogue actions from this tick's input sample
+    game->pollInput();
+    if (game->getCurrentScene() != this) {
         return;
     }
 
-    // Check if player is on the lab portal, and if so, change scene
-    if (isPlayerNearLabPortal()) {
-        qDebug() << "Player on lab portal, switching scene...";
-        // Switch to lab scene
-        game->changeScene(GameState::LABORATORY);
+    // Events that used up their step budget carry on here
+    {
+        AllocationTracker::Scope allocationScope(AllocationTracker::SCRIPTS);
+        game->getScripts()->tick();
+    }
+
+    // If bag is open or dialogue is active, don't update
+    if (isBagOpen || isDialogueActive) {
         return;
     }
-    
-    // Check if player is on the grassland portal, and if so, change scene
-    if (isPlayerNearGrasslandPortal()) {
-        qDebug() << "Player on grassland portal, switching scene...";
-        // Switch to grassland scene
-        game->changeScene(GameState::GRASSLAND);
+
+    applySimulationSnapshot();
+
+    // Hand the player over once they have walked out of the town or onto
+    // the lab's door. This is done here rather than in the trigger handler
+    // so a key press handler that moved the player never keeps running
+    // after the town has let go.
+    if (pendingArea >= 0) {
+        qDebug() << "Player left the town for area" << pendingArea;
+        const GameState next = Game::areaState(static_cast<MapLayout::Area>(pendingArea));
+        pendingArea = -1;
+        game->changeScene(next);
         return;
     }
 
     // Other update logic...
 }
 
-void TownScene::updatePlayerSprite()
+void TownScene::onTriggerEntered(TriggerSystem::Kind kind, int index)
 {
-    QString basePath = ":/Dataset/Image/player/player_";
-    QString spritePath;
-
-    // If not moving or first frame, use the base sprite for that direction
-    if (walkFrame == 0) {
-        spritePath = basePath + playerDirection + ".png";
-    } else {
-        // Use the walking animation frames (W1 or W2)
-        spritePath = basePath + playerDirection + "W" + QString::number(walkFrame) + ".png";
-    }
-    
-    QPixmap playerSprite(spritePath);
-    
-    if (playerSprite.isNull()) {
-        qDebug() << "Failed to load sprite:" << spritePath;
-        // Fallback to default sprite if animation frame not found
-        if (playerDirection == "F") {
-            playerSprite = QPixmap(":/Dataset/Image/player/player_F.png");
-        } else {
-            // If even the fallback fails, create a colored rectangle
-            playerSprite = QPixmap(35, 48);
-            playerSprite.fill(Qt::red);
+    // Portal volumes are numbered as MapLayout::portalLinks()
+    if (kind == TriggerSystem::Kind::Portal) {
+        const QVector<MapLayout::PortalLink> portals = MapLayout::portalLinks();
+        if (index >= 0 && index < portals.size()) {
+            pendingArea = portals[index].to;
         }
     }
-    
+}
+
+void TownScene::updatePlayerSprite()
+{
+    // Walk frames are decoded once and shared, so a step only swaps pixmaps
     if (playerItem) {
-        playerItem->setPixmap(playerSprite);
+        playerItem->setPixmap(SpriteCache::instance().playerFrame(playerDirection.at(0), walkFrame));
     }
 }
 
@@ -591,13 +414,14 @@ void TownScene::updateCamera()
     // 2. When boundary is reached, window boundary won't exceed background boundary
     // 3. If player moves away from boundary, window centers again
     
-    // Calculate boundary constraints
-    float minCameraX = 0; // Left boundary
-    float maxCameraX = TOWN_WIDTH - VIEW_WIDTH; // Right boundary
-    float minCameraY = 0; // Top boundary
-    float maxCameraY = TOWN_HEIGHT - VIEW_HEIGHT; // Bottom boundary
+    // Calculate boundary constraints; the grassland above is in view too
+    const QRectF region = MapLayout::regionRect(MapLayout::AREA_TOWN);
+    float minCameraX = region.left(); // Left boundary
+    float maxCameraX = region.right() - VIEW_WIDTH; // Right boundary
+    float minCameraY = region.top(); // Top boundary
+    float maxCameraY = region.bottom() - VIEW_HEIGHT; // Bottom boundary
     
-    // Apply constraints - prevent camera from going outside town boundaries
+    // Apply constraints - prevent camera from going outside the map
     if (targetCameraPos.x() < minCameraX) targetCameraPos.setX(minCameraX);
     if (targetCameraPos.y() < minCameraY) targetCameraPos.setY(minCameraY);
     if (targetCameraPos.x() > maxCameraX) targetCameraPos.setX(maxCameraX);
@@ -608,9 +432,7 @@ void TownScene::updateCamera()
     
     // Update the view - this makes the camera follow the player
     scene->setSceneRect(cameraPos.x(), cameraPos.y(), VIEW_WIDTH, VIEW_HEIGHT);
-    
-    // Debug info
-    qDebug() << "Camera at:" << cameraPos << "Player at:" << playerPos;
+    game->getWorldStreamer()->setView(QRectF(cameraPos, QSizeF(VIEW_WIDTH, VIEW_HEIGHT)));
     
     // Update dialogue box position if active
     if (isDialogueActive && dialogBoxItem) {
@@ -636,16 +458,17 @@ void TownScene::updateCamera()
 bool TownScene::checkCollision()
 {
     // Boundary checking
-    if (playerPos.x() < 0 || playerPos.x() > TOWN_WIDTH - 35 ||
-        playerPos.y() < 0 || playerPos.y() > TOWN_HEIGHT - 48) {
+    const QRectF town = MapLayout::areaRect(MapLayout::AREA_TOWN);
+    if (playerPos.x() < town.left() || playerPos.x() > town.right() - 35 ||
+        playerPos.y() < town.top() || playerPos.y() > town.bottom() - 48) {
         return true;
     }
 
     // Check collision with barriers - use smaller hitbox at player's feet
     QRectF playerRect(playerPos.x() + 5, playerPos.y() + 30, 25, 18);
     
-    for (const QGraphicsRectItem* barrier : barrierItems) {
-        if (playerRect.intersects(barrier->rect())) {
+    for (const QRectF &barrier : barrierRects) {
+        if (playerRect.intersects(barrier)) {
             return true;
         }
     }
@@ -678,6 +501,7 @@ void TownScene::toggleBag()
         // Update the display to show the Pokémon in the bag
         updateBagDisplay();
     }
+    updatePlayerFreeze();
 }
 
 void TownScene::clearBagDisplayItems()
@@ -819,7 +643,7 @@ void TownScene::updateBagDisplay()
                 
                 // Add count text ("x1", "x2", etc.)
                 QFont countFont("Arial", 10, QFont::Bold);
-                QGraphicsTextItem* countText = scene->addText("x" + QString::number(count), countFont);
+                BitmapTextItem* countText = BitmapTextItem::create(scene, "x" + QString::number(count), countFont);
                 countText->setDefaultTextColor(Qt::black);
                 countText->setZValue(102);
                 // Position text closer to icon to save space
@@ -861,24 +685,19 @@ void TownScene::updateBagDisplay()
     for (int i = 0; i < playerPokemon.size() && i < 4; i++) {
         Pokemon* pokemon = playerPokemon[i];
         
-        // Load the Pokémon image
-        QPixmap pokemonImage(pokemon->getImagePath());
+        // Shared icon, already scaled to fit the row height
+        QPixmap pokemonImage = SpriteCache::instance().sprite(pokemon->getName(), SpriteCache::BAG_ICON);
         if (pokemonImage.isNull()) {
             qDebug() << "Failed to load Pokémon image for" << pokemon->getName() << "at" << pokemon->getImagePath();
             continue;
         }
         
-        // Scale the image to fit the row height
-        pokemonImage = pokemonImage.scaled(ROW_HEIGHT, ROW_HEIGHT, 
-                                          Qt::KeepAspectRatio, 
-                                          Qt::SmoothTransformation);
-        
         // Calculate row position with even spacing
         float rowY = startY + i * (ROW_HEIGHT + ROW_SPACING);
         
         // Create the Pokémon name text first (on the left)
         QFont nameFont("Arial", 12, QFont::Bold);
-        QGraphicsTextItem* nameText = scene->addText(pokemon->getName(), nameFont);
+        BitmapTextItem* nameText = BitmapTextItem::create(scene, StringTable::name(pokemon->getName()), nameFont);
         nameText->setDefaultTextColor(Qt::black);
         nameText->setZValue(102); // Above both bag and row
         
@@ -937,7 +756,7 @@ void TownScene::showDialogueBox(const QString &text)
     
     // Create text with appropriate font
     QFont dialogFont("Arial", 12);
-    dialogTextItem = scene->addText(text, dialogFont);
+    dialogTextItem = BitmapTextItem::create(scene, text, dialogFont);
     dialogTextItem->setDefaultTextColor(Qt::black);
     
     // Position the text inside the dialogue box with some padding
@@ -947,8 +766,7 @@ void TownScene::showDialogueBox(const QString &text)
     dialogTextItem->setZValue(91); // Above dialogue box
     
     // Set text width to wrap long lines
-    QTextDocument* doc = dialogTextItem->document();
-    doc->setTextWidth(VIEW_WIDTH - 40); // Allow text to wrap
+    dialogTextItem->setTextWidth(VIEW_WIDTH - 40); // Allow text to wrap
     
     // Adjust dialog box height if needed for multiline text
     float textHeight = dialogTextItem->boundingRect().height();
@@ -959,6 +777,7 @@ void TownScene::showDialogueBox(const QString &text)
 
     // Set dialogue as active
     isDialogueActive = true;
+    updatePlayerFreeze();
 }
 
 void TownScene::showDialogue(const QString &text)
@@ -969,7 +788,23 @@ void TownScene::showDialogue(const QString &text)
 
 void TownScene::handleDialogue()
 {
-    // For now, just close the dialogue when A is pressed
+    // Scripted dialogue decides what A does next
+    ScriptEngine *scripts = game->getScripts();
+    if (scripts->isRunning()) {
+        scripts->advance();
+        return;
+    }
+    
+    closeDialogue();
+}
+
+void TownScene::scriptSay(const QString &text)
+{
+    showDialogue(text);
+}
+
+void TownScene::scriptEnd()
+{
     closeDialogue();
 }
 
@@ -991,275 +826,37 @@ void TownScene::closeDialogue()
     // Reset dialogue state
     isDialogueActive = false;
     currentDialogueState = 0;
-}
-
-bool TownScene::isPlayerNearBulletinBoard(int &boardIndex) const
-{
-    // Get player's center position for distance calculation
-    QPointF playerCenter(playerPos.x() + 17, playerPos.y() + 30);
-    
-    // Check each bulletin board
-    for (int i = 0; i < bulletinBoardItems.size(); i++) {
-        QRectF boardRect = bulletinBoardItems[i]->rect();
-        
-        // Calculate the center of the bulletin board
-        QPointF boardCenter(
-            boardRect.x() + boardRect.width()/2,
-            boardRect.y() + boardRect.height()/2
-        );
-        
-        // Calculate distance between player and board center
-        float dx = playerCenter.x() - boardCenter.x();
-        float dy = playerCenter.y() - boardCenter.y();
-        float distance = sqrt(dx*dx + dy*dy);
-        
-        // Check if player is within 25 pixels (circular radius) of the board
-        const float INTERACTION_RADIUS = 25.0;
-        bool isInRange = (distance <= INTERACTION_RADIUS + boardRect.width()/2);
-        
-        // Debug output
-        qDebug() << "Bulletin board" << i 
-                 << "at center:" << boardCenter
-                 << "player at:" << playerCenter
-                 << "distance:" << distance
-                 << "isInRange:" << isInRange;
-        
-        // Remove the direction check - activate if player is within range regardless of facing direction
-        if (isInRange) {
-            boardIndex = i;
-            return true;
-        }
-    }
-    
-    boardIndex = -1;
-    return false;
-}
-
-bool TownScene::isPlayerNearLabPortal() const
-{
-    // Get player's feet position (collision box)
-    QRectF playerFeet(playerPos.x() + 5, playerPos.y() + 30, 25, 18);
-    
-    if (!labPortalItem) {
-        qDebug() << "Lab portal item is null!";
-        return false;
-    }
-    
-    QRectF portalRect = labPortalItem->rect();
-    
-    // Check if player's feet area intersects with the portal
-    bool isOnPortal = playerFeet.intersects(portalRect);
-    
-    // Debug output
-    qDebug() << "Lab portal at:" << portalRect
-             << "player feet at:" << playerFeet
-             << "isOnPortal:" << isOnPortal;
-    
-    // Player must be directly on the portal to transport
-    return isOnPortal;
-}
-
-bool TownScene::isPlayerNearGrasslandPortal() const
-{
-    // Get player's feet position (collision box)
-    QRectF playerFeet(playerPos.x() + 5, playerPos.y() + 30, 25, 18);
-    
-    if (!grasslandPortalItem) {
-        qDebug() << "Grassland portal item is null!";
-        return false;
-    }
-    
-    QRectF portalRect = grasslandPortalItem->rect();
-    
-    // Check if player's feet area intersects with the portal
-    bool isOnPortal = playerFeet.intersects(portalRect);
-    
-    // Debug output
-    qDebug() << "Grassland portal at:" << portalRect
-             << "player feet at:" << playerFeet
-             << "isOnPortal:" << isOnPortal;
-    
-    // Player must be directly on the portal to transport
-    return isOnPortal;
-}
-
-bool TownScene::isPlayerNearBox(int &boxIndex) const
-{
-    // Get player's center position for distance calculation
-    QPointF playerCenter(playerPos.x() + 17, playerPos.y() + 30);
-    
-    // Check each box
-    for (int i = 0; i < boxHitboxes.size(); i++) {
-        QRectF boxRect = boxHitboxes[i]->rect();
-        
-        // Calculate the center of the box
-        QPointF boxCenter(
-            boxRect.x() + boxRect.width()/2,
-            boxRect.y() + boxRect.height()/2
-        );
-        
-        // Calculate distance between player and box center
-        float dx = playerCenter.x() - boxCenter.x();
-        float dy = playerCenter.y() - boxCenter.y();
-        float distance = sqrt(dx*dx + dy*dy);
-        
-        // Check if player is within 25 pixels (circular radius) of the box
-        const float INTERACTION_RADIUS = 25.0;
-        bool isInRange = (distance <= INTERACTION_RADIUS + boxRect.width()/2);
-        
-        // Debug output
-        qDebug() << "Box" << i 
-                 << "at center:" << boxCenter
-                 << "player at:" << playerCenter
-                 << "distance:" << distance
-                 << "isInRange:" << isInRange;
-        
-        // If player is within range, activate interaction
-        if (isInRange) {
-            boxIndex = i;
-            return true;
-        }
-    }
-    
-    boxIndex = -1;
-    return false;
+    updatePlayerFreeze();
 }
 
 void TownScene::createBoxes()
 {
-    const int BOX_SIZE = 40;
-    const int NUM_BOXES = 12;
-    const int MIN_DISTANCE = 50; // Minimum distance between boxes
-    
-    // Initialize boxItems with empty strings
-    boxItems.clear();
-    for (int i = 0; i < NUM_BOXES; ++i) {
-        boxItems.append("");
+    // Game placed the boxes when the town was first entered (or loaded them
+    // from the save), so the layout is the same every visit
+    const int BOX_SIZE = MapLayout::TOWN_BOX_SIZE;
+    const QVector<QPointF> &boxPositions = game->getTownBoxPositions();
+    if (boxPositions.isEmpty()) {
+        qDebug() << "Game has no town boxes to show";
+        return;
     }
 
-    // Generate random items for the boxes
-    generateRandomItems();
+    // Every box shares one sprite
+    QPixmap boxPixmap(":/Dataset/Image/box.png");
+    if (boxPixmap.isNull()) {
+        qDebug() << "Failed to load box image";
+        return;
+    }
+    boxPixmap = boxPixmap.scaled(BOX_SIZE, BOX_SIZE, Qt::KeepAspectRatio, Qt::SmoothTransformation);
 
-    // Create a list to store box positions
-    QVector<QPointF> boxPositions;
-    
-    // Function to check if a position is valid (not overlapping with barriers or other boxes)
-    auto isValidPosition = [&](const QPointF& pos) {
-        // Check if too close to other boxes
-        for (const QPointF& existingPos : boxPositions) {
-            float dx = pos.x() - existingPos.x();
-            float dy = pos.y() - existingPos.y();
-            if (sqrt(dx*dx + dy*dy) < MIN_DISTANCE) {
-                return false;
-            }
-        }
-        
-        // Create a rect for the proposed box position
-        QRectF proposedRect(pos.x(), pos.y(), BOX_SIZE, BOX_SIZE);
-        
-        // Check collision with barriers
-        for (const QGraphicsRectItem* barrier : barrierItems) {
-            if (proposedRect.intersects(barrier->rect())) {
-                return false;
-            }
-        }
-        
-        // Check collision with bulletin boards
-        for (const QGraphicsRectItem* board : bulletinBoardItems) {
-            if (proposedRect.intersects(board->rect())) {
-                return false;
-            }
-        }
+    for (int i = 0; i < boxPositions.size(); ++i) {
+        QPointF pos = MapLayout::toWorld(MapLayout::AREA_TOWN, boxPositions[i]);
         
-        // Check if too close to edges
-        if (pos.x() < 100 || pos.x() > TOWN_WIDTH - BOX_SIZE - 100 ||
-            pos.y() < 100 || pos.y() > TOWN_HEIGHT - BOX_SIZE - 100) {
-            return false;
-        }
-        
-        return true;
-    };
-
-    // Try to place each box
-    for (int i = 0; i < NUM_BOXES; ++i) {
-        QPointF pos;
-        bool found = false;
-        int attempts = 0;
-        const int MAX_ATTEMPTS = 100;
-        
-        // Keep trying until we find a valid position or run out of attempts
-        while (!found && attempts < MAX_ATTEMPTS) {
-            // Generate random position
-            float x = QRandomGenerator::global()->bounded(100, TOWN_WIDTH - BOX_SIZE - 100);
-            float y = QRandomGenerator::global()->bounded(100, TOWN_HEIGHT - BOX_SIZE - 100);
-            pos = QPointF(x, y);
-            
-            if (isValidPosition(pos)) {
-                found = true;
-                boxPositions.append(pos);
-            }
-            
-            attempts++;
-        }
+        // The box sprite only exists while the chunk it stands on is near the camera
+        boxSprites.append(game->getWorldStreamer()->addSprite(boxPixmap, pos, 5));
         
-        if (!found) {
-            qDebug() << "Could not find valid position for box" << i;
-            continue;
-        }
-        
-        // Create box sprite
-        QPixmap boxPixmap(":/Dataset/Image/box.png");
-        if (boxPixmap.isNull()) {
-            qDebug() << "Failed to load box image";
-            continue;
-        }
-        boxPixmap = boxPixmap.scaled(BOX_SIZE, BOX_SIZE, Qt::KeepAspectRatio, Qt::SmoothTransformation);
-        QGraphicsPixmapItem* box = scene->addPixmap(boxPixmap);
-        box->setPos(pos);
-        box->setZValue(5);
-        boxSprites.append(box);
-        
-        // Create hitbox for collision detection
-        QGraphicsRectItem* hitbox = scene->addRect(pos.x(), pos.y(), BOX_SIZE, BOX_SIZE, QPen(Qt::transparent));
-        hitbox->setZValue(5);
+        // Hitbox for collision detection; its index is the box's index in Game
+        QRectF hitbox(pos.x(), pos.y(), BOX_SIZE, BOX_SIZE);
         boxHitboxes.append(hitbox);
-        
-        // Initialize box as unopened
-        boxOpened[boxHitboxes.size() - 1] = false;
-    }
-}
-
-void TownScene::generateRandomItems()
-{
-    // Create a list of all items with their desired counts
-    QVector<QString> itemPool;
-    
-    // Add 3 Poké Balls
-    for (int i = 0; i < 3; i++) {
-        itemPool.append("Poké Ball");
-    }
-    
-    // Add 9 Potions
-    for (int i = 0; i < 9; i++) {
-        itemPool.append("Potion");
-    }
-    
-    // Add 3 Ethers
-    for (int i = 0; i < 3; i++) {
-        itemPool.append("Ether");
-    }
-    
-    // Shuffle the item pool
-    for (int i = itemPool.size() - 1; i > 0; i--) {
-        int j = QRandomGenerator::global()->bounded(i + 1);
-        if (i != j) {
-            std::swap(itemPool[i], itemPool[j]);
-        }
-    }
-    
-    // Place items in boxes (first 12 items from shuffled pool)
-    for (int i = 0; i < qMin(12, itemPool.size()); i++) {
-        boxItems[i] = itemPool[i];
     }
 }
 
@@ -1272,4 +869,4 @@ void TownScene::update()
 
     // Update scene state
     updateScene();
-} 
\ No newline at end of file
+} 
\ No newline at end of file
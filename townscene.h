@@ -2,6 +2,13 @@
 #define TOWNSCENE_H
 
 #include "scene.h"
+#include "frameloop.h"
+#include "collisionworld.h"
+#include "kinematicmover.h"
+#include "pathfinder.h"
+#include "triggersystem.h"
+#include "debugoverlayitem.h"
+#include "bitmaptextitem.h"
 #include <QGraphicsScene>
 #include <QGraphicsPixmapItem>
 #include <QGraphicsRectItem>
@@ -21,69 +28,79 @@ public:
     ~TownScene() override;
 
     void initialize() override;
-    void handleKeyPress(int key) override;
-    void handleKeyRelease(int key) override;
+    void handleAction(InputSystem::Action action) override;
+    void handleActionRelease(InputSystem::Action action) override;
     void cleanup() override;
     void update() override;
 
+    void addToWorld(WorldContent &content) override;
+    void enterArea(const QPointF &position) override;
+    void leaveArea() override;
+
+    // Solids (barriers and bulletin boards) and the walkable grid of the
+    // town, in world coordinates; reads only MapLayout, so the warm-up can
+    // call it on any thread
+    static void buildWorld(CollisionWorld &world, Pathfinder &pathfinder);
+
 private slots:
     void updateScene();
-    void processMovement();
 
 private:
-    // Constants for town dimensions
-    const int TOWN_WIDTH = 1000;
-    const int TOWN_HEIGHT = 1000;
+    // Barrier geometry for swept player movement
+    CollisionWorld collisionWorld;
+    KinematicMover playerMover;
+    Pathfinder pathfinder;  // Walkable grid for scripted/automatic walks
 
     // Timers
-    QTimer *updateTimer{nullptr};
-    QTimer *movementTimer{nullptr};
+    FrameLoop *frameLoop{nullptr};
+
+    // Portal, bulletin board and box volumes
+    int pendingArea{-1};  // Area the player walked or was sent into, handled in updateScene
+    int occupiedBulletin{-1};  // Volumes the player stands in, from the simulation's snapshots
+    int occupiedBox{-1};
 
-    // Graphics items
-    QGraphicsPixmapItem *backgroundItem{nullptr};
+    // Map geometry in world coordinates - plain rects, drawn only by the debug overlay
+    QVector<QRectF> barrierRects;
+    QVector<QRectF> bulletinBoardRects;
+    QRectF labPortalRect;        // Portal to return to lab
+    DebugOverlayItem *debugOverlay{nullptr};  // Debug builds only
+
+    // Graphics items; hidden while the player is in another area
     QGraphicsPixmapItem *playerItem{nullptr};
-    QVector<QGraphicsRectItem*> barrierItems;
-    QVector<QGraphicsRectItem*> bulletinBoardItems;
-    QGraphicsRectItem *labPortalItem{nullptr};  // Portal to return to lab
-    QGraphicsRectItem *grasslandPortalItem{nullptr};  // Portal to grassland
-    QGraphicsRectItem *townPortalItem{nullptr};  // Portal to return to town
-    QGraphicsRectItem *bulletinBoardItem{nullptr};  // Bulletin board for conversation
     
-    // Box items - new
-    QVector<QString> boxItems;  // Items in each box
-    QVector<QGraphicsPixmapItem*> boxSprites;  // Visual box sprites
-    QVector<QGraphicsRectItem*> boxHitboxes;  // Collision detection areas
-    QMap<int, bool> boxOpened;  // Track which boxes have been opened
+    // Boxes; positions, contents and opened flags belong to Game
+    QVector<int> boxSprites;  // WorldStreamer sprites, streamed in with the ground under them
+    QVector<QRectF> boxHitboxes;  // Collision detection areas
     
     // Dialogue items
     QGraphicsItem* dialogBoxItem{nullptr};
-    QGraphicsTextItem* dialogTextItem{nullptr};
+    BitmapTextItem* dialogTextItem{nullptr};
     bool isDialogueActive{false};
     int currentDialogueState{0};
 
     // Bag items
     QGraphicsPixmapItem* bagBackgroundItem{nullptr};
     QVector<QGraphicsPixmapItem*> bagPokemonSprites;
-    QVector<QGraphicsTextItem*> bagPokemonNames;
+    QVector<BitmapTextItem*> bagPokemonNames;
     QVector<QGraphicsRectItem*> bagSlotRects;
     bool isBagOpen{false};
 
     // Player state
-    QPointF playerPos{500, 500}; // Default starting position (center of 1000x1000 town)
+    QPointF playerPos; // World position, set when the player enters the town
     QPointF cameraPos{0, 0}; // Camera position for viewing
     QString playerDirection{"F"}; // F=front, B=back, L=left, R=right
     int walkFrame{0};
-    
-    // Input handling
-    QSet<int> pressedKeys;
-    int currentPressedKey{0};
 
     // Methods
     void createBackground();
     void createPlayer();
     void createBarriers();
-    void createBoxes();  // New method to create boxes
+    void createBoxes();  // Boxes at the positions Game placed them
     void updatePlayerSprite();
+    void applySimulationSnapshot();
+    void onTriggerEntered(TriggerSystem::Kind kind, int index);
+    // The bag and dialogues stop the player; called where they open and close
+    void updatePlayerFreeze();
     void updatePlayerPosition();
     void updateCamera();
     bool checkCollision();
@@ -94,11 +111,10 @@ private:
     void showDialogue(const QString &text);
     void closeDialogue();
     void handleDialogue();
-    bool isPlayerNearBulletinBoard(int &boardIndex) const;
-    bool isPlayerNearLabPortal() const;
-    bool isPlayerNearGrasslandPortal() const;
-    bool isPlayerNearBox(int &boxIndex) const;  // New method to check proximity to boxes
-    void generateRandomItems();  // Add this line
+
+    // Event scripts (town_bulletin)
+    void scriptSay(const QString &text) override;
+    void scriptEnd() override;
 };
 
-#endif // TOWNSCENE_H 
\ No newline at end of file
+#endif // TOWNSCENE_H 
\ No newline at end of file
@@ -0,0 +1,129 @@
+#include "triggersystem.h"
+#include <cmath>
+
+TriggerSystem::TriggerSystem(qreal cellSize, QObject *parent)
+    : QObject(parent),
+      cellSize(cellSize > 0 ? cellSize : 1.0)
+{
+}
+
+void TriggerSystem::addRect(Kind kind, int index, const QRectF &rect)
+{
+    Volume volume;
+    volume.kind = kind;
+    volume.index = index;
+    volume.rect = rect;
+    volume.radius = 0;
+    volume.inside = false;
+    volumes.append(volume);
+
+    // Re-test on the next update so a volume added under the player fires
+    hasCell = false;
+}
+
+void TriggerSystem::addRadius(Kind kind, int index, const QPointF &center, qreal radius)
+{
+    Volume volume;
+    volume.kind = kind;
+    volume.index = index;
+    volume.center = center;
+    volume.radius = radius;
+    volume.inside = false;
+    volumes.append(volume);
+
+    hasCell = false;
+}
+
+void TriggerSystem::remove(Kind kind, int index)
+{
+    bool wasInside = false;
+    for (int i = volumes.size() - 1; i >= 0; --i) {
+        if (volumes[i].kind == kind && volumes[i].index == index) {
+            wasInside |= volumes[i].inside;
+            volumes.remove(i);
+        }
+    }
+    if (wasInside) {
+        emit exited(kind, index);
+    }
+}
+
+void TriggerSystem::clear()
+{
+    volumes.clear();
+    pending.clear();
+    hasCell = false;
+    clearCount++;
+}
+
+int TriggerSystem::occupied(Kind kind) const
+{
+    for (const Volume &volume : volumes) {
+        if (volume.kind == kind && volume.inside) {
+            return volume.index;
+        }
+    }
+    return -1;
+}
+
+void TriggerSystem::updatePlayer(const QPointF &playerPos)
+{
+    // Nothing can change while the player stays inside the same cell
+    int x = static_cast<int>(std::floor(playerPos.x() / cellSize));
+    int y = static_cast<int>(std::floor(playerPos.y() / cellSize));
+    if (hasCell && x == cellX && y == cellY) {
+        return;
+    }
+    hasCell = true;
+    cellX = x;
+    cellY = y;
+
+    // Same player shapes the scenes use: feet hitbox for walking onto
+    // things, centre point for standing next to them
+    QRectF playerFeet(playerPos.x() + 5, playerPos.y() + 30, 25, 18);
+    QPointF playerCenter(playerPos.x() + 17, playerPos.y() + 30);
+
+    pending.clear();
+    for (Volume &volume : volumes) {
+        bool inside;
+        if (volume.radius > 0) {
+            qreal dx = playerCenter.x() - volume.center.x();
+            qreal dy = playerCenter.y() - volume.center.y();
+            inside = dx * dx + dy * dy <= volume.radius * volume.radius;
+        } else {
+            inside = playerFeet.intersects(volume.rect);
+        }
+
+        if (inside != volume.inside) {
+            pending.append({inside ? ENTERED : EXITED, volume.kind, volume.index});
+        } else if (inside) {
+            pending.append({STAYED, volume.kind, volume.index});
+        }
+        volume.inside = inside;
+    }
+
+    // Exits go out first so a scene moving between neighbouring volumes
+    // sees the old one close before the new one opens. A handler may
+    // change scenes, which clears us - stop as soon as that happens.
+    const quint32 clearsBefore = clearCount;
+    for (int type = EXITED; type <= STAYED; ++type) {
+        for (int i = 0; i < pending.size(); ++i) {
+            const Event event = pending[i];
+            if (event.type != type) {
+                continue;
+            }
+
+            if (type == EXITED) {
+                emit exited(event.kind, event.index);
+            } else if (type == ENTERED) {
+                emit entered(event.kind, event.index);
+            } else {
+                emit stayed(event.kind, event.index);
+            }
+
+            if (clearCount != clearsBefore) {
+                return;
+            }
+        }
+    }
+}
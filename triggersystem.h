@@ -0,0 +1,86 @@
+#ifndef TRIGGERSYSTEM_H
+#define TRIGGERSYSTEM_H
+
+#include <QObject>
+#include <QPointF>
+#include <QRectF>
+#include <QVector>
+
+// Trigger volumes for portals, bulletin boards, tall grass and boxes.
+//
+// The simulation adds the volumes of the chunks around the player, removes
+// them again as the player walks away, and feeds every player step into
+// updatePlayer(). Volumes are only tested when the player's
+// quantized cell changes, and the result is raised as entered/exited/stayed
+// signals, which the simulation passes on to the scene as WorldEvents.
+class TriggerSystem : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class Kind {
+        Portal,
+        Bulletin,
+        Grass,
+        Box
+    };
+    Q_ENUM(Kind)
+    static const int KIND_COUNT = 4;
+
+    explicit TriggerSystem(qreal cellSize = 4.0, QObject *parent = nullptr);
+
+    // Occupied while the player's feet hitbox intersects rect
+    void addRect(Kind kind, int index, const QRectF &rect);
+    // Occupied while the player's interaction point is within radius of center
+    void addRadius(Kind kind, int index, const QPointF &center, qreal radius);
+
+    // Drops the volumes of this kind and index. One the player stood in
+    // raises exited, so occupied state never outlives its volume.
+    void remove(Kind kind, int index);
+    // Drops all volumes; safe to call from a signal handler
+    void clear();
+
+    // Call after every player move (player sprite top-left)
+    void updatePlayer(const QPointF &playerPos);
+
+    // Index of the first occupied volume of this kind, -1 if none
+    int occupied(Kind kind) const;
+
+signals:
+    void entered(TriggerSystem::Kind kind, int index);
+    void exited(TriggerSystem::Kind kind, int index);
+    void stayed(TriggerSystem::Kind kind, int index);
+
+private:
+    enum EventType {
+        EXITED = 0,
+        ENTERED = 1,
+        STAYED = 2
+    };
+
+    struct Volume {
+        Kind kind;
+        int index;
+        QRectF rect;      // Rect volumes
+        QPointF center;   // Radius volumes
+        qreal radius;     // <= 0 for rect volumes
+        bool inside;
+    };
+
+    struct Event {
+        EventType type;
+        Kind kind;
+        int index;
+    };
+
+    qreal cellSize;
+    QVector<Volume> volumes;
+    QVector<Event> pending;  // Reused between updates
+
+    bool hasCell{false};
+    int cellX{0};
+    int cellY{0};
+    quint32 clearCount{0};  // Lets updatePlayer notice a clear() from a handler
+};
+
+#endif // TRIGGERSYSTEM_H
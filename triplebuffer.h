@@ -0,0 +1,53 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <atomic>
+
+// Lock-free single-producer / single-consumer triple buffer.
+//
+// The producer fills writeBuffer() and calls publish(); the consumer calls
+// update() and reads readBuffer(). Three slots mean neither side ever waits:
+// the producer always has a free slot to write into, and the consumer always
+// sees the most recent complete value, skipping any it was too slow to read.
+template <typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() = default;
+    TripleBuffer(const TripleBuffer &) = delete;
+    TripleBuffer &operator=(const TripleBuffer &) = delete;
+
+    // Producer side
+    T &writeBuffer() { return buffers[writeIndex]; }
+
+    void publish()
+    {
+        // Swap the filled slot with the shared one and flag it as fresh
+        int previous = shared.exchange(writeIndex | FRESH, std::memory_order_acq_rel);
+        writeIndex = previous & INDEX_MASK;
+    }
+
+    // Consumer side. Returns true when a newer value became readable.
+    bool update()
+    {
+        if (!(shared.load(std::memory_order_relaxed) & FRESH)) {
+            return false;
+        }
+        int previous = shared.exchange(readIndex, std::memory_order_acq_rel);
+        readIndex = previous & INDEX_MASK;
+        return true;
+    }
+
+    const T &readBuffer() const { return buffers[readIndex]; }
+
+private:
+    static const int INDEX_MASK = 3;
+    static const int FRESH = 4;
+
+    T buffers[3];
+    int writeIndex{0};          // Owned by the producer
+    int readIndex{1};           // Owned by the consumer
+    std::atomic<int> shared{2}; // Slot in transit, plus the FRESH bit
+};
+
+#endif // TRIPLEBUFFER_H
@@ -0,0 +1,181 @@
+#include "viewportculler.h"
+#include <QGraphicsItem>
+#include <QGraphicsScene>
+#include <cmath>
+
+ViewportCuller::ViewportCuller(QGraphicsScene *scene, qreal margin, qreal cellSize)
+    : scene(scene),
+      margin(margin),
+      cellSize(cellSize > 0 ? cellSize : 256.0)
+{
+}
+
+ViewportCuller::~ViewportCuller()
+{
+    clear();
+}
+
+void ViewportCuller::addItem(QGraphicsItem *item)
+{
+    if (!item) {
+        return;
+    }
+
+    int index = itemIndex.value(item, -1);
+    if (index >= 0) {
+        erase(index);
+    } else {
+        index = entries.size();
+        Entry entry;
+        entry.item = item;
+        entry.inScene = item->scene() != nullptr;
+        entries.append(entry);
+        itemIndex.insert(item, index);
+        if (entry.inScene) {
+            attached.append(index);
+        }
+    }
+
+    Entry &entry = entries[index];
+    entry.bounds = item->sceneBoundingRect();
+    insert(index);
+
+    // Before the first update everything stays where it is
+    if (activeRect.isNull()) {
+        return;
+    }
+    bool wanted = entry.bounds.intersects(activeRect);
+    if (wanted && !entry.inScene) {
+        attach(index);
+    } else if (!wanted && entry.inScene) {
+        detach(index);
+        attached.removeOne(index);
+    }
+}
+
+void ViewportCuller::removeItem(QGraphicsItem *item)
+{
+    int index = itemIndex.value(item, -1);
+    if (index < 0) {
+        return;
+    }
+
+    if (!entries[index].inScene) {
+        attach(index);
+    }
+    attached.removeOne(index);
+    erase(index);
+    entries[index].item = nullptr;
+    itemIndex.remove(item);
+}
+
+void ViewportCuller::update(const QRectF &viewRect)
+{
+    activeRect = viewRect.adjusted(-margin, -margin, margin, margin);
+
+    // A new stamp value marks "not near the view" for every entry at once
+    if (++stamp == 0) {
+        for (Entry &entry : entries) {
+            entry.seenStamp = 0;
+        }
+        stamp = 1;
+    }
+
+    int firstX = static_cast<int>(std::floor(activeRect.left() / cellSize));
+    int lastX = static_cast<int>(std::floor(activeRect.right() / cellSize));
+    int firstY = static_cast<int>(std::floor(activeRect.top() / cellSize));
+    int lastY = static_cast<int>(std::floor(activeRect.bottom() / cellSize));
+
+    for (int y = firstY; y <= lastY; ++y) {
+        for (int x = firstX; x <= lastX; ++x) {
+            auto it = cells.constFind(cellKey(x, y));
+            if (it == cells.constEnd()) {
+                continue;
+            }
+            for (int index : it.value()) {
+                Entry &entry = entries[index];
+                if (entry.seenStamp == stamp || !entry.bounds.intersects(activeRect)) {
+                    continue;
+                }
+                entry.seenStamp = stamp;
+                if (!entry.inScene) {
+                    attach(index);
+                }
+            }
+        }
+    }
+
+    // Whatever is attached but was not seen has left the view
+    for (int i = 0; i < attached.size();) {
+        if (entries[attached[i]].seenStamp == stamp) {
+            ++i;
+            continue;
+        }
+        detach(attached[i]);
+        attached[i] = attached.last();
+        attached.removeLast();
+    }
+}
+
+void ViewportCuller::clear()
+{
+    for (int index = 0; index < entries.size(); ++index) {
+        if (entries[index].item && !entries[index].inScene) {
+            attach(index);
+        }
+    }
+    entries.clear();
+    itemIndex.clear();
+    cells.clear();
+    attached.clear();
+    activeRect = QRectF();
+}
+
+void ViewportCuller::insert(int index)
+{
+    const QRectF &rect = entries[index].bounds;
+    int firstX = static_cast<int>(std::floor(rect.left() / cellSize));
+    int lastX = static_cast<int>(std::floor(rect.right() / cellSize));
+    int firstY = static_cast<int>(std::floor(rect.top() / cellSize));
+    int lastY = static_cast<int>(std::floor(rect.bottom() / cellSize));
+
+    for (int y = firstY; y <= lastY; ++y) {
+        for (int x = firstX; x <= lastX; ++x) {
+            cells[cellKey(x, y)].append(index);
+        }
+    }
+}
+
+void ViewportCuller::erase(int index)
+{
+    const QRectF &rect = entries[index].bounds;
+    int firstX = static_cast<int>(std::floor(rect.left() / cellSize));
+    int lastX = static_cast<int>(std::floor(rect.right() / cellSize));
+    int firstY = static_cast<int>(std::floor(rect.top() / cellSize));
+    int lastY = static_cast<int>(std::floor(rect.bottom() / cellSize));
+
+    for (int y = firstY; y <= lastY; ++y) {
+        for (int x = firstX; x <= lastX; ++x) {
+            auto it = cells.find(cellKey(x, y));
+            if (it != cells.end()) {
+                it.value().removeOne(index);
+            }
+        }
+    }
+}
+
+void ViewportCuller::attach(int index)
+{
+    Entry &entry = entries[index];
+    scene->addItem(entry.item);
+    entry.inScene = true;
+    attached.append(index);
+}
+
+void ViewportCuller::detach(int index)
+{
+    // Leaves the attached list to the caller, which may be iterating it
+    Entry &entry = entries[index];
+    scene->removeItem(entry.item);
+    entry.inScene = false;
+}
@@ -0,0 +1,69 @@
+#ifndef VIEWPORTCULLER_H
+#define VIEWPORTCULLER_H
+
+#include <QHash>
+#include <QRectF>
+#include <QVector>
+
+class QGraphicsItem;
+class QGraphicsScene;
+
+// Keeps only the world items near the camera in the scene.
+//
+// Managed items (boxes, wild Pokémon) are taken out of the scene while
+// they are further than the margin from the view, so the scene neither
+// paints nor indexes them, and are put back when the camera comes near.
+// A detached item is still a normal item: its pos and visibility can be
+// read and changed as usual.
+//
+// Items are found through a uniform grid like CollisionWorld's, so an
+// update only touches the items near the old and the new view.
+class ViewportCuller
+{
+public:
+    explicit ViewportCuller(QGraphicsScene *scene, qreal margin = 64.0, qreal cellSize = 256.0);
+    ~ViewportCuller();
+
+    // Starts managing an item that is in the scene, or refreshes the bounds
+    // of one already managed after it has been moved
+    void addItem(QGraphicsItem *item);
+    // Stops managing an item and puts it back into the scene
+    void removeItem(QGraphicsItem *item);
+
+    // viewRect: the part of the scene the camera currently shows
+    void update(const QRectF &viewRect);
+
+    // Puts every detached item back so the scene owns them all again - call
+    // before the scene is cleared or the items are deleted
+    void clear();
+
+    int managedCount() const { return itemIndex.size(); }
+    int attachedCount() const { return attached.size(); }
+
+private:
+    struct Entry {
+        QGraphicsItem *item{nullptr};  // nullptr once removed
+        QRectF bounds;                 // Scene bounds when last added
+        bool inScene{true};
+        quint32 seenStamp{0};
+    };
+
+    QGraphicsScene *scene;
+    qreal margin;
+    qreal cellSize;
+
+    QVector<Entry> entries;
+    QHash<QGraphicsItem *, int> itemIndex;
+    QHash<qint64, QVector<int>> cells;
+    QVector<int> attached;  // Entries currently in the scene
+    QRectF activeRect;      // View plus margin from the last update
+    quint32 stamp{0};
+
+    static qint64 cellKey(int x, int y) { return (static_cast<qint64>(y) << 32) | static_cast<quint32>(x); }
+    void insert(int index);
+    void erase(int index);
+    void attach(int index);
+    void detach(int index);
+};
+
+#endif // VIEWPORTCULLER_H
@@ -0,0 +1,123 @@
+#include "warmup.h"
+#include "spritecache.h"
+#include <QDebug>
+#include <QRunnable>
+#include <QThread>
+#include <QVector>
+
+namespace {
+
+// Every species the lab hands out or the grassland spawns
+const char *const SPECIES[] = {"charmander", "squirtle", "bulbasaur"};
+const char PLAYER_DIRECTIONS[] = "FBLR";
+
+class WarmUpTask : public QRunnable
+{
+public:
+    explicit WarmUpTask(const std::function<void()> &work)
+        : work(work)
+    {
+    }
+
+    void run() override
+    {
+        work();
+    }
+
+private:
+    std::function<void()> work;
+};
+
+}
+
+WarmUp::WarmUp(QObject *parent)
+    : QObject(parent)
+{
+    // Leave a core to the GUI thread, which keeps drawing the title screen
+    pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 1));
+}
+
+WarmUp::~WarmUp()
+{
+    // Results still queued for this object are dropped with it
+    pool.clear();
+    pool.waitForDone();
+}
+
+void WarmUp::setWorldBuilder(MapLayout::Area area, WorldBuilder builder)
+{
+    builders[area] = builder;
+}
+
+void WarmUp::start()
+{
+    if (started) {
+        return;
+    }
+    started = true;
+    clock.start();
+
+    for (int area = 0; area < MapLayout::AREA_COUNT; ++area) {
+        WorldBuilder builder = builders[area];
+        if (!builder) {
+            continue;
+        }
+        queue([this, area, builder]() -> std::function<void()> {
+            AreaWorld built;
+            builder(built.collision, built.pathfinder);
+            return [this, area, built]() {
+                worlds[area] = built;
+                worldReady[area] = true;
+            };
+        });
+    }
+
+    queue([]() -> std::function<void()> {
+        QVector<SpriteCache::Images> species;
+        for (const char *name : SPECIES) {
+            species.append(SpriteCache::decode(QString::fromLatin1(name)));
+        }
+        QVector<QImage> frames;
+        for (int direction = 0; direction < 4; ++direction) {
+            for (int walkFrame = 0; walkFrame < 3; ++walkFrame) {
+                frames.append(SpriteCache::decodePlayerFrame(QLatin1Char(PLAYER_DIRECTIONS[direction]), walkFrame));
+            }
+        }
+
+        return [species, frames]() {
+            SpriteCache &cache = SpriteCache::instance();
+            for (int i = 0; i < species.size(); ++i) {
+                cache.insert(QString::fromLatin1(SPECIES[i]), species[i]);
+            }
+            for (int i = 0; i < frames.size(); ++i) {
+                cache.insertPlayerFrame(QLatin1Char(PLAYER_DIRECTIONS[i / 3]), i % 3, frames[i]);
+            }
+        };
+    });
+}
+
+const WarmUp::AreaWorld *WarmUp::world(MapLayout::Area area) const
+{
+    return worldReady[area] ? &worlds[area] : nullptr;
+}
+
+void WarmUp::queue(std::function<std::function<void()>()> work)
+{
+    pendingJobs++;
+    pool.start(new WarmUpTask([this, work]() {
+        std::function<void()> apply = work();
+        QMetaObject::invokeMethod(this, [this, apply]() {
+            apply();
+            jobDone();
+        }, Qt::QueuedConnection);
+    }));
+}
+
+void WarmUp::jobDone()
+{
+    pendingJobs--;
+    if (pendingJobs == 0) {
+        qDebug() << "Warm-up finished in" << clock.elapsed() << "ms";
+        emit finished();
+    }
+}
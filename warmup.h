@@ -0,0 +1,65 @@
+#ifndef WARMUP_H
+#define WARMUP_H
+
+#include "collisionworld.h"
+#include "maplayout.h"
+#include "pathfinder.h"
+#include <QElapsedTimer>
+#include <QObject>
+#include <QThreadPool>
+#include <functional>
+
+// Prepares the playable areas while the title screen is up.
+//
+// A small thread pool builds each area's collision world and navigation
+// grid, one job per area, next to a job decoding the player and Pokémon
+// sprites, so pressing start finds them ready instead of doing that work
+// between two frames. Area backgrounds are not handled here; the
+// WorldStreamer decodes those on its thread. Results are handed back to
+// the GUI thread, which is also where the decoded sprites become pixmaps.
+class WarmUp : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Fills an empty world and grid with an area's barriers; must not touch
+    // anything but its arguments, it runs on a pool thread
+    typedef void (*WorldBuilder)(CollisionWorld &world, Pathfinder &pathfinder);
+
+    struct AreaWorld {
+        CollisionWorld collision;
+        Pathfinder pathfinder;
+    };
+
+    explicit WarmUp(QObject *parent = nullptr);
+    ~WarmUp();
+
+    // Call for every area before start()
+    void setWorldBuilder(MapLayout::Area area, WorldBuilder builder);
+    // Queues all the work; later calls do nothing
+    void start();
+
+    // The prebuilt world of an area, or nullptr while it is not ready. A
+    // scene copies it, which shares the data instead of duplicating it.
+    const AreaWorld *world(MapLayout::Area area) const;
+    bool isFinished() const { return started && pendingJobs == 0; }
+
+signals:
+    void finished();
+
+private:
+    QThreadPool pool;
+    WorldBuilder builders[MapLayout::AREA_COUNT] = {};
+    AreaWorld worlds[MapLayout::AREA_COUNT];
+    bool worldReady[MapLayout::AREA_COUNT] = {};
+    int pendingJobs{0};
+    bool started{false};
+    QElapsedTimer clock;
+
+    // Runs work on the pool; work returns what to do with its result back
+    // on this object's thread
+    void queue(std::function<std::function<void()>()> work);
+    void jobDone();
+};
+
+#endif // WARMUP_H
@@ -0,0 +1,330 @@
+#include "wildspawner.h"
+#include <QDebug>
+#include <QRandomGenerator>
+#include <algorithm>
+#include <cmath>
+
+// Random draws from the free list before falling back to a scan
+static const int MAX_RANDOM_PICKS = 8;
+
+WildSpawner::WildSpawner(qreal cellSize, qreal edgeMargin, qreal spriteSize, qreal minSpacing)
+    : cellSize(cellSize),
+      edgeMargin(edgeMargin),
+      spriteSize(spriteSize),
+      minSpacing(minSpacing),
+      spacingCells(static_cast<int>(std::ceil(minSpacing / cellSize))),
+      random(QRandomGenerator::global())
+{
+}
+
+void WildSpawner::clear()
+{
+    blockers.clear();
+    tables.clear();
+    cells.clear();
+    areas.clear();
+    arena = nullptr;
+    lattice = nullptr;
+    latticeColumns = 0;
+    latticeRows = 0;
+}
+
+void WildSpawner::begin(SceneArena &arena, const QRectF &bounds)
+{
+    clear();
+
+    latticeLeft = static_cast<int>(std::floor(bounds.left() / cellSize));
+    latticeTop = static_cast<int>(std::floor(bounds.top() / cellSize));
+    latticeColumns = static_cast<int>(std::ceil(bounds.right() / cellSize)) - latticeLeft + 1;
+    latticeRows = static_cast<int>(std::ceil(bounds.bottom() / cellSize)) - latticeTop + 1;
+
+    const int size = latticeColumns * latticeRows;
+    lattice = arena.allocateArray<int>(size);
+    std::fill(lattice, lattice + size, -1);
+
+    this->arena = &arena;
+    cells.attach(arena);
+    areas.attach(arena);
+}
+
+QVector<WildSpawner::SpawnEntry> WildSpawner::defaultTable()
+{
+    return {
+        {"Bulbasaur", 1},
+        {"Charmander", 1},
+        {"Squirtle", 1},
+    };
+}
+
+void WildSpawner::addBlocker(const QRectF &rect)
+{
+    blockers.append(rect);
+}
+
+int WildSpawner::addArea(const QRectF &rect, const QVector<SpawnEntry> &table, int respawnDelayMs)
+{
+    if (!lattice) {
+        qDebug() << "WildSpawner::addArea called before begin()";
+        return -1;
+    }
+
+    Area area;
+    area.rect = rect;
+    area.table = tables.size();
+    tables.append(table.isEmpty() ? defaultTable() : table);
+    area.totalWeight = 0;
+    for (const SpawnEntry &entry : tables.last()) {
+        area.totalWeight += qMax(entry.weight, 0);
+    }
+    area.respawnDelayMs = respawnDelayMs;
+    area.respawnAtMs = 0;  // First spawn is allowed right away
+    area.activeCount = 0;
+    area.failureLogged = false;
+    area.enabled = true;
+
+    const int areaIndex = areas.size();
+
+    // Cells sit on a global lattice so spacing works across neighbouring areas.
+    // Keep the same 30 pixel edge margin the old random placement used.
+    const int firstX = static_cast<int>(std::ceil((rect.left() + edgeMargin) / cellSize));
+    const int lastX = static_cast<int>(std::ceil((rect.right() - edgeMargin) / cellSize)) - 1;
+    const int firstY = static_cast<int>(std::ceil((rect.top() + edgeMargin) / cellSize));
+    const int lastY = static_cast<int>(std::ceil((rect.bottom() - edgeMargin) / cellSize)) - 1;
+
+    // Room for every lattice point in the area, rejected ones included
+    area.freeCells = arena->allocateArray<int>(qMax(0, lastX - firstX + 1) * qMax(0, lastY - firstY + 1));
+    area.freeCount = 0;
+
+    int rejected = 0;
+    for (int y = firstY; y <= lastY; ++y) {
+        for (int x = firstX; x <= lastX; ++x) {
+            QPointF position(x * cellSize, y * cellSize);
+            QRectF spriteRect(position.x() - spriteSize / 2, position.y() - spriteSize / 2,
+                              spriteSize, spriteSize);
+
+            bool blocked = false;
+            for (const QRectF &blocker : blockers) {
+                if (spriteRect.intersects(blocker)) {
+                    blocked = true;
+                    break;
+                }
+            }
+
+            // Overlapping areas share a lattice point; the first area keeps it
+            const int slot = latticeSlot(x, y);
+            if (blocked || slot < 0 || lattice[slot] >= 0) {
+                rejected++;
+                continue;
+            }
+
+            Cell cell;
+            cell.position = position;
+            cell.latticeX = x;
+            cell.latticeY = y;
+            cell.area = areaIndex;
+            cell.blockers = 0;
+            cell.freeSlot = area.freeCount;
+            cell.occupied = false;
+
+            lattice[slot] = cells.size();
+            area.freeCells[area.freeCount++] = cells.size();
+            cells.append(cell);
+        }
+    }
+
+    qDebug() << "Spawn area" << areaIndex << "at" << rect << "has" << area.freeCount
+             << "candidate cells (" << rejected << "rejected)";
+
+    areas.append(area);
+    return areaIndex;
+}
+
+QRectF WildSpawner::areaRect(int area) const
+{
+    if (area < 0 || area >= areas.size()) {
+        return QRectF();
+    }
+    return areas[area].rect;
+}
+
+int WildSpawner::activeCount(int area) const
+{
+    if (area < 0 || area >= areas.size()) {
+        return 0;
+    }
+    return areas[area].activeCount;
+}
+
+int WildSpawner::freeCellCount(int area) const
+{
+    if (area < 0 || area >= areas.size()) {
+        return 0;
+    }
+    return areas[area].freeCount;
+}
+
+void WildSpawner::adjustBlockers(int cellIndex, int delta)
+{
+    const int centerX = cells[cellIndex].latticeX;
+    const int centerY = cells[cellIndex].latticeY;
+    const qreal spacingSquared = minSpacing * minSpacing;
+
+    for (int dy = -spacingCells; dy <= spacingCells; ++dy) {
+        for (int dx = -spacingCells; dx <= spacingCells; ++dx) {
+            // Only cells strictly closer than the spacing are blocked
+            if ((dx * dx + dy * dy) * cellSize * cellSize >= spacingSquared) {
+                continue;
+            }
+
+            const int slot = latticeSlot(centerX + dx, centerY + dy);
+            if (slot < 0 || lattice[slot] < 0) {
+                continue;
+            }
+
+            const int index = lattice[slot];
+            Cell &cell = cells[index];
+            Area &area = areas[cell.area];
+
+            if (delta > 0) {
+                if (cell.blockers++ == 0) {
+                    // Swap-remove from the free list
+                    const int slot = cell.freeSlot;
+                    const int moved = area.freeCells[--area.freeCount];
+                    area.freeCells[slot] = moved;
+                    cells[moved].freeSlot = slot;
+                    cell.freeSlot = -1;
+                }
+            } else {
+                if (--cell.blockers == 0) {
+                    cell.freeSlot = area.freeCount;
+                    area.freeCells[area.freeCount++] = index;
+                }
+            }
+        }
+    }
+}
+
+QString WildSpawner::pickSpecies(const Area &area) const
+{
+    const QVector<SpawnEntry> &table = tables[area.table];
+    if (area.totalWeight <= 0) {
+        return table.first().species;
+    }
+
+    int roll = random->bounded(area.totalWeight);
+    for (const SpawnEntry &entry : table) {
+        roll -= qMax(entry.weight, 0);
+        if (roll < 0) {
+            return entry.species;
+        }
+    }
+    return table.last().species;
+}
+
+bool WildSpawner::spawn(int area, const QPointF &playerCenter, qreal minPlayerDistance, Spawn &result)
+{
+    if (area < 0 || area >= areas.size()) {
+        return false;
+    }
+
+    Area &spawnArea = areas[area];
+    if (!spawnArea.enabled) {
+        return false;
+    }
+    if (spawnArea.freeCount == 0) {
+        if (!spawnArea.failureLogged) {
+            qDebug() << "Spawn area" << area << "is full - no free cell left";
+            spawnArea.failureLogged = true;
+        }
+        return false;
+    }
+
+    const qreal minDistanceSquared = minPlayerDistance * minPlayerDistance;
+    auto farFromPlayer = [&](int cellIndex) {
+        qreal dx = cells[cellIndex].position.x() - playerCenter.x();
+        qreal dy = cells[cellIndex].position.y() - playerCenter.y();
+        return dx * dx + dy * dy >= minDistanceSquared;
+    };
+
+    // The player only covers a small part of an area, so a few random
+    // draws almost always succeed
+    int chosen = -1;
+    for (int attempt = 0; attempt < MAX_RANDOM_PICKS; ++attempt) {
+        int candidate = spawnArea.freeCells[random->bounded(spawnArea.freeCount)];
+        if (farFromPlayer(candidate)) {
+            chosen = candidate;
+            break;
+        }
+    }
+
+    // Player is standing in a small area - scan for any valid cell
+    if (chosen < 0) {
+        for (int i = 0; i < spawnArea.freeCount; ++i) {
+            if (farFromPlayer(spawnArea.freeCells[i])) {
+                chosen = spawnArea.freeCells[i];
+                break;
+            }
+        }
+    }
+
+    if (chosen < 0) {
+        // The simulation retries a little later until the player walks away
+        if (!spawnArea.failureLogged) {
+            qDebug() << "Spawn area" << area << "has no free cell far enough from the player";
+            spawnArea.failureLogged = true;
+        }
+        return false;
+    }
+
+    cells[chosen].occupied = true;
+    adjustBlockers(chosen, +1);
+    spawnArea.activeCount++;
+    spawnArea.failureLogged = false;
+
+    result.token = chosen;
+    result.area = area;
+    result.species = pickSpecies(spawnArea);
+    result.position = cells[chosen].position;
+    return true;
+}
+
+void WildSpawner::release(int token, qint64 nowMs)
+{
+    if (token < 0 || token >= cells.size() || !cells[token].occupied) {
+        return;
+    }
+
+    cells[token].occupied = false;
+    adjustBlockers(token, -1);
+
+    Area &area = areas[cells[token].area];
+    area.activeCount--;
+    area.respawnAtMs = nowMs + area.respawnDelayMs;
+    area.failureLogged = false;
+}
+
+void WildSpawner::setAreaEnabled(int area, bool enabled)
+{
+    if (area >= 0 && area < areas.size()) {
+        areas[area].enabled = enabled;
+    }
+}
+
+bool WildSpawner::isRespawnDue(int area, qint64 nowMs) const
+{
+    if (area < 0 || area >= areas.size()) {
+        return false;
+    }
+    return areas[area].enabled && areas[area].activeCount == 0 && nowMs >= areas[area].respawnAtMs;
+}
+
+qint64 WildSpawner::nextRespawnAtMs() const
+{
+    qint64 next = -1;
+    for (const Area &area : areas) {
+        if (area.enabled && area.activeCount == 0 && (next < 0 || area.respawnAtMs < next)) {
+            next = area.respawnAtMs;
+        }
+    }
+    return next;
+}
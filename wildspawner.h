@@ -0,0 +1,139 @@
+#ifndef WILDSPAWNER_H
+#define WILDSPAWNER_H
+
+#include <QPointF>
+#include <QRectF>
+#include <QString>
+#include <QVector>
+#include "scenearena.h"
+
+class QRandomGenerator;
+
+// Picks spawn points for wild Pokémon inside the tall grass areas.
+//
+// Every grass area is cut into a lattice of candidate cells once, when the
+// area is added (cells too close to the edge or whose sprite would overlap a
+// barrier are dropped). Spawned Pokémon block every cell within the spacing
+// radius, and each area keeps a free list of unblocked cells, so a valid
+// position is drawn in O(1) and inter-spawn spacing never has to be checked.
+//
+// The lattice is a dense grid over the whole map, so finding a cell's
+// neighbours is plain indexing. It lives in the scene's arena together with
+// the cells, the areas and their free lists; only the species tables and
+// the blocker rects stay on the heap.
+class WildSpawner
+{
+public:
+    struct SpawnEntry {
+        QString species;  // Bulbasaur, Charmander, Squirtle
+        int weight;       // Relative chance within the area's table
+    };
+
+    struct Spawn {
+        int token{-1};    // Pass back to release() once the Pokémon is gone
+        int area{-1};
+        QString species;
+        QPointF position; // Centre of the sprite
+    };
+
+    explicit WildSpawner(qreal cellSize = 10.0, qreal edgeMargin = 30.0,
+                         qreal spriteSize = 40.0, qreal minSpacing = 60.0);
+
+    // Forgets every area; call before the arena given to begin() is reset
+    void clear();
+
+    // Source of the species rolls and cell draws; the global generator
+    // unless set. The simulation gives it its own.
+    void setRandomGenerator(QRandomGenerator *generator) { random = generator; }
+
+    // Starts a new layout. bounds is the map; cells outside it are dropped.
+    // Must come before the areas are added.
+    void begin(SceneArena &arena, const QRectF &bounds);
+
+    // Barriers must be added before the areas they affect
+    void addBlocker(const QRectF &rect);
+    int addArea(const QRectF &rect, const QVector<SpawnEntry> &table, int respawnDelayMs);
+    static QVector<SpawnEntry> defaultTable();
+
+    int areaCount() const { return areas.size(); }
+    QRectF areaRect(int area) const;
+    int activeCount(int area) const;
+    int freeCellCount(int area) const;
+
+    // Chooses a species from the area's table and a free cell at least
+    // minPlayerDistance from the player. Returns false instead of settling
+    // for a bad spot when the area has no valid cell left. The failure is
+    // logged once per respawn window, not on every retry.
+    bool spawn(int area, const QPointF &playerCenter, qreal minPlayerDistance, Spawn &result);
+
+    // Frees the spawn's cells and starts the area's respawn timer
+    void release(int token, qint64 nowMs);
+
+    // Areas start enabled. A disabled area spawns nothing and is never due,
+    // e.g. while the simulation has its chunks unloaded.
+    void setAreaEnabled(int area, bool enabled);
+
+    // True when the area is enabled, empty and its respawn timer has run out
+    bool isRespawnDue(int area, qint64 nowMs) const;
+    // Earliest time an enabled empty area becomes due, or -1 when there is none
+    qint64 nextRespawnAtMs() const;
+
+private:
+    struct Cell {
+        QPointF position;
+        int latticeX;
+        int latticeY;
+        int area;
+        int blockers;   // Active spawns within spacing range
+        int freeSlot;   // Index in the area's free list, -1 when blocked
+        bool occupied;  // A spawn sits exactly on this cell
+    };
+
+    struct Area {
+        QRectF rect;
+        int table;        // Index in tables
+        int totalWeight;
+        int respawnDelayMs;
+        qint64 respawnAtMs;
+        int activeCount;
+        int *freeCells;   // Arena array with room for every cell of the area
+        int freeCount;
+        bool failureLogged;  // Spawn failure already reported since the last release
+        bool enabled;
+    };
+
+    qreal cellSize;
+    qreal edgeMargin;
+    qreal spriteSize;
+    qreal minSpacing;
+    int spacingCells;  // Lattice radius covered by minSpacing
+
+    QVector<QRectF> blockers;
+    QVector<QVector<SpawnEntry>> tables;
+    ArenaArray<Cell> cells;
+    ArenaArray<Area> areas;
+    SceneArena *arena{nullptr};
+    QRandomGenerator *random;
+
+    // Lattice point -> cell index, -1 where there is no cell; lives in the arena
+    int *lattice{nullptr};
+    int latticeLeft{0};
+    int latticeTop{0};
+    int latticeColumns{0};
+    int latticeRows{0};
+
+    // Slot of lattice point (x, y) in lattice, -1 outside the map
+    int latticeSlot(int x, int y) const
+    {
+        x -= latticeLeft;
+        y -= latticeTop;
+        if (x < 0 || y < 0 || x >= latticeColumns || y >= latticeRows) {
+            return -1;
+        }
+        return y * latticeColumns + x;
+    }
+    void adjustBlockers(int cellIndex, int delta);
+    QString pickSpecies(const Area &area) const;
+};
+
+#endif // WILDSPAWNER_H
@@ -0,0 +1,81 @@
+#include "worldcontent.h"
+#include <QDebug>
+#include <QtMath>
+
+void WorldContent::addCollision(const CollisionWorld &world)
+{
+    solids += world.solids();
+    ledges += world.ledges();
+}
+
+void WorldContent::addRect(TriggerSystem::Kind kind, int index, const QRectF &rect)
+{
+    triggers.append({kind, index, rect, QPointF(), 0});
+}
+
+void WorldContent::addRadius(TriggerSystem::Kind kind, int index, const QPointF &center, qreal radius)
+{
+    triggers.append({kind, index, QRectF(), center, radius});
+}
+
+int WorldContent::triggerCount(TriggerSystem::Kind kind) const
+{
+    int count = 0;
+    for (const Trigger &trigger : triggers) {
+        if (trigger.kind == kind) {
+            count++;
+        }
+    }
+    return count;
+}
+
+int WorldContent::chunkOf(qreal coordinate)
+{
+    // Floor, not truncation: the grassland lies at negative y
+    return qFloor(coordinate / MapLayout::CHUNK_SIZE);
+}
+
+template <typename Add>
+void WorldContent::forChunks(const QRectF &rect, Add add)
+{
+    const int lastColumn = chunkOf(rect.right());
+    const int lastRow = chunkOf(rect.bottom());
+    for (int row = chunkOf(rect.top()); row <= lastRow; ++row) {
+        for (int column = chunkOf(rect.left()); column <= lastColumn; ++column) {
+            add(chunks[chunkKey(column, row)]);
+        }
+    }
+}
+
+void WorldContent::buildChunks()
+{
+    chunks.clear();
+    for (int i = 0; i < solids.size(); ++i) {
+        forChunks(solids[i], [i](Chunk &chunk) { chunk.solids.append(i); });
+    }
+    for (int i = 0; i < ledges.size(); ++i) {
+        forChunks(ledges[i], [i](Chunk &chunk) { chunk.ledges.append(i); });
+    }
+
+    // Radius volumes go under the square around their circle
+    for (int i = 0; i < triggers.size(); ++i) {
+        const Trigger &trigger = triggers[i];
+        const QRectF reach = trigger.radius > 0
+            ? QRectF(trigger.center.x() - trigger.radius, trigger.center.y() - trigger.radius,
+                     trigger.radius * 2, trigger.radius * 2)
+            : trigger.rect;
+        forChunks(reach, [i](Chunk &chunk) { chunk.triggers.append(i); });
+    }
+    for (int i = 0; i < grassAreas.size(); ++i) {
+        forChunks(grassAreas[i], [i](Chunk &chunk) { chunk.grassAreas.append(i); });
+    }
+
+    qDebug() << "World content filed into" << chunks.size() << "chunks:" << solids.size() << "solids,"
+             << ledges.size() << "ledges," << triggers.size() << "triggers," << grassAreas.size() << "grass areas";
+}
+
+const WorldContent::Chunk *WorldContent::chunk(int column, int row) const
+{
+    auto it = chunks.constFind(chunkKey(column, row));
+    return it == chunks.constEnd() ? nullptr : &it.value();
+}
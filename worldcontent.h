@@ -0,0 +1,84 @@
+#ifndef WORLDCONTENT_H
+#define WORLDCONTENT_H
+
+#include "collisionworld.h"
+#include "maplayout.h"
+#include "triggersystem.h"
+#include <QHash>
+#include <QPointF>
+#include <QRectF>
+#include <QVector>
+
+// Everything the simulation knows about the world, in world coordinates:
+// the colliders, trigger volumes and grass areas of every area, and how
+// the player walks in each of them.
+//
+// Each area scene adds its share once, when the world is entered.
+// buildChunks() then files every collider, volume and grass area under the
+// MapLayout::CHUNK_SIZE squares it touches - the same squares WorldStreamer
+// streams the backgrounds in - so the simulation keeps only the chunks
+// around the player loaded.
+struct WorldContent
+{
+    struct Walk {
+        QRectF bounds;           // Area the sprite position may occupy
+        int stepIntervalMs{100};
+        qreal baseSpeed{8};
+        qreal fastSpeed{10};     // Used once the key has been held a few steps
+        qreal nudgeDistance{5};  // Immediate step taken when a key goes down
+    };
+    Walk walks[MapLayout::AREA_COUNT];
+
+    QVector<QRectF> solids;
+    QVector<QRectF> ledges;
+
+    struct Trigger {
+        TriggerSystem::Kind kind;
+        int index;        // What the scenes see in events; unique per kind across the world
+        QRectF rect;      // Rect volumes
+        QPointF center;   // Radius volumes
+        qreal radius;     // <= 0 for rect volumes
+    };
+    QVector<Trigger> triggers;
+
+    // Wild Pokémon appear in the grass areas, away from the blockers.
+    // Their index matches the Grass trigger laid over each of them.
+    QRectF spawnBounds;
+    QVector<QRectF> spawnBlockers;
+    QVector<QRectF> grassAreas;
+    int respawnDelayMs{5000};
+    int maxWildPokemon{16};
+    bool fillGrass{false};  // Spawn until the pool or the grass is full, not one per area
+    bool encounters{true};  // Stress runs walk straight through
+
+    // Indices into the lists above of everything that touches one chunk
+    struct Chunk {
+        QVector<int> solids;
+        QVector<int> ledges;
+        QVector<int> triggers;
+        QVector<int> grassAreas;
+    };
+
+    void addCollision(const CollisionWorld &world);
+    void addRect(TriggerSystem::Kind kind, int index, const QRectF &rect);
+    void addRadius(TriggerSystem::Kind kind, int index, const QPointF &center, qreal radius);
+    // Volumes of kind added so far; an area numbering its volumes after
+    // another area's starts from here
+    int triggerCount(TriggerSystem::Kind kind) const;
+
+    // Call once everything is added
+    void buildChunks();
+    // nullptr where nothing touches the chunk
+    const Chunk *chunk(int column, int row) const;
+    static int chunkOf(qreal coordinate);
+
+private:
+    QHash<qint64, Chunk> chunks;
+
+    static qint64 chunkKey(int column, int row) { return (static_cast<qint64>(row) << 32) | static_cast<quint32>(column); }
+    // Calls add(chunk) for every chunk rect touches
+    template <typename Add>
+    void forChunks(const QRectF &rect, Add add);
+};
+
+#endif // WORLDCONTENT_H
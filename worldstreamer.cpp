@@ -0,0 +1,412 @@
+#include "worldstreamer.h"
+#include <QColor>
+#include <QDebug>
+#include <QGraphicsPixmapItem>
+#include <QGraphicsScene>
+#include <QThread>
+#include <QTimer>
+
+// Enough for every area at once; a tighter budget still works, it just re-decodes more
+static const qint64 DEFAULT_MEMORY_BUDGET = 16 * 1024 * 1024;
+// How close (in pixels) the view may get to an area or a door before that area is prefetched
+static const qreal PREFETCH_MARGIN = 200;
+// Decoded chunks turned into pixmaps per event loop turn; a whole area at once would stall a frame
+static const int CHUNKS_PER_CONVERSION = 2;
+
+void ChunkDecoder::decode(int area)
+{
+    MapLayout::AreaInfo info = MapLayout::areaInfo(static_cast<MapLayout::Area>(area));
+
+    QImage image(info.background);
+    if (image.isNull()) {
+        qDebug() << "Background image not found:" << info.background;
+        image = QImage(info.size, QImage::Format_RGB32);
+        image.fill(area == MapLayout::AREA_GRASSLAND ? QColor(120, 200, 80) : QColor(Qt::white));
+    } else if (image.size() != info.size) {
+        image = image.scaled(info.size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    }
+
+    const int size = WorldStreamer::CHUNK_SIZE;
+    QVector<QImage> chunks;
+    for (int y = 0; y < image.height(); y += size) {
+        for (int x = 0; x < image.width(); x += size) {
+            chunks.append(image.copy(x, y, qMin(size, image.width() - x), qMin(size, image.height() - y)));
+        }
+    }
+
+    emit decoded(area, chunks);
+}
+
+WorldStreamer::WorldStreamer(QObject *parent)
+    : QObject(parent),
+      memoryBudget(DEFAULT_MEMORY_BUDGET)
+{
+    qRegisterMetaType<QVector<QImage>>("QVector<QImage>");
+
+    // The decoder lives on its own thread and is deleted there when it stops
+    decoderThread = new QThread(this);
+    decoderThread->setObjectName("WorldStreamer");
+    decoder = new ChunkDecoder;
+    decoder->moveToThread(decoderThread);
+    connect(decoderThread, &QThread::finished, decoder, &QObject::deleteLater);
+    connect(decoder, &ChunkDecoder::decoded, this, &WorldStreamer::chunksDecoded);
+    decoderThread->start();
+
+    convertTimer = new QTimer(this);
+    convertTimer->setInterval(0);
+    connect(convertTimer, &QTimer::timeout, this, &WorldStreamer::convertChunks);
+
+    // Areas and portals never change; looking them up per frame would build strings and vectors
+    for (int area = 0; area < MapLayout::AREA_COUNT; ++area) {
+        areaColumns[area] = columnCount(static_cast<MapLayout::Area>(area));
+        areaRows[area] = rowCount(static_cast<MapLayout::Area>(area));
+        areaRects[area] = MapLayout::areaRect(static_cast<MapLayout::Area>(area));
+    }
+    portals = MapLayout::portalLinks();
+}
+
+WorldStreamer::~WorldStreamer()
+{
+    // Chunk items left in a scene belong to that scene now
+    decoderThread->quit();
+    decoderThread->wait();
+    decoder = nullptr;
+}
+
+int WorldStreamer::columnCount(MapLayout::Area area)
+{
+    return (MapLayout::areaInfo(area).size.width() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+}
+
+int WorldStreamer::rowCount(MapLayout::Area area)
+{
+    return (MapLayout::areaInfo(area).size.height() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+}
+
+void WorldStreamer::attach(QGraphicsScene *scene, qreal z)
+{
+    detach();
+    this->scene = scene;
+    zValue = z;
+    lastView = QRectF();
+}
+
+void WorldStreamer::detach()
+{
+    if (scene) {
+        for (QGraphicsPixmapItem *item : items) {
+            scene->removeItem(item);
+            delete item;
+        }
+        for (const Sprite &sprite : sprites) {
+            if (sprite.item) {
+                scene->removeItem(sprite.item);
+                delete sprite.item;
+            }
+        }
+    }
+    items.clear();
+    sprites.clear();
+    chunkSprites.clear();
+    scene = nullptr;
+    for (int area = 0; area < MapLayout::AREA_COUNT; ++area) {
+        shownRange[area] = QRect();
+        shownRangeComplete[area] = false;
+    }
+}
+
+void WorldStreamer::prefetch(MapLayout::Area area)
+{
+    if (cachedPerArea[area] == areaColumns[area] * areaRows[area] || pendingAreas.contains(area)) {
+        return;
+    }
+    pendingAreas.insert(area);
+    QMetaObject::invokeMethod(decoder, [this, area]() { decoder->decode(area); }, Qt::QueuedConnection);
+}
+
+void WorldStreamer::setMemoryBudget(qint64 bytes)
+{
+    memoryBudget = bytes;
+    evictToBudget();
+}
+
+int WorldStreamer::visibleChunkCount() const
+{
+    int visible = 0;
+    for (QGraphicsPixmapItem *item : items) {
+        if (item->isVisible()) {
+            visible++;
+        }
+    }
+    return visible;
+}
+
+void WorldStreamer::setView(const QRectF &viewRect)
+{
+    if (!scene) {
+        return;
+    }
+    lastView = viewRect;
+
+    // Grown by a chunk so items exist before they scroll in
+    const QRectF wanted = viewRect.adjusted(-CHUNK_SIZE, -CHUNK_SIZE, CHUNK_SIZE, CHUNK_SIZE);
+    for (int area = 0; area < MapLayout::AREA_COUNT; ++area) {
+        // Area-local columns and rows; none for areas out of range
+        QRect range;
+        const QRectF local = wanted.intersected(areaRects[area]).translated(-areaRects[area].topLeft());
+        if (!local.isEmpty()) {
+            const int firstColumn = static_cast<int>(local.left()) / CHUNK_SIZE;
+            const int lastColumn = qMin(areaColumns[area] - 1, static_cast<int>(local.right()) / CHUNK_SIZE);
+            const int firstRow = static_cast<int>(local.top()) / CHUNK_SIZE;
+            const int lastRow = qMin(areaRows[area] - 1, static_cast<int>(local.bottom()) / CHUNK_SIZE);
+            range = QRect(firstColumn, firstRow, lastColumn - firstColumn + 1, lastRow - firstRow + 1);
+        }
+
+        // Most frames scroll within the same chunks; then there is nothing to add or drop
+        if (range != shownRange[area] || !shownRangeComplete[area]) {
+            updateItems(area, range);
+        }
+    }
+
+    // Decode the areas the view is getting close to, and whatever lies
+    // behind a nearby door, before the player walks in
+    const QRectF nearby = viewRect.adjusted(-PREFETCH_MARGIN, -PREFETCH_MARGIN, PREFETCH_MARGIN, PREFETCH_MARGIN);
+    for (int area = 0; area < MapLayout::AREA_COUNT; ++area) {
+        if (nearby.intersects(areaRects[area])) {
+            prefetch(static_cast<MapLayout::Area>(area));
+        }
+    }
+    for (const MapLayout::PortalLink &link : portals) {
+        if (nearby.intersects(link.rect)) {
+            prefetch(link.to);
+        }
+    }
+
+    emit viewChanged(viewRect);
+}
+
+void WorldStreamer::updateItems(int area, const QRect &range)
+{
+    const int columns = areaColumns[area];
+    const QPointF origin = areaRects[area].topLeft();
+
+    bool missing = false;
+    for (int row = range.top(); row <= range.bottom(); ++row) {
+        for (int column = range.left(); column <= range.right(); ++column) {
+            const int key = chunkKey(area, row * columns + column);
+            showSprites(key);
+
+            auto cached = cache.find(key);
+            if (cached == cache.end()) {
+                missing = true;
+                continue;
+            }
+            cached->lastUsed = ++useCounter;
+
+            auto shown = items.constFind(key);
+            if (shown == items.constEnd()) {
+                QGraphicsPixmapItem *item = scene->addPixmap(cached->pixmap);
+                item->setPos(origin + QPointF(column * CHUNK_SIZE, row * CHUNK_SIZE));
+                item->setZValue(zValue);
+                items.insert(key, item);
+            } else if (!shown.value()->isVisible()) {
+                shown.value()->setVisible(true);
+            }
+        }
+    }
+
+    // Items that scrolled out of range are hidden rather than deleted, so
+    // walking back over ground already seen creates nothing; detach() and
+    // evictToBudget() delete them
+    for (auto it = items.constBegin(); it != items.constEnd(); ++it) {
+        if ((it.key() >> 16) != area) {
+            continue;
+        }
+        const int index = it.key() & 0xFFFF;
+        if (!range.contains(index % columns, index / columns) && it.value()->isVisible()) {
+            it.value()->setVisible(false);
+        }
+    }
+
+    // Sprites are few and cheap to make again, so theirs go
+    const QRect &previous = shownRange[area];
+    for (int row = previous.top(); row <= previous.bottom(); ++row) {
+        for (int column = previous.left(); column <= previous.right(); ++column) {
+            if (!range.contains(column, row)) {
+                hideSprites(chunkKey(area, row * columns + column));
+            }
+        }
+    }
+
+    if (missing) {
+        prefetch(static_cast<MapLayout::Area>(area));
+    }
+    shownRange[area] = range;
+    shownRangeComplete[area] = !missing;
+}
+
+int WorldStreamer::addSprite(const QPixmap &pixmap, const QPointF &pos, qreal z)
+{
+    Sprite sprite;
+    sprite.pixmap = pixmap;
+    sprite.pos = pos;
+    sprite.z = z;
+    sprite.chunk = -1;
+
+    const int id = nextSpriteId++;
+    bool inRange = true;
+    for (int area = 0; area < MapLayout::AREA_COUNT; ++area) {
+        if (areaRects[area].contains(pos)) {
+            const QPointF local = pos - areaRects[area].topLeft();
+            const int column = qMin(areaColumns[area] - 1, static_cast<int>(local.x()) / CHUNK_SIZE);
+            const int row = qMin(areaRows[area] - 1, static_cast<int>(local.y()) / CHUNK_SIZE);
+            sprite.chunk = chunkKey(area, row * areaColumns[area] + column);
+            chunkSprites[sprite.chunk].append(id);
+            inRange = shownRange[area].contains(column, row);
+            break;
+        }
+    }
+
+    Sprite &added = sprites.insert(id, sprite).value();
+    if (inRange) {
+        showSprite(added);
+    }
+    return id;
+}
+
+void WorldStreamer::removeSprite(int id)
+{
+    auto it = sprites.find(id);
+    if (it == sprites.end()) {
+        return;
+    }
+    if (it->item) {
+        scene->removeItem(it->item);
+        delete it->item;
+    }
+    if (it->chunk >= 0) {
+        chunkSprites[it->chunk].removeOne(id);
+    }
+    sprites.erase(it);
+}
+
+void WorldStreamer::showSprites(int chunk)
+{
+    auto onChunk = chunkSprites.constFind(chunk);
+    if (onChunk == chunkSprites.constEnd()) {
+        return;
+    }
+    for (int id : onChunk.value()) {
+        showSprite(sprites[id]);
+    }
+}
+
+void WorldStreamer::hideSprites(int chunk)
+{
+    auto onChunk = chunkSprites.constFind(chunk);
+    if (onChunk == chunkSprites.constEnd()) {
+        return;
+    }
+    for (int id : onChunk.value()) {
+        Sprite &sprite = sprites[id];
+        if (sprite.item) {
+            scene->removeItem(sprite.item);
+            delete sprite.item;
+            sprite.item = nullptr;
+        }
+    }
+}
+
+void WorldStreamer::showSprite(Sprite &sprite)
+{
+    if (sprite.item || !scene) {
+        return;
+    }
+    sprite.item = scene->addPixmap(sprite.pixmap);
+    sprite.item->setPos(sprite.pos);
+    sprite.item->setZValue(sprite.z);
+}
+
+void WorldStreamer::chunksDecoded(int area, const QVector<QImage> &chunks)
+{
+    // Pixmaps can only be made on this thread; convertChunks() does a few at a time
+    for (int index = 0; index < chunks.size(); ++index) {
+        if (!cache.contains(chunkKey(area, index))) {
+            converting.append({area, index, chunks[index]});
+            convertingPerArea[area]++;
+        }
+    }
+
+    if (convertingPerArea[area] == 0) {
+        pendingAreas.remove(area);
+    } else if (!convertTimer->isActive()) {
+        convertTimer->start();
+    }
+}
+
+void WorldStreamer::convertChunks()
+{
+    const int count = qMin(CHUNKS_PER_CONVERSION, converting.size());
+    for (int i = 0; i < count; ++i) {
+        const DecodedChunk &decoded = converting[i];
+        const int key = chunkKey(decoded.area, decoded.index);
+        if (!cache.contains(key)) {
+            CachedChunk chunk;
+            chunk.pixmap = QPixmap::fromImage(decoded.image);
+            chunk.bytes = static_cast<qint64>(decoded.image.bytesPerLine()) * decoded.image.height();
+            chunk.lastUsed = ++useCounter;
+            cache.insert(key, chunk);
+            cachedPerArea[decoded.area]++;
+            bytesUsed += chunk.bytes;
+        }
+
+        if (--convertingPerArea[decoded.area] == 0) {
+            pendingAreas.remove(decoded.area);
+            qDebug() << "Streamed area" << decoded.area << "in" << cachedPerArea[decoded.area] << "chunks,"
+                     << bytesUsed / 1024 << "KB cached";
+        }
+    }
+    converting.remove(0, count);
+    if (converting.isEmpty()) {
+        convertTimer->stop();
+    }
+
+    evictToBudget();
+
+    // Show the chunks that were missing from the current view
+    if (scene) {
+        for (int area = 0; area < MapLayout::AREA_COUNT; ++area) {
+            if (!shownRangeComplete[area]) {
+                setView(lastView);
+                break;
+            }
+        }
+    }
+}
+
+void WorldStreamer::evictToBudget()
+{
+    while (bytesUsed > memoryBudget) {
+        // Only a few dozen chunks exist, so a linear scan for the oldest is fine
+        auto oldest = cache.end();
+        for (auto it = cache.begin(); it != cache.end(); ++it) {
+            QGraphicsPixmapItem *item = items.value(it.key());
+            if (item && item->isVisible()) {
+                continue;  // On screen
+            }
+            if (oldest == cache.end() || it->lastUsed < oldest->lastUsed) {
+                oldest = it;
+            }
+        }
+        if (oldest == cache.end()) {
+            break;
+        }
+        if (QGraphicsPixmapItem *hidden = items.take(oldest.key())) {
+            scene->removeItem(hidden);
+            delete hidden;
+        }
+        bytesUsed -= oldest->bytes;
+        cachedPerArea[oldest.key() >> 16]--;
+        cache.erase(oldest);
+    }
+}
@@ -0,0 +1,144 @@
+#ifndef WORLDSTREAMER_H
+#define WORLDSTREAMER_H
+
+#include "maplayout.h"
+#include <QHash>
+#include <QImage>
+#include <QObject>
+#include <QPixmap>
+#include <QPointF>
+#include <QRect>
+#include <QRectF>
+#include <QSet>
+#include <QVector>
+
+class QGraphicsScene;
+class QGraphicsPixmapItem;
+class QThread;
+class QTimer;
+
+// Loads area backgrounds on the streaming thread: decode, scale to the
+// area size and slice into CHUNK_SIZE squares, row by row
+class ChunkDecoder : public QObject
+{
+    Q_OBJECT
+
+public slots:
+    void decode(int area);
+
+signals:
+    void decoded(int area, const QVector<QImage> &chunks);
+};
+
+// Streams the world into the scene in square chunks: the area backgrounds,
+// and the static sprites standing on them.
+//
+// Backgrounds are decoded and sliced off the GUI thread, so walking into an
+// area never stalls a frame on a PNG decode. Only the chunks around the
+// camera get graphics items, whichever areas they belong to; the rest wait
+// in a cache that is bounded by a byte budget and evicts the least recently
+// used chunk first. When the camera gets close to another area, or to a
+// door leading into one, that area is decoded ahead of time, so the player
+// finds its background ready.
+class WorldStreamer : public QObject
+{
+    Q_OBJECT
+
+public:
+    static const int CHUNK_SIZE = MapLayout::CHUNK_SIZE;
+
+    explicit WorldStreamer(QObject *parent = nullptr);
+    ~WorldStreamer();
+
+    // Shows the world in scene, in world coordinates
+    void attach(QGraphicsScene *scene, qreal z = 0);
+    // Removes the chunk and sprite items and forgets the sprites; call
+    // before the scene is cleared
+    void detach();
+
+    // viewRect: the part of the world the camera currently shows
+    void setView(const QRectF &viewRect);
+
+    // Something that never moves, like a box or the lab's NPC, with its
+    // top-left corner at pos. Its item only exists while the chunk under
+    // pos is in range. Returns the id for removeSprite().
+    int addSprite(const QPixmap &pixmap, const QPointF &pos, qreal z);
+    void removeSprite(int id);
+
+    // Queues an area for decoding if it is not cached already
+    void prefetch(MapLayout::Area area);
+
+    void setMemoryBudget(qint64 bytes);
+    qint64 memoryUsed() const { return bytesUsed; }
+    int cachedChunkCount() const { return cache.size(); }
+    int visibleChunkCount() const;
+
+signals:
+    // After every setView(), for scenes that cull items of their own
+    void viewChanged(const QRectF &viewRect);
+
+private:
+    struct CachedChunk {
+        QPixmap pixmap;
+        qint64 bytes{0};
+        quint64 lastUsed{0};
+    };
+
+    QThread *decoderThread{nullptr};
+    ChunkDecoder *decoder{nullptr};
+    QSet<int> pendingAreas;  // Decoding, or waiting to become pixmaps
+
+    // Decoded chunks waiting to become pixmaps, a few per event loop turn
+    struct DecodedChunk {
+        int area;
+        int index;
+        QImage image;
+    };
+    QVector<DecodedChunk> converting;
+    int convertingPerArea[MapLayout::AREA_COUNT] = {};
+    QTimer *convertTimer{nullptr};
+
+    // Chunk key (area and chunk index) -> chunk
+    QHash<int, CachedChunk> cache;
+    int cachedPerArea[MapLayout::AREA_COUNT] = {};
+    int areaColumns[MapLayout::AREA_COUNT] = {};
+    int areaRows[MapLayout::AREA_COUNT] = {};
+    QRectF areaRects[MapLayout::AREA_COUNT];
+    QVector<MapLayout::PortalLink> portals;
+    qint64 bytesUsed{0};
+    qint64 memoryBudget;
+    quint64 useCounter{0};
+
+    // What is currently shown
+    QGraphicsScene *scene{nullptr};
+    qreal zValue{0};
+    QRectF lastView;
+    QHash<int, QGraphicsPixmapItem *> items;  // Hidden while out of range
+    QRect shownRange[MapLayout::AREA_COUNT];  // Columns and rows of each area that have items
+    bool shownRangeComplete[MapLayout::AREA_COUNT] = {};  // False while some of them are still decoding
+
+    struct Sprite {
+        QPixmap pixmap;
+        QPointF pos;
+        qreal z;
+        int chunk;  // Key of the chunk under pos, -1 off every area (always shown)
+        QGraphicsPixmapItem *item{nullptr};  // While the chunk is in range
+    };
+    QHash<int, Sprite> sprites;
+    QHash<int, QVector<int>> chunkSprites;  // Chunk key -> ids of the sprites on it
+    int nextSpriteId{1};
+
+    static int chunkKey(int area, int index) { return (area << 16) | index; }
+    static int columnCount(MapLayout::Area area);
+    static int rowCount(MapLayout::Area area);
+
+    void updateItems(int area, const QRect &range);
+    void showSprites(int chunk);
+    void hideSprites(int chunk);
+    void showSprite(Sprite &sprite);
+    void chunksDecoded(int area, const QVector<QImage> &chunks);
+    void convertChunks();
+    void evictToBudget();
+};
+
+#endif // WORLDSTREAMER_H